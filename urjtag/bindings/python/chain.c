@@ -333,6 +333,54 @@ urj_pyc_get_frequency (urj_pychain_t *self, PyObject *args)
     return Py_BuildValue ("i", (uint32_t) freq);
 }
 
+/* return the performance counters of the cable as a dictionary
+ */
+static PyObject *
+urj_pyc_get_cable_stats (urj_pychain_t *self, PyObject *args)
+{
+    urj_chain_t *urc = self->urchain;
+    urj_cable_stats_t stats;
+    PyObject *latency;
+    int i;
+
+    if (!urj_pyc_precheck (urc, UPRC_CBL))
+        return NULL;
+
+    urj_tap_cable_get_stats (urc->cable, &stats);
+
+    latency = PyList_New (URJ_CABLE_STATS_LATENCY_BUCKETS);
+    if (latency == NULL)
+        return NULL;
+    for (i = 0; i < URJ_CABLE_STATS_LATENCY_BUCKETS; i++)
+        PyList_SET_ITEM (latency, i,
+                         PyLong_FromUnsignedLongLong (stats.latency[i]));
+
+    return Py_BuildValue ("{s:K,s:K,s:K,s:(K,K,K),s:K,s:K,s:K,s:N}",
+                          "items", (unsigned long long) stats.items,
+                          "clocks", (unsigned long long) stats.clocks,
+                          "bits", (unsigned long long) stats.bits,
+                          "flushes",
+                          (unsigned long long) stats.flushes[URJ_TAP_CABLE_OPTIONALLY],
+                          (unsigned long long) stats.flushes[URJ_TAP_CABLE_TO_OUTPUT],
+                          (unsigned long long) stats.flushes[URJ_TAP_CABLE_COMPLETELY],
+                          "transactions",
+                          (unsigned long long) stats.transactions,
+                          "bytes_out", (unsigned long long) stats.bytes_out,
+                          "bytes_in", (unsigned long long) stats.bytes_in,
+                          "latency", latency);
+}
+
+static PyObject *
+urj_pyc_reset_cable_stats (urj_pychain_t *self, PyObject *args)
+{
+    urj_chain_t *urc = self->urchain;
+    if (!urj_pyc_precheck (urc, UPRC_CBL))
+        return NULL;
+
+    urj_tap_cable_reset_stats (urc->cable);
+    return Py_BuildValue ("");
+}
+
 /* set instruction for the active part
  */
 static PyObject *
@@ -837,6 +885,10 @@ static PyMethodDef urj_pyc_methods[] =
      "Change the TCK frequency to be at most the specified value in Hz"},
     {"get_frequency", (PyCFunction) urj_pyc_get_frequency, METH_NOARGS,
      "get the current TCK frequency"},
+    {"get_cable_stats", (PyCFunction) urj_pyc_get_cable_stats, METH_NOARGS,
+     "get the performance counters of the cable as a dictionary"},
+    {"reset_cable_stats", (PyCFunction) urj_pyc_reset_cable_stats, METH_NOARGS,
+     "set the performance counters of the cable to zero"},
     {"set_instruction", (PyCFunction) urj_pyc_set_instruction, METH_VARARGS,
      "Set values in the instruction register holding buffer"},
     {"shift_ir", (PyCFunction) urj_pyc_shift_ir, METH_NOARGS,
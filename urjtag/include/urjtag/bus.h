@@ -37,6 +37,20 @@ extern urj_bus_t *urj_bus;
 int urj_bus_readmem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_bus_writemem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len);
+/**
+ * Write @count words of @data to consecutive bus addresses from @adr on,
+ * with the driver's write_block or urj_bus_generic_write_block().
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_bus_write_block (urj_bus_t *bus, uint32_t adr, const uint32_t *data,
+                         int count);
+/**
+ * Read @count words from consecutive bus addresses from @adr on into @data,
+ * with the driver's read_block or urj_bus_generic_read_block().
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *data,
+                        int count);
 
 typedef struct
 {
@@ -121,6 +121,22 @@ struct URJ_BUS_DRIVER
     int (*enable) (urj_bus_t *bus);
     int (*disable) (urj_bus_t *bus);
     urj_bus_type_t bus_type;
+    /**
+     * Write @count words of @data to consecutive bus addresses from @adr
+     * on, with the result of as many calls of write. Optional: drivers
+     * that leave it NULL get urj_bus_generic_write_block().
+     * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+     */
+    int (*write_block) (urj_bus_t *bus, uint32_t adr, const uint32_t *data,
+                        int count);
+    /**
+     * Read @count words from consecutive bus addresses from @adr on into
+     * @data, with the result of read_start, read_next and read_end.
+     * Optional: drivers that leave it NULL get urj_bus_generic_read_block().
+     * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+     */
+    int (*read_block) (urj_bus_t *bus, uint32_t adr, uint32_t *data,
+                       int count);
 };
 
 struct URJ_BUS
@@ -66,11 +66,37 @@ typedef enum URJ_CABLE_PARAM_KEY
     URJ_CABLE_PARAM_KEY_INTERFACE,      /* lu           ftdi */
     URJ_CABLE_PARAM_KEY_FIRMWARE,       /* string       ice100 */
     URJ_CABLE_PARAM_KEY_INDEX,          /* lu           ftdi */
+    URJ_CABLE_PARAM_KEY_IOTHREAD,       /* bool         cable.c */
+    URJ_CABLE_PARAM_KEY_PROFILE,        /* string       loopback */
+    URJ_CABLE_PARAM_KEY_LATENCY,        /* lu           loopback */
+    URJ_CABLE_PARAM_KEY_BANDWIDTH,      /* lu           loopback */
+    URJ_CABLE_PARAM_KEY_PACKET,         /* lu           loopback */
+    URJ_CABLE_PARAM_KEY_TARGET,         /* string       loopback */
+    URJ_CABLE_PARAM_KEY_RECORD,         /* string       generic_usbconn */
+    URJ_CABLE_PARAM_KEY_REPLAY,         /* string       generic_usbconn */
+    URJ_CABLE_PARAM_KEY_CHIP,           /* string       gpiochip */
+    URJ_CABLE_PARAM_KEY_MEM,            /* string       mmgpio */
+    URJ_CABLE_PARAM_KEY_BASE,           /* lu           mmgpio */
+    URJ_CABLE_PARAM_KEY_OUTREG,         /* lu           mmgpio */
+    URJ_CABLE_PARAM_KEY_INREG,          /* lu           mmgpio */
+    URJ_CABLE_PARAM_KEY_DIRREG,         /* lu           mmgpio */
+    URJ_CABLE_PARAM_KEY_HOST,           /* string       remote */
+    URJ_CABLE_PARAM_KEY_PORT,           /* lu           remote */
 }
 urj_cable_param_key_t;
 
 /* Random cable-specific quirks; a bitfield */
 #define URJ_CABLE_QUIRK_ONESHOT 0x1
+/* flush() can't handle URJ_TAP_CABLE_TMS_SEQUENCE items */
+#define URJ_CABLE_QUIRK_NO_TMS_SEQUENCE 0x2
+
+/* The entries of a TMS sequence, one char per clock; a bitfield */
+#define URJ_CABLE_SEQ_TDI       0x1     /* TDI value for this clock */
+#define URJ_CABLE_SEQ_TMS       0x2     /* TMS value for this clock */
+#define URJ_CABLE_SEQ_CAPTURE   0x4     /* record TDO before this clock */
+
+/* Maximum length of the TMS bits held back by urj_tap_cable_defer_tms_prefix() */
+#define URJ_CABLE_SEQ_PREFIX_MAX 8
 
 struct URJ_CABLE_DRIVER
 {
@@ -105,6 +131,11 @@ struct URJ_CABLE_DRIVER
     void (*help) (urj_log_level_t ll, const char *);
     /* A bitfield of quirks */
     uint32_t quirks;
+    /** Clock out a sequence of TMS/TDI bits (see URJ_CABLE_SEQ_*) and
+     * store the TDO bits of the clocks marked for capture in the last
+     * argument, in order. NULL selects urj_tap_cable_generic_tms_sequence().
+     * @return the number of captured bits on success; -1 on failure */
+    int (*tms_sequence) (urj_cable_t *, int, const char *, char *);
 };
 
 typedef struct URJ_CABLE_QUEUE urj_cable_queue_t;
@@ -118,7 +149,8 @@ struct URJ_CABLE_QUEUE
         URJ_TAP_CABLE_GET_TDO,
         URJ_TAP_CABLE_TRANSFER,
         URJ_TAP_CABLE_SET_SIGNAL,
-        URJ_TAP_CABLE_GET_SIGNAL
+        URJ_TAP_CABLE_GET_SIGNAL,
+        URJ_TAP_CABLE_TMS_SEQUENCE
     } action;
     union
     {
@@ -141,6 +173,12 @@ struct URJ_CABLE_QUEUE
             char *out;
         } transfer;
         struct
+        {
+            int len;
+            char *seq;
+            char *out;
+        } sequence;
+        struct
         {
             int len;
             int res;
@@ -158,6 +196,54 @@ struct URJ_CABLE_QUEUE_INFO
     int num_items;
     int next_item;
     int next_free;
+    int high_water;             /**< largest num_items seen so far */
+    int resizes;                /**< number of times data was enlarged */
+};
+
+typedef struct URJ_CABLE_ARENA_CHUNK urj_cable_arena_chunk_t;
+typedef struct URJ_CABLE_IO_THREAD urj_cable_io_thread_t;
+
+/**
+ * Memory for the payloads of queued transfers. Chunks are only ever
+ * appended while there is queued activity; once both queues have drained,
+ * the arena is rewound to a single chunk sized for what the last cycle
+ * used, so a steady stream of transfers does not touch the heap at all and
+ * a long one does not keep growing it.
+ */
+struct URJ_CABLE_ARENA_CHUNK
+{
+    urj_cable_arena_chunk_t *next;
+    size_t size;
+    size_t used;
+    char *data;
+};
+
+/* Number of buckets in urj_cable_stats_t.latency */
+#define URJ_CABLE_STATS_LATENCY_BUCKETS 20
+
+typedef struct URJ_CABLE_STATS urj_cable_stats_t;
+
+/**
+ * Performance counters of a cable. Transactions and bytes are counted by
+ * urj_tap_usbconn_read/write/bulk/control() and the urj_tap_parport_*()
+ * accessors, all others by the cable layer.
+ */
+struct URJ_CABLE_STATS
+{
+    uint64_t items;             /**< items queued for the driver */
+    uint64_t clocks;            /**< TCK cycles, queued or immediate */
+    uint64_t bits;              /**< clocks with TMS = 0 in transfers and
+                                     TMS sequences, i.e. shifted bits */
+    uint64_t flushes[URJ_TAP_CABLE_COMPLETELY + 1];   /**< by amount */
+    uint64_t transactions;      /**< USB transfers or parport accesses */
+    uint64_t bytes_out;         /**< bytes sent to the cable */
+    uint64_t bytes_in;          /**< bytes received from the cable */
+    /** Round trips of flushes with URJ_TAP_CABLE_TO_OUTPUT or
+     * URJ_TAP_CABLE_COMPLETELY: bucket 0 counts those below 1 us, bucket i
+     * those from 2^(i-1) up to 2^i us, the last one all longer ones */
+    uint64_t latency[URJ_CABLE_STATS_LATENCY_BUCKETS];
+    uint64_t arena_bytes;       /**< memory held by the transfer arena when
+                                     the counters were read */
 };
 
 struct URJ_CABLE
@@ -173,6 +259,13 @@ struct URJ_CABLE
     urj_chain_t *chain;
     urj_cable_queue_info_t todo;
     urj_cable_queue_info_t done;
+    urj_cable_arena_chunk_t *arena;
+    char *scratch;              /**< see urj_tap_cable_scratch() */
+    size_t scratch_size;
+    urj_cable_io_thread_t *io_thread;   /**< NULL unless pipelined */
+    char prefix[URJ_CABLE_SEQ_PREFIX_MAX];  /**< see urj_tap_cable_defer_tms_prefix() */
+    int prefix_len;
+    urj_cable_stats_t stats;    /**< see urj_tap_cable_get_stats() */
     uint32_t delay;
     uint32_t frequency;
 };
@@ -211,11 +304,95 @@ int urj_tap_cable_transfer_late (urj_cable_t *cable, char *out);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure */
 int urj_tap_cable_defer_transfer (urj_cable_t *cable, int len, char *in,
                                   char *out);
+/**
+ * Like urj_tap_cable_defer_transfer(), but queue the caller's buffers
+ * without copying them. @in must stay unchanged until the transfer has been
+ * flushed; if @out is not NULL, the TDO bits are stored straight into it and
+ * the result still has to be collected with urj_tap_cable_transfer_late().
+ * Buffers from urj_tap_cable_arena_alloc() meet these requirements.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure
+ */
+int urj_tap_cable_defer_transfer_nocopy (urj_cable_t *cable, int len,
+                                         char *in, char *out);
+/** @return the number of captured bits on success; -1 on failure */
+int urj_tap_cable_tms_sequence (urj_cable_t *cable, int len, const char *seq,
+                                char *out);
+/** @return the number of captured bits on success; -1 on failure */
+int urj_tap_cable_tms_sequence_late (urj_cable_t *cable, char *out);
+/**
+ * Queue a sequence of @len clocks with the TMS and TDI values given in
+ * @seq (see URJ_CABLE_SEQ_*). A complete scan, from leaving Run-Test/Idle
+ * to entering Update-DR, fits into one sequence, so the driver can send it
+ * as one transaction. The buffers are queued without copying them, the
+ * same requirements as for urj_tap_cable_defer_transfer_nocopy() apply.
+ * If any clocks are marked for capture, @out receives their TDO bits, and
+ * the result has to be collected with urj_tap_cable_tms_sequence_late().
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure
+ */
+int urj_tap_cable_defer_tms_sequence (urj_cable_t *cable, int len, char *seq,
+                                      char *out);
+/**
+ * Queue the few clocks that lead into a scan, e.g. from Run-Test/Idle to
+ * Capture-DR. They are held back and become the beginning of the next
+ * urj_tap_cable_defer_tms_sequence(); any other cable activity queues them
+ * as plain clocks first. At most URJ_CABLE_SEQ_PREFIX_MAX clocks can be
+ * held back, capturing is not supported.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure
+ */
+int urj_tap_cable_defer_tms_prefix (urj_cable_t *cable, int len,
+                                    const char *seq);
+/**
+ * Allocate @len bytes from the cable's transfer arena. The memory stays
+ * valid until the next allocation that finds both the todo and done queues
+ * empty, i.e. for one complete defer/flush/collect cycle. Callers that need
+ * several buffers for the same transfer should carve them out of a single
+ * allocation.
+ *
+ * @return pointer to the memory on success; NULL on failure
+ */
+char *urj_tap_cable_arena_alloc (urj_cable_t *cable, int len);
+/**
+ * Scratch memory for the flush() method of a driver, e.g. to combine
+ * several queued transfers. Unlike the arena it belongs to the side that
+ * runs the driver, which may be the I/O thread. Its contents are undefined
+ * after the next call.
+ *
+ * @return pointer to at least @len bytes on success; NULL on failure
+ */
+char *urj_tap_cable_scratch (urj_cable_t *cable, size_t len);
 
+/**
+ * Start or stop the background I/O thread. While it runs, deferred
+ * activity is handed to a dedicated thread that runs the driver's
+ * flush(), so the caller can prepare the next scan while the previous one
+ * is still in progress. This can also be requested with the "iothread"
+ * parameter of the cable command.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure
+ */
+int urj_tap_cable_set_io_thread (urj_cable_t *cable, int enable);
+/**
+ * Copy the performance counters of @cable to @stats. If the I/O thread
+ * runs, this waits until it has finished the queued activity.
+ */
+void urj_tap_cable_get_stats (urj_cable_t *cable, urj_cable_stats_t *stats);
+/** Set all performance counters of @cable to zero */
+void urj_tap_cable_reset_stats (urj_cable_t *cable);
 void urj_tap_cable_set_frequency (urj_cable_t *cable, uint32_t frequency);
 uint32_t urj_tap_cable_get_frequency (urj_cable_t *cable);
 void urj_tap_cable_wait (urj_cable_t *cable);
 void urj_tap_cable_purge_queue (urj_cable_queue_info_t *q, int io);
+/**
+ * Make sure that @num_items more items can be queued (and their results
+ * kept) without having to resize the queues on the way. Callers that know
+ * the size of a batch up front save the repeated growing this way.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure
+ */
+int urj_tap_cable_reserve_queue (urj_cable_t *cable, int num_items);
 /** @return queue item number on success; -1 on failure */
 int urj_tap_cable_add_queue_item (urj_cable_t *cable,
                                   urj_cable_queue_info_t *q);
@@ -252,6 +429,20 @@ urj_cable_t *urj_tap_cable_other_connect (urj_chain_t *chain,
                                           const urj_cable_driver_t *driver,
                                           const urj_param_t *params[]);
 
+/** Default TCP port of jtag-serve for the "remote" cable */
+#define URJ_CABLE_REMOTE_PORT   5225
+
+/**
+ * Serve the protocol of the "remote" cable on the connected socket @fd:
+ * the cable activity a client sends is queued on @cable and the results
+ * are sent back. Returns when the client closes the connection. Only
+ * available if the remote cable driver is enabled.
+ *
+ * @return URJ_STATUS_OK when the client has closed the connection;
+ *      URJ_STATUS_FAIL on failure
+ */
+int urj_tap_cable_remote_serve (urj_cable_t *cable, int fd);
+
 extern const urj_cable_driver_t * const urj_tap_cable_drivers[];
 
 /** The list of recognized parameters */
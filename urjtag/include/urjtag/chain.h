@@ -45,6 +45,7 @@ struct URJ_CHAIN
     urj_cable_t *cable;
     urj_bsdl_globs_t bsdl;
     int main_part;
+    int defer_output;           /* see urj_tap_chain_defer_output_begin() */
 };
 
 urj_chain_t *urj_tap_chain_alloc (void);
@@ -64,6 +65,22 @@ void urj_tap_chain_disconnect (urj_chain_t *chain);
 int urj_tap_chain_clock (urj_chain_t *chain, int tms, int tdi, int n);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_tap_chain_defer_clock (urj_chain_t *chain, int tms, int tdi, int n);
+/**
+ * Queue clocks with the given TMS values and TDI = 0, the first one in bit 0
+ * of @tms. Up to URJ_CABLE_SEQ_PREFIX_MAX clocks go to the cable as a single
+ * queue item.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_tap_chain_defer_tms_path (urj_chain_t *chain, int len,
+                                  unsigned int tms);
+/**
+ * Queue the shortest way from the current TAP state to @state, see
+ * urj_tap_state_path(). From an unknown state, the TAP is reset first.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_tap_chain_defer_goto_state (urj_chain_t *chain, int state);
 /** @return trst = 0 or 1 on success; -1 on error */
 int urj_tap_chain_set_trst (urj_chain_t *chain, int trst);
 /** @return 0 or 1 on success; -1 on error */
@@ -81,7 +98,28 @@ int urj_tap_chain_shift_data_registers (urj_chain_t *chain,
 int urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
                                              int capture_output, int capture,
                                              int chain_exit);
+/**
+ * Queue a capture and shift of the data registers of all parts, like
+ * urj_tap_chain_shift_data_registers() with capture_output, but leave the
+ * captured bits in the cable's queue. Each call must be matched, in order,
+ * by a urj_tap_chain_get_data_registers(), which stores the bits in the
+ * out registers of the parts; the first of those flushes the cable. This
+ * lets a run of scans, such as the cycles of a block read, be sent off
+ * and read back in few round trips.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_tap_chain_defer_data_registers (urj_chain_t *chain);
+void urj_tap_chain_get_data_registers (urj_chain_t *chain);
 void urj_tap_chain_flush (urj_chain_t *chain);
+/**
+ * Until the matching urj_tap_chain_defer_output_end(), instruction and
+ * data register shifts that capture no output stay in the cable queue rather than being
+ * sent off one by one, so that a run of them, such as the bus cycles of a
+ * block write, goes to the cable in few round trips. Calls nest; the
+ * outermost end flushes the queue to the cable.
+ */
+void urj_tap_chain_defer_output_begin (urj_chain_t *chain);
+void urj_tap_chain_defer_output_end (urj_chain_t *chain);
 /** @return 0 or 1 on success; -1 on failure */
 int urj_tap_chain_set_pod_signal (urj_chain_t *chain, int mask, int val);
 /** @return 0 or 1 on success; -1 on failure */
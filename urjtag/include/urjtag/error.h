@@ -96,7 +96,15 @@ typedef struct URJ_ERROR_STATE
 }
 urj_error_state_t;
 
-extern urj_error_state_t        urj_error_state;
+/* Each thread has its own error state; the cable I/O thread passes the
+ * errors of the driver on to the thread that flushes the cable. */
+#ifdef __GNUC__
+# define URJ_ERROR_THREAD_LOCAL __thread
+#else
+# define URJ_ERROR_THREAD_LOCAL
+#endif
+
+extern URJ_ERROR_THREAD_LOCAL urj_error_state_t urj_error_state;
 
 /**
  * Descriptive string for error type
@@ -57,6 +57,14 @@ typedef struct
     int (*get_status) (urj_parport_t *);
     /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
     int (*set_control) (urj_parport_t *, unsigned char);
+    /** Optional: write @len bytes to the data register in a row.
+     * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+    int (*write_data_seq) (urj_parport_t *, const unsigned char *, int);
+    /** Optional: as write_data_seq, reading the status register after
+     * each byte into the last argument.
+     * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+    int (*read_status_seq) (urj_parport_t *, const unsigned char *, int,
+                            unsigned char *);
 }
 urj_parport_driver_t;
 
@@ -75,6 +83,16 @@ int urj_tap_parport_get_data (urj_parport_t *port);
 /** @return status on success; -1 on error */
 int urj_tap_parport_get_status (urj_parport_t *port);
 int urj_tap_parport_set_control (urj_parport_t *port, const unsigned char data);
+/** Write @len bytes to the data register in a row.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+int urj_tap_parport_write_data_seq (urj_parport_t *port,
+                                    const unsigned char *data, int len);
+/** Write @len bytes to the data register, reading the status after each
+ * of them into @status.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+int urj_tap_parport_read_status_seq (urj_parport_t *port,
+                                     const unsigned char *data, int len,
+                                     unsigned char *status);
 
 const char *urj_cable_parport_devtype_string(urj_cable_parport_devtype_t dt);
 
@@ -25,6 +25,8 @@
 #ifndef URJ_PART_H
 #define URJ_PART_H
 
+#include <stdint.h>
+
 #include "types.h"
 
 #define URJ_PART_MANUFACTURER_MAXLEN    25
@@ -51,9 +53,13 @@ struct URJ_PART
     urj_part_instruction_t *instructions;
     urj_part_instruction_t *active_instruction;
     urj_data_register_t *data_registers;
+    urj_data_register_t *bsr;   /* Boundary Scan Register, NULL if none */
     int boundary_length;
     urj_bsbit_t **bsbits;
     urj_part_params_t *params;
+    urj_part_index_t *index;    /* name lookup, see part.c */
+    unsigned int generation;    /* bumped when signals, bits or data
+                                   registers change; see sighandles */
 };
 
 urj_part_t *urj_part_alloc (const urj_tap_register_t *id);
@@ -79,6 +85,55 @@ int urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val);
 
 /** @return -1 on error; signal number >= 0 for success */
 int urj_part_get_signal (urj_part_t *p, const urj_part_signal_t *s);
+
+/**
+ * A signal resolved to its boundary scan cells, for bus drivers that drive
+ * and sample the same signals on every bus cycle. The accessors below do no
+ * lookups and no checks: a cell the signal lacks is simply left alone.
+ * Later signal, bit or register definitions leave a handle stale until
+ * urj_part_sighandles_refresh () resolves it again.
+ */
+struct URJ_PART_SIGHANDLE
+{
+    urj_part_t *part;
+    const urj_part_signal_t *signal;
+    unsigned int generation;    /* of part when resolved */
+    urj_data_register_t *bsr;
+    int output;                 /* cell driving the pin; -1 if none */
+    int control;                /* cell enabling the driver; -1 if none */
+    int control_value;          /* control cell value that disables it */
+    int input;                  /* cell sampling the pin; -1 if none */
+};
+
+/**
+ * Resolve signal s of part p into handle h. A NULL signal gives a handle
+ * without cells.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL if p has no BSR
+ */
+int urj_part_sighandle_init (urj_part_t *p, const urj_part_signal_t *s,
+                             urj_part_sighandle_t *h);
+/**
+ * Resolve again those of the n handles of h[] that went stale since they
+ * were resolved; a no-op while their part is unchanged.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_sighandles_refresh (urj_part_sighandle_t *h, int n);
+/** Drive the signal of h to val, as urj_part_set_signal (p, s, 1, val) */
+void urj_part_sighandle_set (const urj_part_sighandle_t *h, int val);
+/** Turn the signal of h into an input, as urj_part_set_signal_input () */
+void urj_part_sighandle_set_input (const urj_part_sighandle_t *h);
+/** @return the sampled value of the signal of h; 0 if it has no input */
+int urj_part_sighandle_get (const urj_part_sighandle_t *h);
+/**
+ * Drive the n signals of h[] to the bits of val, h[0] to bit 0, or turn
+ * them all into inputs with urj_part_sighandles_set_input (). Sample them
+ * back into a value with urj_part_sighandles_get ().
+ */
+void urj_part_sighandles_set (const urj_part_sighandle_t *h, int n,
+                              uint32_t val);
+void urj_part_sighandles_set_input (const urj_part_sighandle_t *h, int n);
+uint32_t urj_part_sighandles_get (const urj_part_sighandle_t *h, int n);
+
 /* @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_part_print (urj_log_level_t ll, urj_part_t *p);
 /**
@@ -25,6 +25,8 @@
 #ifndef URJ_TAP_H
 #define URJ_TAP_H
 
+#include <stdint.h>
+
 #include "types.h"
 
 void urj_tap_reset (urj_chain_t *chain);
@@ -52,6 +54,16 @@ int urj_tap_manual_add (urj_chain_t *chain, int instr_len);
 int urj_tap_detect_register_size (urj_chain_t *chain, int maxlen);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_tap_discovery (urj_chain_t *chain);
+/**
+ * Find the highest TCK frequency, up to @max_frequency (0: a default), at
+ * which long pseudo-random patterns come back bit-exact through all parts
+ * in BYPASS. The cable is left at that frequency less a safety margin,
+ * which is stored in @frequency.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_tap_auto_frequency (urj_chain_t *chain, uint32_t max_frequency,
+                            uint32_t *frequency);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_tap_idcode (urj_chain_t *chain, unsigned int bytes);
 /**
@@ -28,9 +28,19 @@
 #include "types.h"
 #include <stdint.h>
 
+/*
+ * Register bits are stored packed, URJ_TAP_REGISTER_WORD_BITS per word.
+ * Bit i lives in words[i / URJ_TAP_REGISTER_WORD_BITS] at position
+ * i % URJ_TAP_REGISTER_WORD_BITS; bit 0 is the bit shifted out first.
+ * Unused bits in the last word are always kept 0.
+ */
+#define URJ_TAP_REGISTER_WORD_BITS      64
+#define URJ_TAP_REGISTER_WORDS(len) \
+    (((len) + URJ_TAP_REGISTER_WORD_BITS - 1) / URJ_TAP_REGISTER_WORD_BITS)
+
 struct URJ_TAP_REGISTER
 {
-    char *data;         /* (public, r/w) register data */
+    uint64_t *words;    /* (private) packed register data */
     int len;            /* (public, r/o) register length */
     char *string;       /* (private) string representation of register data */
 };
@@ -60,4 +70,40 @@ urj_tap_register_t *urj_tap_register_shift_right (urj_tap_register_t *tr,
 urj_tap_register_t *urj_tap_register_shift_left (urj_tap_register_t *tr,
                                                  int shift);
 
+/**
+ * Single bit access. No range checking is done, pos must be within
+ * 0 .. tr->len - 1.
+ */
+int urj_tap_register_get_bit (const urj_tap_register_t *tr, int pos);
+void urj_tap_register_set_bit (urj_tap_register_t *tr, int pos, int val);
+
+/**
+ * Whole word access to the packed layout described above, for code that
+ * precomputes masks of many bits. No range checking is done, word must be
+ * within 0 .. URJ_TAP_REGISTER_WORDS (tr->len) - 1. update_word replaces
+ * the bits of the word selected by mask with those of val.
+ */
+uint64_t urj_tap_register_get_word (const urj_tap_register_t *tr, int word);
+void urj_tap_register_update_word (urj_tap_register_t *tr, int word,
+                                   uint64_t mask, uint64_t val);
+
+/**
+ * Bulk import/export of byte buffers. Byte 0 holds register bits 0..7;
+ * within a byte, bit 0 of the register is the LSB unless msb_first is set
+ * (e.g. for Xilinx bitstreams). At most tr->len bits are transferred; the
+ * remaining bits of the register or buffer are left untouched.
+ */
+int urj_tap_register_set_bytes (urj_tap_register_t *tr, const uint8_t *buf,
+                                int nbytes, int msb_first);
+int urj_tap_register_get_bytes (const urj_tap_register_t *tr, uint8_t *buf,
+                                int nbytes, int msb_first);
+
+/**
+ * Conversion from/to the unpacked one-char-per-bit format used by
+ * the cable drivers (urj_cable_driver_t::transfer) and by older code that
+ * indexed the register data directly. bits must hold tr->len chars.
+ */
+void urj_tap_register_unpack (const urj_tap_register_t *tr, char *bits);
+void urj_tap_register_pack (urj_tap_register_t *tr, const char *bits);
+
 #endif /* URJ_REGISTER_H */
@@ -63,4 +63,19 @@ int urj_tap_state_reset (urj_chain_t *chain);
 int urj_tap_state_set_trst (urj_chain_t *chain, int old_trst, int new_trst);
 int urj_tap_state_clock (urj_chain_t *chain, int tms);
 
+/* Maximum number of clocks returned by urj_tap_state_path() */
+#define URJ_TAP_STATE_PATH_MAX  8
+
+/**
+ * Look up the shortest way from one TAP state to another.
+ *
+ * @param from  current state
+ * @param to    destination state
+ * @param tms   receives the TMS values, the one for the first clock in bit 0
+ *
+ * @return the number of clocks (0 if from == to); -1 if either state is
+ *      unknown
+ */
+int urj_tap_state_path (int from, int to, unsigned int *tms);
+
 #endif /* URJ_TAP_STATE_H */
@@ -39,6 +39,8 @@ typedef struct URJ_PART_SALIAS urj_part_salias_t;
 typedef struct URJ_PART_INSTRUCTION urj_part_instruction_t;
 typedef struct URJ_PART_PARAMS urj_part_params_t;
 typedef struct URJ_PART_INIT urj_part_init_t;
+typedef struct URJ_PART_INDEX urj_part_index_t;
+typedef struct URJ_PART_SIGHANDLE urj_part_sighandle_t;
 typedef struct URJ_DATA_REGISTER urj_data_register_t;
 typedef struct URJ_BSBIT urj_bsbit_t;
 typedef struct URJ_TAP_REGISTER urj_tap_register_t;
@@ -57,9 +57,16 @@ typedef struct
     int (*read) (urj_usbconn_t *, uint8_t *, int);
     /** @return bytes written on success; -1 on error */
     int (*write) (urj_usbconn_t *, uint8_t *, int, int);
+    /** @return bytes transferred on success; -1 on error */
+    int (*bulk) (urj_usbconn_t *, int, uint8_t *, int, int);
+    /** @return bytes transferred on success; -1 on error */
+    int (*control) (urj_usbconn_t *, int, int, int, int, uint8_t *, int, int);
 }
 urj_usbconn_driver_t;
 
+/* direction bit of bulk endpoints and control request types */
+#define URJ_USBCONN_ENDPOINT_IN         0x80
+
 struct URJ_USBCONN
 {
     const urj_usbconn_driver_t *driver;
@@ -72,6 +79,19 @@ int urj_tap_usbconn_close (urj_usbconn_t *conn);
 int urj_tap_usbconn_read (urj_usbconn_t *conn, uint8_t *buf, int len);
 int urj_tap_usbconn_write (urj_usbconn_t *conn, uint8_t *buf, int len,
                            int recv);
+/**
+ * Raw transfers for the cables that speak their own protocol on the
+ * endpoints of the device rather than going through read/write. A bulk
+ * transfer reads from endpoint into buf if it has URJ_USBCONN_ENDPOINT_IN
+ * set, and writes buf to it otherwise; likewise for control transfers and
+ * request_type.
+ * @return bytes transferred on success; -1 and urj_error on error
+ */
+int urj_tap_usbconn_bulk (urj_usbconn_t *conn, int endpoint, uint8_t *buf,
+                          int len, int timeout);
+int urj_tap_usbconn_control (urj_usbconn_t *conn, int request_type,
+                             int request, int value, int index,
+                             uint8_t *buf, int len, int timeout);
 extern const urj_usbconn_driver_t * const urj_tap_usbconn_drivers[];
 
 #endif /* URJ_USBCONN_H */
@@ -0,0 +1,569 @@
+/*
+ * $Id$
+ *
+ * Benchmarks of the TAP, bus and flash code on the JIM simulator
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <getopt.h>
+
+#include <urjtag/chain.h>
+#include <urjtag/cable.h>
+#include <urjtag/part.h>
+#include <urjtag/tap.h>
+#include <urjtag/tap_register.h>
+#include <urjtag/bus.h>
+#include <urjtag/flash.h>
+#include <urjtag/parse.h>
+#include <urjtag/log.h>
+#include <urjtag/error.h>
+#include <urjtag/fclock.h>
+#include <urjtag/jtag.h>
+#ifdef ENABLE_SVF
+#include <urjtag/svf.h>
+#endif
+#ifdef ENABLE_STAPL
+#include <urjtag/stapl.h>
+#endif
+
+#ifndef BENCH_SRCDIR
+#define BENCH_SRCDIR "."
+#endif
+#ifndef BENCH_JIM_DIR
+#define BENCH_JIM_DIR "../../jim"
+#endif
+
+/* Commands bringing up some_cpu and its flash, as in src/jim/README.jim */
+static const char *bench_setup[] = {
+    "cable jim",
+    "bsdl path " BENCH_JIM_DIR,
+    "detect",
+    "initbus prototype amsb=A(31) alsb=A(0) dmsb=D(15) dlsb=D(0) cs=CS oe=OE we=WE amode=8",
+    "detectflash 0",
+    NULL
+};
+
+/* Memory transfers go outside the flash, which is all that some_cpu has on
+ * its bus, so that they do not leave it in a command mode */
+#define BENCH_MEM_ADDR          0x00200000
+#define BENCH_MEM_LEN           0x1000
+#define BENCH_FLASH_LEN         0x400
+
+typedef struct bench bench_t;
+
+struct bench
+{
+    const char *name;
+    /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+    int (*run) (urj_chain_t *chain, const bench_t *b);
+    int ops;                    /**< operations at scale 1 */
+    int arg;
+};
+
+/* the image for writemem, the image for flashmem and the readmem output */
+static FILE *bench_image;
+static FILE *bench_flash_image;
+static FILE *bench_scratch;
+
+static int
+bench_select (urj_chain_t *chain, const char *instruction)
+{
+    urj_part_t *part = urj_tap_chain_active_part (chain);
+
+    if (part == NULL)
+        return URJ_STATUS_FAIL;
+    urj_part_set_instruction (part, instruction);
+    if (part->active_instruction == NULL)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND, _("Unknown instruction '%s'"),
+                       instruction);
+        return URJ_STATUS_FAIL;
+    }
+
+    return urj_tap_chain_shift_instructions (chain);
+}
+
+static int
+bench_shift_dr (urj_chain_t *chain, const bench_t *b)
+{
+    urj_tap_register_t *in, *out;
+    int i;
+
+    if (bench_select (chain, "BYPASS") != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    in = urj_tap_register_alloc (b->arg);
+    out = urj_tap_register_alloc (b->arg);
+    if (in == NULL || out == NULL)
+    {
+        urj_tap_register_free (in);
+        urj_tap_register_free (out);
+        return URJ_STATUS_FAIL;
+    }
+    for (i = 0; i < in->len; i += 64)
+        urj_tap_register_set_value_bit_range (in, UINT64_C (0x9b1c6a53e2f4d087),
+                                              i + 63 < in->len ? i + 63
+                                              : in->len - 1, i);
+
+    for (i = 0; i < b->ops; i++)
+    {
+        urj_tap_capture_dr (chain);
+        urj_tap_shift_register (chain, in, out, URJ_CHAIN_EXITMODE_IDLE);
+    }
+
+    urj_tap_register_free (in);
+    urj_tap_register_free (out);
+
+    return URJ_STATUS_OK;
+}
+
+/* Scans kept in the cable queue before their captures are fetched */
+#define BENCH_ARENA_BATCH       64
+
+/* A long run of scans, captured one by one, captured in batches as by a
+ * block read, and not captured at all, must leave the transfer arena as
+ * large as it was half way through */
+static int
+bench_arena (urj_chain_t *chain, const bench_t *b)
+{
+    urj_tap_register_t *in, *out;
+    urj_cable_stats_t half, end;
+    int i, j;
+
+    if (bench_select (chain, "BYPASS") != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    in = urj_tap_register_alloc (b->arg);
+    out = urj_tap_register_alloc (b->arg);
+    if (in == NULL || out == NULL)
+    {
+        urj_tap_register_free (in);
+        urj_tap_register_free (out);
+        return URJ_STATUS_FAIL;
+    }
+    urj_tap_register_fill (in, 1);
+
+    for (i = 0; i < b->ops; i += BENCH_ARENA_BATCH)
+    {
+        if (i / BENCH_ARENA_BATCH == b->ops / BENCH_ARENA_BATCH / 2)
+            urj_tap_cable_get_stats (chain->cable, &half);
+
+        urj_tap_capture_dr (chain);
+        urj_tap_shift_register (chain, in, out, URJ_CHAIN_EXITMODE_IDLE);
+        urj_tap_capture_dr (chain);
+        urj_tap_defer_shift_register (chain, in, NULL,
+                                      URJ_CHAIN_EXITMODE_IDLE);
+        for (j = 0; j < BENCH_ARENA_BATCH; j++)
+        {
+            urj_tap_capture_dr (chain);
+            urj_tap_defer_shift_register (chain, in, out,
+                                          URJ_CHAIN_EXITMODE_IDLE);
+        }
+        for (j = 0; j < BENCH_ARENA_BATCH; j++)
+            urj_tap_shift_register_output (chain, in, out,
+                                           URJ_CHAIN_EXITMODE_IDLE);
+    }
+    urj_tap_cable_get_stats (chain->cable, &end);
+
+    urj_tap_register_free (in);
+    urj_tap_register_free (out);
+
+    if (end.arena_bytes > half.arena_bytes)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
+                       _("transfer arena grew from %llu to %llu bytes"),
+                       (unsigned long long) half.arena_bytes,
+                       (unsigned long long) end.arena_bytes);
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+static int
+bench_ir_dr (urj_chain_t *chain, const bench_t *b)
+{
+    static const char *instructions[] = { "IDCODE", "BYPASS" };
+    int i;
+
+    for (i = 0; i < b->ops; i++)
+    {
+        if (bench_select (chain, instructions[i & 1]) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        if (urj_tap_chain_shift_data_registers (chain, 1) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+static int
+bench_readmem (urj_chain_t *chain, const bench_t *b)
+{
+    int i;
+
+    for (i = 0; i < b->ops; i++)
+    {
+        rewind (bench_scratch);
+        if (urj_bus_readmem (urj_bus, bench_scratch, BENCH_MEM_ADDR,
+                             b->arg) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+static int
+bench_writemem (urj_chain_t *chain, const bench_t *b)
+{
+    int i;
+
+    for (i = 0; i < b->ops; i++)
+    {
+        rewind (bench_image);
+        if (urj_bus_writemem (urj_bus, bench_image, BENCH_MEM_ADDR,
+                              b->arg) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+/* The simulated flash erases blocks to 0xFF and ANDs programmed data into
+ * the array, so each run erases and programs the image afresh */
+static int
+bench_flashmem (urj_chain_t *chain, const bench_t *b)
+{
+    int i;
+
+    for (i = 0; i < b->ops; i++)
+    {
+        rewind (bench_flash_image);
+        if (urj_flashmem (urj_bus, bench_flash_image, 0, 0) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+#ifdef ENABLE_SVF
+static int
+bench_svf (urj_chain_t *chain, const bench_t *b)
+{
+    FILE *f;
+    int i, r = URJ_STATUS_OK;
+
+    f = fopen (BENCH_SRCDIR "/some_cpu.svf", "r");
+    if (f == NULL)
+    {
+        urj_error_IO_set (_("Cannot open file '%s'"),
+                          BENCH_SRCDIR "/some_cpu.svf");
+        return URJ_STATUS_FAIL;
+    }
+
+    for (i = 0; i < b->ops && r == URJ_STATUS_OK; i++)
+    {
+        rewind (f);
+        r = urj_svf_run (chain, f, 1, 0);
+    }
+    fclose (f);
+
+    return r;
+}
+#endif
+
+#ifdef ENABLE_STAPL
+static int
+bench_stapl (urj_chain_t *chain, const bench_t *b)
+{
+    static char file[] = BENCH_SRCDIR "/some_cpu.stp";
+    static char action[] = "-aBENCH";
+    int i;
+
+    for (i = 0; i < b->ops; i++)
+        if (urj_stapl_run (chain, file, action) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+    return URJ_STATUS_OK;
+}
+
+/* The STAPL player keeps heap and data addresses in int32_t symbol values;
+ * only run it where they fit */
+static const char *
+bench_stapl_skip (void)
+{
+    static int probe;
+    void *p = malloc (1);
+    int low = (uintptr_t) p <= INT32_MAX && (uintptr_t) &probe <= INT32_MAX;
+
+    free (p);
+    return low ? NULL : _("the STAPL player needs addresses below 2 GiB");
+}
+#endif
+
+static const bench_t benches[] = {
+    { "shift_dr_32", bench_shift_dr, 2000, 32 },
+    { "shift_dr_1024", bench_shift_dr, 200, 1024 },
+    { "shift_dr_65536", bench_shift_dr, 8, 65536 },
+    { "ir_dr_roundtrip", bench_ir_dr, 1000, 0 },
+    { "arena_flat", bench_arena, 8192, 256 },
+    { "readmem_4k", bench_readmem, 4, BENCH_MEM_LEN },
+    { "writemem_4k", bench_writemem, 4, BENCH_MEM_LEN },
+    { "flashmem_1k", bench_flashmem, 2, BENCH_FLASH_LEN },
+#ifdef ENABLE_SVF
+    { "svf_playback", bench_svf, 20, 0 },
+#endif
+#ifdef ENABLE_STAPL
+    { "stapl_playback", bench_stapl, 5, 0 },
+#endif
+};
+
+static int
+bench_wanted (const char *name, int argc, char *const argv[])
+{
+    int i;
+
+    if (argc == 0)
+        return 1;
+    for (i = 0; i < argc; i++)
+        if (strstr (name, argv[i]) != NULL)
+            return 1;
+
+    return 0;
+}
+
+static int
+bench_run (urj_chain_t *chain, const bench_t *proto, int scale)
+{
+    bench_t b = *proto;
+    urj_cable_stats_t before, after;
+    long double start, seconds;
+    clock_t cpu;
+    urj_log_level_t level = urj_log_state.level;
+    int r;
+
+    b.ops *= scale;
+
+    urj_tap_cable_get_stats (chain->cable, &before);
+    cpu = clock ();
+    start = urj_lib_frealtime ();
+
+    /* the players and the memory commands report progress */
+    urj_log_state.level = URJ_LOG_LEVEL_WARNING;
+    r = b.run (chain, &b);
+    urj_tap_chain_flush (chain);
+    urj_log_state.level = level;
+
+    seconds = urj_lib_frealtime () - start;
+    cpu = clock () - cpu;
+    urj_tap_cable_get_stats (chain->cable, &after);
+
+    if (r != URJ_STATUS_OK)
+        return r;
+
+    printf ("%s\t%d\t%.6Lf\t%.1Lf\t%.2f\t%.2f\t%.6f\n", b.name, b.ops,
+            seconds, seconds > 0 ? b.ops / seconds : 0.0L,
+            (double) (after.items - before.items) / b.ops,
+            (double) (after.clocks - before.clocks) / b.ops,
+            (double) cpu / CLOCKS_PER_SEC);
+    fflush (stdout);
+
+    return URJ_STATUS_OK;
+}
+
+static FILE *
+bench_tmpfile (int len)
+{
+    FILE *f;
+    int i;
+
+    f = tmpfile ();
+    if (f == NULL)
+    {
+        urj_error_IO_set (_("Cannot create temporary file"));
+        return NULL;
+    }
+
+    for (i = 0; i < len; i++)
+        fputc ((i * 13 + 5) & 0xff, f);
+    rewind (f);
+
+    return f;
+}
+
+static void
+usage (void)
+{
+    printf (_("Usage: %s [OPTIONS] [WORKLOAD ...]\n"), "jtag-bench");
+    printf ("\n");
+    printf (_("Run fixed workloads on the JIM simulator and print one tab separated\n"
+              "line per workload: name, operations, seconds, operations per second,\n"
+              "queued cable items and TCK clocks per operation, and CPU seconds.\n"
+              "Only the workloads whose name contains one of the WORKLOAD arguments\n"
+              "are run, all of them when none is given.\n"));
+    printf ("\n");
+    printf (_("  -h, --help          display this help and exit\n"));
+    printf (_("  -s, --setup FILE    bring up the chain with the commands in FILE\n"));
+    printf (_("  -n, --scale N       multiply the number of operations by N\n"));
+    printf (_("  -l, --list          list the workloads and exit\n"));
+}
+
+int
+main (int argc, char *const argv[])
+{
+    urj_chain_t *chain;
+    const char *setup = NULL;
+    int scale = 1;
+    int status = 0;
+    size_t i;
+    int c;
+
+    urj_set_argv0 (argv[0]);
+
+    while (1)
+    {
+        static struct option long_options[] = {
+            {"help", no_argument, 0, 'h'},
+            {"setup", required_argument, 0, 's'},
+            {"scale", required_argument, 0, 'n'},
+            {"list", no_argument, 0, 'l'},
+            {0, 0, 0, 0}
+        };
+
+        c = getopt_long (argc, argv, "hs:n:l", long_options, NULL);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+        case 's':
+            setup = optarg;
+            break;
+
+        case 'n':
+            scale = atoi (optarg);
+            if (scale < 1)
+            {
+                fprintf (stderr, _("Invalid scale '%s'\n"), optarg);
+                return 1;
+            }
+            break;
+
+        case 'l':
+            for (i = 0; i < ARRAY_SIZE (benches); i++)
+                printf ("%s\n", benches[i].name);
+            return 0;
+
+        case 'h':
+        default:
+            usage ();
+            return c == 'h' ? 0 : 1;
+        }
+    }
+
+    chain = urj_tap_chain_alloc ();
+    if (chain == NULL)
+    {
+        printf (_("Out of memory\n"));
+        return 1;
+    }
+
+    urj_log_state.level = URJ_LOG_LEVEL_WARNING;
+    if (setup != NULL)
+    {
+        if (urj_parse_file (chain, setup) != URJ_STATUS_OK)
+            status = 1;
+    }
+    else
+    {
+        for (i = 0; bench_setup[i] != NULL && status == 0; i++)
+            if (urj_parse_line (chain, bench_setup[i]) != URJ_STATUS_OK)
+                status = 1;
+    }
+    urj_log_state.level = URJ_LOG_LEVEL_NORMAL;
+
+    if (status == 0 && (chain->cable == NULL || chain->parts == NULL
+                        || urj_bus == NULL))
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND,
+                       _("setup did not bring up a cable, a part and a bus"));
+        status = 1;
+    }
+    if (status != 0)
+        fprintf (stderr, _("%s: setup failed, no workloads run\n"),
+                 "jtag-bench");
+    if (status == 0)
+    {
+        bench_image = bench_tmpfile (BENCH_MEM_LEN);
+        bench_flash_image = bench_tmpfile (BENCH_FLASH_LEN);
+        bench_scratch = bench_tmpfile (0);
+        if (bench_image == NULL || bench_flash_image == NULL
+            || bench_scratch == NULL)
+            status = 1;
+    }
+
+    if (status == 0)
+    {
+        printf ("# %s benchmark, cable %s\n", PACKAGE_STRING,
+                chain->cable->driver->name);
+        printf ("workload\tops\tseconds\tops_per_s\titems_per_op\t"
+                "clocks_per_op\tcpu_seconds\n");
+    }
+
+    for (i = 0; i < ARRAY_SIZE (benches) && status == 0; i++)
+    {
+        if (!bench_wanted (benches[i].name, argc - optind, argv + optind))
+            continue;
+#ifdef ENABLE_STAPL
+        if (benches[i].run == bench_stapl && bench_stapl_skip () != NULL)
+        {
+            printf ("# skipped %s: %s\n", benches[i].name,
+                    bench_stapl_skip ());
+            continue;
+        }
+#endif
+        if (bench_run (chain, &benches[i], scale) != URJ_STATUS_OK)
+        {
+            fprintf (stderr, _("%s: workload '%s' failed\n"), "jtag-bench",
+                     benches[i].name);
+            status = 1;
+        }
+    }
+
+    if (status != 0 && urj_error_get () != URJ_ERROR_OK)
+        urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+
+    if (bench_image != NULL)
+        fclose (bench_image);
+    if (bench_flash_image != NULL)
+        fclose (bench_flash_image);
+    if (bench_scratch != NULL)
+        fclose (bench_scratch);
+    urj_flash_cleanup ();
+    urj_bus_buses_free ();
+    urj_tap_chain_free (chain);
+
+    return status;
+}
@@ -0,0 +1,236 @@
+/*
+ * $Id$
+ *
+ * Server for the "remote" cable: makes a local cable usable over TCP
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+
+#include <urjtag/chain.h>
+#include <urjtag/cable.h>
+#include <urjtag/parse.h>
+#include <urjtag/log.h>
+#include <urjtag/error.h>
+#include <urjtag/jtag.h>
+
+static void
+usage (void)
+{
+    printf (_("Usage: %s [OPTIONS] [CABLE [PARAMETER ...]]\n"), "jtag-serve");
+    printf ("\n");
+    printf (_("Connect to a cable, as with the \"cable\" command of jtag, and\n"
+              "let \"cable remote\" of other UrJTAG instances use it over TCP.\n"
+              "Clients are served one at a time.\n"));
+    printf ("\n");
+    printf (_("  -h, --help          display this help and exit\n"));
+    printf (_("  -a, --address HOST  listen on the address of HOST (default localhost)\n"));
+    printf (_("  -p, --port PORT     listen on TCP port PORT (default %d)\n"),
+            URJ_CABLE_REMOTE_PORT);
+    printf (_("  -s, --setup FILE    connect to the cable with the commands in FILE\n"));
+    printf (_("  -o, --once          exit after the first client\n"));
+}
+
+/* Run "cable" with the arguments @argv[0 .. argc-1] */
+static int
+serve_cable (urj_chain_t *chain, int argc, char *const argv[])
+{
+    size_t len = sizeof "cable";
+    char *line;
+    int i, r;
+
+    for (i = 0; i < argc; i++)
+        len += strlen (argv[i]) + 1;
+    line = malloc (len);
+    if (line == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("malloc(%zd) fails"), len);
+        return URJ_STATUS_FAIL;
+    }
+    strcpy (line, "cable");
+    for (i = 0; i < argc; i++)
+    {
+        strcat (line, " ");
+        strcat (line, argv[i]);
+    }
+    r = urj_parse_line (chain, line);
+    free (line);
+
+    return r;
+}
+
+static int
+serve_listen (const char *address, const char *port)
+{
+    struct addrinfo hints, *res, *ai;
+    int fd = -1;
+    int one = 1;
+    int e;
+
+    memset (&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    e = getaddrinfo (address, port, &hints, &res);
+    if (e != 0)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND, _("unknown host '%s': %s"),
+                       address, gai_strerror (e));
+        return -1;
+    }
+    for (ai = res; ai != NULL; ai = ai->ai_next)
+    {
+        fd = socket (ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+        if (bind (fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen (fd, 1) == 0)
+            break;
+        close (fd);
+        fd = -1;
+    }
+    freeaddrinfo (res);
+    if (fd < 0)
+        urj_error_IO_set (_("Unable to listen on %s port %s"), address, port);
+
+    return fd;
+}
+
+int
+main (int argc, char *const argv[])
+{
+    urj_chain_t *chain;
+    const char *address = "localhost";
+    const char *setup = NULL;
+    char port[16];
+    int once = 0;
+    int status = 0;
+    int fd, client;
+    int c;
+
+    urj_set_argv0 (argv[0]);
+    snprintf (port, sizeof port, "%d", URJ_CABLE_REMOTE_PORT);
+
+    while (1)
+    {
+        static struct option long_options[] = {
+            {"help", no_argument, 0, 'h'},
+            {"address", required_argument, 0, 'a'},
+            {"port", required_argument, 0, 'p'},
+            {"setup", required_argument, 0, 's'},
+            {"once", no_argument, 0, 'o'},
+            {0, 0, 0, 0}
+        };
+
+        c = getopt_long (argc, argv, "+ha:p:s:o", long_options, NULL);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+        case 'a':
+            address = optarg;
+            break;
+
+        case 'p':
+            snprintf (port, sizeof port, "%s", optarg);
+            break;
+
+        case 's':
+            setup = optarg;
+            break;
+
+        case 'o':
+            once = 1;
+            break;
+
+        case 'h':
+        default:
+            usage ();
+            return c == 'h' ? 0 : 1;
+        }
+    }
+
+    if ((setup == NULL) == (optind == argc))
+    {
+        usage ();
+        return 1;
+    }
+
+    chain = urj_tap_chain_alloc ();
+    if (chain == NULL)
+    {
+        printf (_("Out of memory\n"));
+        return 1;
+    }
+
+    if (setup != NULL)
+        status = urj_parse_file (chain, setup) != URJ_STATUS_OK;
+    else
+        status = serve_cable (chain, argc - optind, argv + optind)
+                 != URJ_STATUS_OK;
+    if (status == 0 && chain->cable == NULL)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND, _("setup did not connect a cable"));
+        status = 1;
+    }
+
+    fd = status == 0 ? serve_listen (address, port) : -1;
+    if (fd < 0)
+        status = 1;
+    else
+        urj_log (URJ_LOG_LEVEL_NORMAL,
+                 _("Serving cable %s on %s port %s\n"),
+                 chain->cable->driver->name, address, port);
+
+    while (status == 0)
+    {
+        client = accept (fd, NULL, NULL);
+        if (client < 0)
+        {
+            urj_error_IO_set (_("accept() fails"));
+            status = 1;
+            break;
+        }
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("Client connected\n"));
+        if (urj_tap_cable_remote_serve (chain->cable, client) != URJ_STATUS_OK)
+            urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+        close (client);
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("Client disconnected\n"));
+        if (once)
+            break;
+    }
+
+    if (status != 0 && urj_error_get () != URJ_ERROR_OK)
+        urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+
+    if (fd >= 0)
+        close (fd);
+    urj_tap_chain_free (chain);
+
+    return status;
+}
@@ -103,7 +103,8 @@ arm9tdmi_debug_in_reg(urj_data_register_t *reg)
 
     urj_log(URJ_LOG_LEVEL_ALL, "in  :");
     for (i = 0; i < reg->in->len; i++)
-        urj_log(URJ_LOG_LEVEL_ALL, reg->in->data[i]?"1":"0");
+        urj_log(URJ_LOG_LEVEL_ALL,
+                urj_tap_register_get_bit (reg->in, i)?"1":"0");
     urj_log(URJ_LOG_LEVEL_ALL, "\n");
 }
 
@@ -114,7 +115,8 @@ arm9tdmi_debug_out_reg(urj_data_register_t *reg)
 
     urj_log(URJ_LOG_LEVEL_ALL, "out :");
     for (i = 0; i < reg->out->len; i++)
-        urj_log(URJ_LOG_LEVEL_ALL, reg->out->data[i]?"1":"0");
+        urj_log(URJ_LOG_LEVEL_ALL,
+                urj_tap_register_get_bit (reg->out, i)?"1":"0");
     urj_log(URJ_LOG_LEVEL_ALL, "\n");
 }
 #endif
@@ -125,12 +127,12 @@ arm9tdmi_exec_instruction(urj_bus_t *bus, unsigned int c1_inst, unsigned int c1_
     int i;
 
     for (i = 0; i < 32; i++)
-        scan1->in->data[66-i] = (c1_inst >> i) & 1;
-    scan1->in->data[34] = flags;
-    scan1->in->data[33] = 0;
-    scan1->in->data[32] = 0;
+        urj_tap_register_set_bit (scan1->in, 66-i, (c1_inst >> i) & 1);
+    urj_tap_register_set_bit (scan1->in, 34, flags);
+    urj_tap_register_set_bit (scan1->in, 33, 0);
+    urj_tap_register_set_bit (scan1->in, 32, 0);
     for (i = 0; i < 32; i++)
-        scan1->in->data[i] = (c1_data >> i) & 1;
+        urj_tap_register_set_bit (scan1->in, i, (c1_data >> i) & 1);
 #if (ARM9DEBUG)
     arm9tdmi_debug_in_reg(scan1);
 #endif
@@ -149,7 +151,7 @@ arm9tdmi_select_scanchain(urj_bus_t *bus, unsigned int chain)
     urj_tap_chain_shift_instructions (bus->chain);
 
     for (i = 0; i < scann->in->len; i++)
-        scann->in->data[i] = (chain >> i) & 1;
+        urj_tap_register_set_bit (scann->in, i, (chain >> i) & 1);
     urj_tap_chain_shift_data_registers (bus->chain, 0);
 }
 
@@ -159,14 +161,14 @@ arm9tdmi_ice_read(urj_bus_t *bus, unsigned int reg_addr, unsigned int *reg_val)
     int i;
 
     for (i = 0; i < 32; i++)
-        scan2->in->data[i] = 0;
+        urj_tap_register_set_bit (scan2->in, i, 0);
     for (i = 0; i < 5; i++)
-        scan2->in->data[i+32] = (reg_addr >> i) & 1;
-    scan2->in->data[37] = 0;
+        urj_tap_register_set_bit (scan2->in, i+32, (reg_addr >> i) & 1);
+    urj_tap_register_set_bit (scan2->in, 37, 0);
     urj_tap_chain_shift_data_registers (bus->chain, 1);
 
     for (i = 0; i < 32; i++)
-        if (scan2->out->data[i])
+        if (urj_tap_register_get_bit (scan2->out, i))
             *reg_val |= (1 << i);
 }
 
@@ -176,10 +178,10 @@ arm9tdmi_ice_write(urj_bus_t *bus, unsigned int reg_addr, unsigned int reg_val)
     int i;
 
     for (i = 0; i < 32; i++)
-        scan2->in->data[i] = (reg_val >> i) & 1;
+        urj_tap_register_set_bit (scan2->in, i, (reg_val >> i) & 1);
     for (i = 0; i < 5; i++)
-        scan2->in->data[i+32] = (reg_addr >> i) & 1;
-    scan2->in->data[37] = 1;
+        urj_tap_register_set_bit (scan2->in, i+32, (reg_addr >> i) & 1);
+    urj_tap_register_set_bit (scan2->in, 37, 1);
     urj_tap_chain_shift_data_registers (bus->chain, 0);
 }
 
@@ -331,7 +333,7 @@ arm9tdmi_read (urj_bus_t *bus, unsigned int addr, unsigned int sz)
     result = 0;
     for (i = 0; i < 32; i++)
     {
-        if (scan1->out->data[i])
+        if (urj_tap_register_get_bit (scan1->out, i))
             result |= (1 << i);
     }
     arm9tdmi_exec_instruction(bus, c1_inst, c1_data, DEBUG_SPEED);
@@ -48,6 +48,8 @@ typedef struct
     urj_part_signal_t *nrwe;
     urj_part_signal_t *nroe;
     urj_part_signal_t *rd[32];
+    urj_bus_generic_map_t *radmap;
+    urj_bus_generic_map_t *rdmap;
 } bus_params_t;
 
 #define RAD     ((bus_params_t *) bus->params)->rad
@@ -55,6 +57,8 @@ typedef struct
 #define nRWE    ((bus_params_t *) bus->params)->nrwe
 #define nROE    ((bus_params_t *) bus->params)->nroe
 #define RD      ((bus_params_t *) bus->params)->rd
+#define RADMAP  ((bus_params_t *) bus->params)->radmap
+#define RDMAP   ((bus_params_t *) bus->params)->rdmap
 
 /**
  * bus->driver->(*new_bus)
@@ -98,8 +102,17 @@ au1500_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
         failed |= urj_bus_generic_attach_sig (part, &(RD[i]), buff);
     }
 
+    if (!failed)
+    {
+        RADMAP = urj_bus_generic_map_new (part, RAD, 32);
+        RDMAP = urj_bus_generic_map_new (part, RD, 32);
+        failed = RADMAP == NULL || RDMAP == NULL;
+    }
+
     if (failed)
     {
+        urj_bus_generic_map_free (RADMAP);
+        urj_bus_generic_map_free (RDMAP);
         free (bus->params);
         free (bus);
         return NULL;
@@ -109,6 +122,18 @@ au1500_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
 
 }
 
+/**
+ * bus->driver->(*free_bus)
+ *
+ */
+static void
+au1500_bus_free (urj_bus_t *bus)
+{
+    urj_bus_generic_map_free (RADMAP);
+    urj_bus_generic_map_free (RDMAP);
+    urj_bus_generic_free (bus);
+}
+
 /**
  * bus->driver->(*printinfo)
  *
@@ -149,54 +174,37 @@ au1500_bus_area (urj_bus_t *bus, uint32_t addr, urj_bus_area_t *area)
 static void
 setup_address (urj_bus_t *bus, uint32_t a)
 {
-    int i;
-    urj_part_t *p = bus->part;
-
-    for (i = 0; i < 32; i++)
-        urj_part_set_signal (p, RAD[i], 1, (a >> i) & 1);
+    urj_bus_generic_map_set (RADMAP, 32, a);
 }
 
 static void
 set_data_in (urj_bus_t *bus)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     au1500_bus_area (bus, 0, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal_input (p, RD[i]);
-
+    urj_bus_generic_map_set_input (RDMAP, area.width);
 }
 
 static uint32_t
 get_data_out (urj_bus_t *bus)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
-    uint32_t d = 0;
 
     au1500_bus_area (bus, 0, &area);
 
-    for (i = 0; i < area.width; i++)
-        d |= (uint32_t) (urj_part_get_signal (p, RD[i]) << i);
-
-    return d;
+    return urj_bus_generic_map_get (RDMAP, area.width);
 }
 
 static void
 setup_data (urj_bus_t *bus, uint32_t d)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     au1500_bus_area (bus, 0, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal (p, RD[i], 1, (d >> i) & 1);
+    urj_bus_generic_map_set (RDMAP, area.width, d);
 }
 
 /**
@@ -261,6 +269,18 @@ au1500_bus_read_end (urj_bus_t *bus)
     return get_data_out (bus);
 }
 
+/**
+ * bus->driver->(*read_block)
+ *
+ */
+static int
+au1500_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *data,
+                       int count)
+{
+    return urj_bus_generic_read_block_extest (bus, adr, data, count,
+                                              setup_address, get_data_out);
+}
+
 /**
  * bus->driver->(*write)
  *
@@ -300,7 +320,7 @@ const urj_bus_driver_t urj_bus_au1500_bus = {
     "au1500",
     N_("AU1500 BUS Driver via BSR"),
     au1500_bus_new,
-    urj_bus_generic_free,
+    au1500_bus_free,
     au1500_bus_printinfo,
     urj_bus_generic_prepare_extest,
     au1500_bus_area,
@@ -314,4 +334,6 @@ const urj_bus_driver_t urj_bus_au1500_bus = {
     urj_bus_generic_no_enable,
     urj_bus_generic_no_disable,
     URJ_BUS_TYPE_PARALLEL,
+    NULL,                       /* write_block */
+    au1500_bus_read_block,
 };
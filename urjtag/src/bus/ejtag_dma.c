@@ -128,7 +128,7 @@ reg_value (urj_tap_register_t *reg)
 
     for (i = 0; i < reg->len; i++)
     {
-        if (reg->data[i])
+        if (urj_tap_register_get_bit (reg, i))
             retval |= (1 << i);
     }
     return retval;
@@ -189,7 +189,7 @@ ejtag_dma_write (urj_bus_t *bus, unsigned int addr, unsigned int data, int sz)
     urj_part_set_instruction (bus->part, "EJTAG_ADDRESS");
     urj_tap_chain_shift_instructions (bus->chain);
     for (i = 0; i < 32; i++)
-        ejaddr->in->data[i] = (addr >> i) & 1;
+        urj_tap_register_set_bit (ejaddr->in, i, (addr >> i) & 1);
     urj_tap_chain_shift_data_registers (bus->chain, 0); /* Push the address to write */
     urj_log (URJ_LOG_LEVEL_COMM, "Wrote to ejaddr->in      =%s %08lX\n",
              urj_tap_register_get_string (ejaddr->in),
@@ -197,7 +197,7 @@ ejtag_dma_write (urj_bus_t *bus, unsigned int addr, unsigned int data, int sz)
     urj_part_set_instruction (bus->part, "EJTAG_DATA");
     urj_tap_chain_shift_instructions (bus->chain);
     for (i = 0; i < 32; i++)
-        ejdata->in->data[i] = (data >> i) & 1;
+        urj_tap_register_set_bit (ejdata->in, i, (data >> i) & 1);
     urj_tap_chain_shift_data_registers (bus->chain, 0); /* Push the data to write */
     urj_log (URJ_LOG_LEVEL_COMM, "Wrote to edata->in(%c)    =%s %08lX\n",
              siz_ (sz), urj_tap_register_get_string (ejdata->in),
@@ -205,12 +205,12 @@ ejtag_dma_write (urj_bus_t *bus, unsigned int addr, unsigned int data, int sz)
     urj_part_set_instruction (bus->part, "EJTAG_CONTROL");
     urj_tap_chain_shift_instructions (bus->chain);
     urj_tap_register_fill (ejctrl->in, 0);
-    ejctrl->in->data[PrAcc] = 1;        // Processor access
-    ejctrl->in->data[ProbEn] = 1;
-    ejctrl->in->data[DmaAcc] = 1;       // DMA operation request */
-    ejctrl->in->data[DstRt] = 1;
+    urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);        // Processor access
+    urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);
+    urj_tap_register_set_bit (ejctrl->in, DmaAcc, 1);       // DMA operation request */
+    urj_tap_register_set_bit (ejctrl->in, DstRt, 1);
     if (sz)
-        ejctrl->in->data[sz] = 1;       // Size : can be WORD/HALFWORD or nothing for byte
+        urj_tap_register_set_bit (ejctrl->in, sz, 1);       // Size : can be WORD/HALFWORD or nothing for byte
     urj_tap_chain_shift_data_registers (bus->chain, 0); /* Do the operation */
     urj_log (URJ_LOG_LEVEL_ALL, "Wrote to ejctrl->in      =%s %08lX\n",
              urj_tap_register_get_string (ejctrl->in),
@@ -221,23 +221,23 @@ ejtag_dma_write (urj_bus_t *bus, unsigned int addr, unsigned int data, int sz)
         urj_part_set_instruction (bus->part, "EJTAG_CONTROL");
         urj_tap_chain_shift_instructions (bus->chain);
         urj_tap_register_fill (ejctrl->in, 0);
-        ejctrl->in->data[PrAcc] = 1;
-        ejctrl->in->data[ProbEn] = 1;
-        ejctrl->in->data[DmaAcc] = 1;
+        urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);
+        urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);
+        urj_tap_register_set_bit (ejctrl->in, DmaAcc, 1);
         urj_tap_chain_shift_data_registers (bus->chain, 1);
         timeout--;
         if (!timeout)
             break;
     }
-    while (ejctrl->out->data[DstRt] == 1);      // This flag tell us the processor has completed the op
+    while (urj_tap_register_get_bit (ejctrl->out, DstRt) == 1);      // This flag tell us the processor has completed the op
 
     urj_part_set_instruction (bus->part, "EJTAG_CONTROL");
     urj_tap_chain_shift_instructions (bus->chain);
     urj_tap_register_fill (ejctrl->in, 0);
-    ejctrl->in->data[PrAcc] = 1;
-    ejctrl->in->data[ProbEn] = 1;
+    urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);
+    urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);
     urj_tap_chain_shift_data_registers (bus->chain, 1); // Disable DMA, reset state to previous one.
-    if (ejctrl->out->data[Derr] == 1)
+    if (urj_tap_register_get_bit (ejctrl->out, Derr) == 1)
     {                           // Check for DMA error, i.e. incorrect address
         urj_error_set (URJ_ERROR_BUS_DMA,
                        _("dma write (dma transaction failed)"));
@@ -269,7 +269,7 @@ ejtag_dma_read (urj_bus_t *bus, unsigned int addr, int sz)
     urj_part_set_instruction (bus->part, "EJTAG_ADDRESS");
     urj_tap_chain_shift_instructions (bus->chain);
     for (i = 0; i < 32; i++)
-        ejaddr->in->data[i] = (addr >> i) & 1;
+        urj_tap_register_set_bit (ejaddr->in, i, (addr >> i) & 1);
     urj_tap_chain_shift_data_registers (bus->chain, 0); /* Push the address to read */
     urj_log (URJ_LOG_LEVEL_COMM, "Wrote to ejaddr->in      =%s %08lX\n",
              urj_tap_register_get_string (ejaddr->in),
@@ -277,13 +277,13 @@ ejtag_dma_read (urj_bus_t *bus, unsigned int addr, int sz)
     urj_part_set_instruction (bus->part, "EJTAG_CONTROL");
     urj_tap_chain_shift_instructions (bus->chain);
     urj_tap_register_fill (ejctrl->in, 0);
-    ejctrl->in->data[PrAcc] = 1;        // Processor access
-    ejctrl->in->data[ProbEn] = 1;
-    ejctrl->in->data[DmaAcc] = 1;       // DMA operation request */
-    ejctrl->in->data[DstRt] = 1;
+    urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);        // Processor access
+    urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);
+    urj_tap_register_set_bit (ejctrl->in, DmaAcc, 1);       // DMA operation request */
+    urj_tap_register_set_bit (ejctrl->in, DstRt, 1);
     if (sz)
-        ejctrl->in->data[sz] = 1;       // Size : can be WORD/HALFWORD or nothing for byte
-    ejctrl->in->data[DmaRwn] = 1;       // This is a read
+        urj_tap_register_set_bit (ejctrl->in, sz, 1);       // Size : can be WORD/HALFWORD or nothing for byte
+    urj_tap_register_set_bit (ejctrl->in, DmaRwn, 1);       // This is a read
     urj_tap_chain_shift_data_registers (bus->chain, 0); /* Do the operation */
     urj_log (URJ_LOG_LEVEL_ALL, "Wrote to ejctrl->in      =%s %08lX\n",
              urj_tap_register_get_string (ejctrl->in),
@@ -294,9 +294,9 @@ ejtag_dma_read (urj_bus_t *bus, unsigned int addr, int sz)
         urj_part_set_instruction (bus->part, "EJTAG_CONTROL");
         urj_tap_chain_shift_instructions (bus->chain);
         urj_tap_register_fill (ejctrl->in, 0);
-        ejctrl->in->data[PrAcc] = 1;
-        ejctrl->in->data[ProbEn] = 1;
-        ejctrl->in->data[DmaAcc] = 1;
+        urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);
+        urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);
+        urj_tap_register_set_bit (ejctrl->in, DmaAcc, 1);
         urj_tap_chain_shift_data_registers (bus->chain, 1);
 
         urj_log (URJ_LOG_LEVEL_ALL, "Wrote to ejctrl->in   =%s %08lX\n",
@@ -309,7 +309,7 @@ ejtag_dma_read (urj_bus_t *bus, unsigned int addr, int sz)
         if (!timeout)
             break;
     }
-    while (ejctrl->out->data[DstRt] == 1);      // This flag tell us the processor has completed the op
+    while (urj_tap_register_get_bit (ejctrl->out, DstRt) == 1);      // This flag tell us the processor has completed the op
 
     urj_part_set_instruction (bus->part, "EJTAG_DATA");
     urj_tap_chain_shift_instructions (bus->chain);
@@ -322,8 +322,8 @@ ejtag_dma_read (urj_bus_t *bus, unsigned int addr, int sz)
     urj_part_set_instruction (bus->part, "EJTAG_CONTROL");
     urj_tap_chain_shift_instructions (bus->chain);
     urj_tap_register_fill (ejctrl->in, 0);
-    ejctrl->in->data[PrAcc] = 1;
-    ejctrl->in->data[ProbEn] = 1;
+    urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);
+    urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);
     urj_tap_chain_shift_data_registers (bus->chain, 1); // Disable DMA, reset state to previous one.
 
     urj_log (URJ_LOG_LEVEL_ALL, "Wrote to ejctrl->in   =%s %08lX\n",
@@ -333,7 +333,7 @@ ejtag_dma_read (urj_bus_t *bus, unsigned int addr, int sz)
              urj_tap_register_get_string (ejctrl->out),
              (long unsigned) reg_value(ejctrl->out));
 
-    if (ejctrl->out->data[Derr] == 1)
+    if (urj_tap_register_get_bit (ejctrl->out, Derr) == 1)
     {                           // Check for DMA error, i.e. incorrect address
         urj_error_set (URJ_ERROR_BUS_DMA,
                        _("dma read (dma transaction failed)"));
@@ -457,24 +457,24 @@ ejtag_dma_bus_init (urj_bus_t *bus)
     urj_tap_register_fill (ejctrl->in, 0);
 
     // Reset the processor
-    ejctrl->in->data[PrRst] = 1;
-    ejctrl->in->data[PerRst] = 1;
+    urj_tap_register_set_bit (ejctrl->in, PrRst, 1);
+    urj_tap_register_set_bit (ejctrl->in, PerRst, 1);
     urj_tap_chain_shift_data_registers (bus->chain, 0);
 
     // Release reset
-    ejctrl->in->data[PrRst] = 0;
-    ejctrl->in->data[PerRst] = 0;
+    urj_tap_register_set_bit (ejctrl->in, PrRst, 0);
+    urj_tap_register_set_bit (ejctrl->in, PerRst, 0);
     urj_tap_chain_shift_data_registers (bus->chain, 0);
 
-    ejctrl->in->data[PrAcc] = 1;
-    ejctrl->in->data[ProbEn] = 1;
-    ejctrl->in->data[ProbTrap] = 1;
-    ejctrl->in->data[JtagBrk] = 1;
-    ejctrl->in->data[Rocc] = 1;
+    urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);
+    urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);
+    urj_tap_register_set_bit (ejctrl->in, ProbTrap, 1);
+    urj_tap_register_set_bit (ejctrl->in, JtagBrk, 1);
+    urj_tap_register_set_bit (ejctrl->in, Rocc, 1);
     urj_tap_chain_shift_data_registers (bus->chain, 0);
 
     /* Wait until processor is in break */
-    ejctrl->in->data[JtagBrk] = 0;
+    urj_tap_register_set_bit (ejctrl->in, JtagBrk, 0);
     do
     {
         urj_tap_chain_shift_data_registers (bus->chain, 1);
@@ -482,7 +482,7 @@ ejtag_dma_bus_init (urj_bus_t *bus)
         if (!timeout)
             break;
     }
-    while (ejctrl->out->data[BrkSt] == 0);
+    while (urj_tap_register_get_bit (ejctrl->out, BrkSt) == 0);
 
     if (timeout == 0)
     {
@@ -493,11 +493,11 @@ ejtag_dma_bus_init (urj_bus_t *bus)
     }
 
     // Handle the reset bit clear, if any
-    if (ejctrl->out->data[Rocc])
+    if (urj_tap_register_get_bit (ejctrl->out, Rocc))
     {
-        ejctrl->in->data[Rocc] = 0;
+        urj_tap_register_set_bit (ejctrl->in, Rocc, 0);
         urj_tap_chain_shift_data_registers (bus->chain, 0);
-        ejctrl->in->data[Rocc] = 1;
+        urj_tap_register_set_bit (ejctrl->in, Rocc, 1);
         urj_tap_chain_shift_data_registers (bus->chain, 1);
     }
 
@@ -25,10 +25,14 @@
 #include <sysdep.h>
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <urjtag/error.h>
 #include <urjtag/part.h>
+#include <urjtag/part_instruction.h>
 #include <urjtag/chain.h>
+#include <urjtag/data_register.h>
+#include <urjtag/tap_register.h>
 
 #include "generic_bus.h"
 
@@ -46,6 +50,253 @@ urj_bus_generic_attach_sig (urj_part_t *part, urj_part_signal_t **sig,
     return URJ_STATUS_OK;
 }
 
+/* bus maps, working on the packed BSR words as laid out in tap_register.h */
+
+#define MAP_NIBBLE(bit)         ((bit) & ~3)
+#define MAP_WORD(bit)           ((bit) / URJ_TAP_REGISTER_WORD_BITS)
+#define MAP_BIT(bit)            ((uint64_t) 1 << ((bit) % URJ_TAP_REGISTER_WORD_BITS))
+
+/* The cells in one BSR word of the pins of one nibble of a value, for
+ * each of the 16 values of the nibble */
+typedef struct
+{
+    int shift;                  /* value bit of the nibble */
+    int word;                   /* BSR word */
+    uint64_t enable;            /* control cells of the word set to enable */
+    uint64_t out[16];           /* output cells of the nibble's 1 bits */
+    uint64_t control[16];       /* control cells of the nibble's pins */
+    uint64_t release[16];       /* control cells of those that are inputs too */
+}
+map_scatter_t;
+
+/* The value bits sampled by one nibble of a BSR word, for each of its
+ * 16 values */
+typedef struct
+{
+    int word;                   /* BSR word */
+    int shift;                  /* bit of the nibble in the word */
+    uint32_t in[16];
+}
+map_gather_t;
+
+struct URJ_BUS_GENERIC_MAP
+{
+    urj_part_t *part;
+    urj_part_signal_t *sig[32];
+    int n;
+    unsigned int generation;    /* of part when the tables were built */
+    urj_data_register_t *bsr;
+    int scatters;
+    int gathers;
+    map_scatter_t scatter[64];  /* at most 8 nibbles times output and control */
+    map_gather_t gather[32];
+};
+
+static map_scatter_t *
+map_scatter (urj_bus_generic_map_t *map, int shift, int word)
+{
+    map_scatter_t *sc;
+    int i;
+
+    for (i = 0; i < map->scatters; i++)
+        if (map->scatter[i].shift == shift && map->scatter[i].word == word)
+            return &map->scatter[i];
+
+    sc = &map->scatter[map->scatters++];
+    sc->shift = shift;
+    sc->word = word;
+
+    return sc;
+}
+
+static map_gather_t *
+map_gather (urj_bus_generic_map_t *map, int word, int shift)
+{
+    map_gather_t *g;
+    int i;
+
+    for (i = 0; i < map->gathers; i++)
+        if (map->gather[i].word == word && map->gather[i].shift == shift)
+            return &map->gather[i];
+
+    g = &map->gather[map->gathers++];
+    g->word = word;
+    g->shift = shift;
+
+    return g;
+}
+
+/* (re)build the tables of map from the current cells of its signals */
+static int
+map_build (urj_bus_generic_map_t *map)
+{
+    urj_part_sighandle_t h;
+    map_scatter_t *sc;
+    map_gather_t *g;
+    int i, v;
+
+    map->generation = map->part->generation;
+    map->scatters = 0;
+    map->gathers = 0;
+    memset (map->scatter, 0, sizeof map->scatter);
+    memset (map->gather, 0, sizeof map->gather);
+
+    for (i = 0; i < map->n; i++)
+    {
+        if (urj_part_sighandle_init (map->part, map->sig[i], &h)
+            != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        map->bsr = h.bsr;
+
+        if (h.output >= 0)
+        {
+            sc = map_scatter (map, MAP_NIBBLE (i), MAP_WORD (h.output));
+            for (v = 0; v < 16; v++)
+                if (v & (1 << (i & 3)))
+                    sc->out[v] |= MAP_BIT (h.output);
+        }
+        if (h.output >= 0 && h.control >= 0)
+        {
+            sc = map_scatter (map, MAP_NIBBLE (i), MAP_WORD (h.control));
+            for (v = 0; v < 16; v++)
+                if (v & (1 << (i & 3)))
+                {
+                    sc->control[v] |= MAP_BIT (h.control);
+                    if (h.input >= 0)
+                        sc->release[v] |= MAP_BIT (h.control);
+                }
+            if (h.control_value)
+                sc->enable &= ~MAP_BIT (h.control);
+            else
+                sc->enable |= MAP_BIT (h.control);
+        }
+        if (h.input >= 0)
+        {
+            g = map_gather (map, MAP_WORD (h.input),
+                            MAP_NIBBLE (h.input % URJ_TAP_REGISTER_WORD_BITS));
+            for (v = 0; v < 16; v++)
+                if (v & (1 << (h.input & 3)))
+                    g->in[v] |= (uint32_t) 1 << i;
+        }
+    }
+
+    return URJ_STATUS_OK;
+}
+
+/* signal or bit definitions since the map was built moved its cells */
+static void
+map_refresh (urj_bus_generic_map_t *map)
+{
+    if (map->generation != map->part->generation)
+        /* cannot fail: the part had a BSR when the map was first built */
+        map_build (map);
+}
+
+urj_bus_generic_map_t *
+urj_bus_generic_map_new (urj_part_t *part, urj_part_signal_t *const sig[],
+                         int n)
+{
+    urj_bus_generic_map_t *map;
+    int i;
+
+    if (n < 0 || n > 32)
+    {
+        urj_error_set (URJ_ERROR_INVALID, _("bus map of %d pins"), n);
+        return NULL;
+    }
+
+    map = calloc (1, sizeof *map);
+    if (map == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       (size_t) 1, sizeof *map);
+        return NULL;
+    }
+
+    map->part = part;
+    for (i = 0; i < n; i++)
+        map->sig[i] = sig[i];
+    map->n = n;
+
+    if (map_build (map) != URJ_STATUS_OK)
+    {
+        free (map);
+        return NULL;
+    }
+
+    return map;
+}
+
+void
+urj_bus_generic_map_free (urj_bus_generic_map_t *map)
+{
+    free (map);
+}
+
+/* @return mask of the pins of the nibble at shift among the first n */
+static int
+map_nibble_mask (int shift, int n)
+{
+    if (n >= shift + 4)
+        return 15;
+    if (n <= shift)
+        return 0;
+
+    return (1 << (n - shift)) - 1;
+}
+
+void
+urj_bus_generic_map_set (urj_bus_generic_map_t *map, int n, uint32_t val)
+{
+    const map_scatter_t *sc;
+    int i, m;
+
+    map_refresh (map);
+    for (i = 0; i < map->scatters; i++)
+    {
+        sc = &map->scatter[i];
+        m = map_nibble_mask (sc->shift, n);
+        urj_tap_register_update_word (map->bsr->in, sc->word,
+                                      sc->out[m] | sc->control[m],
+                                      sc->out[(val >> sc->shift) & m]
+                                      | (sc->control[m] & sc->enable));
+    }
+}
+
+void
+urj_bus_generic_map_set_input (urj_bus_generic_map_t *map, int n)
+{
+    const map_scatter_t *sc;
+    int i, m;
+
+    map_refresh (map);
+    for (i = 0; i < map->scatters; i++)
+    {
+        sc = &map->scatter[i];
+        m = map_nibble_mask (sc->shift, n);
+        urj_tap_register_update_word (map->bsr->in, sc->word, sc->release[m],
+                                      ~sc->enable);
+    }
+}
+
+uint32_t
+urj_bus_generic_map_get (urj_bus_generic_map_t *map, int n)
+{
+    const map_gather_t *g;
+    uint32_t val = 0;
+    int i;
+
+    map_refresh (map);
+    for (i = 0; i < map->gathers; i++)
+    {
+        g = &map->gather[i];
+        val |= g->in[(urj_tap_register_get_word (map->bsr->out, g->word)
+                      >> g->shift) & 15];
+    }
+
+    return n < 32 ? val & (((uint32_t) 1 << n) - 1) : val;
+}
+
 urj_bus_t *
 urj_bus_generic_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
                      size_t param_size)
@@ -148,6 +399,173 @@ urj_bus_generic_write_start (urj_bus_t *bus, uint32_t adr)
     return 0;
 }
 
+/* Bus cycles queued before the cable is asked to send them */
+#define WRITE_BLOCK_BATCH       256
+
+/**
+ * bus->driver->(*write_block)
+ *
+ * Lets the driver's write queue the scans of up to WRITE_BLOCK_BATCH words
+ * before they go to the cable in one go. Scans copy the BSR when queued,
+ * so each bus cycle keeps its own image.
+ */
+int
+urj_bus_generic_write_block (urj_bus_t *bus, uint32_t adr,
+                             const uint32_t *data, int count)
+{
+    urj_bus_area_t area;
+    uint32_t step;
+    int i;
+
+    if (URJ_BUS_AREA (bus, adr, &area) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    step = area.width / 8;
+    if (step == 0)
+    {
+        urj_error_set (URJ_ERROR_INVALID, _("Unknown bus width"));
+        return URJ_STATUS_FAIL;
+    }
+
+    for (i = 0; i < count; i++, adr += step)
+    {
+        if (i % WRITE_BLOCK_BATCH == 0)
+            urj_tap_chain_defer_output_begin (bus->chain);
+        URJ_BUS_WRITE (bus, adr, data[i]);
+        if ((i + 1) % WRITE_BLOCK_BATCH == 0 || i + 1 == count)
+            urj_tap_chain_defer_output_end (bus->chain);
+    }
+
+    return URJ_STATUS_OK;
+}
+
+/**
+ * bus->driver->(*read_block)
+ *
+ * One read_start, read_next per further word and read_end, as readmem
+ * has always done it.
+ */
+int
+urj_bus_generic_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *data,
+                            int count)
+{
+    urj_bus_area_t area;
+    uint32_t step;
+    int i;
+
+    if (count <= 0)
+        return URJ_STATUS_OK;
+
+    if (URJ_BUS_AREA (bus, adr, &area) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    step = area.width / 8;
+    if (step == 0)
+    {
+        urj_error_set (URJ_ERROR_INVALID, _("Unknown bus width"));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (URJ_BUS_READ_START (bus, adr) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    for (i = 1; i < count; i++)
+        data[i - 1] = URJ_BUS_READ_NEXT (bus, adr + i * step);
+    data[count - 1] = URJ_BUS_READ_END (bus);
+
+    return URJ_STATUS_OK;
+}
+
+/* Bus reads queued before the captured data is fetched from the cable, and
+ * the transfer arena they may take: a captured scan takes about three bytes
+ * per bit of the chain's data registers until it is fetched */
+#define READ_BLOCK_BATCH        1024
+#define READ_BLOCK_ARENA        (1024 * 1024)
+
+/**
+ * bus->driver->(*read_block)
+ *
+ * For EXTEST drivers whose read_next is "set up the address, shift the
+ * BSR, return the data pins": @address sets up the address pins for the
+ * next word and @get_data extracts a word from the captured BSR. The
+ * shifts of up to READ_BLOCK_BATCH words are queued with their captures
+ * kept in the cable, and the captured BSR images are fetched back in
+ * queue order afterwards, so a batch costs one flush instead of one per
+ * word. Every batch is fetched completely before the next one is queued,
+ * so that the cable's transfer arena is rewound in between.
+ */
+int
+urj_bus_generic_read_block_extest (urj_bus_t *bus, uint32_t adr,
+                                   uint32_t *data, int count,
+                                   void (*address) (urj_bus_t *bus,
+                                                    uint32_t adr),
+                                   uint32_t (*get_data) (urj_bus_t *bus))
+{
+    urj_bus_area_t area;
+    urj_parts_t *ps;
+    uint32_t step;
+    int batch, bits;
+    int i, j, n;
+
+    if (count <= 0)
+        return URJ_STATUS_OK;
+
+    if (URJ_BUS_AREA (bus, adr, &area) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    step = area.width / 8;
+    if (step == 0)
+    {
+        urj_error_set (URJ_ERROR_INVALID, _("Unknown bus width"));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (URJ_BUS_READ_START (bus, adr) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    ps = bus->chain->parts;
+    for (i = 0, bits = 0; i < ps->len; i++)
+        if (ps->parts[i]->active_instruction != NULL
+            && ps->parts[i]->active_instruction->data_register != NULL)
+            bits += ps->parts[i]->active_instruction->data_register->in->len;
+    batch = READ_BLOCK_ARENA / (3 * bits + 1);
+    if (batch > READ_BLOCK_BATCH)
+        batch = READ_BLOCK_BATCH;
+    if (batch < 1)
+        batch = 1;
+
+    /* the scan that sets up word i + 1 captures the data of word i */
+    for (i = 0; i < count - 1; i += n)
+    {
+        n = count - 1 - i;
+        if (n > batch)
+            n = batch;
+
+        for (j = 0; j < n; j++)
+        {
+            address (bus, adr + (i + j + 1) * step);
+            if (urj_tap_chain_defer_data_registers (bus->chain)
+                != URJ_STATUS_OK)
+            {
+                /* drop the captures queued so far */
+                while (j-- > 0)
+                    urj_tap_chain_get_data_registers (bus->chain);
+                return URJ_STATUS_FAIL;
+            }
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            urj_tap_chain_get_data_registers (bus->chain);
+            data[i + j] = get_data (bus);
+        }
+    }
+
+    data[count - 1] = URJ_BUS_READ_END (bus);
+
+    return URJ_STATUS_OK;
+}
+
 /**
  * bus->driver->(*read)
  *
@@ -32,6 +32,31 @@
 int urj_bus_generic_attach_sig (urj_part_t *part, urj_part_signal_t **sig,
                                 const char *id);
 
+/**
+ * A bus map: up to 32 pins of a bus, such as its address or data lines,
+ * compiled into tables that scatter a value into the BSR and gather it
+ * back four pins at a time, at a cost independent of the bus width.
+ */
+typedef struct URJ_BUS_GENERIC_MAP urj_bus_generic_map_t;
+
+/**
+ * Compile the n signals sig[0] (value bit 0) .. sig[n-1] of part into a
+ * bus map. NULL signals and cells the signals lack are skipped. The map
+ * follows later signal, bit and register definitions of part.
+ * @return map on success; NULL on error
+ */
+urj_bus_generic_map_t *urj_bus_generic_map_new (urj_part_t *part,
+                                                urj_part_signal_t *const sig[],
+                                                int n);
+void urj_bus_generic_map_free (urj_bus_generic_map_t *map);
+/** Drive the first n pins of map to the bits of val */
+void urj_bus_generic_map_set (urj_bus_generic_map_t *map, int n,
+                              uint32_t val);
+/** Turn the first n pins of map into inputs */
+void urj_bus_generic_map_set_input (urj_bus_generic_map_t *map, int n);
+/** @return the values sampled on the first n pins of map */
+uint32_t urj_bus_generic_map_get (urj_bus_generic_map_t *map, int n);
+
 urj_bus_t *urj_bus_generic_new (urj_chain_t *chain,
                                 const urj_bus_driver_t *driver,
                                 size_t param_size);
@@ -42,5 +67,14 @@ int urj_bus_generic_no_disable (urj_bus_t *bus);
 void urj_bus_generic_prepare_extest (urj_bus_t *bus);
 int urj_bus_generic_write_start(urj_bus_t *bus, uint32_t adr);
 uint32_t urj_bus_generic_read (urj_bus_t *bus, uint32_t adr);
+int urj_bus_generic_write_block (urj_bus_t *bus, uint32_t adr,
+                                 const uint32_t *data, int count);
+int urj_bus_generic_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *data,
+                                int count);
+int urj_bus_generic_read_block_extest (urj_bus_t *bus, uint32_t adr,
+                                       uint32_t *data, int count,
+                                       void (*address) (urj_bus_t *bus,
+                                                        uint32_t adr),
+                                       uint32_t (*get_data) (urj_bus_t *bus));
 
 #endif /* URJ_BUS_GENERIC_BUS_H */
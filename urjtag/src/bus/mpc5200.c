@@ -44,6 +44,8 @@
 #define LPC_NUM_CS      6
 #define LPC_NUM_AD      32
 #define LPC_ADDR_TO_CS(a) ((a) >> bp->lpc_num_ad)
+/* nCS pin values selecting chip select cs */
+#define LPC_NCS(cs)     ((cs) < LPC_NUM_CS ? ~((uint32_t) 1 << (cs)) : ~(uint32_t) 0)
 #define LPC_ADDR_SIZE   (((long unsigned long) 1 << bp->lpc_num_ad) * LPC_NUM_CS)
 
 typedef struct
@@ -58,6 +60,9 @@ typedef struct
     int muxed;
     int lpc_num_ad;
     int lpc_num_d;
+    urj_bus_generic_map_t *amap;
+    urj_bus_generic_map_t *dmap;
+    urj_bus_generic_map_t *csmap;
 } bus_params_t;
 
 #define LAST_ADR        ((bus_params_t *) bus->params)->last_adr
@@ -67,6 +72,9 @@ typedef struct
 #define nOE             ((bus_params_t *) bus->params)->noe
 #define nALE            ((bus_params_t *) bus->params)->nale
 #define ATA_ISO         ((bus_params_t *) bus->params)->ata_iso
+#define AMAP            ((bus_params_t *) bus->params)->amap
+#define DMAP            ((bus_params_t *) bus->params)->dmap
+#define CSMAP           ((bus_params_t *) bus->params)->csmap
 
 /**
  * bus->driver->(*new_bus)
@@ -133,8 +141,21 @@ mpc5200_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
 
     failed |= urj_bus_generic_attach_sig (part, &(ATA_ISO), "ATA_ISOLATION");
 
+    if (!failed)
+    {
+        AMAP = urj_bus_generic_map_new (part, AD, bp->lpc_num_ad);
+        DMAP = urj_bus_generic_map_new (part,
+                                        &AD[LPC_NUM_AD - bp->lpc_num_d],
+                                        bp->lpc_num_d);
+        CSMAP = urj_bus_generic_map_new (part, nCS, LPC_NUM_CS);
+        failed = AMAP == NULL || DMAP == NULL || CSMAP == NULL;
+    }
+
     if (failed)
     {
+        urj_bus_generic_map_free (AMAP);
+        urj_bus_generic_map_free (DMAP);
+        urj_bus_generic_map_free (CSMAP);
         urj_bus_generic_free (bus);
         return NULL;
     }
@@ -142,6 +163,19 @@ mpc5200_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
     return bus;
 }
 
+/**
+ * bus->driver->(*free_bus)
+ *
+ */
+static void
+mpc5200_bus_free (urj_bus_t *bus)
+{
+    urj_bus_generic_map_free (AMAP);
+    urj_bus_generic_map_free (DMAP);
+    urj_bus_generic_map_free (CSMAP);
+    urj_bus_generic_free (bus);
+}
+
 /**
  * bus->driver->(*printinfo)
  *
@@ -187,44 +221,34 @@ static void
 setup_address (urj_bus_t *bus, uint32_t a)
 {
     bus_params_t *bp = (bus_params_t *) bus->params;
-    urj_part_t *p = bus->part;
-    int i;
 
-    for (i = 0; i < bp->lpc_num_ad; i++)
-        urj_part_set_signal (p, AD[i], 1, (a >> i) & 1);
+    urj_bus_generic_map_set (AMAP, bp->lpc_num_ad, a);
 }
 
 static void
 set_data_in (urj_bus_t *bus, uint32_t adr)
 {
     bus_params_t *bp = (bus_params_t *) bus->params;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
-    int i;
 
     mpc5200_bus_area (bus, adr, &area);
     if (area.width > bp->lpc_num_d)
         return;
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal_input (p, AD[i + (LPC_NUM_AD - bp->lpc_num_d)]);
+    urj_bus_generic_map_set_input (DMAP, area.width);
 }
 
 static void
 setup_data (urj_bus_t *bus, uint32_t adr, uint32_t d)
 {
     bus_params_t *bp = (bus_params_t *) bus->params;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
-    int i;
 
     mpc5200_bus_area (bus, adr, &area);
     if (area.width > bp->lpc_num_d)
         return;
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal (p, AD[i + (LPC_NUM_AD - bp->lpc_num_d)], 1,
-                             (d >> i) & 1);
+    urj_bus_generic_map_set (DMAP, area.width, d);
 }
 
 static uint32_t
@@ -232,20 +256,12 @@ get_data (urj_bus_t *bus, uint32_t adr)
 {
     bus_params_t *bp = (bus_params_t *) bus->params;
     urj_bus_area_t area;
-    uint32_t d = 0;
-    urj_part_t *p = bus->part;
-    int i;
 
     mpc5200_bus_area (bus, adr, &area);
     if (area.width > bp->lpc_num_d)
         return 0;
 
-    for (i = 0; i < area.width; i++)
-    {
-        d |= (uint32_t) (urj_part_get_signal
-                         (p, AD[i + (LPC_NUM_AD - bp->lpc_num_d)]) << i);
-    }
-    return d;
+    return urj_bus_generic_map_get (DMAP, area.width);
 }
 
 /**
@@ -258,16 +274,12 @@ mpc5200_bus_read_start (urj_bus_t *bus, uint32_t adr)
     bus_params_t *bp = (bus_params_t *) bus->params;
     urj_part_t *p = bus->part;
     uint8_t cs = LPC_ADDR_TO_CS (adr);
-    int i;
 
     LAST_ADR = adr;
 
     /* see Figure 6-45 in [1] */
 
-    for (i = 0; i < LPC_NUM_CS; i++)
-    {
-        urj_part_set_signal (p, nCS[i], 1, !(cs == i));
-    }
+    urj_bus_generic_map_set (CSMAP, LPC_NUM_CS, LPC_NCS (cs));
 
     urj_part_set_signal_high (p, ATA_ISO);
     urj_part_set_signal_high (p, nWE);
@@ -335,17 +347,13 @@ mpc5200_bus_read_end (urj_bus_t *bus)
 {
     bus_params_t *bp = (bus_params_t *) bus->params;
     urj_part_t *p = bus->part;
-    int i;
 
     if (bp->muxed)
     {
         set_data_in (bus, LAST_ADR);
         urj_tap_chain_shift_data_registers (bus->chain, 0);
     }
-    for (i = 0; i < LPC_NUM_CS; i++)
-    {
-        urj_part_set_signal_high (p, nCS[i]);
-    }
+    urj_bus_generic_map_set (CSMAP, LPC_NUM_CS, ~(uint32_t) 0);
     urj_part_set_signal_high (p, nOE);
 
     urj_tap_chain_shift_data_registers (bus->chain, 1);
@@ -365,7 +373,6 @@ mpc5200_bus_write (urj_bus_t *bus, uint32_t adr, uint32_t data)
     urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
     uint8_t cs = LPC_ADDR_TO_CS (adr);
-    int i;
 
     if (bp->muxed)
     {
@@ -376,10 +383,7 @@ mpc5200_bus_write (urj_bus_t *bus, uint32_t adr, uint32_t data)
         urj_tap_chain_shift_data_registers (chain, 0);
     }
 
-    for (i = 0; i < LPC_NUM_CS; i++)
-    {
-        urj_part_set_signal (p, nCS[i], 1, !(cs == i));
-    }
+    urj_bus_generic_map_set (CSMAP, LPC_NUM_CS, LPC_NCS (cs));
     urj_part_set_signal_high (p, ATA_ISO);
     urj_part_set_signal_high (p, nWE);
     urj_part_set_signal_high (p, nOE);
@@ -400,7 +404,7 @@ const urj_bus_driver_t urj_bus_mpc5200_bus = {
     "mpc5200",
     N_("Freescale MPC5200 compatible bus driver via BSR, parameter: [mux]"),
     mpc5200_bus_new,
-    urj_bus_generic_free,
+    mpc5200_bus_free,
     mpc5200_bus_printinfo,
     urj_bus_generic_prepare_extest,
     mpc5200_bus_area,
@@ -46,6 +46,12 @@ typedef struct
     urj_part_signal_t *oe;
     int alsbi, amsbi, ai, aw, dlsbi, dmsbi, di, dw, csa, wea, oea;
     int ashift;
+    /* the signals above resolved to BSR cells */
+    urj_bus_generic_map_t *amap;
+    urj_bus_generic_map_t *dmap;
+    urj_part_sighandle_t csh;
+    urj_part_sighandle_t weh;
+    urj_part_sighandle_t oeh;
 } bus_params_t;
 
 #define A       ((bus_params_t *) bus->params)->a
@@ -68,6 +74,12 @@ typedef struct
 
 #define ASHIFT ((bus_params_t *) bus->params)->ashift
 
+#define AMAP    ((bus_params_t *) bus->params)->amap
+#define DMAP    ((bus_params_t *) bus->params)->dmap
+#define CSH     (&((bus_params_t *) bus->params)->csh)
+#define WEH     (&((bus_params_t *) bus->params)->weh)
+#define OEH     (&((bus_params_t *) bus->params)->oeh)
+
 static void
 prototype_bus_signal_parse (const char *str, char *fmt, int *inst)
 {
@@ -97,6 +109,7 @@ prototype_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
 {
     urj_bus_t *bus;
     urj_part_signal_t *sig;
+    urj_part_signal_t *pins[32];
     char buff[16], fmt[16], afmt[16], dfmt[16];
     int i, j, inst, max, min;
     int failed = 0;
@@ -153,12 +166,18 @@ prototype_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
 
             inst = 32;
             prototype_bus_signal_parse (value, fmt, &inst);
-            // @@@@ RFHH Flag error?
-            // @@@@ RFHH If it is mandatory for a signal to have an int inst
-            // number, why does prototype_bus_signal_parse() accept values
-            // without an int?
-            if (inst > 31 || inst < 0)
+            /* address and data pins need an index, the control pins not */
+            if ((inst > 31 || inst < 0)
+                && (cmd_params[i]->key == URJ_BUS_PARAM_KEY_ALSB
+                    || cmd_params[i]->key == URJ_BUS_PARAM_KEY_AMSB
+                    || cmd_params[i]->key == URJ_BUS_PARAM_KEY_DLSB
+                    || cmd_params[i]->key == URJ_BUS_PARAM_KEY_DMSB))
+            {
+                urj_error_set (URJ_ERROR_INVALID,
+                               _("signal '%s' has no index 0..31"), value);
+                failed = 1;
                 continue;
+            }
 
             sig = urj_part_find_signal (bus->part, value);
             if (!sig)
@@ -336,8 +355,24 @@ prototype_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
         failed = 1;
     }
 
+    if (!failed)
+    {
+        for (i = 0, j = ALSBI; i < AW; i++, j += AI)
+            pins[i] = A[j];
+        AMAP = urj_bus_generic_map_new (bus->part, pins, AW);
+        for (i = 0, j = DLSBI; i < DW; i++, j += DI)
+            pins[i] = D[j];
+        DMAP = urj_bus_generic_map_new (bus->part, pins, DW);
+        failed = AMAP == NULL || DMAP == NULL
+            || urj_part_sighandle_init (bus->part, CS, CSH) != URJ_STATUS_OK
+            || urj_part_sighandle_init (bus->part, OE, OEH) != URJ_STATUS_OK
+            || urj_part_sighandle_init (bus->part, WE, WEH) != URJ_STATUS_OK;
+    }
+
     if (failed)
     {
+        urj_bus_generic_map_free (AMAP);
+        urj_bus_generic_map_free (DMAP);
         urj_bus_generic_free (bus);
         return NULL;
     }
@@ -345,6 +380,18 @@ prototype_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
     return bus;
 }
 
+/**
+ * bus->driver->(*free_bus)
+ *
+ */
+static void
+prototype_bus_free (urj_bus_t *bus)
+{
+    urj_bus_generic_map_free (AMAP);
+    urj_bus_generic_map_free (DMAP);
+    urj_bus_generic_free (bus);
+}
+
 /**
  * bus->driver->(*printinfo)
  *
@@ -380,39 +427,37 @@ prototype_bus_area (urj_bus_t *bus, uint32_t adr, urj_bus_area_t *area)
 static void
 setup_address (urj_bus_t *bus, uint32_t a)
 {
-    int i, j;
-    urj_part_t *p = bus->part;
-
-    a >>= ASHIFT;
+    urj_bus_generic_map_set (AMAP, AW, a >> ASHIFT);
+}
 
-    for (i = 0, j = ALSBI; i < AW; i++, j += AI)
-        urj_part_set_signal (p, A[j], 1, (a >> i) & 1);
+static uint32_t
+get_data_out (urj_bus_t *bus)
+{
+    return urj_bus_generic_map_get (DMAP, DW);
 }
 
 static void
 set_data_in (urj_bus_t *bus)
 {
-    int i, j;
-    urj_part_t *p = bus->part;
-    urj_bus_area_t area;
-
-    prototype_bus_area (bus, 0, &area);
-
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        urj_part_set_signal_input (p, D[j]);
+    urj_bus_generic_map_set_input (DMAP, DW);
 }
 
 static void
 setup_data (urj_bus_t *bus, uint32_t d)
 {
-    int i, j;
-    urj_part_t *p = bus->part;
-    urj_bus_area_t area;
+    urj_bus_generic_map_set (DMAP, DW, d);
+}
 
-    prototype_bus_area (bus, 0, &area);
+/* resolve CS, WE and OE again after later signal or bit definitions */
+static int
+refresh_handles (urj_bus_t *bus)
+{
+    if (urj_part_sighandles_refresh (CSH, 1) != URJ_STATUS_OK
+        || urj_part_sighandles_refresh (WEH, 1) != URJ_STATUS_OK
+        || urj_part_sighandles_refresh (OEH, 1) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
 
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        urj_part_set_signal (p, D[j], 1, (d >> i) & 1);
+    return URJ_STATUS_OK;
 }
 
 /**
@@ -422,12 +467,14 @@ setup_data (urj_bus_t *bus, uint32_t d)
 static int
 prototype_bus_read_start (urj_bus_t *bus, uint32_t adr)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
 
-    urj_part_set_signal (p, CS, 1, CSA);
-    urj_part_set_signal (p, WE, 1, WEA ? 0 : 1);
-    urj_part_set_signal (p, OE, 1, OEA);
+    if (refresh_handles (bus) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    urj_part_sighandle_set (CSH, CSA);
+    urj_part_sighandle_set (WEH, WEA ? 0 : 1);
+    urj_part_sighandle_set (OEH, OEA);
 
     setup_address (bus, adr);
     set_data_in (bus);
@@ -444,10 +491,7 @@ prototype_bus_read_start (urj_bus_t *bus, uint32_t adr)
 static uint32_t
 prototype_bus_read_next (urj_bus_t *bus, uint32_t adr)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i, j;
-    uint32_t d = 0;
     urj_bus_area_t area;
 
     prototype_bus_area (bus, adr, &area);
@@ -455,10 +499,7 @@ prototype_bus_read_next (urj_bus_t *bus, uint32_t adr)
     setup_address (bus, adr);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        d |= (uint32_t) (urj_part_get_signal (p, D[j]) << i);
-
-    return d;
+    return get_data_out (bus);
 }
 
 /**
@@ -468,22 +509,28 @@ prototype_bus_read_next (urj_bus_t *bus, uint32_t adr)
 static uint32_t
 prototype_bus_read_end (urj_bus_t *bus)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i, j;
-    uint32_t d = 0;
     urj_bus_area_t area;
 
     prototype_bus_area (bus, 0, &area);
 
-    urj_part_set_signal (p, CS, 1, CSA ? 0 : 1);
-    urj_part_set_signal (p, OE, 1, OEA ? 0 : 1);
+    urj_part_sighandle_set (CSH, CSA ? 0 : 1);
+    urj_part_sighandle_set (OEH, OEA ? 0 : 1);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        d |= (uint32_t) (urj_part_get_signal (p, D[j]) << i);
+    return get_data_out (bus);
+}
 
-    return d;
+/**
+ * bus->driver->(*read_block)
+ *
+ */
+static int
+prototype_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *data,
+                          int count)
+{
+    return urj_bus_generic_read_block_extest (bus, adr, data, count,
+                                              setup_address, get_data_out);
 }
 
 /**
@@ -493,22 +540,24 @@ prototype_bus_read_end (urj_bus_t *bus)
 static void
 prototype_bus_write (urj_bus_t *bus, uint32_t adr, uint32_t data)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
 
-    urj_part_set_signal (p, CS, 1, CSA);
-    urj_part_set_signal (p, WE, 1, WEA ? 0 : 1);
-    urj_part_set_signal (p, OE, 1, OEA ? 0 : 1);
+    if (refresh_handles (bus) != URJ_STATUS_OK)
+        return;
+
+    urj_part_sighandle_set (CSH, CSA);
+    urj_part_sighandle_set (WEH, WEA ? 0 : 1);
+    urj_part_sighandle_set (OEH, OEA ? 0 : 1);
 
     setup_address (bus, adr);
     setup_data (bus, data);
 
     urj_tap_chain_shift_data_registers (chain, 0);
 
-    urj_part_set_signal (p, WE, 1, WEA);
+    urj_part_sighandle_set (WEH, WEA);
     urj_tap_chain_shift_data_registers (chain, 0);
-    urj_part_set_signal (p, WE, 1, WEA ? 0 : 1);
-    urj_part_set_signal (p, CS, 1, CSA ? 0 : 1);
+    urj_part_sighandle_set (WEH, WEA ? 0 : 1);
+    urj_part_sighandle_set (CSH, CSA ? 0 : 1);
     urj_tap_chain_shift_data_registers (chain, 0);
 }
 
@@ -518,7 +567,7 @@ const urj_bus_driver_t urj_bus_prototype_bus = {
        "           amsb=<addr MSB> alsb=<addr LSB> dmsb=<data MSB> dlsb=<data LSB>\n"
        "           ncs=<CS#>|cs=<CS> noe=<OE#>|oe=<OE> nwe=<WE#>|we=<WE> [amode=auto|x8|x16|x32]"),
     prototype_bus_new,
-    urj_bus_generic_free,
+    prototype_bus_free,
     prototype_bus_printinfo,
     urj_bus_generic_prepare_extest,
     prototype_bus_area,
@@ -532,4 +581,6 @@ const urj_bus_driver_t urj_bus_prototype_bus = {
     urj_bus_generic_no_enable,
     urj_bus_generic_no_disable,
     URJ_BUS_TYPE_PARALLEL,
+    NULL,                       /* write_block */
+    prototype_bus_read_block,
 };
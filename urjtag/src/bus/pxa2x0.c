@@ -121,6 +121,8 @@ typedef struct
     int inited;
     int proc;
     ncs_map_entry ncs_map[nCS_TOTAL];
+    urj_bus_generic_map_t *amap;
+    urj_bus_generic_map_t *dmap;
 } bus_params_t;
 
 #define PROC            ((bus_params_t *) bus->params)->proc
@@ -133,6 +135,8 @@ typedef struct
 #define nWE             ((bus_params_t *) bus->params)->nwe
 #define nOE             ((bus_params_t *) bus->params)->noe
 #define nSDCAS          ((bus_params_t *) bus->params)->nsdcas
+#define AMAP            ((bus_params_t *) bus->params)->amap
+#define DMAP            ((bus_params_t *) bus->params)->dmap
 
 #define MC_pointer      (&((bus_params_t *) bus->params)->MC_registers)
 
@@ -232,8 +236,17 @@ pxa2xx_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
 
     failed |= urj_bus_generic_attach_sig (part, &(nSDCAS), "nSDCAS");
 
+    if (!failed)
+    {
+        AMAP = urj_bus_generic_map_new (part, MA, 26);
+        DMAP = urj_bus_generic_map_new (part, MD, 32);
+        failed = AMAP == NULL || DMAP == NULL;
+    }
+
     if (failed)
     {
+        urj_bus_generic_map_free (AMAP);
+        urj_bus_generic_map_free (DMAP);
         urj_bus_generic_free (bus);
         return NULL;
     }
@@ -241,6 +254,18 @@ pxa2xx_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
     return bus;
 }
 
+/**
+ * bus->driver->(*free_bus)
+ *
+ */
+static void
+pxa2xx_bus_free (urj_bus_t *bus)
+{
+    urj_bus_generic_map_free (AMAP);
+    urj_bus_generic_map_free (DMAP);
+    urj_bus_generic_free (bus);
+}
+
 /**
  * bus->driver->(*printinfo)
  *
@@ -537,37 +562,27 @@ pxa27x_bus_area (urj_bus_t *bus, uint32_t adr, urj_bus_area_t *area)
 static void
 setup_address (urj_bus_t *bus, uint32_t a)
 {
-    int i;
-    urj_part_t *p = bus->part;
-
-    for (i = 0; i < 26; i++)
-        urj_part_set_signal (p, MA[i], 1, (a >> i) & 1);
+    urj_bus_generic_map_set (AMAP, 26, a);
 }
 
 static void
 set_data_in (urj_bus_t *bus, uint32_t adr)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     bus->driver->area (bus, adr, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal_input (p, MD[i]);
+    urj_bus_generic_map_set_input (DMAP, area.width);
 }
 
 static void
 setup_data (urj_bus_t *bus, uint32_t adr, uint32_t d)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     bus->driver->area (bus, adr, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal (p, MD[i], 1, (d >> i) & 1);
+    urj_bus_generic_map_set (DMAP, area.width, d);
 }
 
 /**
@@ -623,7 +638,6 @@ pxa2xx_bus_read_start (urj_bus_t *bus, uint32_t adr)
 static uint32_t
 pxa2xx_bus_read_next (urj_bus_t *bus, uint32_t adr)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
     uint32_t d;
     uint32_t old_last_adr = LAST_ADR;
@@ -632,7 +646,6 @@ pxa2xx_bus_read_next (urj_bus_t *bus, uint32_t adr)
 
     if (adr < UINT32_C (0x18000000))
     {
-        int i;
         urj_bus_area_t area;
 
         if (nCS[adr >> 26] == NULL)     // avoid undefined nCS windows
@@ -644,9 +657,7 @@ pxa2xx_bus_read_next (urj_bus_t *bus, uint32_t adr)
         setup_address (bus, adr);
         urj_tap_chain_shift_data_registers (chain, 1);
 
-        d = 0;
-        for (i = 0; i < area.width; i++)
-            d |= (uint32_t) (urj_part_get_signal (p, MD[i]) << i);
+        d = urj_bus_generic_map_get (DMAP, area.width);
 
         return d;
     }
@@ -678,7 +689,6 @@ pxa2xx_bus_read_end (urj_bus_t *bus)
 
     if (LAST_ADR < UINT32_C (0x18000000))
     {
-        int i;
         uint32_t d = 0;
         urj_bus_area_t area;
 
@@ -694,8 +704,7 @@ pxa2xx_bus_read_end (urj_bus_t *bus)
 
         urj_tap_chain_shift_data_registers (chain, 1);
 
-        for (i = 0; i < area.width; i++)
-            d |= (uint32_t) (urj_part_get_signal (p, MD[i]) << i);
+        d = urj_bus_generic_map_get (DMAP, area.width);
 
         return d;
     }
@@ -760,7 +769,7 @@ const urj_bus_driver_t urj_bus_pxa2x0_bus = {
     "pxa2x0",
     N_("Intel PXA2x0 compatible bus driver via BSR"),
     pxa2xx_bus_new,
-    urj_bus_generic_free,
+    pxa2xx_bus_free,
     pxa2xx_bus_printinfo,
     urj_bus_generic_prepare_extest,
     pxa2xx_bus_area,
@@ -780,7 +789,7 @@ const urj_bus_driver_t urj_bus_pxa27x_bus = {
     "pxa27x",
     N_("Intel PXA27x compatible bus driver via BSR"),
     pxa2xx_bus_new,
-    urj_bus_generic_free,
+    pxa2xx_bus_free,
     pxa2xx_bus_printinfo,
     urj_bus_generic_prepare_extest,
     pxa27x_bus_area,
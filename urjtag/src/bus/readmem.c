@@ -39,6 +39,23 @@
 #include <urjtag/flash.h>
 #include <urjtag/jtag.h>
 
+#include "generic_bus.h"
+
+int
+urj_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *data, int count)
+{
+    if (!bus)
+    {
+        urj_error_set (URJ_ERROR_NO_BUS_DRIVER, _("Missing bus driver"));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (bus->driver->read_block != NULL)
+        return bus->driver->read_block (bus, adr, data, count);
+
+    return urj_bus_generic_read_block (bus, adr, data, count);
+}
+
 int
 urj_bus_readmem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
 {
@@ -47,6 +64,7 @@ urj_bus_readmem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
     size_t bc = 0;
 #define BSIZE 4096
     uint8_t b[BSIZE];
+    uint32_t words[BSIZE];
     urj_bus_area_t area;
     uint64_t end;
 
@@ -93,41 +111,42 @@ urj_bus_readmem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
     end = a + len;
     urj_log (URJ_LOG_LEVEL_NORMAL, _("reading:\n"));
 
-    if (URJ_BUS_READ_START (bus, addr) != URJ_STATUS_OK)
-        return URJ_STATUS_FAIL;
-
-    for (a += step; a <= end; a += step)
+    while (a < end)
     {
-        uint32_t data;
-        int j;
-
-        if (a < end)
-            data = URJ_BUS_READ_NEXT (bus, a);
-        else
-            data = URJ_BUS_READ_END (bus);
-
-        for (j = step; j > 0; j--)
-            if (urj_get_file_endian () == URJ_ENDIAN_BIG)
-                b[bc++] = (data >> ((j - 1) * 8)) & 0xFF;
-            else
-            {
-                b[bc++] = data & 0xFF;
-                data >>= 8;
-            }
-
-        if ((bc >= BSIZE) || (a >= end))
+        int nwords = BSIZE / step;
+        int i, j;
+
+        if (end - a < (uint64_t) nwords * step)
+            nwords = (end - a) / step;
+
+        if (urj_bus_read_block (bus, a, words, nwords) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        a += (uint64_t) nwords * step;
+
+        for (i = 0; i < nwords; i++)
+        {
+            uint32_t data = words[i];
+
+            for (j = step; j > 0; j--)
+                if (urj_get_file_endian () == URJ_ENDIAN_BIG)
+                    b[bc++] = (data >> ((j - 1) * 8)) & 0xFF;
+                else
+                {
+                    b[bc++] = data & 0xFF;
+                    data >>= 8;
+                }
+        }
+
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("addr: 0x%08llX\r"),
+                 (long long unsigned) a);
+        if (fwrite (b, bc, 1, f) != 1)
         {
-            urj_log (URJ_LOG_LEVEL_NORMAL, _("addr: 0x%08llX\r"),
-                     (long long unsigned) a);
-            if (fwrite (b, bc, 1, f) != 1)
-            {
-                urj_error_set (URJ_ERROR_FILEIO, "fwrite fails");
-                urj_error_state.sys_errno = ferror(f);
-                clearerr(f);
-                return URJ_STATUS_FAIL;
-            }
-            bc = 0;
+            urj_error_set (URJ_ERROR_FILEIO, "fwrite fails");
+            urj_error_state.sys_errno = ferror(f);
+            clearerr(f);
+            return URJ_STATUS_FAIL;
         }
+        bc = 0;
     }
 
     urj_log (URJ_LOG_LEVEL_NORMAL, _("\nDone.\n"));
@@ -45,6 +45,8 @@ typedef struct
     urj_part_signal_t *a[26];
     urj_part_signal_t *d[32];
     urj_part_signal_t *ncs[6];
+    urj_bus_generic_map_t *amap;
+    urj_bus_generic_map_t *dmap;
     urj_part_signal_t *rd_nwr;
     urj_part_signal_t *nwe;
     urj_part_signal_t *noe;
@@ -52,6 +54,8 @@ typedef struct
 
 #define A       ((bus_params_t *) bus->params)->a
 #define D       ((bus_params_t *) bus->params)->d
+#define AMAP    ((bus_params_t *) bus->params)->amap
+#define DMAP    ((bus_params_t *) bus->params)->dmap
 #define nCS     ((bus_params_t *) bus->params)->ncs
 #define RD_nWR  ((bus_params_t *) bus->params)->rd_nwr
 #define nWE     ((bus_params_t *) bus->params)->nwe
@@ -100,8 +104,17 @@ sa1110_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
 
     failed |= urj_bus_generic_attach_sig (part, &(nOE), "nOE");
 
+    if (!failed)
+    {
+        AMAP = urj_bus_generic_map_new (part, A, 26);
+        DMAP = urj_bus_generic_map_new (part, D, 32);
+        failed = AMAP == NULL || DMAP == NULL;
+    }
+
     if (failed)
     {
+        urj_bus_generic_map_free (AMAP);
+        urj_bus_generic_map_free (DMAP);
         urj_bus_generic_free (bus);
         return NULL;
     }
@@ -109,6 +122,18 @@ sa1110_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
     return bus;
 }
 
+/**
+ * bus->driver->(*free_bus)
+ *
+ */
+static void
+sa1110_bus_free (urj_bus_t *bus)
+{
+    urj_bus_generic_map_free (AMAP);
+    urj_bus_generic_map_free (DMAP);
+    urj_bus_generic_free (bus);
+}
+
 /**
  * bus->driver->(*printinfo)
  *
@@ -146,37 +171,37 @@ sa1110_bus_area (urj_bus_t *bus, uint32_t adr, urj_bus_area_t *area)
 static void
 setup_address (urj_bus_t *bus, uint32_t a)
 {
-    int i;
-    urj_part_t *p = bus->part;
+    urj_bus_generic_map_set (AMAP, 26, a);
+}
 
-    for (i = 0; i < 26; i++)
-        urj_part_set_signal (p, A[i], 1, (a >> i) & 1);
+static uint32_t
+get_data_out (urj_bus_t *bus)
+{
+    urj_bus_area_t area;
+
+    sa1110_bus_area (bus, 0, &area);
+
+    return urj_bus_generic_map_get (DMAP, area.width);
 }
 
 static void
 set_data_in (urj_bus_t *bus)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     sa1110_bus_area (bus, 0, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal_input (p, D[i]);
+    urj_bus_generic_map_set_input (DMAP, area.width);
 }
 
 static void
 setup_data (urj_bus_t *bus, uint32_t d)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     sa1110_bus_area (bus, 0, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal (p, D[i], 1, (d >> i) & 1);
+    urj_bus_generic_map_set (DMAP, area.width, d);
 }
 
 /**
@@ -216,9 +241,7 @@ static uint32_t
 sa1110_bus_read_next (urj_bus_t *bus, uint32_t adr)
 {
     /* see Figure 10-12 in [1] */
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i;
     uint32_t d = 0;
     urj_bus_area_t area;
 
@@ -227,8 +250,7 @@ sa1110_bus_read_next (urj_bus_t *bus, uint32_t adr)
     setup_address (bus, adr);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0; i < area.width; i++)
-        d |= (uint32_t) (urj_part_get_signal (p, D[i]) << i);
+    d = urj_bus_generic_map_get (DMAP, area.width);
 
     return d;
 }
@@ -243,7 +265,6 @@ sa1110_bus_read_end (urj_bus_t *bus)
     /* see Figure 10-12 in [1] */
     urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i;
     uint32_t d = 0;
     urj_bus_area_t area;
 
@@ -258,12 +279,24 @@ sa1110_bus_read_end (urj_bus_t *bus)
     urj_part_set_signal_high (p, nOE);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0; i < area.width; i++)
-        d |= (uint32_t) (urj_part_get_signal (p, D[i]) << i);
+    d = urj_bus_generic_map_get (DMAP, area.width);
 
     return d;
 }
 
+/**
+ * bus->driver->(*read_block)
+ *
+ */
+static int
+sa1110_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *data,
+                       int count)
+{
+    /* see Figure 10-12 in [1] */
+    return urj_bus_generic_read_block_extest (bus, adr, data, count,
+                                              setup_address, get_data_out);
+}
+
 /**
  * bus->driver->(*write)
  *
@@ -306,7 +339,7 @@ const urj_bus_driver_t urj_bus_sa1110_bus = {
     "sa1110",
     N_("Intel SA-1110 compatible bus driver via BSR"),
     sa1110_bus_new,
-    urj_bus_generic_free,
+    sa1110_bus_free,
     sa1110_bus_printinfo,
     urj_bus_generic_prepare_extest,
     sa1110_bus_area,
@@ -320,4 +353,6 @@ const urj_bus_driver_t urj_bus_sa1110_bus = {
     urj_bus_generic_no_enable,
     urj_bus_generic_no_disable,
     URJ_BUS_TYPE_PARALLEL,
+    NULL,                       /* write_block */
+    sa1110_bus_read_block,
 };
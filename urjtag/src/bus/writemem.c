@@ -32,6 +32,24 @@
 #include <urjtag/flash.h>
 #include <urjtag/jtag.h>
 
+#include "generic_bus.h"
+
+int
+urj_bus_write_block (urj_bus_t *bus, uint32_t adr, const uint32_t *data,
+                     int count)
+{
+    if (!bus)
+    {
+        urj_error_set (URJ_ERROR_NO_BUS_DRIVER, _("Missing bus driver"));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (bus->driver->write_block != NULL)
+        return bus->driver->write_block (bus, adr, data, count);
+
+    return urj_bus_generic_write_block (bus, adr, data, count);
+}
+
 int
 urj_bus_writemem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
 {
@@ -41,6 +59,9 @@ urj_bus_writemem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
     int bidx = 0;
 #define BSIZE 4096
     uint8_t b[BSIZE];
+    uint32_t words[BSIZE];
+    int nwords = 0;
+    uint32_t wadr = addr;
     urj_bus_area_t area;
     uint64_t end;
 
@@ -95,6 +116,13 @@ urj_bus_writemem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
         /* Read one block of data */
         if (bc == 0)
         {
+            /* write the words of the last one first */
+            if (nwords > 0
+                && urj_bus_write_block (bus, wadr, words, nwords)
+                   != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+            nwords = 0;
+
             urj_log (URJ_LOG_LEVEL_NORMAL, _("addr: 0x%08llX\r"),
                      (long long unsigned) a);
             bc = fread (b, 1, BSIZE, f);
@@ -139,9 +167,15 @@ urj_bus_writemem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
             bc--;
         }
 
-        URJ_BUS_WRITE (bus, a, data);
+        if (nwords == 0)
+            wadr = a;
+        words[nwords++] = data;
     }
 
+    if (nwords > 0
+        && urj_bus_write_block (bus, wadr, words, nwords) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
     urj_log (URJ_LOG_LEVEL_NORMAL, _("\nDone.\n"));
 
     return URJ_STATUS_OK;
@@ -45,6 +45,73 @@ cable_probe (char *params[])
     return urj_tap_cable_usb_probe (params);
 }
 
+static int
+cable_stats (urj_chain_t *chain, char *params[])
+{
+    urj_cable_stats_t stats;
+    int i;
+
+    if (urj_cmd_params (params) > 3
+        || (params[2] != NULL && strcasecmp (params[2], "reset") != 0))
+    {
+        urj_error_set (URJ_ERROR_SYNTAX, "%s: syntax is '%s stats [reset]'",
+                       params[0], params[0]);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (urj_cmd_test_cable (chain) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    if (params[2] != NULL)
+    {
+        urj_tap_cable_reset_stats (chain->cable);
+        return URJ_STATUS_OK;
+    }
+
+    urj_tap_cable_get_stats (chain->cable, &stats);
+
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             _("Queue items:     %llu (at most %d queued, %d results)\n"),
+             (unsigned long long) stats.items, chain->cable->todo.high_water,
+             chain->cable->done.high_water);
+    urj_log (URJ_LOG_LEVEL_NORMAL, _("Clocks:          %llu\n"),
+             (unsigned long long) stats.clocks);
+    urj_log (URJ_LOG_LEVEL_NORMAL, _("Bits shifted:    %llu\n"),
+             (unsigned long long) stats.bits);
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             _("Flushes:         %llu optional, %llu to output, %llu complete\n"),
+             (unsigned long long) stats.flushes[URJ_TAP_CABLE_OPTIONALLY],
+             (unsigned long long) stats.flushes[URJ_TAP_CABLE_TO_OUTPUT],
+             (unsigned long long) stats.flushes[URJ_TAP_CABLE_COMPLETELY]);
+    urj_log (URJ_LOG_LEVEL_NORMAL, _("Transactions:    %llu\n"),
+             (unsigned long long) stats.transactions);
+    urj_log (URJ_LOG_LEVEL_NORMAL, _("Bytes out/in:    %llu/%llu\n"),
+             (unsigned long long) stats.bytes_out,
+             (unsigned long long) stats.bytes_in);
+    urj_log (URJ_LOG_LEVEL_NORMAL, _("Arena:           %llu bytes\n"),
+             (unsigned long long) stats.arena_bytes);
+
+    urj_log (URJ_LOG_LEVEL_NORMAL, _("Flush latency:\n"));
+    for (i = 0; i < URJ_CABLE_STATS_LATENCY_BUCKETS; i++)
+    {
+        char range[32];
+
+        if (stats.latency[i] == 0)
+            continue;
+        if (i == 0)
+            snprintf (range, sizeof range, "< 1 us");
+        else if (i == URJ_CABLE_STATS_LATENCY_BUCKETS - 1)
+            snprintf (range, sizeof range, ">= %lu us", 1UL << (i - 1));
+        else
+            snprintf (range, sizeof range, "%lu - %lu us", 1UL << (i - 1),
+                      1UL << i);
+        urj_log (URJ_LOG_LEVEL_NORMAL, "  %-18s %llu\n", range,
+                 (unsigned long long) stats.latency[i]);
+    }
+
+    return URJ_STATUS_OK;
+}
+
 static int
 cmd_cable_run (urj_chain_t *chain, char *params[])
 {
@@ -60,6 +127,9 @@ cmd_cable_run (urj_chain_t *chain, char *params[])
         return URJ_STATUS_FAIL;
     }
 
+    if (strcasecmp (params[1], "stats") == 0)
+        return cable_stats (chain, params);
+
     if (strcasecmp (params[1], "probe") == 0 && cable_probe (params))
     {
         urj_error_set (URJ_ERROR_NOTFOUND,
@@ -119,7 +189,9 @@ cmd_cable_help (void)
 {
     urj_log (URJ_LOG_LEVEL_NORMAL,
              _("Usage: %s DRIVER [DRIVER_OPTS]\n"
-               "Select JTAG cable type.\n"
+               "Usage: %s stats [reset]\n"
+               "Select JTAG cable type, or show the performance counters of\n"
+               "the current cable.\n"
                "\n"
                "DRIVER      name of cable\n"
                "DRIVER_OPTS options for the selected cable\n"
@@ -127,7 +199,7 @@ cmd_cable_help (void)
                "Type \"cable DRIVER help\" for info about options for cable DRIVER.\n"
                "You can also use the driver \"probe\" to attempt autodetection.\n"
                "\n" "List of supported cables:\n"),
-             "cable");
+             "cable", "cable");
 
     urj_cmd_show_list (urj_tap_cable_drivers);
 }
@@ -143,6 +215,7 @@ cmd_cable_complete (urj_chain_t *chain, char ***matches, size_t *match_cnt,
     {
     case 1:
         urj_completion_mayben_add_match (matches, match_cnt, text, text_len, "probe");
+        urj_completion_mayben_add_match (matches, match_cnt, text, text_len, "stats");
 
         for (i = 0; urj_tap_cable_drivers[i]; i++)
             urj_completion_mayben_add_match (matches, match_cnt, text, text_len,
@@ -25,10 +25,12 @@
 #include <sysdep.h>
 
 #include <stdio.h>
+#include <string.h>
 
 #include <urjtag/error.h>
 #include <urjtag/chain.h>
 #include <urjtag/cable.h>
+#include <urjtag/tap.h>
 
 #include <urjtag/cmd.h>
 
@@ -42,11 +44,19 @@ cmd_frequency_run (urj_chain_t *chain, char *params[])
     if (urj_cmd_test_cable (chain) != URJ_STATUS_OK)
         return URJ_STATUS_FAIL;
 
-    if (urj_cmd_params (params) > 2)
+    if (urj_cmd_params (params) > 3)
     {
         urj_error_set (URJ_ERROR_SYNTAX,
                        "%s: #parameters should be <= %d, not %d",
-                       params[0], 2, urj_cmd_params (params));
+                       params[0], 3, urj_cmd_params (params));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (urj_cmd_params (params) == 3 && strcasecmp (params[1], "auto") != 0)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX,
+                       "%s: only 'auto' takes a second parameter, not '%s'",
+                       params[0], params[1]);
         return URJ_STATUS_FAIL;
     }
 
@@ -57,6 +67,21 @@ cmd_frequency_run (urj_chain_t *chain, char *params[])
         return URJ_STATUS_OK;
     }
 
+    if (strcasecmp (params[1], "auto") == 0)
+    {
+        uint32_t found;
+
+        freq = 0;
+        if (urj_cmd_params (params) == 3
+            && urj_cmd_get_number (params[2], &freq) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        if (urj_tap_auto_frequency (chain, freq, &found) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("TCK frequency set to %lu Hz\n"),
+                 (long unsigned) found);
+        return URJ_STATUS_OK;
+    }
+
     if (urj_cmd_get_number (params[1], &freq) != URJ_STATUS_OK)
         return URJ_STATUS_FAIL;
 
@@ -72,6 +97,7 @@ cmd_frequency_help (void)
 {
     urj_log (URJ_LOG_LEVEL_NORMAL,
              _("Usage: %s [FREQ]\n"
+               "Usage: %s auto [MAX]\n"
                "Change TCK frequency to FREQ or print current TCK frequency.\n"
                "\n"
                "FREQ is in hertz. It's a maximum TCK frequency for JTAG interface.\n"
@@ -80,8 +106,14 @@ cmd_frequency_help (void)
                "adapter.\n"
                "\n"
                "FREQ must be an unsigned integer. Minimum allowed frequency is 1 Hz.\n"
-               "Use 0 for FREQ to disable frequency limit.\n"),
-             "frequency");
+               "Use 0 for FREQ to disable frequency limit.\n"
+               "\n"
+               "With \"auto\", find the highest frequency up to MAX at which\n"
+               "random patterns pass through all parts in BYPASS without error,\n"
+               "and set TCK a safety margin below it. MAX is in hertz as well;\n"
+               "without it, or with 0, the search starts at 100 MHz or the\n"
+               "fastest the cable can do.\n"),
+             "frequency", "frequency");
 }
 
 const urj_cmd_t urj_cmd_frequency = {
@@ -44,6 +44,7 @@
 #include <urjtag/error.h>
 #include <urjtag/flash.h>
 #include <urjtag/bus.h>
+#include <urjtag/chain.h>
 
 #include "flash.h"
 #include "cfi.h"
@@ -554,7 +555,7 @@ amd_flash_program_buffer (urj_flash_cfi_array_t *cfi_array, uint32_t adr,
 
     while (count > 0)
     {
-        int wcount, idx;
+        int wcount;
         uint32_t sa = adr;
 
         /* determine length of next multi-byte write */
@@ -563,22 +564,26 @@ amd_flash_program_buffer (urj_flash_cfi_array_t *cfi_array, uint32_t adr,
         if (wcount > count)
             wcount = count;
 
+        /* the whole command goes to the cable at once */
+        urj_tap_chain_defer_output_begin (bus->chain);
+
         URJ_BUS_WRITE (bus, cfi_array->address + (0x0555 << o), 0x00aa00aa);
         URJ_BUS_WRITE (bus, cfi_array->address + (0x02aa << o), 0x00550055);
         URJ_BUS_WRITE (bus, adr, 0x00250025);
         URJ_BUS_WRITE (bus, sa, wcount - 1);
 
         /* write payload to write buffer */
-        for (idx = 0; idx < wcount; idx++)
-        {
-            URJ_BUS_WRITE (bus, adr, buffer[offset + idx]);
-            adr += cfi_array->bus_width;
-        }
+        status = urj_bus_write_block (bus, adr, &buffer[offset], wcount);
+        adr += wcount * cfi_array->bus_width;
         offset += wcount;
 
         /* program buffer to flash */
         URJ_BUS_WRITE (bus, sa, 0x00290029);
 
+        urj_tap_chain_defer_output_end (bus->chain);
+        if (status != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
         status = amd_program_buffer_status (cfi_array,
                                             adr - cfi_array->bus_width,
                                             buffer[offset - 1]);
@@ -45,6 +45,7 @@
 #include <urjtag/log.h>
 #include <urjtag/flash.h>
 #include <urjtag/bus.h>
+#include <urjtag/chain.h>
 
 #include "flash.h"
 
@@ -365,7 +366,7 @@ intel_flash_program_buffer (urj_flash_cfi_array_t *cfi_array,
 
     while (count > 0)
     {
-        int wcount, idx;
+        int wcount, status;
         uint32_t block_adr = adr;
 
         /* determine length of next multi-byte write */
@@ -382,20 +383,24 @@ intel_flash_program_buffer (urj_flash_cfi_array_t *cfi_array,
             URJ_BUS_WRITE (bus, adr, CFI_INTEL_CMD_WRITE_TO_BUFFER);
         } while (!((sr = URJ_BUS_READ (bus, cfi_array->address) & 0xFE) & CFI_INTEL_SR_READY)); /* TODO: add timeout */
 
+        /* the rest of the command goes to the cable at once */
+        urj_tap_chain_defer_output_begin (bus->chain);
+
         /* write count value (number of upcoming writes - 1) */
         URJ_BUS_WRITE (bus, adr, wcount - 1);
 
         /* write payload to buffer */
-        for (idx = 0; idx < wcount; idx++)
-        {
-            URJ_BUS_WRITE (bus, adr, buffer[offset + idx]);
-            adr += cfi_array->bus_width;
-        }
+        status = urj_bus_write_block (bus, adr, &buffer[offset], wcount);
+        adr += wcount * cfi_array->bus_width;
         offset += wcount;
 
         /* issue command WRITE_CONFIRM */
         URJ_BUS_WRITE (bus, block_adr, CFI_INTEL_CMD_WRITE_CONFIRM);
 
+        urj_tap_chain_defer_output_end (bus->chain);
+        if (status != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
         count -= wcount;
     }
 
@@ -32,7 +32,7 @@
 #include <urjtag/error.h>
 #include <urjtag/jtag.h>
 
-urj_error_state_t urj_error_state;
+URJ_ERROR_THREAD_LOCAL urj_error_state_t urj_error_state;
 
 static int stderr_vprintf (const char *fmt, va_list ap);
 static int stdout_vprintf (const char *fmt, va_list ap);
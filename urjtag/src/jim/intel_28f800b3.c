@@ -29,6 +29,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/time.h>
 #include <time.h>
 
@@ -54,11 +55,13 @@ typedef enum
     ERASE_SUSP_TO_READ_STATUS = 12,
     ERASE_SUSP_TO_READ_ARRAY = 13,
     ERASE_SUSP_TO_READ_ID = 14,
-    ERASE_COMPLETE = 15
+    ERASE_COMPLETE = 15,
+    READ_QUERY = 16,
+    LOCK_SETUP = 17
 }
 intel_f28xxxb3_op_state_t;
 
-static const char *intel_28fxxx_opstate_name[16] = {
+static const char *intel_28fxxx_opstate_name[18] = {
     "READ_ARRAY",
     "READ_STATUS",
     "READ_ID",
@@ -74,7 +77,9 @@ static const char *intel_28fxxx_opstate_name[16] = {
     "ERASE_SUSP_TO_READ_STATUS",
     "ERASE_SUSP_TO_READ_ARRAY",
     "ERASE_SUSP_TO_READ_ID",
-    "ERASE_COMPLETE"
+    "ERASE_COMPLETE",
+    "READ_QUERY",
+    "LOCK_SETUP"
 };
 
 typedef enum
@@ -93,6 +98,32 @@ b3_boot_type_t;
 #define I28F_BLOCK_LOCKED       0x02
 #define I28F_RESERVED           0x01
 
+/* Blocks of the B3 family, in words: 8 parameter blocks at the boot end,
+ * main blocks everywhere else */
+#define I28F_PARAM_BLOCK        0x1000
+#define I28F_MAIN_BLOCK         0x8000
+
+/* CFI query data of the 28F800B3 (bottom boot) from offset 0x10 on, see
+ * table 27 of the datasheet; top boot devices list the erase block regions
+ * the other way round */
+static const uint8_t intel_28f800b3b_query[] = {
+    'Q', 'R', 'Y',              /* 0x10: query string */
+    0x03, 0x00, 0x35, 0x00,     /* 0x13: Intel command set, table at 0x35 */
+    0x00, 0x00, 0x00, 0x00,     /* 0x17: no alternate command set */
+    0x27, 0x36, 0xB4, 0xC6,     /* 0x1B: Vcc and Vpp ranges */
+    0x05, 0x00, 0x0A, 0x00,     /* 0x1F: typical timeouts */
+    0x04, 0x00, 0x03, 0x00,     /* 0x23: maximum timeouts */
+    0x14,                       /* 0x27: 2^20 bytes */
+    0x01, 0x00,                 /* 0x28: x16 interface */
+    0x00, 0x00,                 /* 0x2A: no write buffer */
+    0x02,                       /* 0x2C: erase block regions */
+    0x07, 0x00, 0x20, 0x00,     /* 0x2D: 8 blocks of 8 KiB */
+    0x0E, 0x00, 0x00, 0x01,     /* 0x31: 15 blocks of 64 KiB */
+    'P', 'R', 'I', '1', '0',    /* 0x35: primary extended query table */
+};
+
+#define I28F_QUERY_OFFSET       0x10
+
 
 typedef struct
 {
@@ -123,8 +154,8 @@ urj_jim_intel_28fxxxb3_init (urj_jim_bus_device_t *d, uint16_t id,
     is->opstate = READ_ARRAY;
     is->identifier = id;
     is->boot_type = bt;
-    is->status = 0x00;
-    is->status_buffer = 0x00;
+    is->status = I28F_WSM_READY;
+    is->status_buffer = I28F_WSM_READY;
     is->control_buffer = 0x00000000;
 
     return URJ_STATUS_OK;
@@ -159,11 +190,28 @@ urj_jim_intel_28fxxxb3_capture (urj_jim_bus_device_t *d,
         case READ_STATUS:
         case PROG_CONTINUE:
         case ERASE_CONTINUE:
+        case PROG_COMPLETE:
+        case ERASE_COMPLETE:
+        case LOCK_SETUP:
         case PROG_SUSP_TO_READ_STATUS:
         case ERASE_SUSP_TO_READ_STATUS:
             data = is->status_buffer;
             break;
 
+        case READ_QUERY:
+            if (address >= I28F_QUERY_OFFSET
+                && address < I28F_QUERY_OFFSET
+                             + sizeof intel_28f800b3b_query)
+            {
+                uint32_t i = address;
+
+                /* swap the two erase block regions */
+                if (is->boot_type == TOP && i >= 0x2D && i < 0x35)
+                    i = i < 0x31 ? i + 4 : i - 4;
+                data = intel_28f800b3b_query[i - I28F_QUERY_OFFSET];
+            }
+            break;
+
         case READ_ID:
         case PROG_SUSP_TO_READ_ID:
         case ERASE_SUSP_TO_READ_ID:
@@ -177,7 +225,7 @@ urj_jim_intel_28fxxxb3_capture (urj_jim_bus_device_t *d,
         case PROG_SUSP_TO_READ_ARRAY:
         case ERASE_SUSP_TO_READ_ARRAY:
             data = shmem[(address << 1)] << 8;
-            data |= shmem[(address << 1)] + 1;
+            data |= shmem[(address << 1) + 1];
             break;
 
         default:
@@ -235,16 +283,30 @@ urj_jim_intel_28fxxxb3_update (urj_jim_bus_device_t *d,
                     if (dusecs > 40)
                     {
                         shmem[(is->address_buffer << 1)] &=
-                            ((data >> 8) & 0xFF);
-                        shmem[(is->address_buffer << 1) + 1] &= (data & 0xFF);
+                            ((is->data_buffer >> 8) & 0xFF);
+                        shmem[(is->address_buffer << 1) + 1] &=
+                            (is->data_buffer & 0xFF);
                         is->status |= I28F_WSM_READY;
+                        is->opstate = PROG_COMPLETE;
                     }
                 }
                 else if (is->opstate == ERASE_CONTINUE)
                 {
                     if (dusecs > 600E3)
                     {
+                        uint32_t block = I28F_MAIN_BLOCK;
+
+                        if ((is->boot_type == BOTTOM
+                             && is->address_buffer < I28F_MAIN_BLOCK)
+                            || (is->boot_type == TOP
+                                && is->address_buffer >=
+                                   d->size - I28F_MAIN_BLOCK))
+                            block = I28F_PARAM_BLOCK;
+                        memset (shmem
+                                + ((is->address_buffer & ~(block - 1)) << 1),
+                                0xFF, block << 1);
                         is->status |= I28F_WSM_READY;
+                        is->opstate = ERASE_COMPLETE;
                     }
                 }
             }
@@ -273,6 +335,7 @@ urj_jim_intel_28fxxxb3_update (urj_jim_bus_device_t *d,
             case READ_STATUS:
             case READ_ARRAY:
             case READ_ID:
+            case READ_QUERY:
                 switch (dl)
                 {
                 case 0x10:
@@ -288,6 +351,12 @@ urj_jim_intel_28fxxxb3_update (urj_jim_bus_device_t *d,
                 case 0x90:
                     is->opstate = READ_ID;
                     break;
+                case 0x98:
+                    is->opstate = READ_QUERY;
+                    break;
+                case 0x60:
+                    is->opstate = LOCK_SETUP;
+                    break;
                 default:
                     is->opstate = READ_ARRAY;
                     break;
@@ -295,19 +364,12 @@ urj_jim_intel_28fxxxb3_update (urj_jim_bus_device_t *d,
                 break;
 
             case PROG_SETUP:
-                if (dl != 0x10 && dl != 0x40)
-                {
-                    is->status |= I28F_PROG_ERROR | I28F_ERASE_ERROR;
-                    is->opstate = READ_STATUS;
-                }
-                else
-                {
-                    is->status &= ~I28F_WSM_READY;
-                    is->data_buffer = data;
-                    is->address_buffer = address;
-                    is->opstate = PROG_CONTINUE;
-                    gettimeofday (&(is->prog_start_time), NULL);
-                }
+                /* the word to program, whatever its value */
+                is->status &= ~I28F_WSM_READY;
+                is->data_buffer = data;
+                is->address_buffer = address;
+                is->opstate = PROG_CONTINUE;
+                gettimeofday (&(is->prog_start_time), NULL);
                 break;
 
             case PROG_CONTINUE:
@@ -355,6 +417,12 @@ urj_jim_intel_28fxxxb3_update (urj_jim_bus_device_t *d,
                 }
                 break;
 
+            case LOCK_SETUP:
+                /* lock, unlock or lock-down; the lock bits are not
+                 * simulated, the device just reports its status */
+                is->opstate = READ_STATUS;
+                break;
+
             case ERASE_CONTINUE:
                 if (dl == 0xB0)
                 {
@@ -402,6 +470,12 @@ urj_jim_intel_28fxxxb3_update (urj_jim_bus_device_t *d,
                 case 0x90:
                     is->opstate = READ_ID;
                     break;
+                case 0x98:
+                    is->opstate = READ_QUERY;
+                    break;
+                case 0x60:
+                    is->opstate = LOCK_SETUP;
+                    break;
                 default:
                     is->opstate = READ_ARRAY;
                     break;
@@ -43,7 +43,7 @@ urj_part_bsbit_alloc_control (urj_part_t *part, int bit, const char *name,
     urj_data_register_t *bsr;
     urj_part_signal_t *signal;
 
-    bsr = urj_part_find_data_register (part, "BSR");
+    bsr = part->bsr;
     if (bsr == NULL)
     {
         urj_error_set(URJ_ERROR_NOTFOUND,
@@ -69,7 +69,7 @@ urj_part_bsbit_alloc_control (urj_part_t *part, int bit, const char *name,
 
     signal = urj_part_find_signal (part, name);
 
-    bsr->in->data[bit] = safe;
+    urj_tap_register_set_bit (bsr->in, bit, safe);
 
     b = malloc (sizeof *b);
     if (!b)
@@ -93,6 +93,7 @@ urj_part_bsbit_alloc_control (urj_part_t *part, int bit, const char *name,
     b->control = -1;
 
     part->bsbits[bit] = b;
+    part->generation++;
 
     if (signal != NULL)
     {
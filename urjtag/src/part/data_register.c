@@ -109,6 +109,7 @@ urj_part_data_register_define (urj_part_t *part, const char *name, int len)
 
     dr->next = part->data_registers;
     part->data_registers = dr;
+    part->generation++;
 
     /* Boundary Scan Register */
     if (strcasecmp (dr->name, "BSR") == 0)
@@ -125,6 +126,7 @@ urj_part_data_register_define (urj_part_t *part, const char *name, int len)
         }
         for (i = 0; i < part->boundary_length; i++)
             part->bsbits[i] = NULL;
+        part->bsr = dr;
     }
 
     /* Device Identification Register */
@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include <urjtag/error.h>
 #include <urjtag/part.h>
@@ -37,6 +38,234 @@
 
 urj_part_init_t *urj_part_inits = NULL;
 
+/* name indexes */
+
+/* The instruction, data register, signal and signal alias lists of a part
+ * stay authoritative; each has a case-insensitive hash index of its names
+ * next to it. Entries are only ever added at the head of a list, by the
+ * define functions, "salias" and bus drivers linking in registers of their
+ * own, so an index catches up on lookup by hashing the entries in front of
+ * the head it saw last. Where a name occurs twice, the entry nearer the
+ * head wins, as with a walk of the list. */
+
+typedef struct
+{
+    const char *(*name) (const void *entry);
+    const void *(*next) (const void *entry);
+}
+part_list_t;
+
+typedef struct
+{
+    const void *head;           /* list head the index is up to date with */
+    unsigned int count;
+    unsigned int mask;          /* number of slots - 1, a power of 2 - 1 */
+    const void **slots;
+}
+part_index_t;
+
+struct URJ_PART_INDEX
+{
+    part_index_t instructions;
+    part_index_t data_registers;
+    part_index_t signals;
+    part_index_t saliases;
+};
+
+static const char *
+instruction_name (const void *entry)
+{
+    return ((const urj_part_instruction_t *) entry)->name;
+}
+
+static const void *
+instruction_next (const void *entry)
+{
+    return ((const urj_part_instruction_t *) entry)->next;
+}
+
+static const char *
+data_register_name (const void *entry)
+{
+    return ((const urj_data_register_t *) entry)->name;
+}
+
+static const void *
+data_register_next (const void *entry)
+{
+    return ((const urj_data_register_t *) entry)->next;
+}
+
+static const char *
+signal_name (const void *entry)
+{
+    return ((const urj_part_signal_t *) entry)->name;
+}
+
+static const void *
+signal_next (const void *entry)
+{
+    return ((const urj_part_signal_t *) entry)->next;
+}
+
+static const char *
+salias_name (const void *entry)
+{
+    return ((const urj_part_salias_t *) entry)->name;
+}
+
+static const void *
+salias_next (const void *entry)
+{
+    return ((const urj_part_salias_t *) entry)->next;
+}
+
+static const part_list_t instruction_list = { instruction_name, instruction_next };
+static const part_list_t data_register_list = { data_register_name, data_register_next };
+static const part_list_t signal_list = { signal_name, signal_next };
+static const part_list_t salias_list = { salias_name, salias_next };
+
+static unsigned int
+index_hash (const char *name)
+{
+    unsigned int h = 2166136261u;
+
+    while (*name)
+        h = (h ^ tolower ((unsigned char) *name++)) * 16777619u;
+
+    return h;
+}
+
+/* Enter entry, replacing one of the same name */
+static void
+index_put (part_index_t *ix, const part_list_t *list, const void *entry)
+{
+    const char *name = list->name (entry);
+    unsigned int k = index_hash (name) & ix->mask;
+
+    while (ix->slots[k] != NULL)
+    {
+        if (strcasecmp (name, list->name (ix->slots[k])) == 0)
+        {
+            ix->slots[k] = entry;
+            return;
+        }
+        k = (k + 1) & ix->mask;
+    }
+    ix->slots[k] = entry;
+    ix->count++;
+}
+
+/* Make room for n more names at a load of at most 1/2 */
+static int
+index_reserve (part_index_t *ix, const part_list_t *list, unsigned int n)
+{
+    const void **old = ix->slots;
+    unsigned int old_size = old ? ix->mask + 1 : 0;
+    unsigned int size = old_size ? old_size : 16;
+    unsigned int k;
+
+    while (2 * (ix->count + n) > size)
+        size *= 2;
+    if (size == old_size)
+        return URJ_STATUS_OK;
+
+    ix->slots = calloc (size, sizeof *ix->slots);
+    if (ix->slots == NULL)
+    {
+        ix->slots = old;
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       (size_t) size, sizeof *ix->slots);
+        return URJ_STATUS_FAIL;
+    }
+    ix->mask = size - 1;
+    ix->count = 0;
+    for (k = 0; k < old_size; k++)
+        if (old[k] != NULL)
+            index_put (ix, list, old[k]);
+    free (old);
+
+    return URJ_STATUS_OK;
+}
+
+/* Bring ix up to date with the list starting at head */
+static int
+index_update (part_index_t *ix, const part_list_t *list, const void *head)
+{
+    const void **added;
+    const void *e;
+    unsigned int n, k;
+
+    for (n = 0, e = head; e != NULL && e != ix->head; e = list->next (e))
+        n++;
+    if (e == NULL && ix->head != NULL)
+    {
+        /* not a list grown at the head: index it afresh */
+        free (ix->slots);
+        ix->slots = NULL;
+        ix->count = 0;
+        ix->head = NULL;
+    }
+
+    if (index_reserve (ix, list, n) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    added = malloc (n * sizeof *added);
+    if (n > 0 && added == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                       n * sizeof *added);
+        return URJ_STATUS_FAIL;
+    }
+
+    /* oldest first, so that later definitions take over a name */
+    for (k = 0, e = head; k < n; e = list->next (e))
+        added[k++] = e;
+    while (k > 0)
+        index_put (ix, list, added[--k]);
+    free (added);
+    ix->head = head;
+
+    return URJ_STATUS_OK;
+}
+
+/* @return the entry called name in the list starting at head, NULL if none */
+static const void *
+index_find (part_index_t *ix, const part_list_t *list, const void *head,
+            const char *name)
+{
+    const void *e;
+    unsigned int k;
+
+    if (head != ix->head && index_update (ix, list, head) != URJ_STATUS_OK)
+    {
+        /* out of memory: walk the list */
+        urj_error_reset ();
+        for (e = head; e != NULL; e = list->next (e))
+            if (strcasecmp (name, list->name (e)) == 0)
+                break;
+        return e;
+    }
+    if (ix->slots == NULL)
+        return NULL;
+
+    for (k = index_hash (name) & ix->mask; ix->slots[k] != NULL;
+         k = (k + 1) & ix->mask)
+        if (strcasecmp (name, list->name (ix->slots[k])) == 0)
+            return ix->slots[k];
+
+    return NULL;
+}
+
+static void
+index_free (urj_part_index_t *index)
+{
+    free (index->instructions.slots);
+    free (index->data_registers.slots);
+    free (index->signals.slots);
+    free (index->saliases.slots);
+    free (index);
+}
+
 /* part */
 
 urj_part_t *
@@ -61,9 +290,20 @@ urj_part_alloc (const urj_tap_register_t *id)
     p->instructions = NULL;
     p->active_instruction = NULL;
     p->data_registers = NULL;
+    p->bsr = NULL;
     p->boundary_length = 0;
     p->bsbits = NULL;
     p->params = NULL;
+    p->generation = 0;
+    p->index = calloc (1, sizeof *p->index);
+    if (!p->index)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       (size_t) 1, sizeof *p->index);
+        urj_tap_register_free (p->id);
+        free (p);
+        return NULL;
+    }
 
     return p;
 }
@@ -123,6 +363,8 @@ urj_part_free (urj_part_t *p)
         p->params->free (p->params->data);
     free (p->params);
 
+    index_free (p->index);
+
     free (p);
 }
 
@@ -137,13 +379,9 @@ urj_part_find_instruction (urj_part_t *p, const char *iname)
         return NULL;
     }
 
-    i = p->instructions;
-    while (i)
-    {
-        if (strcasecmp (iname, i->name) == 0)
-            break;
-        i = i->next;
-    }
+    i = (urj_part_instruction_t *) index_find (&p->index->instructions,
+                                               &instruction_list,
+                                               p->instructions, iname);
 
     return i;
 }
@@ -159,13 +397,9 @@ urj_part_find_data_register (urj_part_t *p, const char *drname)
         return NULL;
     }
 
-    dr = p->data_registers;
-    while (dr)
-    {
-        if (strcasecmp (drname, dr->name) == 0)
-            break;
-        dr = dr->next;
-    }
+    dr = (urj_data_register_t *) index_find (&p->index->data_registers,
+                                             &data_register_list,
+                                             p->data_registers, drname);
 
     return dr;
 }
@@ -182,21 +416,15 @@ urj_part_find_signal (urj_part_t *p, const char *signalname)
         return NULL;
     }
 
-    s = p->signals;
-    while (s)
-    {
-        if (strcasecmp (signalname, s->name) == 0)
-            return s;
-        s = s->next;
-    }
+    s = (urj_part_signal_t *) index_find (&p->index->signals, &signal_list,
+                                          p->signals, signalname);
+    if (s)
+        return s;
 
-    sa = p->saliases;
-    while (sa)
-    {
-        if (strcasecmp (signalname, sa->name) == 0)
-            return sa->signal;
-        sa = sa->next;
-    }
+    sa = (urj_part_salias_t *) index_find (&p->index->saliases, &salias_list,
+                                           p->saliases, signalname);
+    if (sa)
+        return sa->signal;
 
     return NULL;
 }
@@ -219,8 +447,7 @@ urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val)
         return URJ_STATUS_FAIL;
     }
 
-    /* search for Boundary Scan Register */
-    bsr = urj_part_find_data_register (p, "BSR");
+    bsr = p->bsr;
     if (!bsr)
     {
         urj_error_set (URJ_ERROR_NOTFOUND,
@@ -238,12 +465,12 @@ urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val)
                            _("signal '%s' cannot be set as output"), s->name);
             return URJ_STATUS_FAIL;
         }
-        bsr->in->data[s->output->bit] = val & 1;
+        urj_tap_register_set_bit (bsr->in, s->output->bit, val & 1);
 
         control = p->bsbits[s->output->bit]->control;
         if (control >= 0)
-            bsr->in->data[control] =
-                p->bsbits[s->output->bit]->control_value ^ 1;
+            urj_tap_register_set_bit (bsr->in,
+                                      control, p->bsbits[s->output->bit]->control_value ^ 1);
     }
     else
     {
@@ -253,9 +480,9 @@ urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val)
                            _("signal '%s' cannot be set as input"), s->name);
             return URJ_STATUS_FAIL;
         }
-        if (s->output)
-            bsr->in->data[s->output->control] =
-                p->bsbits[s->output->bit]->control_value;
+        if (s->output && s->output->control >= 0)
+            urj_tap_register_set_bit (bsr->in,
+                                      s->output->control, p->bsbits[s->output->bit]->control_value);
     }
 
     return URJ_STATUS_OK;
@@ -272,8 +499,7 @@ urj_part_get_signal (urj_part_t *p, const urj_part_signal_t *s)
         return -1;
     }
 
-    /* search for Boundary Scan Register */
-    bsr = urj_part_find_data_register (p, "BSR");
+    bsr = p->bsr;
     if (!bsr)
     {
         urj_error_set (URJ_ERROR_NOTFOUND,
@@ -288,7 +514,117 @@ urj_part_get_signal (urj_part_t *p, const urj_part_signal_t *s)
         return -1;
     }
 
-    return bsr->out->data[s->input->bit];
+    return urj_tap_register_get_bit (bsr->out, s->input->bit);
+}
+
+int
+urj_part_sighandle_init (urj_part_t *p, const urj_part_signal_t *s,
+                         urj_part_sighandle_t *h)
+{
+    if (!p || !h)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL part or handle");
+        return URJ_STATUS_FAIL;
+    }
+
+    if (!p->bsr)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND,
+                       _("Boundary Scan Register (BSR) not found"));
+        return URJ_STATUS_FAIL;
+    }
+
+    h->part = p;
+    h->signal = s;
+    h->generation = p->generation;
+    h->bsr = p->bsr;
+    h->output = -1;
+    h->control = -1;
+    h->control_value = 0;
+    h->input = -1;
+
+    if (s && s->output)
+    {
+        h->output = s->output->bit;
+        h->control = p->bsbits[s->output->bit]->control;
+        h->control_value = p->bsbits[s->output->bit]->control_value;
+    }
+    if (s && s->input)
+        h->input = s->input->bit;
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_part_sighandles_refresh (urj_part_sighandle_t *h, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        if (h[i].generation != h[i].part->generation
+            && urj_part_sighandle_init (h[i].part, h[i].signal, &h[i])
+               != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+    return URJ_STATUS_OK;
+}
+
+void
+urj_part_sighandle_set (const urj_part_sighandle_t *h, int val)
+{
+    if (h->output < 0)
+        return;
+
+    urj_tap_register_set_bit (h->bsr->in, h->output, val & 1);
+    if (h->control >= 0)
+        urj_tap_register_set_bit (h->bsr->in, h->control,
+                                  h->control_value ^ 1);
+}
+
+void
+urj_part_sighandle_set_input (const urj_part_sighandle_t *h)
+{
+    if (h->control >= 0)
+        urj_tap_register_set_bit (h->bsr->in, h->control, h->control_value);
+}
+
+int
+urj_part_sighandle_get (const urj_part_sighandle_t *h)
+{
+    if (h->input < 0)
+        return 0;
+
+    return urj_tap_register_get_bit (h->bsr->out, h->input);
+}
+
+void
+urj_part_sighandles_set (const urj_part_sighandle_t *h, int n, uint32_t val)
+{
+    int i;
+
+    for (i = 0; i < n; i++, val >>= 1)
+        urj_part_sighandle_set (&h[i], val & 1);
+}
+
+void
+urj_part_sighandles_set_input (const urj_part_sighandle_t *h, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        urj_part_sighandle_set_input (&h[i]);
+}
+
+uint32_t
+urj_part_sighandles_get (const urj_part_sighandle_t *h, int n)
+{
+    uint32_t val = 0;
+    int i;
+
+    for (i = 0; i < n; i++)
+        val |= (uint32_t) urj_part_sighandle_get (&h[i]) << i;
+
+    return val;
 }
 
 int
@@ -134,6 +134,7 @@ urj_part_signal_define_pin (urj_chain_t *chain, const char *signal_name,
 
     s->next = part->signals;
     part->signals = s;
+    part->generation++;
 
     return s;
 }
@@ -148,6 +149,8 @@ int
 urj_part_signal_redefine_pin (urj_chain_t *chain, urj_part_signal_t *s,
                               const char *pin_name)
 {
+    urj_part_t *part;
+
     /* @@@@ RFHH Check s != NULL */
     free(s->pin);
 
@@ -159,5 +162,9 @@ urj_part_signal_redefine_pin (urj_chain_t *chain, urj_part_signal_t *s,
         return URJ_STATUS_FAIL;
     }
 
+    part = urj_tap_chain_active_part (chain);
+    if (part != NULL)
+        part->generation++;
+
     return URJ_STATUS_OK;
 }
@@ -568,9 +568,7 @@ xlx_configure (urj_pld_t *pld, FILE *bit_file)
     urj_part_t *part = pld->part;
     urj_part_instruction_t *i;
     xlx_bitstream_t *bs;
-    uint32_t u;
     int dr_len;
-    char *dr_data;
     int status = URJ_STATUS_OK;
 
     /* set all devices in bypass mode */
@@ -607,20 +605,8 @@ xlx_configure (urj_pld_t *pld, FILE *bit_file)
 
     i = urj_part_find_instruction (part, "CFG_IN");
 
-    /* copy data into shift register */
-    dr_data = i->data_register->in->data;
-    for (u = 0; u < bs->length; u++)
-    {
-        /* flip bits */
-        dr_data[8*u+0] = (bs->data[u] & 0x80) ? 1 : 0;
-        dr_data[8*u+1] = (bs->data[u] & 0x40) ? 1 : 0;
-        dr_data[8*u+2] = (bs->data[u] & 0x20) ? 1 : 0;
-        dr_data[8*u+3] = (bs->data[u] & 0x10) ? 1 : 0;
-        dr_data[8*u+4] = (bs->data[u] & 0x08) ? 1 : 0;
-        dr_data[8*u+5] = (bs->data[u] & 0x04) ? 1 : 0;
-        dr_data[8*u+6] = (bs->data[u] & 0x02) ? 1 : 0;
-        dr_data[8*u+7] = (bs->data[u] & 0x01) ? 1 : 0;
-    }
+    /* copy data into shift register, flipping the bits of each byte */
+    urj_tap_register_set_bytes (i->data_register->in, bs->data, bs->length, 1);
 
     if (xlx_set_ir_and_shift (chain, part, "JPROGRAM") != URJ_STATUS_OK)
     {
@@ -91,6 +91,10 @@ int urj_jam_seek (int32_t offset);
 
 int urj_jam_jtag_io (int tms, int tdi, int read_tdo);
 
+int urj_jam_jtag_goto_state (int from_state, int to_state);
+
+int urj_jam_jtag_idle (int tms, int32_t cycles);
+
 void urj_jam_message (const char *message_text);
 
 void urj_jam_export_integer (const char *key, int32_t value);
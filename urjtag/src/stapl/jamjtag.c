@@ -76,79 +76,6 @@ struct JAMS_JTAG_MAP
     {IRUPDATE, "IRUPDATE"}
 };
 
-/*
-*   This structure shows, for each JTAG state, which state is reached after
-*   a single TCK clock cycle with TMS high or TMS low, respectively.  This
-*   describes all possible state transitions in the JTAG state machine.
-*/
-struct JAMS_JTAG_MACHINE
-{
-    JAME_JTAG_STATE tms_high;
-    JAME_JTAG_STATE tms_low;
-} static const jam_jtag_state_transitions[] =
-{
-/* RESET     */
-    {
-    RESET, IDLE},
-/* IDLE      */
-    {
-    DRSELECT, IDLE},
-/* DRSELECT  */
-    {
-    IRSELECT, DRCAPTURE},
-/* DRCAPTURE */
-    {
-    DREXIT1, DRSHIFT},
-/* DRSHIFT   */
-    {
-    DREXIT1, DRSHIFT},
-/* DREXIT1   */
-    {
-    DRUPDATE, DRPAUSE},
-/* DRPAUSE   */
-    {
-    DREXIT2, DRPAUSE},
-/* DREXIT2   */
-    {
-    DRUPDATE, DRSHIFT},
-/* DRUPDATE  */
-    {
-    DRSELECT, IDLE},
-/* IRSELECT  */
-    {
-    RESET, IRCAPTURE},
-/* IRCAPTURE */
-    {
-    IREXIT1, IRSHIFT},
-/* IRSHIFT   */
-    {
-    IREXIT1, IRSHIFT},
-/* IREXIT1   */
-    {
-    IRUPDATE, IRPAUSE},
-/* IRPAUSE   */
-    {
-    IREXIT2, IRPAUSE},
-/* IREXIT2   */
-    {
-    IRUPDATE, IRSHIFT},
-/* IRUPDATE  */
-    {
-    DRSELECT, IDLE}
-};
-
-/*
-*   This table contains the TMS value to be used to take the NEXT STEP on
-*   the path to the desired state.  The array index is the current state,
-*   and the bit position is the desired endstate.  To find out which state
-*   is used as the intermediate state, look up the TMS value in the
-*   urj_jam_jtag_state_transitions[] table.
-*/
-static const unsigned short jam_jtag_path_map[16] = {
-    0x0001, 0xFFFD, 0xFE01, 0xFFE7, 0xFFEF, 0xFF0F, 0xFFBF, 0xFF0F,
-    0xFEFD, 0x0001, 0xF3FF, 0xF7FF, 0x87FF, 0xDFFF, 0x87FF, 0x7FFD
-};
-
 /*
 *   Flag bits for urj_jam_jtag_io() function
 */
@@ -619,8 +546,6 @@ urj_jam_goto_jtag_state (JAME_JTAG_STATE state)
 /*                                                                          */
 /****************************************************************************/
 {
-    int tms = 0;
-    int count = 0;
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
     if (urj_jam_jtag_state == JAM_ILLEGAL_JTAG_STATE)
@@ -646,34 +571,12 @@ urj_jam_goto_jtag_state (JAME_JTAG_STATE state)
             urj_jam_jtag_io (TMS_HIGH, TDI_LOW, IGNORE_TDO);
         }
     }
-    else
+    else if (urj_jam_jtag_goto_state (urj_jam_jtag_state, state))
     {
-        while ((urj_jam_jtag_state != state) && (count < 9))
-        {
-            /*
-             *      Get TMS value to take a step toward desired state
-             */
-            tms = (jam_jtag_path_map[urj_jam_jtag_state] & (1 << state)) ?
-                TMS_HIGH : TMS_LOW;
-
-            /*
-             *      Take a step
-             */
-            urj_jam_jtag_io (tms, TDI_LOW, IGNORE_TDO);
-
-            if (tms)
-            {
-                urj_jam_jtag_state =
-                    jam_jtag_state_transitions[urj_jam_jtag_state].tms_high;
-            }
-            else
-            {
-                urj_jam_jtag_state =
-                    jam_jtag_state_transitions[urj_jam_jtag_state].tms_low;
-            }
-
-            ++count;
-        }
+        /*
+         *      Take the shortest path to the desired state in one go
+         */
+        urj_jam_jtag_state = state;
     }
 
     if (urj_jam_jtag_state != state)
@@ -727,7 +630,6 @@ JAM_RETURN_TYPE urj_jam_do_wait_cycles
 /****************************************************************************/
 {
     int tms = 0;
-    int32_t count = 0L;
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
     if (urj_jam_jtag_state != wait_state)
@@ -743,9 +645,9 @@ JAM_RETURN_TYPE urj_jam_do_wait_cycles
          */
         tms = (wait_state == RESET) ? TMS_HIGH : TMS_LOW;
 
-        for (count = 0L; count < cycles; count++)
+        if (cycles > 0L && !urj_jam_jtag_idle (tms, cycles))
         {
-            urj_jam_jtag_io (tms, TDI_LOW, IGNORE_TDO);
+            status = JAMC_INTERNAL_ERROR;
         }
     }
 
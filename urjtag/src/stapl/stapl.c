@@ -31,6 +31,7 @@
 #include "jamutil.h"
 #include <urjtag/chain.h>
 #include <urjtag/cable.h>
+#include <urjtag/tap_state.h>
 
 /***********************************************************************
 *   Global variables
@@ -47,6 +48,8 @@ static int32_t file_length = 0L;
 int urj_jam_getc (void);
 int urj_jam_seek (int32_t offset);
 int urj_jam_jtag_io (int tms, int tdi, int read_tdo);
+int urj_jam_jtag_goto_state (int from_state, int to_state);
+int urj_jam_jtag_idle (int tms, int32_t cycles);
 int urj_jam_jtag_io_transfer (int count, char *tdi, char *tdo);
 void urj_jam_message (const char *message_text);
 void urj_jam_export_integer (const char *key, int32_t value);
@@ -100,6 +103,43 @@ urj_jam_jtag_io (int tms, int tdi, int read_tdo)
     return tdo;
 }
 
+// TAP state changes via UrJTAG: the shortest path, queued as one item
+int
+urj_jam_jtag_goto_state (int from_state, int to_state)
+{
+    /* in the order of JAME_JTAG_STATE */
+    static const int states[16] = {
+        URJ_TAP_STATE_TEST_LOGIC_RESET, URJ_TAP_STATE_RUN_TEST_IDLE,
+        URJ_TAP_STATE_SELECT_DR_SCAN, URJ_TAP_STATE_CAPTURE_DR,
+        URJ_TAP_STATE_SHIFT_DR, URJ_TAP_STATE_EXIT1_DR,
+        URJ_TAP_STATE_PAUSE_DR, URJ_TAP_STATE_EXIT2_DR,
+        URJ_TAP_STATE_UPDATE_DR, URJ_TAP_STATE_SELECT_IR_SCAN,
+        URJ_TAP_STATE_CAPTURE_IR, URJ_TAP_STATE_SHIFT_IR,
+        URJ_TAP_STATE_EXIT1_IR, URJ_TAP_STATE_PAUSE_IR,
+        URJ_TAP_STATE_EXIT2_IR, URJ_TAP_STATE_UPDATE_IR
+    };
+    unsigned int tms;
+    int len;
+
+    if (from_state < 0 || from_state >= 16 || to_state < 0 || to_state >= 16)
+        return 0;
+
+    len = urj_tap_state_path (states[from_state], states[to_state], &tms);
+    if (len < 0)
+        return 0;
+
+    return urj_tap_chain_defer_tms_path (current_chain, len, tms)
+        == URJ_STATUS_OK;
+}
+
+// Idle clocks via UrJTAG: one queue item, the cable driver clocks them in bulk
+int
+urj_jam_jtag_idle (int tms, int32_t cycles)
+{
+    return urj_tap_chain_defer_clock (current_chain, tms ? 0x01 : 0, 0,
+                                      cycles) == URJ_STATUS_OK;
+}
+
 // Vector-based JTAG communication via UrJTAG
 int
 urj_jam_jtag_io_transfer (int count, char *tdi, char *tdo)
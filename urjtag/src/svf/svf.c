@@ -90,6 +90,8 @@ urj_svf_force_reset_state (urj_chain_t *chain)
  * Moves from any TAP state to the specified state.
  * The state traversal is done according to the SVF specification.
  *   See STATE of the Serial Vector Format Specification
+ * The paths of the specification are the shortest ones, which are looked
+ * up in a table and queued to the cable as one item.
  *
  * Encoding of state is according to the jtag suite's defines.
  *
@@ -99,125 +101,18 @@ urj_svf_force_reset_state (urj_chain_t *chain)
 static void
 urj_svf_goto_state (urj_chain_t *chain, int new_state)
 {
-    int current_state;
-
-    current_state = urj_tap_state (chain);
-
     /* handle unknown state */
     if (new_state == URJ_TAP_STATE_UNKNOWN_STATE)
         new_state = URJ_TAP_STATE_TEST_LOGIC_RESET;
 
     /* abort if new_state already reached */
-    if (current_state == new_state)
+    if (urj_tap_state (chain) == new_state)
         return;
 
-    switch (current_state)
-    {
-    case URJ_TAP_STATE_TEST_LOGIC_RESET:
-        CHAIN_CLOCK (chain, 0, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_RUN_TEST_IDLE:
-        CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_SELECT_DR_SCAN:
-    case URJ_TAP_STATE_SELECT_IR_SCAN:
-        if (new_state == URJ_TAP_STATE_TEST_LOGIC_RESET ||
-            new_state == URJ_TAP_STATE_RUN_TEST_IDLE ||
-            (current_state & URJ_TAP_STATE_DR && new_state & URJ_TAP_STATE_IR)
-            || (current_state & URJ_TAP_STATE_IR
-                && new_state & URJ_TAP_STATE_DR))
-            /* progress in select-idle/reset loop */
-            CHAIN_CLOCK (chain, 1, 0, 1);
-        else
-            /* enter DR/IR branch */
-            CHAIN_CLOCK (chain, 0, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_CAPTURE_DR:
-        if (new_state == URJ_TAP_STATE_SHIFT_DR)
-            /* enter URJ_TAP_STATE_SHIFT_DR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
-        else
-            /* bypass URJ_TAP_STATE_SHIFT_DR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_CAPTURE_IR:
-        if (new_state == URJ_TAP_STATE_SHIFT_IR)
-            /* enter URJ_TAP_STATE_SHIFT_IR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
-        else
-            /* bypass URJ_TAP_STATE_SHIFT_IR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_SHIFT_DR:
-    case URJ_TAP_STATE_SHIFT_IR:
-        /* progress to URJ_TAP_STATE_EXIT1_DR/IR */
-        CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_EXIT1_DR:
-        if (new_state == URJ_TAP_STATE_PAUSE_DR)
-            /* enter URJ_TAP_STATE_PAUSE_DR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
-        else
-            /* bypass URJ_TAP_STATE_PAUSE_DR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_EXIT1_IR:
-        if (new_state == URJ_TAP_STATE_PAUSE_IR)
-            /* enter URJ_TAP_STATE_PAUSE_IR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
-        else
-            /* bypass URJ_TAP_STATE_PAUSE_IR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_PAUSE_DR:
-    case URJ_TAP_STATE_PAUSE_IR:
-        /* progress to URJ_TAP_STATE_EXIT2_DR/IR */
-        CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_EXIT2_DR:
-        if (new_state == URJ_TAP_STATE_SHIFT_DR)
-            /* enter URJ_TAP_STATE_SHIFT_DR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
-        else
-            /* progress to URJ_TAP_STATE_UPDATE_DR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_EXIT2_IR:
-        if (new_state == URJ_TAP_STATE_SHIFT_IR)
-            /* enter URJ_TAP_STATE_SHIFT_IR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
-        else
-            /* progress to URJ_TAP_STATE_UPDATE_IR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    case URJ_TAP_STATE_UPDATE_DR:
-    case URJ_TAP_STATE_UPDATE_IR:
-        if (new_state == URJ_TAP_STATE_RUN_TEST_IDLE)
-            /* enter URJ_TAP_STATE_RUN_TEST_IDLE */
-            CHAIN_CLOCK (chain, 0, 0, 1);
-        else
-            /* progress to Select_DR/IR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
-        break;
-
-    default:
+    if (urj_tap_state (chain) == URJ_TAP_STATE_UNKNOWN_STATE)
         urj_svf_force_reset_state (chain);
-        break;
-    }
 
-    /* continue state changes */
-    urj_svf_goto_state (chain, new_state);
+    urj_tap_chain_defer_goto_state (chain, new_state);
 }
 
 
@@ -448,6 +343,7 @@ urj_svf_compare_tdo (urj_svf_parser_priv_t *priv, char *tdo, char *mask,
                      urj_tap_register_t *reg, YYLTYPE *loc)
 {
     char *tdo_bit, *mask_bit;
+    const char *reg_bit;
     int pos, mismatch, result = URJ_STATUS_OK;
 
     if (!(tdo_bit = urj_svf_build_bit_string (tdo, reg->len)))
@@ -459,11 +355,11 @@ urj_svf_compare_tdo (urj_svf_parser_priv_t *priv, char *tdo, char *mask,
     }
 
     /* retrieve string representation */
-    urj_tap_register_get_string (reg);
+    reg_bit = urj_tap_register_get_string (reg);
 
     mismatch = -1;
     for (pos = 0; pos < reg->len; pos++)
-        if ((tdo_bit[pos] != reg->string[pos]) && (mask_bit[pos] == '1'))
+        if ((tdo_bit[pos] != reg_bit[pos]) && (mask_bit[pos] == '1'))
             mismatch = pos;
 
     if (mismatch >= 0)
@@ -481,7 +377,7 @@ urj_svf_compare_tdo (urj_svf_parser_priv_t *priv, char *tdo, char *mask,
 
         urj_log (URJ_LOG_LEVEL_DEBUG, "Expected : %s\n", tdo_bit);
         urj_log (URJ_LOG_LEVEL_DEBUG, "Mask     : %s\n", mask_bit);
-        urj_log (URJ_LOG_LEVEL_DEBUG, "TDO data : %s\n", reg->string);
+        urj_log (URJ_LOG_LEVEL_DEBUG, "TDO data : %s\n", reg_bit);
 
         if (priv->svf_stop_on_mismatch)
             result = URJ_STATUS_FAIL;
@@ -42,8 +42,15 @@
 #include <urjtag/chain.h>
 #include <urjtag/tap.h>
 #include <urjtag/cable.h>
+#include <urjtag/fclock.h>
 
 #include "cable.h"
+#include "cable/generic.h"
+
+/* initial size of a cable's transfer arena; it doubles whenever it fills */
+#define URJ_TAP_CABLE_ARENA_CHUNK_SIZE  4096
+/* initial size of the todo and done queues; they double whenever they fill */
+#define URJ_TAP_CABLE_QUEUE_MIN_ITEMS   128
 
 const urj_cable_driver_t * const urj_tap_cable_drivers[] = {
 #define _URJ_CABLE(cable) &urj_tap_cable_##cable##_driver,
@@ -75,20 +82,31 @@ urj_tap_cable_init (urj_cable_t *cable)
     cable->delay = 0;
     cable->frequency = 0;
 
-    cable->todo.max_items = 128;
+    cable->todo.max_items = URJ_TAP_CABLE_QUEUE_MIN_ITEMS;
     cable->todo.num_items = 0;
     cable->todo.next_item = 0;
     cable->todo.next_free = 0;
+    cable->todo.high_water = 0;
+    cable->todo.resizes = 0;
     cable->todo.data =
         malloc (cable->todo.max_items * sizeof (urj_cable_queue_t));
 
-    cable->done.max_items = 128;
+    cable->done.max_items = URJ_TAP_CABLE_QUEUE_MIN_ITEMS;
     cable->done.num_items = 0;
     cable->done.next_item = 0;
     cable->done.next_free = 0;
+    cable->done.high_water = 0;
+    cable->done.resizes = 0;
     cable->done.data =
         malloc (cable->done.max_items * sizeof (urj_cable_queue_t));
 
+    cable->arena = NULL;
+    cable->scratch = NULL;
+    cable->scratch_size = 0;
+    cable->io_thread = NULL;
+    cable->prefix_len = 0;
+    memset (&cable->stats, 0, sizeof cable->stats);
+
     if (cable->todo.data == NULL || cable->done.data == NULL)
     {
         urj_error_set (URJ_ERROR_OUT_OF_MEMORY,
@@ -105,129 +123,426 @@ urj_tap_cable_init (urj_cable_t *cable)
     return cable->driver->init (cable);
 }
 
+static void urj_tap_cable_commit_prefix (urj_cable_t *cable);
+
+static void
+urj_tap_cable_count_latency (urj_cable_t *cable, long double seconds)
+{
+    long double us = seconds * 1e6;
+    int i = 0;
+
+    while (i < URJ_CABLE_STATS_LATENCY_BUCKETS - 1 && us >= (1UL << i))
+        i++;
+    cable->stats.latency[i]++;
+}
+
+/* The clocks with TMS = 0 of a TMS sequence shift bits */
+static void
+urj_tap_cable_count_sequence (urj_cable_t *cable, int len, const char *seq)
+{
+    int i;
+
+    cable->stats.clocks += len;
+    for (i = 0; i < len; i++)
+        if (!(seq[i] & URJ_CABLE_SEQ_TMS))
+            cable->stats.bits++;
+}
+
 void
 urj_tap_cable_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
 {
-    cable->driver->flush (cable, how_much);
+    long double start = 0;
+
+#ifdef ENABLE_IO_THREAD
+    /* the driver may call back into the cable API from the I/O thread */
+    if (cable->io_thread != NULL && urj_tap_cable_thread_is_self (cable))
+    {
+        cable->driver->flush (cable, how_much);
+        return;
+    }
+#endif
+    urj_tap_cable_commit_prefix (cable);
+
+    cable->stats.flushes[how_much]++;
+    if (how_much != URJ_TAP_CABLE_OPTIONALLY)
+        start = urj_lib_frealtime ();
+
+#ifdef ENABLE_IO_THREAD
+    if (cable->io_thread != NULL)
+        urj_tap_cable_thread_flush (cable, how_much);
+    else
+#endif
+        cable->driver->flush (cable, how_much);
+
+    if (how_much != URJ_TAP_CABLE_OPTIONALLY)
+        urj_tap_cable_count_latency (cable, urj_lib_frealtime () - start);
+}
+
+/* Get a slot for a new item in the todo queue, or in the ring that feeds
+ * it when the I/O thread is running. The item is passed on to the driver
+ * by urj_tap_cable_defer_commit(). */
+static urj_cable_queue_t *
+urj_tap_cable_defer_item (urj_cable_t *cable)
+{
+    int i;
+
+    urj_tap_cable_commit_prefix (cable);
+
+    cable->stats.items++;
+
+#ifdef ENABLE_IO_THREAD
+    if (cable->io_thread != NULL)
+        return urj_tap_cable_thread_slot (cable);
+#endif
+
+    i = urj_tap_cable_add_queue_item (cable, &cable->todo);
+    if (i < 0)
+        return NULL;
+
+    return &cable->todo.data[i];
+}
+
+static void
+urj_tap_cable_defer_commit (urj_cable_t *cable)
+{
+#ifdef ENABLE_IO_THREAD
+    if (cable->io_thread != NULL)
+        urj_tap_cable_thread_commit (cable);
+#endif
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+}
+
+static char *urj_tap_cable_arena_take (urj_cable_t *cable, int len);
+
+/* Queue the clocks held back by urj_tap_cable_defer_tms_prefix() on their
+ * own, because something else comes first */
+static void
+urj_tap_cable_commit_prefix (urj_cable_t *cable)
+{
+    char prefix[URJ_CABLE_SEQ_PREFIX_MAX];
+    int len = cable->prefix_len;
+    int i, n;
+
+    if (len == 0)
+        return;
+
+    memcpy (prefix, cable->prefix, len);
+    cable->prefix_len = 0;
+
+    if (!(cable->driver->quirks & URJ_CABLE_QUIRK_NO_TMS_SEQUENCE))
+    {
+        /* no rewind: the caller may just have taken its buffer from the
+         * arena */
+        char *seq = urj_tap_cable_arena_take (cable, len);
+
+        if (seq != NULL)
+        {
+            memcpy (seq, prefix, len);
+            urj_tap_cable_defer_tms_sequence (cable, len, seq, NULL);
+            return;
+        }
+    }
+
+    for (i = 0; i < len; i += n)
+    {
+        for (n = 1; i + n < len && prefix[i + n] == prefix[i]; n++)
+            ;
+        urj_tap_cable_defer_clock (cable,
+                                   (prefix[i] & URJ_CABLE_SEQ_TMS) ? 1 : 0,
+                                   (prefix[i] & URJ_CABLE_SEQ_TDI) ? 1 : 0,
+                                   n);
+    }
+}
+
+/* Nothing queued (or in flight on the I/O thread) at all? */
+static int
+urj_tap_cable_queues_empty (urj_cable_t *cable)
+{
+#ifdef ENABLE_IO_THREAD
+    if (cable->io_thread != NULL && !urj_tap_cable_thread_idle (cable))
+        return 0;
+#endif
+    return cable->todo.num_items == 0 && cable->done.num_items == 0;
+}
+
+static void
+urj_tap_cable_arena_free (urj_cable_t *cable)
+{
+    while (cable->arena != NULL)
+    {
+        urj_cable_arena_chunk_t *next = cable->arena->next;
+
+        free (cable->arena->data);
+        free (cable->arena);
+        cable->arena = next;
+    }
+}
+
+static urj_cable_arena_chunk_t *
+urj_tap_cable_arena_add_chunk (urj_cable_t *cable, size_t size)
+{
+    urj_cable_arena_chunk_t *c;
+
+    c = malloc (sizeof (urj_cable_arena_chunk_t));
+    if (c == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                       sizeof (urj_cable_arena_chunk_t));
+        return NULL;
+    }
+    c->data = malloc (size);
+    if (c->data == NULL)
+    {
+        free (c);
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails", size);
+        return NULL;
+    }
+    c->size = size;
+    c->used = 0;
+    c->next = cable->arena;
+    cable->arena = c;
+
+    return c;
+}
+
+/* Nothing in the queues refers to arena memory any more: start over with
+ * a single chunk that is large enough for what the previous cycle used.
+ * The chunks appended during that cycle are freed, and so is a chunk that
+ * is far larger than needed, so that one long burst does not pin its
+ * memory for good. */
+static void
+urj_tap_cable_arena_rewind (urj_cable_t *cable)
+{
+    size_t used = 0, size = URJ_TAP_CABLE_ARENA_CHUNK_SIZE;
+    urj_cable_arena_chunk_t *c;
+
+    if (cable->arena == NULL)
+        return;
+
+    for (c = cable->arena; c != NULL; c = c->next)
+        used += c->used;
+    while (size < used)
+        size *= 2;
+
+    if (cable->arena->next == NULL && cable->arena->size >= size
+        && cable->arena->size <= 4 * size)
+    {
+        cable->arena->used = 0;
+        return;
+    }
+
+    urj_tap_cable_arena_free (cable);
+    /* if this fails, the next allocation simply starts a new chunk */
+    urj_tap_cable_arena_add_chunk (cable, size);
+}
+
+static char *
+urj_tap_cable_arena_take (urj_cable_t *cable, int len)
+{
+    urj_cable_arena_chunk_t *c = cable->arena;
+    char *p;
+
+    if (c == NULL || c->size - c->used < (size_t) len)
+    {
+        size_t size = URJ_TAP_CABLE_ARENA_CHUNK_SIZE;
+
+        if (c != NULL && size < 2 * c->size)
+            size = 2 * c->size;
+        if (size < (size_t) len)
+            size = len;
+
+        c = urj_tap_cable_arena_add_chunk (cable, size);
+        if (c == NULL)
+            return NULL;
+    }
+
+    p = c->data + c->used;
+    c->used += len;
+
+    return p;
+}
+
+char *
+urj_tap_cable_arena_alloc (urj_cable_t *cable, int len)
+{
+    /* clocks held back by urj_tap_cable_defer_tms_prefix() are kept in the
+     * cable, not in the arena */
+    if (urj_tap_cable_queues_empty (cable))
+        urj_tap_cable_arena_rewind (cable);
+
+    return urj_tap_cable_arena_take (cable, len);
+}
+
+char *
+urj_tap_cable_scratch (urj_cable_t *cable, size_t len)
+{
+    if (cable->scratch_size < len)
+    {
+        char *p = realloc (cable->scratch, len);
+
+        if (p == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%s,%zd) fails",
+                           "cable->scratch", len);
+            return NULL;
+        }
+        cable->scratch = p;
+        cable->scratch_size = len;
+    }
+
+    return cable->scratch;
 }
 
 void
 urj_tap_cable_done (urj_cable_t *cable)
 {
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+#ifdef ENABLE_IO_THREAD
+    urj_tap_cable_thread_stop (cable);
+#endif
+    urj_log (URJ_LOG_LEVEL_DETAIL,
+             _("JTAG activity queues: todo used %d of %d items (%d resizes), "
+               "done used %d of %d items (%d resizes)\n"),
+             cable->todo.high_water, cable->todo.max_items,
+             cable->todo.resizes, cable->done.high_water,
+             cable->done.max_items, cable->done.resizes);
     if (cable->todo.data != NULL)
     {
         free (cable->todo.data);
         free (cable->done.data);
     }
+    urj_tap_cable_arena_free (cable);
+    free (cable->scratch);
+    cable->scratch = NULL;
+    cable->scratch_size = 0;
     cable->driver->done (cable);
 }
 
-int
-urj_tap_cable_add_queue_item (urj_cable_t *cable, urj_cable_queue_info_t *q)
+/* Grow the ring buffer of @q to hold @new_max_items. If the queued items
+ * wrap around the end of the old array, resizing introduces a gap between
+ * old and new max, which has to be closed; either by moving the items from
+ * next_item .. max_items to the end of the new array, or the ones from
+ * 0 .. next_free into the gap (whatever is smaller and fits). */
+static int
+urj_tap_cable_resize_queue (urj_cable_queue_info_t *q, int new_max_items)
 {
-    int i, j;
-    if (q->num_items >= q->max_items)   /* queue full? */
+    urj_cable_queue_t *resized;
+
+    urj_log (URJ_LOG_LEVEL_DETAIL,
+        "Queue %p needs resizing; n(%d), max(%d); free=%d, next=%d\n",
+         q, q->num_items, q->max_items, q->next_free, q->next_item);
+
+    resized = realloc (q->data, new_max_items * sizeof (urj_cable_queue_t));
+    if (resized == NULL)
     {
-        int new_max_items;
-        urj_cable_queue_t *resized;
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%s,%zd) fails",
+                       "q->data",
+                       new_max_items * sizeof (urj_cable_queue_t));
+        return URJ_STATUS_FAIL;
+    }
+    urj_log (URJ_LOG_LEVEL_DETAIL,
+             _("(Resized JTAG activity queue to hold max %d items)\n"),
+             new_max_items);
+    q->data = resized;
 
-        urj_log (URJ_LOG_LEVEL_DETAIL,
-            "Queue %p needs resizing; n(%d) >= max(%d); free=%d, next=%d\n",
-             q, q->num_items, q->max_items, q->next_free, q->next_item);
+    if (q->num_items > 0 && q->next_item + q->num_items > q->max_items)
+    {
+        int added_space = new_max_items - q->max_items;
+        int num_at_end = q->max_items - q->next_item;
+        int num_at_start = q->num_items - num_at_end;
 
-        new_max_items = q->max_items + 128;
-        resized = realloc (q->data, new_max_items * sizeof (urj_cable_queue_t));
-        if (resized == NULL)
+        if (num_at_start < num_at_end && num_at_start <= added_space)
         {
-            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%s,%zd) fails",
-                           "q->data",
-                           new_max_items * sizeof (urj_cable_queue_t));
-            return -1;          /* report failure */
+            /* Relocate queue items at beginning of old array
+             * to end of old items: 561234__ -> __123456 */
+
+            urj_log (URJ_LOG_LEVEL_DETAIL,
+                     "Resize: Move %d items from start to end\n",
+                     num_at_start);
+            memcpy (&q->data[q->max_items], &q->data[0],
+                    num_at_start * sizeof (urj_cable_queue_t));
         }
-        urj_log (URJ_LOG_LEVEL_DETAIL,
-                 _("(Resized JTAG activity queue to hold max %d items)\n"),
-                 new_max_items);
-        q->data = resized;
-
-        /* The queue was full. Except for the special case when next_item is 0,
-         * resizing just introduced a gap between old and new max, which has to
-         * be filled; either by moving data from next_item .. max_items, or
-         * from 0 .. next_free (whatever is smaller). */
+        else
+        {
+            /* Move queue items at end of old array
+             * towards end of new array: 345612__ -> 3456__12 */
 
-#define CHOOSE_SMALLEST_AREA_TO_MOVE 1
+            int dest = new_max_items - num_at_end;
+            urj_log (URJ_LOG_LEVEL_DETAIL,
+                "Resize: Move %d items towards end of queue memory (%d > %d)\n",
+                num_at_end, q->next_item, dest);
+            memmove (&q->data[dest], &q->data[q->next_item],
+                     num_at_end * sizeof (urj_cable_queue_t));
 
-        if (q->next_item != 0)
-        {
-            int added_space = new_max_items - q->max_items;
-            int num_to_move = q->max_items - q->next_item;
-
-#ifdef CHOOSE_SMALLEST_AREA_TO_MOVE
-            if (num_to_move <= q->next_free)
-#endif /* def CHOOSE_SMALLEST_AREA_TO_MOVE */
-            {
-                /* Move queue items at end of old array
-                 * towards end of new array: 345612__ -> 3456__12 */
-
-                int dest = new_max_items - num_to_move;
-                urj_log (URJ_LOG_LEVEL_DETAIL,
-                    "Resize: Move %d items towards end of queue memory (%d > %d)\n",
-                    num_to_move, q->next_item, dest);
-                memmove (&q->data[dest], &q->data[q->next_item],
-                         num_to_move * sizeof (urj_cable_queue_t));
-
-                q->next_item = dest;
-            }
-#ifdef CHOOSE_SMALLEST_AREA_TO_MOVE
-            else
-            {
-                if (q->next_free <= added_space)
-                {
-                    /* Relocate queue items at beginning of old array
-                     * to end of new array: 561234__ -> __123456 */
-
-                    urj_log (URJ_LOG_LEVEL_DETAIL,
-                             "Resize: Move %d items from start to end\n",
-                             q->next_free);
-                    memcpy (&q->data[q->max_items], &q->data[0],
-                            q->next_free * sizeof (urj_cable_queue_t));
-
-                }
-                else
-                {
-                    /* Same as above, but for the case if new space
-                     * isn't large enough to hold all relocated items */
-
-                    /* Step 1: 456123__ -> __612345 */
-
-                    urj_log (URJ_LOG_LEVEL_DETAIL,
-                             "Resize.A: Move %d items from start to end\n",
-                            added_space);
-
-                    memcpy (&q->data[q->max_items], &q->data[0],
-                            added_space * sizeof (urj_cable_queue_t));
-
-                    /* Step 2: __612345 -> 6__12345 */
-
-                    urj_log (URJ_LOG_LEVEL_DETAIL,
-                         "Resize.B: Move %d items towards start (offset %d)\n",
-                         (q->next_free - added_space), added_space);
-
-                    memmove (&q->data[0], &q->data[added_space],
-                             (q->next_free -
-                              added_space) * sizeof (urj_cable_queue_t));
-                }
-            }
-#endif /* def CHOOSE_SMALLEST_AREA_TO_MOVE */
+            q->next_item = dest;
         }
-        q->max_items = new_max_items;
-        q->next_free = q->next_item + q->num_items;
-        if (q->next_free >= new_max_items)
-            q->next_free -= new_max_items;
+    }
+
+    q->max_items = new_max_items;
+    q->next_free = q->next_item + q->num_items;
+    if (q->next_free >= new_max_items)
+        q->next_free -= new_max_items;
+    q->resizes++;
+
+    urj_log (URJ_LOG_LEVEL_DETAIL,
+         "Queue %p after resizing; n(%d), max(%d); free=%d, next=%d\n",
+         q, q->num_items, q->max_items, q->next_free, q->next_item);
 
-        urj_log (URJ_LOG_LEVEL_DETAIL,
-             "Queue %p after resizing; n(%d) >= max(%d); free=%d, next=%d\n",
-             q, q->num_items, q->max_items, q->next_free, q->next_item);
+    return URJ_STATUS_OK;
+}
+
+/* Make room for at least @num_items more items in @q. The queue doubles
+ * in size, so that filling it up costs amortized constant time per item.
+ * One slot always stays free: the flush loops of the cable drivers walk
+ * the ring from next_item until they get back to where they stopped, and
+ * in a full ring that is where they started. */
+static int
+urj_tap_cable_grow_queue (urj_cable_queue_info_t *q, int num_items)
+{
+    int new_max_items = q->max_items;
+
+    if (q->num_items + num_items < q->max_items)
+        return URJ_STATUS_OK;
+
+    if (new_max_items < URJ_TAP_CABLE_QUEUE_MIN_ITEMS)
+        new_max_items = URJ_TAP_CABLE_QUEUE_MIN_ITEMS;
+    while (new_max_items <= q->num_items + num_items)
+        new_max_items *= 2;
+
+    return urj_tap_cable_resize_queue (q, new_max_items);
+}
+
+int
+urj_tap_cable_reserve_queue (urj_cable_t *cable, int num_items)
+{
+    if (num_items < 0)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "num_items %d < 0", num_items);
+        return URJ_STATUS_FAIL;
+    }
+
+#ifdef ENABLE_IO_THREAD
+    /* the queues belong to the I/O thread, which grows them as needed */
+    if (cable->io_thread != NULL)
+        return URJ_STATUS_OK;
+#endif
+
+    /* every queued item produces at most one result */
+    if (urj_tap_cable_grow_queue (&cable->todo, num_items) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    return urj_tap_cable_grow_queue (&cable->done,
+                                     cable->todo.num_items + num_items);
+}
+
+int
+urj_tap_cable_add_queue_item (urj_cable_t *cable, urj_cable_queue_info_t *q)
+{
+    int i, j;
+
+    if (q->num_items + 1 >= q->max_items)       /* queue full? */
+    {
+        if (urj_tap_cable_grow_queue (q, 1) != URJ_STATUS_OK)
+            return -1;          /* report failure */
     }
 
     i = q->next_free;
@@ -236,6 +551,8 @@ urj_tap_cable_add_queue_item (urj_cable_t *cable, urj_cable_queue_info_t *q)
         j = 0;
     q->next_free = j;
     q->num_items++;
+    if (q->num_items > q->high_water)
+        q->high_water = q->num_items;
 
     // urj_log (URJ_LOG_LEVEL_DEBUG, "add_queue_item to %p: %d\n", q, i);
     return i;
@@ -264,31 +581,8 @@ urj_tap_cable_get_queue_item (urj_cable_t *cable, urj_cable_queue_info_t *q)
 void
 urj_tap_cable_purge_queue (urj_cable_queue_info_t *q, int io)
 {
-    while (q->num_items > 0)
-    {
-        int i = q->next_item;
-        if (q->data[i].action == URJ_TAP_CABLE_TRANSFER)
-        {
-            if (io == 0)        /* todo queue */
-            {
-                if (q->data[i].arg.transfer.in != NULL)
-                    free (q->data[i].arg.transfer.in);
-                if (q->data[i].arg.transfer.out != NULL)
-                    free (q->data[i].arg.transfer.out);
-            }
-            else                /* done queue */
-            {
-                if (q->data[i].arg.xferred.out != NULL)
-                    free (q->data[i].arg.xferred.out);
-            }
-        }
-
-        i++;
-        if (i >= q->max_items)
-            i = 0;
-        q->num_items--;
-    }
-
+    /* Transfer payloads belong to the cable's arena or to the caller,
+     * so there is nothing to free here, whichever queue this is */
     q->num_items = 0;
     q->next_item = 0;
     q->next_free = 0;
@@ -298,20 +592,22 @@ void
 urj_tap_cable_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+    cable->stats.clocks += n;
     cable->driver->clock (cable, tms, tdi, n);
 }
 
 int
 urj_tap_cable_defer_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
-    int i = urj_tap_cable_add_queue_item (cable, &cable->todo);
-    if (i < 0)
+    urj_cable_queue_t *item = urj_tap_cable_defer_item (cable);
+    if (item == NULL)
         return URJ_STATUS_FAIL;               /* report failure */
-    cable->todo.data[i].action = URJ_TAP_CABLE_CLOCK;
-    cable->todo.data[i].arg.clock.tms = tms;
-    cable->todo.data[i].arg.clock.tdi = tdi;
-    cable->todo.data[i].arg.clock.n = n;
-    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+    item->action = URJ_TAP_CABLE_CLOCK;
+    item->arg.clock.tms = tms;
+    item->arg.clock.tdi = tdi;
+    item->arg.clock.n = n;
+    cable->stats.clocks += n;
+    urj_tap_cable_defer_commit (cable);
     return URJ_STATUS_OK;                   /* success */
 }
 
@@ -348,11 +644,11 @@ urj_tap_cable_get_tdo_late (urj_cable_t *cable)
 int
 urj_tap_cable_defer_get_tdo (urj_cable_t *cable)
 {
-    int i = urj_tap_cable_add_queue_item (cable, &cable->todo);
-    if (i < 0)
+    urj_cable_queue_t *item = urj_tap_cable_defer_item (cable);
+    if (item == NULL)
         return URJ_STATUS_FAIL;               /* report failure */
-    cable->todo.data[i].action = URJ_TAP_CABLE_GET_TDO;
-    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+    item->action = URJ_TAP_CABLE_GET_TDO;
+    urj_tap_cable_defer_commit (cable);
     return URJ_STATUS_OK;                   /* success */
 }
 
@@ -366,13 +662,13 @@ urj_tap_cable_set_signal (urj_cable_t *cable, int mask, int val)
 int
 urj_tap_cable_defer_set_signal (urj_cable_t *cable, int mask, int val)
 {
-    int i = urj_tap_cable_add_queue_item (cable, &cable->todo);
-    if (i < 0)
+    urj_cable_queue_t *item = urj_tap_cable_defer_item (cable);
+    if (item == NULL)
         return URJ_STATUS_FAIL;               /* report failure */
-    cable->todo.data[i].action = URJ_TAP_CABLE_SET_SIGNAL;
-    cable->todo.data[i].arg.value.mask = mask;
-    cable->todo.data[i].arg.value.val = val;
-    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+    item->action = URJ_TAP_CABLE_SET_SIGNAL;
+    item->arg.value.mask = mask;
+    item->arg.value.val = val;
+    urj_tap_cable_defer_commit (cable);
     return URJ_STATUS_OK;                   /* success */
 }
 
@@ -416,12 +712,12 @@ urj_tap_cable_get_signal_late (urj_cable_t *cable, urj_pod_sigsel_t sig)
 int
 urj_tap_cable_defer_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig)
 {
-    int i = urj_tap_cable_add_queue_item (cable, &cable->todo);
-    if (i < 0)
+    urj_cable_queue_t *item = urj_tap_cable_defer_item (cable);
+    if (item == NULL)
         return URJ_STATUS_FAIL;               /* report failure */
-    cable->todo.data[i].action = URJ_TAP_CABLE_GET_SIGNAL;
-    cable->todo.data[i].arg.value.sig = sig;
-    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+    item->action = URJ_TAP_CABLE_GET_SIGNAL;
+    item->arg.value.sig = sig;
+    urj_tap_cable_defer_commit (cable);
     return URJ_STATUS_OK;                   /* success */
 }
 
@@ -429,6 +725,8 @@ int
 urj_tap_cable_transfer (urj_cable_t *cable, int len, char *in, char *out)
 {
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+    cable->stats.clocks += len;
+    cable->stats.bits += len;
     return cable->driver->transfer (cable, len, in, out);
 }
 
@@ -447,11 +745,10 @@ urj_tap_cable_transfer_late (urj_cable_t *cable, char *out)
                 cable->done.data[i].arg.xferred.len,
                 cable->done.data[i].arg.xferred.out);
 #endif
-        if (out)
+        if (out && out != cable->done.data[i].arg.xferred.out)
             memcpy (out,
                     cable->done.data[i].arg.xferred.out,
                     cable->done.data[i].arg.xferred.len);
-        free (cable->done.data[i].arg.xferred.out);
         return cable->done.data[i].arg.xferred.res;
     }
 
@@ -470,50 +767,190 @@ urj_tap_cable_transfer_late (urj_cable_t *cable, char *out)
     return 0;
 }
 
+int
+urj_tap_cable_defer_transfer_nocopy (urj_cable_t *cable, int len, char *in,
+                                     char *out)
+{
+    urj_cable_queue_t *item = urj_tap_cable_defer_item (cable);
+    if (item == NULL)
+        return URJ_STATUS_FAIL;               /* report failure */
+    item->action = URJ_TAP_CABLE_TRANSFER;
+    item->arg.transfer.len = len;
+    item->arg.transfer.in = in;
+    item->arg.transfer.out = out;
+    cable->stats.clocks += len;
+    cable->stats.bits += len;
+    urj_tap_cable_defer_commit (cable);
+    return URJ_STATUS_OK;                   /* success */
+}
+
 int
 urj_tap_cable_defer_transfer (urj_cable_t *cable, int len, char *in,
                               char *out)
 {
     char *ibuf, *obuf = NULL;
-    int i;
 
-    ibuf = malloc (len);
+    /* one allocation for both, see urj_tap_cable_arena_alloc() */
+    ibuf = urj_tap_cable_arena_alloc (cable, out ? 2 * len : len);
     if (ibuf == NULL)
+        return URJ_STATUS_FAIL;
+    if (out)
+        obuf = ibuf + len;
+
+    if (in)
+        memcpy (ibuf, in, len);
+
+    return urj_tap_cable_defer_transfer_nocopy (cable, len, ibuf, obuf);
+}
+
+int
+urj_tap_cable_tms_sequence (urj_cable_t *cable, int len, const char *seq,
+                            char *out)
+{
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+    urj_tap_cable_count_sequence (cable, len, seq);
+    if (cable->driver->tms_sequence != NULL)
+        return cable->driver->tms_sequence (cable, len, seq, out);
+    return urj_tap_cable_generic_tms_sequence (cable, len, seq, out);
+}
+
+int
+urj_tap_cable_tms_sequence_late (urj_cable_t *cable, char *out)
+{
+    int i;
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_TO_OUTPUT);
+    i = urj_tap_cable_get_queue_item (cable, &cable->done);
+
+    if (i < 0)
     {
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-                       (size_t) len);
+        urj_warning (
+             _("Internal error: Wanted sequence result but none was queued\n"));
+        return -1;
+    }
+
+    if (cable->done.data[i].action != URJ_TAP_CABLE_TMS_SEQUENCE)
+    {
+        urj_warning (
+             _("Internal error: Got wrong type of result from queue (#%d %p.%d)\n"),
+             cable->done.data[i].action, &cable->done, i);
+        urj_tap_cable_purge_queue (&cable->done, 1);
+        return -1;
+    }
+
+    if (out && out != cable->done.data[i].arg.xferred.out)
+        memcpy (out,
+                cable->done.data[i].arg.xferred.out,
+                cable->done.data[i].arg.xferred.len);
+    return cable->done.data[i].arg.xferred.res;
+}
+
+int
+urj_tap_cable_defer_tms_sequence (urj_cable_t *cable, int len, char *seq,
+                                  char *out)
+{
+    urj_cable_queue_t *item;
+
+    if (cable->driver->quirks & URJ_CABLE_QUIRK_NO_TMS_SEQUENCE)
+    {
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("cable '%s' does not support TMS sequences"),
+                       cable->driver->name);
         return URJ_STATUS_FAIL;
     }
 
-    if (out)
+    if (cable->prefix_len > 0)
     {
-        obuf = malloc (len);
-        if (obuf == NULL)
-        {
-            free (ibuf);
-            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-                           (size_t) len);
+        /* the held back clocks become the start of this sequence; no
+         * rewind, @seq itself may have just been taken from the arena */
+        char *buf = urj_tap_cable_arena_take (cable, cable->prefix_len + len);
+        if (buf == NULL)
             return URJ_STATUS_FAIL;
-        }
+        memcpy (buf, cable->prefix, cable->prefix_len);
+        memcpy (buf + cable->prefix_len, seq, len);
+        len += cable->prefix_len;
+        seq = buf;
+        cable->prefix_len = 0;
     }
 
-    i = urj_tap_cable_add_queue_item (cable, &cable->todo);
-    if (i < 0)
-    {
-        free (ibuf);
-        if (obuf)
-            free (obuf);
+    item = urj_tap_cable_defer_item (cable);
+    if (item == NULL)
         return URJ_STATUS_FAIL;               /* report failure */
+    item->action = URJ_TAP_CABLE_TMS_SEQUENCE;
+    item->arg.sequence.len = len;
+    item->arg.sequence.seq = seq;
+    item->arg.sequence.out = out;
+    urj_tap_cable_count_sequence (cable, len, seq);
+    urj_tap_cable_defer_commit (cable);
+    return URJ_STATUS_OK;                   /* success */
+}
+
+int
+urj_tap_cable_defer_tms_prefix (urj_cable_t *cable, int len, const char *seq)
+{
+    int i;
+
+    if (cable->prefix_len + len > URJ_CABLE_SEQ_PREFIX_MAX)
+        urj_tap_cable_commit_prefix (cable);
+    if (len > URJ_CABLE_SEQ_PREFIX_MAX)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
+                       _("TMS prefix of %d clocks is too long"), len);
+        return URJ_STATUS_FAIL;
     }
 
-    cable->todo.data[i].action = URJ_TAP_CABLE_TRANSFER;
-    cable->todo.data[i].arg.transfer.len = len;
-    if (in)
-        memcpy (ibuf, in, len);
-    cable->todo.data[i].arg.transfer.in = ibuf;
-    cable->todo.data[i].arg.transfer.out = obuf;
-    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
-    return URJ_STATUS_OK;                   /* success */
+    for (i = 0; i < len; i++)
+        cable->prefix[cable->prefix_len++] = seq[i] & ~URJ_CABLE_SEQ_CAPTURE;
+
+    /* nothing to merge them into */
+    if (cable->driver->quirks & URJ_CABLE_QUIRK_NO_TMS_SEQUENCE)
+        urj_tap_cable_commit_prefix (cable);
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_tap_cable_set_io_thread (urj_cable_t *cable, int enable)
+{
+#ifdef ENABLE_IO_THREAD
+    if (enable)
+        return urj_tap_cable_thread_start (cable);
+
+    urj_tap_cable_thread_stop (cable);
+    return URJ_STATUS_OK;
+#else
+    if (!enable)
+        return URJ_STATUS_OK;
+
+    urj_error_set (URJ_ERROR_UNSUPPORTED,
+                   _("this build does not support the cable I/O thread"));
+    return URJ_STATUS_FAIL;
+#endif
+}
+
+void
+urj_tap_cable_get_stats (urj_cable_t *cable, urj_cable_stats_t *stats)
+{
+    urj_cable_arena_chunk_t *c;
+
+#ifdef ENABLE_IO_THREAD
+    /* the I/O thread counts the transactions */
+    if (cable->io_thread != NULL)
+        urj_tap_cable_thread_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+#endif
+    *stats = cable->stats;
+    stats->arena_bytes = 0;
+    for (c = cable->arena; c != NULL; c = c->next)
+        stats->arena_bytes += c->size;
+}
+
+void
+urj_tap_cable_reset_stats (urj_cable_t *cable)
+{
+#ifdef ENABLE_IO_THREAD
+    if (cable->io_thread != NULL)
+        urj_tap_cable_thread_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+#endif
+    memset (&cable->stats, 0, sizeof cable->stats);
 }
 
 void
@@ -683,6 +1120,22 @@ static const urj_param_descr_t cable_param[] =
     { URJ_CABLE_PARAM_KEY_INTERFACE,    URJ_PARAM_TYPE_LU,      "interface", },
     { URJ_CABLE_PARAM_KEY_FIRMWARE,     URJ_PARAM_TYPE_STRING,  "firmware", },
     { URJ_CABLE_PARAM_KEY_INDEX,        URJ_PARAM_TYPE_LU,      "index", },
+    { URJ_CABLE_PARAM_KEY_IOTHREAD,     URJ_PARAM_TYPE_BOOL,    "iothread", },
+    { URJ_CABLE_PARAM_KEY_PROFILE,      URJ_PARAM_TYPE_STRING,  "profile", },
+    { URJ_CABLE_PARAM_KEY_LATENCY,      URJ_PARAM_TYPE_LU,      "latency", },
+    { URJ_CABLE_PARAM_KEY_BANDWIDTH,    URJ_PARAM_TYPE_LU,      "bandwidth", },
+    { URJ_CABLE_PARAM_KEY_PACKET,       URJ_PARAM_TYPE_LU,      "packet", },
+    { URJ_CABLE_PARAM_KEY_TARGET,       URJ_PARAM_TYPE_STRING,  "target", },
+    { URJ_CABLE_PARAM_KEY_RECORD,       URJ_PARAM_TYPE_STRING,  "record", },
+    { URJ_CABLE_PARAM_KEY_REPLAY,       URJ_PARAM_TYPE_STRING,  "replay", },
+    { URJ_CABLE_PARAM_KEY_CHIP,         URJ_PARAM_TYPE_STRING,  "chip", },
+    { URJ_CABLE_PARAM_KEY_MEM,          URJ_PARAM_TYPE_STRING,  "mem", },
+    { URJ_CABLE_PARAM_KEY_BASE,         URJ_PARAM_TYPE_LU,      "base", },
+    { URJ_CABLE_PARAM_KEY_OUTREG,       URJ_PARAM_TYPE_LU,      "outreg", },
+    { URJ_CABLE_PARAM_KEY_INREG,        URJ_PARAM_TYPE_LU,      "inreg", },
+    { URJ_CABLE_PARAM_KEY_DIRREG,       URJ_PARAM_TYPE_LU,      "dirreg", },
+    { URJ_CABLE_PARAM_KEY_HOST,         URJ_PARAM_TYPE_STRING,  "host", },
+    { URJ_CABLE_PARAM_KEY_PORT,         URJ_PARAM_TYPE_LU,      "port", },
 };
 
 const urj_param_list_t urj_cable_param_list =
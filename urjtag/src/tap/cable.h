@@ -28,4 +28,16 @@
 #define _URJ_CABLE(cable) extern const urj_cable_driver_t urj_tap_cable_##cable##_driver;
 #include "cable_list.h"
 
+#ifdef ENABLE_IO_THREAD
+/* background I/O thread, see cable_thread.c */
+int urj_tap_cable_thread_start (urj_cable_t *cable);
+void urj_tap_cable_thread_stop (urj_cable_t *cable);
+int urj_tap_cable_thread_is_self (urj_cable_t *cable);
+int urj_tap_cable_thread_idle (urj_cable_t *cable);
+urj_cable_queue_t *urj_tap_cable_thread_slot (urj_cable_t *cable);
+void urj_tap_cable_thread_commit (urj_cable_t *cable);
+void urj_tap_cable_thread_flush (urj_cable_t *cable,
+                                 urj_cable_flush_amount_t how_much);
+#endif
+
 #endif /* URJ_CABLE_CABLE_H */
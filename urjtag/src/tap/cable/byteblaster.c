@@ -111,6 +111,9 @@ byteblaster_init (urj_cable_t *cable)
                                      BB_ENABLE) != URJ_STATUS_OK)
         return URJ_STATUS_FAIL;
 
+    urj_tap_cable_generic_parport_pins (cable, 0, TMS, TDI, TCK, TDO,
+                                        -1, -1);
+
     return URJ_STATUS_OK;
 }
 
@@ -177,7 +180,7 @@ byteblaster_set_signal (urj_cable_t *cable, int mask, int val)
     return prev_sigs;
 }
 
-const const urj_cable_driver_t urj_tap_cable_byteblaster_driver = {
+const urj_cable_driver_t urj_tap_cable_byteblaster_driver = {
     "ByteBlaster",
     N_("Altera ByteBlaster/ByteBlaster II/ByteBlasterMV Parallel Port Download Cable"),
     URJ_CABLE_DEVICE_PARPORT,
@@ -189,9 +192,11 @@ const const urj_cable_driver_t urj_tap_cable_byteblaster_driver = {
     urj_tap_cable_generic_set_frequency,
     byteblaster_clock,
     byteblaster_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     byteblaster_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    urj_tap_cable_generic_parport_help
+    urj_tap_cable_generic_parport_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
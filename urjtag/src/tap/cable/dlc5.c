@@ -64,6 +64,9 @@ dlc5_init (urj_cable_t *cable)
 
     PARAM_SIGNALS (cable) = URJ_POD_CS_TRST;
 
+    urj_tap_cable_generic_parport_pins (cable, 1 << PROG, TMS, TDI, TCK, TDO,
+                                        -1, -1);
+
     return URJ_STATUS_OK;
 }
 
@@ -144,9 +147,11 @@ const urj_cable_driver_t urj_tap_cable_dlc5_driver = {
     urj_tap_cable_generic_set_frequency,
     dlc5_clock,
     dlc5_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     dlc5_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    urj_tap_cable_generic_parport_help
+    urj_tap_cable_generic_parport_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
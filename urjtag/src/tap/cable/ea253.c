@@ -67,6 +67,9 @@ ea253_init (urj_cable_t *cable)
     else
         PARAM_SIGNALS (cable) = ((data >> TRST) && 1) ? URJ_POD_CS_TRST : 0;
 
+    urj_tap_cable_generic_parport_pins (cable, 0, TMS, TDI, TCK, TDO,
+                                        TRST, -1);
+
     return URJ_STATUS_OK;
 }
 
@@ -150,9 +153,11 @@ const urj_cable_driver_t urj_tap_cable_ea253_driver = {
     urj_tap_cable_generic_set_frequency,
     ea253_clock,
     ea253_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     ea253_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    urj_tap_cable_generic_parport_help
+    urj_tap_cable_generic_parport_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
@@ -88,6 +88,11 @@
 /* FT2232H / FT4232H only commands */
 #define DISABLE_CLOCKDIV  0x8A /* Disables the clk divide by 5 to allow for a 60MHz master clock */
 #define ENABLE_CLOCKDIV   0x8B /* Enables the clk divide by 5 to allow for backward compatibility with FT2232D */
+#define CLOCK_N_CYCLES    0x8E /* Clocks 1 to 8 cycles without data transfer */
+#define CLOCK_N8_CYCLES   0x8F /* Clocks 8 to 524288 cycles in multiples of 8 without data transfer */
+
+/* Below this number of clocks, the TMS command is as good as the clock-only ones */
+#define FT2232H_CLOCK_BULK_MIN 16
 
 /* bit and bitmask definitions for GPIO commands */
 #define BIT_TCK         0
@@ -274,6 +279,9 @@ typedef struct
     unsigned int last_tdo;
     int signals;
 
+    /* the chip understands the FT2232H / FT4232H only commands */
+    int high_speed;
+
     urj_tap_cable_cx_cmd_root_t cmd_root;
 } params_t;
 
@@ -299,6 +307,8 @@ ft2232_set_frequency_common (urj_cable_t *cable, uint32_t new_frequency, uint32_
     params_t *params = cable->params;
     urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
 
+    params->high_speed = max_frequency == FT2232H_MAX_TCK_FREQ;
+
     if (!new_frequency || new_frequency > max_frequency)
         new_frequency = max_frequency;
 
@@ -1522,12 +1532,74 @@ ft2232_milkymist_done (urj_cable_t *cable)
     urj_tap_cable_generic_usbconn_done (cable);
 }
 
+/* Idle run of n clocks with constant TMS and TDI: one clock through the
+   TMS command sets both pins, the clock-only commands of the FT2232H
+   keep them for the rest. 64K clocks cost 3 bytes instead of 28K. */
+static void
+ft2232h_clock_bulk_schedule (urj_cable_t *cable, int tms, int tdi, int n)
+{
+    params_t *params = cable->params;
+    urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
+    int count;
+
+    urj_tap_cable_cx_cmd_queue (cmd_root, 0);
+    /* Clock Data to TMS/CS Pin (no Read) */
+    urj_tap_cable_cx_cmd_push (cmd_root, MPSSE_WRITE_TMS |
+                               MPSSE_LSB | MPSSE_BITMODE |
+                               MPSSE_WRITE_NEG);
+    urj_tap_cable_cx_cmd_push (cmd_root, 0);
+    urj_tap_cable_cx_cmd_push (cmd_root, (tdi ? 1 << 7 : 0) | (tms ? 1 : 0));
+    n--;
+
+    while (n > 0)
+    {
+        if (urj_tap_cable_cx_cmd_space
+            (cmd_root, URJ_USBCONN_FTDX_MAXSEND_MPSSE) < 4)
+        {
+            urj_tap_cable_cx_xfer (cmd_root, &imm_cmd, cable,
+                                   URJ_TAP_CABLE_COMPLETELY);
+            urj_tap_cable_cx_cmd_queue (cmd_root, 0);
+        }
+
+        if (n >= 8)
+        {
+            count = n >> 3;
+            if (count > (1 << 16))
+                count = 1 << 16;
+            /* Clock For n x 8 bits with no data transfer */
+            urj_tap_cable_cx_cmd_push (cmd_root, CLOCK_N8_CYCLES);
+            urj_tap_cable_cx_cmd_push (cmd_root, (count - 1) & 0xff);
+            urj_tap_cable_cx_cmd_push (cmd_root, ((count - 1) >> 8) & 0xff);
+            n -= count << 3;
+        }
+        else
+        {
+            /* Clock For n bits with no data transfer */
+            urj_tap_cable_cx_cmd_push (cmd_root, CLOCK_N_CYCLES);
+            urj_tap_cable_cx_cmd_push (cmd_root, n - 1);
+            n = 0;
+        }
+    }
+
+    params->signals &= ~(URJ_POD_CS_TMS | URJ_POD_CS_TDI | URJ_POD_CS_TCK);
+    if (tms)
+        params->signals |= URJ_POD_CS_TMS;
+    if (tdi)
+        params->signals |= URJ_POD_CS_TDI;
+}
+
 static void
 ft2232_clock_schedule (urj_cable_t *cable, int tms, int tdi, int n)
 {
     params_t *params = cable->params;
     urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
 
+    if (params->high_speed && n >= FT2232H_CLOCK_BULK_MIN)
+    {
+        ft2232h_clock_bulk_schedule (cable, tms, tdi, n);
+        return;
+    }
+
     tms = tms ? 0x7f : 0;
     tdi = tdi ? 1 << 7 : 0;
 
@@ -1738,9 +1810,10 @@ ft2232_set_signal (urj_cable_t *cable, int mask, int val)
 }
 
 
+/* Shift @len bits with TMS=0; bit k of TDI is (in[k] & mask) != 0 */
 static void
-ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
-                          char *out)
+ft2232_data_schedule (urj_cable_t *cable, int len, const char *in, int mask,
+                      int read)
 {
     params_t *params = cable->params;
     urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
@@ -1761,7 +1834,7 @@ ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
         int byte_idx;
 
         /* reduce chunkbytes to the maximum amount we can receive in one step */
-        if (out && chunkbytes > URJ_USBCONN_FTDX_MAXRECV)
+        if (read && chunkbytes > URJ_USBCONN_FTDX_MAXRECV)
             chunkbytes = URJ_USBCONN_FTDX_MAXRECV;
         /* reduce chunkbytes to the maximum amount that fits into one buffer
            for performance reasons */
@@ -1777,7 +1850,7 @@ ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
      * Determine data shifting command (bytewise).
      * Either with or without read
      ***********************************************************************/
-        if (out)
+        if (read)
         {
             urj_tap_cable_cx_cmd_queue (cmd_root, chunkbytes);
             /* Clock Data Bytes In and Out LSB First
@@ -1807,7 +1880,7 @@ ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
             unsigned char b = 0;
 
             for (bit_idx = 1; bit_idx < 256; bit_idx <<= 1)
-                if (in[in_offset++])
+                if (in[in_offset++] & mask)
                     b |= bit_idx;
             urj_tap_cable_cx_cmd_push (cmd_root, b);
         }
@@ -1825,7 +1898,7 @@ ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
      * Determine data shifting command (bitwise).
      * Either with or without read
      ***********************************************************************/
-        if (out)
+        if (read)
         {
             urj_tap_cable_cx_cmd_queue (cmd_root, 1);
             /* Clock Data Bytes In and Out LSB First
@@ -1855,14 +1928,14 @@ ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
             unsigned char b = 0;
             for (bit_idx = 1; bit_idx < 1 << bitwise_len; bit_idx <<= 1)
             {
-                if (in[in_offset++])
+                if (in[in_offset++] & mask)
                     b |= bit_idx;
             }
             urj_tap_cable_cx_cmd_push (cmd_root, b);
         }
     }
 
-    if (out)
+    if (read)
     {
         /* Read Data Bits Low Byte to get current TDO,
            Do this only if we'll read out data nonetheless */
@@ -1875,13 +1948,25 @@ ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
 }
 
 
+static void
+ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
+                          char *out)
+{
+    ft2232_data_schedule (cable, len, in, ~0, out != NULL);
+}
+
+
+/* Collect the TDO bits of ft2232_data_schedule(). If @seq is not NULL,
+ * only the bits of clocks marked for capture in it are stored.
+ * Returns the number of stored bits. */
 static int
-ft2232_transfer_finish (urj_cable_t *cable, int len, char *out)
+ft2232_data_finish (urj_cable_t *cable, int len, const char *seq, char *out)
 {
     params_t *params = cable->params;
     int bitwise_len;
     int chunkbytes;
     int out_offset = 0;
+    int bit_offset = 0;
 
     chunkbytes = len >> 3;
     bitwise_len = len % 8;
@@ -1904,7 +1989,12 @@ ft2232_transfer_finish (urj_cable_t *cable, int len, char *out)
 
                 b = urj_tap_cable_cx_xfer_recv (cable);
                 for (bit_idx = 1; bit_idx < 256; bit_idx <<= 1)
-                    out[out_offset++] = (b & bit_idx) ? 1 : 0;
+                {
+                    if (seq == NULL
+                        || (seq[bit_offset] & URJ_CABLE_SEQ_CAPTURE))
+                        out[out_offset++] = (b & bit_idx) ? 1 : 0;
+                    bit_offset++;
+                }
             }
         }
 
@@ -1921,7 +2011,11 @@ ft2232_transfer_finish (urj_cable_t *cable, int len, char *out)
 
             for (bit_idx = (1 << (8 - bitwise_len)); bit_idx < 256;
                  bit_idx <<= 1)
-                out[out_offset++] = (b & bit_idx) ? 1 : 0;
+            {
+                if (seq == NULL || (seq[bit_offset] & URJ_CABLE_SEQ_CAPTURE))
+                    out[out_offset++] = (b & bit_idx) ? 1 : 0;
+                bit_offset++;
+            }
         }
 
         /* gather current TDO */
@@ -1932,6 +2026,14 @@ ft2232_transfer_finish (urj_cable_t *cable, int len, char *out)
     else
         params->last_tdo_valid = 0;
 
+    return out_offset;
+}
+
+
+static int
+ft2232_transfer_finish (urj_cable_t *cable, int len, char *out)
+{
+    ft2232_data_finish (cable, len, NULL, out);
     return 0;
 }
 
@@ -1948,6 +2050,153 @@ ft2232_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 }
 
 
+/* A TMS sequence is split into runs of 8 or more clocks with TMS=0, which
+ * go through the data shifting commands, and groups of up to 7 clocks
+ * with the same TDI value for the TMS command. The data shifting commands
+ * leave TMS as the last TMS command set it, so a run only starts after a
+ * clock with TMS=0; otherwise its first clock goes to the TMS command on
+ * its own. At the start of the sequence TMS is not known. Returns the
+ * length of the segment at seq[i], *data tells which kind it is. */
+static int
+ft2232_sequence_segment (const char *seq, int i, int len, int *data)
+{
+    int n, z;
+
+    for (n = 0; i + n < len && !(seq[i + n] & URJ_CABLE_SEQ_TMS); n++)
+        ;
+    if (n >= 8)
+    {
+        if (i == 0 || (seq[i - 1] & URJ_CABLE_SEQ_TMS))
+        {
+            *data = 0;
+            return 1;
+        }
+        *data = 1;
+        return n;
+    }
+
+    *data = 0;
+    for (n = 1; n < 7 && i + n < len; n++)
+    {
+        if ((seq[i + n] & URJ_CABLE_SEQ_TDI) != (seq[i] & URJ_CABLE_SEQ_TDI))
+            break;
+        /* leave the long runs to the data shifting commands */
+        for (z = 0; z < 8 && i + n + z < len
+             && !(seq[i + n + z] & URJ_CABLE_SEQ_TMS); z++)
+            ;
+        if (z >= 8)
+            break;
+    }
+
+    return n;
+}
+
+
+static int
+ft2232_sequence_reads (const char *seq, int n)
+{
+    int j;
+
+    for (j = 0; j < n; j++)
+        if (seq[j] & URJ_CABLE_SEQ_CAPTURE)
+            return 1;
+
+    return 0;
+}
+
+
+static void
+ft2232_sequence_schedule (urj_cable_t *cable, int len, const char *seq)
+{
+    params_t *params = cable->params;
+    urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
+    int i, j, n, data;
+
+    for (i = 0; i < len; i += n)
+    {
+        int read;
+
+        n = ft2232_sequence_segment (seq, i, len, &data);
+        read = ft2232_sequence_reads (seq + i, n);
+
+        if (data)
+            ft2232_data_schedule (cable, n, seq + i, URJ_CABLE_SEQ_TDI, read);
+        else
+        {
+            uint8_t byte = (seq[i] & URJ_CABLE_SEQ_TDI) ? 1 << 7 : 0;
+
+            for (j = 0; j < n; j++)
+                if (seq[i + j] & URJ_CABLE_SEQ_TMS)
+                    byte |= 1 << j;
+
+            /* Clock Data to TMS/CS Pin (with Read if needed) */
+            urj_tap_cable_cx_cmd_queue (cmd_root, read ? 1 : 0);
+            urj_tap_cable_cx_cmd_push (cmd_root, MPSSE_WRITE_TMS |
+                                       (read ? MPSSE_DO_READ : 0) |
+                                       MPSSE_LSB | MPSSE_BITMODE |
+                                       MPSSE_WRITE_NEG);
+            urj_tap_cable_cx_cmd_push (cmd_root, n - 1);
+            urj_tap_cable_cx_cmd_push (cmd_root, byte);
+        }
+    }
+
+    if (len > 0)
+    {
+        params->signals &= ~(URJ_POD_CS_TMS | URJ_POD_CS_TDI | URJ_POD_CS_TCK);
+        if (seq[len - 1] & URJ_CABLE_SEQ_TMS)
+            params->signals |= URJ_POD_CS_TMS;
+        if (seq[len - 1] & URJ_CABLE_SEQ_TDI)
+            params->signals |= URJ_POD_CS_TDI;
+    }
+    params->last_tdo_valid = 0;
+}
+
+
+static int
+ft2232_sequence_finish (urj_cable_t *cable, int len, const char *seq,
+                        char *out)
+{
+    params_t *params = cable->params;
+    int i, j, n, data;
+    int out_offset = 0;
+
+    for (i = 0; i < len; i += n)
+    {
+        n = ft2232_sequence_segment (seq, i, len, &data);
+        if (!ft2232_sequence_reads (seq + i, n))
+            continue;
+
+        if (data)
+            out_offset += ft2232_data_finish (cable, n, seq + i,
+                                              out + out_offset);
+        else
+        {
+            /* the bits are shifted in from the top */
+            unsigned char b = urj_tap_cable_cx_xfer_recv (cable);
+
+            for (j = 0; j < n; j++)
+                if (seq[i + j] & URJ_CABLE_SEQ_CAPTURE)
+                    out[out_offset++] = (b & (1 << (8 - n + j))) ? 1 : 0;
+        }
+    }
+    params->last_tdo_valid = 0;
+
+    return out_offset;
+}
+
+
+static int
+ft2232_tms_sequence (urj_cable_t *cable, int len, const char *seq, char *out)
+{
+    params_t *params = cable->params;
+
+    ft2232_sequence_schedule (cable, len, seq);
+    urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
+                           URJ_TAP_CABLE_COMPLETELY);
+    return ft2232_sequence_finish (cable, len, seq, out);
+}
+
+
 static void
 ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
 {
@@ -2001,6 +2250,16 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                         tms = cable->todo.data[i].arg.clock.tms ? 1 : 0;
                         cn = cable->todo.data[i].arg.clock.n;
                     }
+                    if (params->high_speed && cn >= FT2232H_CLOCK_BULK_MIN)
+                    {
+                        if (length)
+                            ft2232_clock_compact_schedule (cable, length - 1,
+                                                           byte | tdi);
+                        ft2232h_clock_bulk_schedule (cable, tms, tdi, cn);
+                        length = 0;
+                        byte = 0;
+                        cn = 0;
+                    }
                     while (cn > 0)
                     {
                         byte |= tms << length;
@@ -2070,6 +2329,15 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                 last_tdo_valid_schedule = params->last_tdo_valid;
                 break;
 
+            case URJ_TAP_CABLE_TMS_SEQUENCE:
+                ft2232_sequence_schedule (cable,
+                                          cable->todo.data[i].arg.sequence.
+                                          len,
+                                          cable->todo.data[i].arg.sequence.
+                                          seq);
+                last_tdo_valid_schedule = 0;
+                break;
+
             default:
                 break;
             }
@@ -2164,7 +2432,6 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                                                     cable->todo.data[j].arg.
                                                     transfer.out);
                     last_tdo_valid_finish = params->last_tdo_valid;
-                    free (cable->todo.data[j].arg.transfer.in);
                     if (cable->todo.data[j].arg.transfer.out)
                     {
                         int m = urj_tap_cable_add_queue_item (cable,
@@ -2182,6 +2449,37 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                             cable->todo.data[j].arg.transfer.out;
                     }
                 }
+                break;
+            case URJ_TAP_CABLE_TMS_SEQUENCE:
+                {
+                    int len = cable->todo.data[j].arg.sequence.len;
+                    const char *seq = cable->todo.data[j].arg.sequence.seq;
+                    int r = ft2232_sequence_finish (cable, len, seq,
+                                                    cable->todo.data[j].arg.
+                                                    sequence.out);
+                    if (len > 0)
+                    {
+                        post_signals &=
+                            ~(URJ_POD_CS_TCK | URJ_POD_CS_TDI | URJ_POD_CS_TMS);
+                        post_signals |= (seq[len - 1] & URJ_CABLE_SEQ_TMS)
+                            ? URJ_POD_CS_TMS : 0;
+                        post_signals |= (seq[len - 1] & URJ_CABLE_SEQ_TDI)
+                            ? URJ_POD_CS_TDI : 0;
+                    }
+                    params->last_tdo_valid = last_tdo_valid_finish = 0;
+                    if (cable->todo.data[j].arg.sequence.out)
+                    {
+                        int m = urj_tap_cable_add_queue_item (cable,
+                                                              &cable->done);
+                        cable->done.data[m].action =
+                            URJ_TAP_CABLE_TMS_SEQUENCE;
+                        cable->done.data[m].arg.xferred.len = r;
+                        cable->done.data[m].arg.xferred.res = r;
+                        cable->done.data[m].arg.xferred.out =
+                            cable->todo.data[j].arg.sequence.out;
+                    }
+                    break;
+                }
             default:
                 break;
             }
@@ -2269,7 +2567,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0000, 0x0000, "-mpsse", "FT2232", ft2232)
 
@@ -2289,7 +2589,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_armusbocd_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x15BA, 0x0003, "-mpsse", "ARM-USB-OCD", armusbocd)
 URJ_DECLARE_FTDX_CABLE(0x15BA, 0x0004, "-mpsse", "ARM-USB-OCD", armusbocdtiny)
@@ -2310,7 +2612,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_armusbtiny_h_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x15BA, 0x002A, "-mpsse", "ARM-USB-TINY-H", armusbtiny_h)
 URJ_DECLARE_FTDX_CABLE(0x15BA, 0x002B, "-mpsse", "ARM-USB-OCD-H", armusbocd_h)
@@ -2331,7 +2635,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_gnice_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0456, 0xF000, "-mpsse", "gnICE", gnice)
 
@@ -2351,7 +2657,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_gniceplus_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0456, 0xF001, "-mpsse", "gnICE+", gniceplus)
 
@@ -2371,7 +2679,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_jtagkey_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xCFF8, "-mpsse", "JTAGkey", jtagkey)
 
@@ -2391,7 +2701,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_oocdlinks_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xbaf8, "-mpsse", "OOCDLink-s", oocdlinks)
 
@@ -2411,7 +2723,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_turtelizer2_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xBDC8, "-mpsse", "Turtelizer2", turtelizer2)
 
@@ -2431,7 +2745,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_usbjtagrs232_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x1457, 0x5118, "-mpsse", "USB-JTAG-RS232", usbjtagrs232)
 
@@ -2451,7 +2767,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_usbtojtagif_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0000, 0x0000, "-mpsse", "USB-to-JTAG-IF", usbtojtagif)
 
@@ -2471,7 +2789,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_signalyzer_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xbca1, "-mpsse", "Signalyzer", signalyzer)
 
@@ -2491,7 +2811,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_flyswatter_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0x6010, "-mpsse", "Flyswatter", flyswatter)
 
@@ -2511,7 +2833,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_usbscarab2_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xbbe0, "-mpsse", "usbScarab2", usbscarab2)
 
@@ -2531,7 +2855,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_ktlink_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xbbe2, "-mpsse", "KT-LINK", ktlink)
 
@@ -2551,7 +2877,9 @@ const urj_cable_driver_t urj_tap_cable_ft2232_milkymist_driver = {
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x20b7, 0x0713, "-mpsse", "milkymist", milkymist)
 
@@ -77,6 +77,56 @@ urj_tap_cable_generic_transfer (urj_cable_t *cable, int len, const char *in,
     return i;
 }
 
+/* bits per transfer() call in urj_tap_cable_generic_tms_sequence() */
+#define SEQ_CHUNK       256
+
+int
+urj_tap_cable_generic_tms_sequence (urj_cable_t *cable, int len,
+                                    const char *seq, char *out)
+{
+    int i = 0, k = 0;
+
+    while (i < len)
+    {
+        int n;
+
+        if (seq[i] & URJ_CABLE_SEQ_TMS)
+        {
+            /* state transition: one clock at a time */
+            if (seq[i] & URJ_CABLE_SEQ_CAPTURE)
+                out[k++] = cable->driver->get_tdo (cable);
+            for (n = 1; i + n < len && seq[i + n] == seq[i]
+                 && !(seq[i] & URJ_CABLE_SEQ_CAPTURE); n++)
+                ;
+            cable->driver->clock (cable, 1, seq[i] & URJ_CABLE_SEQ_TDI, n);
+        }
+        else
+        {
+            /* shifting: as many clocks with TMS=0 as possible at once */
+            char tdi[SEQ_CHUNK], tdo[SEQ_CHUNK];
+            int capture = 0, j;
+
+            for (n = 0; i + n < len && n < SEQ_CHUNK
+                 && !(seq[i + n] & URJ_CABLE_SEQ_TMS); n++)
+            {
+                tdi[n] = seq[i + n] & URJ_CABLE_SEQ_TDI;
+                if (seq[i + n] & URJ_CABLE_SEQ_CAPTURE)
+                    capture = 1;
+            }
+            if (cable->driver->transfer (cable, n, tdi,
+                                         capture ? tdo : NULL) < 0)
+                return -1;
+            if (capture)
+                for (j = 0; j < n; j++)
+                    if (seq[i + j] & URJ_CABLE_SEQ_CAPTURE)
+                        out[k++] = tdo[j];
+        }
+        i += n;
+    }
+
+    return k;
+}
+
 int
 urj_tap_cable_generic_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig)
 {
@@ -98,7 +148,8 @@ do_one_queued_action (urj_cable_t *cable)
         {
             if (cable->todo.data[i].action == URJ_TAP_CABLE_GET_TDO
                 || cable->todo.data[i].action == URJ_TAP_CABLE_GET_SIGNAL
-                || cable->todo.data[i].action == URJ_TAP_CABLE_TRANSFER)
+                || cable->todo.data[i].action == URJ_TAP_CABLE_TRANSFER
+                || cable->todo.data[i].action == URJ_TAP_CABLE_TMS_SEQUENCE)
             {
                 urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
                                _("No space in cable activity results queue"));
@@ -131,7 +182,6 @@ do_one_queued_action (urj_cable_t *cable)
                                                  cable->todo.data[i].arg.
                                                  transfer.out);
 
-                free (cable->todo.data[i].arg.transfer.in);
                 if (cable->todo.data[i].arg.transfer.out != NULL)
                 {
                     /* @@@@ RFHH check result */
@@ -149,6 +199,42 @@ do_one_queued_action (urj_cable_t *cable)
                 }
                 break;
             }
+        case URJ_TAP_CABLE_TMS_SEQUENCE:
+            {
+                int r;
+
+                if (cable->driver->tms_sequence != NULL)
+                    r = cable->driver->tms_sequence (cable,
+                                                     cable->todo.data[i].arg.
+                                                     sequence.len,
+                                                     cable->todo.data[i].arg.
+                                                     sequence.seq,
+                                                     cable->todo.data[i].arg.
+                                                     sequence.out);
+                else
+                    r = urj_tap_cable_generic_tms_sequence (cable,
+                                                     cable->todo.data[i].arg.
+                                                     sequence.len,
+                                                     cable->todo.data[i].arg.
+                                                     sequence.seq,
+                                                     cable->todo.data[i].arg.
+                                                     sequence.out);
+
+                if (cable->todo.data[i].arg.sequence.out != NULL)
+                {
+                    /* @@@@ RFHH check result */
+                    j = urj_tap_cable_add_queue_item (cable, &cable->done);
+                    urj_log (URJ_LOG_LEVEL_DEBUG,
+                             "add result from sequence to %p.%d\n",
+                             &cable->done, j);
+                    cable->done.data[j].action = URJ_TAP_CABLE_TMS_SEQUENCE;
+                    cable->done.data[j].arg.xferred.len = r < 0 ? 0 : r;
+                    cable->done.data[j].arg.xferred.res = r;
+                    cable->done.data[j].arg.xferred.out =
+                        cable->todo.data[i].arg.sequence.out;
+                }
+                break;
+            }
         case URJ_TAP_CABLE_GET_TDO:
             /* @@@@ RFHH check result */
             j = urj_tap_cable_add_queue_item (cable, &cable->done);
@@ -193,6 +279,197 @@ urj_tap_cable_generic_flush_one_by_one (urj_cable_t *cable,
     while (do_one_queued_action (cable));
 }
 
+/* Number of captured clocks in seq[from .. to-1] */
+static int
+count_captured (const char *seq, int from, int to)
+{
+    int k = 0;
+
+    for (; from < to; from++)
+        if (seq[from] & URJ_CABLE_SEQ_CAPTURE)
+            k++;
+
+    return k;
+}
+
+/* Like flush_using_transfer below, but for drivers with a tms_sequence()
+ * method. Clocks with any TMS value and complete TMS sequences can be
+ * combined as well, so a run of scans becomes a single driver call. */
+static void
+flush_using_sequence (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
+{
+    int i, j, n;
+
+    do
+    {
+        int r, bits = 0, pos, k;
+        char *seq, *out;
+
+        urj_log (URJ_LOG_LEVEL_DETAIL, "flush(%d)\n", cable->todo.num_items);
+
+        /* Step 1: Count clocks. Can do clock, get_tdo, transfer, sequence */
+
+        for (i = cable->todo.next_item, n = 0; n < cable->todo.num_items; n++)
+        {
+            urj_cable_queue_t *item = &cable->todo.data[i];
+
+            if (item->action == URJ_TAP_CABLE_CLOCK)
+                bits += item->arg.clock.n;
+            else if (item->action == URJ_TAP_CABLE_TRANSFER)
+                bits += item->arg.transfer.len;
+            else if (item->action == URJ_TAP_CABLE_TMS_SEQUENCE)
+                bits += item->arg.sequence.len;
+            else if (item->action != URJ_TAP_CABLE_GET_TDO)
+            {
+                urj_log (URJ_LOG_LEVEL_DETAIL,
+                         "cutoff at n=%d because action unsuitable for sequence\n",
+                         n);
+                break;
+            }
+            i++;
+            if (i >= cable->todo.max_items)
+                i = 0;
+        }
+
+        urj_log (URJ_LOG_LEVEL_DETAIL, "%d combined into one (%d bits)\n",
+                 n, bits);
+
+        if (bits == 0 || n <= 1)
+        {
+            do_one_queued_action (cable);
+            continue;
+        }
+
+        /* Step 2: Combine into single sequence. Transfers that want their
+         * output capture all their bits, get_tdo the bit that follows. */
+
+        seq = urj_tap_cable_scratch (cable, 2 * bits);
+        if (seq == NULL)
+        {
+            urj_tap_cable_generic_flush_one_by_one (cable, how_much);
+            break;
+        }
+        out = seq + bits;
+
+        for (j = 0, pos = 0, i = cable->todo.next_item; j < n; j++)
+        {
+            urj_cable_queue_t *item = &cable->todo.data[i];
+
+            if (item->action == URJ_TAP_CABLE_CLOCK)
+            {
+                memset (seq + pos,
+                        (item->arg.clock.tms ? URJ_CABLE_SEQ_TMS : 0)
+                        | (item->arg.clock.tdi ? URJ_CABLE_SEQ_TDI : 0),
+                        item->arg.clock.n);
+                pos += item->arg.clock.n;
+            }
+            else if (item->action == URJ_TAP_CABLE_TRANSFER)
+            {
+                char flags = item->arg.transfer.out ? URJ_CABLE_SEQ_CAPTURE : 0;
+                for (k = 0; k < item->arg.transfer.len; k++)
+                    seq[pos++] = flags
+                        | (item->arg.transfer.in[k] ? URJ_CABLE_SEQ_TDI : 0);
+            }
+            else if (item->action == URJ_TAP_CABLE_TMS_SEQUENCE)
+            {
+                memcpy (seq + pos, item->arg.sequence.seq,
+                        item->arg.sequence.len);
+                pos += item->arg.sequence.len;
+            }
+            else if (pos < bits)
+                seq[pos] |= URJ_CABLE_SEQ_CAPTURE;      /* get_tdo */
+            i++;
+            if (i >= cable->todo.max_items)
+                i = 0;
+        }
+
+        /* Step 3: Do the sequence */
+
+        r = cable->driver->tms_sequence (cable, bits, seq, out);
+
+        /* Step 4: Pick results from sequence; k is the index in out of the
+         * first captured bit at or after pos */
+
+        for (j = 0, pos = 0, k = 0, i = cable->todo.next_item; j < n; j++)
+        {
+            urj_cable_queue_t *item = &cable->todo.data[i];
+            int c;
+
+            switch (item->action)
+            {
+            case URJ_TAP_CABLE_CLOCK:
+                k += count_captured (seq, pos, pos + item->arg.clock.n);
+                pos += item->arg.clock.n;
+                break;
+            case URJ_TAP_CABLE_GET_TDO:
+                c = urj_tap_cable_add_queue_item (cable, &cable->done);
+                cable->done.data[c].action = URJ_TAP_CABLE_GET_TDO;
+                if (pos < bits && r >= 0)
+                    cable->done.data[c].arg.value.val = out[k];
+                else
+                    cable->done.data[c].arg.value.val =
+                        cable->driver->get_tdo (cable);
+                break;
+            case URJ_TAP_CABLE_TRANSFER:
+                if (item->arg.transfer.out != NULL)
+                {
+                    c = urj_tap_cable_add_queue_item (cable, &cable->done);
+                    cable->done.data[c].action = URJ_TAP_CABLE_TRANSFER;
+                    cable->done.data[c].arg.xferred.len =
+                        item->arg.transfer.len;
+                    cable->done.data[c].arg.xferred.res =
+                        r < 0 ? r : item->arg.transfer.len;
+                    cable->done.data[c].arg.xferred.out =
+                        item->arg.transfer.out;
+                    if (r >= 0)
+                        memcpy (item->arg.transfer.out, out + k,
+                                item->arg.transfer.len);
+                }
+                k += count_captured (seq, pos, pos + item->arg.transfer.len);
+                pos += item->arg.transfer.len;
+                break;
+            case URJ_TAP_CABLE_TMS_SEQUENCE:
+                {
+                    /* a get_tdo may have marked the first bit as well */
+                    const char *s = item->arg.sequence.seq;
+                    int b, m = 0;
+
+                    for (b = 0; b < item->arg.sequence.len; b++, pos++)
+                        if (seq[pos] & URJ_CABLE_SEQ_CAPTURE)
+                        {
+                            if ((s[b] & URJ_CABLE_SEQ_CAPTURE) && r >= 0
+                                && item->arg.sequence.out != NULL)
+                                item->arg.sequence.out[m++] = out[k];
+                            k++;
+                        }
+
+                    if (item->arg.sequence.out != NULL)
+                    {
+                        c = urj_tap_cable_add_queue_item (cable,
+                                                          &cable->done);
+                        cable->done.data[c].action =
+                            URJ_TAP_CABLE_TMS_SEQUENCE;
+                        cable->done.data[c].arg.xferred.len = m;
+                        cable->done.data[c].arg.xferred.res = r < 0 ? r : m;
+                        cable->done.data[c].arg.xferred.out =
+                            item->arg.sequence.out;
+                    }
+                    break;
+                }
+            default:
+                break;
+            }
+            i++;
+            if (i >= cable->todo.max_items)
+                i = 0;
+        }
+
+        cable->todo.next_item = i;
+        cable->todo.num_items -= n;
+    }
+    while (cable->todo.num_items > 0);
+}
+
 void
 urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
                                             urj_cable_flush_amount_t how_much)
@@ -206,6 +483,12 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
     if (cable->todo.num_items == 0)
         return;
 
+    if (cable->driver->tms_sequence != NULL)
+    {
+        flush_using_sequence (cable, how_much);
+        return;
+    }
+
     do
     {
         int r, bits = 0, tdo = 0, savbits;
@@ -265,19 +548,13 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
         {
             /* Step 2: Combine into single transfer. */
 
-            in = malloc (bits);
-            out = malloc (bits);
-
-            if (in == NULL || out == NULL)
+            in = urj_tap_cable_scratch (cable, 2 * bits);
+            if (in == NULL)
             {
-                /* @@@@ RFHH free(NULL) is correct */
-                if (in != NULL)
-                    free (in);
-                if (out != NULL)
-                    free (out);
                 urj_tap_cable_generic_flush_one_by_one (cable, how_much);
                 break;
             }
+            out = in + bits;
 
             for (j = 0, bits = 0, i = cable->todo.next_item; j < n; j++)
             {
@@ -345,7 +622,6 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
                 {
                     char *p = cable->todo.data[i].arg.transfer.out;
                     int len = cable->todo.data[i].arg.transfer.len;
-                    free (cable->todo.data[i].arg.transfer.in);
                     if (p != NULL)
                     {
                         int c = urj_tap_cable_add_queue_item (cable,
@@ -372,9 +648,6 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
 
             cable->todo.next_item = i;
             cable->todo.num_items -= n;
-
-            free (in);
-            free (out);
         }
     }
     while (cable->todo.num_items > 0);
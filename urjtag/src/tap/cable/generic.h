@@ -43,6 +43,14 @@ void urj_tap_cable_generic_set_frequency (urj_cable_t *cable,
 /** @return number of clocks on success; -1 on error */
 int urj_tap_cable_generic_transfer (urj_cable_t *cable, int len, const char *in,
                                     char *out);
+/**
+ * Default tms_sequence() method, built on the clock(), get_tdo() and
+ * transfer() methods of the driver.
+ *
+ * @return the number of captured bits on success; -1 on failure
+ */
+int urj_tap_cable_generic_tms_sequence (urj_cable_t *cable, int len,
+                                        const char *seq, char *out);
 int urj_tap_cable_generic_get_signal (urj_cable_t *cable,
                                       urj_pod_sigsel_t sig);
 void urj_tap_cable_generic_flush_one_by_one (urj_cable_t *cable,
@@ -53,7 +53,7 @@ urj_tap_cable_generic_parport_connect (urj_cable_t *cable,
                                        const char *devname,
                                        const urj_param_t *params[])
 {
-    urj_tap_cable_generic_params_t *cable_params;
+    urj_tap_cable_generic_parport_params_t *cable_params;
     urj_parport_t *port;
     int i;
 
@@ -93,6 +93,7 @@ urj_tap_cable_generic_parport_connect (urj_cable_t *cable,
     }
 
     cable->link.port = port;
+    port->cable = cable;
     cable->params = cable_params;
     cable->chain = NULL;
 
@@ -113,6 +114,131 @@ urj_tap_cable_generic_parport_done (urj_cable_t *cable)
     urj_tap_parport_close (cable->link.port);
 }
 
+void
+urj_tap_cable_generic_parport_pins (urj_cable_t *cable, int base, int tms,
+                                    int tdi, int tck, int tdo, int trst,
+                                    int reset)
+{
+    urj_tap_cable_parport_pins_t *pins = PARAM_PINS (cable);
+    int i;
+
+    for (i = 0; i < 8; i++)
+        pins->data[i] = base
+            | (((i >> 2) & 1) << tms) | (((i >> 1) & 1) << tdi)
+            | ((i & 1) << tck);
+    pins->trst[0] = 0;
+    pins->trst[1] = trst < 0 ? 0 : 1 << trst;
+    pins->reset[0] = 0;
+    pins->reset[1] = reset < 0 ? 0 : 1 << reset;
+    pins->tdo_mask = 1 << tdo;
+    pins->tdo_value = 1 << tdo;
+}
+
+/* bits per bulk parport operation */
+#define PLAY_CHUNK      256
+
+/* Clock out @len bits of a URJ_CABLE_SEQ_* sequence: per bit, TCK low with
+ * the new TMS and TDI, where TDO is sampled if wanted, then TCK high.
+ * Doesn't update the signals of the cable. */
+static int
+parport_play (urj_cable_t *cable, int len, const char *seq, char *out)
+{
+    const urj_tap_cable_parport_pins_t *pins = PARAM_PINS (cable);
+    int signals = PARAM_SIGNALS (cable);
+    unsigned char data[2 * PLAY_CHUNK], status[2 * PLAY_CHUNK];
+    unsigned char base;
+    int i, j, n, k = 0;
+
+    base = pins->trst[(signals & URJ_POD_CS_TRST) != 0]
+        | pins->reset[(signals & URJ_POD_CS_RESET) != 0];
+
+    for (i = 0; i < len; i += n)
+    {
+        int capture = 0;
+
+        n = len - i < PLAY_CHUNK ? len - i : PLAY_CHUNK;
+        for (j = 0; j < n; j++)
+        {
+            int s = seq[i + j];
+            int p = URJ_TAP_CABLE_PARPORT_PINS ((s & URJ_CABLE_SEQ_TMS) != 0,
+                                                (s & URJ_CABLE_SEQ_TDI) != 0,
+                                                0);
+
+            data[2 * j] = base | pins->data[p];
+            data[2 * j + 1] = base | pins->data[p | 1];
+            if (s & URJ_CABLE_SEQ_CAPTURE)
+                capture = 1;
+        }
+
+        if (!capture)
+        {
+            if (urj_tap_parport_write_data_seq (cable->link.port, data,
+                                                2 * n) != URJ_STATUS_OK)
+                return -1;
+            continue;
+        }
+
+        if (urj_tap_parport_read_status_seq (cable->link.port, data, 2 * n,
+                                             status) != URJ_STATUS_OK)
+            return -1;
+        for (j = 0; j < n; j++)
+            if (seq[i + j] & URJ_CABLE_SEQ_CAPTURE)
+                out[k++] = (status[2 * j] & pins->tdo_mask) == pins->tdo_value;
+    }
+
+    return k;
+}
+
+int
+urj_tap_cable_generic_parport_transfer (urj_cable_t *cable, int len,
+                                        const char *in, char *out)
+{
+    char seq[PLAY_CHUNK];
+    int i, j, n;
+
+    /* a set frequency needs the waits of the driver's clock() */
+    if (cable->frequency != 0 || len < 2)
+        return urj_tap_cable_generic_transfer (cable, len, in, out);
+
+    for (i = 0; i < len - 1; i += n)
+    {
+        n = len - 1 - i < PLAY_CHUNK ? len - 1 - i : PLAY_CHUNK;
+        for (j = 0; j < n; j++)
+            seq[j] = (in[i + j] ? URJ_CABLE_SEQ_TDI : 0)
+                | (out ? URJ_CABLE_SEQ_CAPTURE : 0);
+        if (parport_play (cable, n, seq, out ? out + i : NULL) < 0)
+            return -1;
+    }
+
+    if (out)
+        out[len - 1] = cable->driver->get_tdo (cable);
+    cable->driver->clock (cable, 0, in[len - 1], 1);
+
+    return len;
+}
+
+int
+urj_tap_cable_generic_parport_tms_sequence (urj_cable_t *cable, int len,
+                                            const char *seq, char *out)
+{
+    int k, last;
+
+    if (cable->frequency != 0 || len < 2)
+        return urj_tap_cable_generic_tms_sequence (cable, len, seq, out);
+
+    k = parport_play (cable, len - 1, seq, out);
+    if (k < 0)
+        return -1;
+
+    last = seq[len - 1];
+    if (last & URJ_CABLE_SEQ_CAPTURE)
+        out[k++] = cable->driver->get_tdo (cable);
+    cable->driver->clock (cable, (last & URJ_CABLE_SEQ_TMS) != 0,
+                          last & URJ_CABLE_SEQ_TDI, 1);
+
+    return k;
+}
+
 void
 urj_tap_cable_generic_parport_help (urj_log_level_t ll, const char *cablename)
 {
@@ -36,4 +36,49 @@ void urj_tap_cable_generic_parport_free (urj_cable_t *cable);
 void urj_tap_cable_generic_parport_done (urj_cable_t *cable);
 void urj_tap_cable_generic_parport_help (urj_log_level_t ll, const char *name);
 
+/* Data register of a bit-bang cable for each combination of TMS, TDI and
+ * TCK, and where its status register shows TDO */
+typedef struct
+{
+    unsigned char data[8];      /* indexed by URJ_TAP_CABLE_PARPORT_PINS */
+    unsigned char trst[2];      /* added to data with URJ_POD_CS_TRST off/on */
+    unsigned char reset[2];     /* added to data with URJ_POD_CS_RESET off/on */
+    unsigned char tdo_mask;
+    unsigned char tdo_value;    /* status & tdo_mask when TDO is 1 */
+}
+urj_tap_cable_parport_pins_t;
+
+#define URJ_TAP_CABLE_PARPORT_PINS(tms,tdi,tck) \
+    ((((tms) & 1) << 2) | (((tdi) & 1) << 1) | ((tck) & 1))
+
+/* cable->params of the cables connected by
+ * urj_tap_cable_generic_parport_connect; starts like
+ * urj_tap_cable_generic_params_t */
+typedef struct
+{
+    int signals;
+    urj_tap_cable_parport_pins_t pins;
+}
+urj_tap_cable_generic_parport_params_t;
+
+#define PARAM_PINS(cable)       (&((urj_tap_cable_generic_parport_params_t *) (cable)->params)->pins)
+
+/* Fill the pins of a cable driving TMS, TDI and TCK on data bits @tms,
+ * @tdi and @tck on top of @base, with TDO on status bit @tdo; TRST and
+ * RESET follow the signals on data bits @trst and @reset, or -1 if the
+ * cable has none */
+void urj_tap_cable_generic_parport_pins (urj_cable_t *cable, int base,
+                                         int tms, int tdi, int tck, int tdo,
+                                         int trst, int reset);
+/* Batched versions of urj_tap_cable_generic_transfer and
+ * urj_tap_cable_generic_tms_sequence for the cables that have set up
+ * PARAM_PINS: all but the last bit are compiled through the pins into
+ * data register values and played by the bulk parport operations; the
+ * last one goes through the driver's get_tdo and clock to leave the
+ * signals as they always were. */
+int urj_tap_cable_generic_parport_transfer (urj_cable_t *cable, int len,
+                                            const char *in, char *out);
+int urj_tap_cable_generic_parport_tms_sequence (urj_cable_t *cable, int len,
+                                                const char *seq, char *out);
+
 #endif /* URJ_TAP_CABLE_GENERIC_H */
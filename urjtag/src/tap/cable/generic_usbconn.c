@@ -32,6 +32,7 @@
 #include <urjtag/chain.h>
 #include "generic.h"
 #include "generic_usbconn.h"
+#include "../usbconn.h"
 
 #include <urjtag/cmd.h>
 
@@ -56,6 +57,8 @@ urj_tap_cable_generic_usbconn_connect (urj_cable_t *cable,
 
     urj_tap_cable_generic_params_t *cable_params;
     urj_usbconn_t *conn = NULL;
+    const char *record = NULL;
+    const char *replay = NULL;
     int i;
 
     if (strcasecmp (cable->driver->name, "usb") != 0)
@@ -87,12 +90,26 @@ urj_tap_cable_generic_usbconn_connect (urj_cable_t *cable,
             case URJ_CABLE_PARAM_KEY_INDEX:
                 user_specified.index = params[i]->value.lu;
                 break;
+            case URJ_CABLE_PARAM_KEY_RECORD:
+                record = params[i]->value.string;
+                break;
+            case URJ_CABLE_PARAM_KEY_REPLAY:
+                replay = params[i]->value.string;
+                break;
             default:
                 // hand these to the driver connect()
                 break;
             }
         }
 
+    /* a recorded session needs no device */
+    if (replay != NULL)
+    {
+        conn = urj_tap_usbconn_replay (replay);
+        if (!conn)
+            return URJ_STATUS_FAIL;
+    }
+
     /* search usbconn driver list */
     for (i = 0; urj_tap_usbconn_drivers[i] && !conn; i++)
     {
@@ -150,16 +167,29 @@ urj_tap_cable_generic_usbconn_connect (urj_cable_t *cable,
         urj_error_reset ();
     }
 
+    if (record != NULL)
+    {
+        urj_usbconn_t *wrapped = urj_tap_usbconn_record (conn, record);
+
+        if (!wrapped)
+        {
+            conn->driver->free (conn);
+            return URJ_STATUS_FAIL;
+        }
+        conn = wrapped;
+    }
+
     cable_params = malloc (sizeof (urj_tap_cable_generic_params_t));
     if (!cable_params)
     {
         urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("malloc(%zd) fails"),
                        sizeof (urj_tap_cable_generic_params_t));
-        urj_tap_usbconn_drivers[i]->free (conn);
+        conn->driver->free (conn);
         return URJ_STATUS_FAIL;
     }
 
     cable->link.usb = conn;
+    conn->cable = cable;
     cable->params = cable_params;
     cable->chain = NULL;
 
@@ -180,6 +210,40 @@ urj_tap_cable_generic_usbconn_done (urj_cable_t *cable)
     urj_tap_usbconn_close (cable->link.usb);
 }
 
+int
+urj_tap_cable_generic_usbconn_tms_sequence (urj_cable_t *cable, int len,
+                                            const char *seq, char *out,
+                                            int (*append) (urj_cable_t *,
+                                                           int, int),
+                                            int (*execute) (urj_cable_t *),
+                                            const uint8_t *tdo)
+{
+    int i, j, k;
+
+    for (k = 0, j = 0, i = 0; i < len; i++)
+    {
+        int full = append (cable, seq[i] & URJ_CABLE_SEQ_TMS,
+                           seq[i] & URJ_CABLE_SEQ_TDI);
+
+        if (full || i == len - 1)
+        {
+            int first = j;
+
+            if (execute (cable) != URJ_STATUS_OK)
+                return -1;
+            for (; j <= i; j++)
+                if (seq[j] & URJ_CABLE_SEQ_CAPTURE)
+                {
+                    int bit = j - first;
+
+                    out[k++] = (tdo[bit >> 3] >> (bit & 7)) & 1;
+                }
+        }
+    }
+
+    return k;
+}
+
 void
 urj_tap_cable_generic_usbconn_help_ex (urj_log_level_t ll, const char *cablename,
                                        const char *ex_short, const char *ex_desc)
@@ -200,15 +264,16 @@ urj_tap_cable_generic_usbconn_help_ex (urj_log_level_t ll, const char *cablename
     }
 
     urj_log (ll,
-             _("Usage: cable %s %s %s\n"
-               "\n" "%s%s"
+             _("Usage: cable %s %s%s %s\n"
+               "\n" "%s%s%s"
                "\n"
                "Default:   vid=%x pid=%x driver=%s\n"
                "\n"),
-             cablename,
-             URJ_TAP_CABLE_GENERIC_USBCONN_HELP_SHORT, ex_short,
-             URJ_TAP_CABLE_GENERIC_USBCONN_HELP_DESC, ex_desc,
-             conn->vid, conn->pid, conn->driver);
+             cablename, URJ_TAP_CABLE_GENERIC_USBCONN_HELP_SHORT,
+             URJ_TAP_CABLE_GENERIC_USBCONN_HELP_RECORD_SHORT,
+             ex_short, URJ_TAP_CABLE_GENERIC_USBCONN_HELP_DESC,
+             URJ_TAP_CABLE_GENERIC_USBCONN_HELP_RECORD_DESC,
+             ex_desc, conn->vid, conn->pid, conn->driver);
 }
 
 void
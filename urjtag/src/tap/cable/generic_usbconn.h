@@ -39,6 +39,23 @@ int urj_tap_cable_generic_usbconn_connect (urj_cable_t *cable,
 void urj_tap_cable_generic_usbconn_done (urj_cable_t *cable);
 void urj_tap_cable_generic_usbconn_free (urj_cable_t *cable);
 
+/**
+ * tms_sequence() for the cables that buffer the TMS and TDI of many clocks
+ * and send them in one command: the whole sequence, state transitions
+ * included, goes out in as few commands as the buffer allows.
+ * @append adds one clock to the buffer and returns nonzero when it is
+ * full; @execute sends it and returns URJ_STATUS_OK once the TDO of its
+ * clocks are in @tdo, bit k being the TDO sampled at clock k, i.e. the one
+ * before it.
+ * @return as tms_sequence() in urj_cable_driver_t
+ */
+int urj_tap_cable_generic_usbconn_tms_sequence (urj_cable_t *cable, int len,
+                                                const char *seq, char *out,
+                                                int (*append) (urj_cable_t *,
+                                                               int, int),
+                                                int (*execute) (urj_cable_t *),
+                                                const uint8_t *tdo);
+
 void urj_tap_cable_generic_usbconn_help (urj_log_level_t ll, const char *cablename);
 void urj_tap_cable_generic_usbconn_help_ex (urj_log_level_t ll, const char *cablename,
                                             const char *ex_short, const char *ex_desc);
@@ -50,6 +67,11 @@ void urj_tap_cable_generic_usbconn_help_ex (urj_log_level_t ll, const char *cabl
     "DESC       Some string to match in description or serial no.\n" \
     "INTERFACE  Interface to use (0=first, 1=second, etc).\n" \
     "INDEX      Number of matching device (0=first, 1=second, etc).\n"
+#define URJ_TAP_CABLE_GENERIC_USBCONN_HELP_RECORD_SHORT \
+    "\n                [record=FILE|replay=FILE]"
+#define URJ_TAP_CABLE_GENERIC_USBCONN_HELP_RECORD_DESC \
+    "FILE       Trace of the USB traffic to write, or to play back\n" \
+    "           instead of using a device.\n"
 
 #define URJ_DECLARE_USBCONN_CABLE(vid, pid, driver, name, cable) \
 const urj_usbconn_cable_t urj_tap_cable_usbconn_##cable = { name, NULL, driver, vid, pid };
@@ -0,0 +1,422 @@
+/*
+ * $Id$
+ *
+ * GPIO JTAG Cable Driver on top of the GPIO character device
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ * Unlike the sysfs based "gpio" cable, all four lines are requested at
+ * once from /dev/gpiochipN through the v2 line API, so TCK, TMS and TDI
+ * change together in one GPIO_V2_LINE_SET_VALUES_IOCTL and a bit takes
+ * two ioctls, plus one to sample TDO. It works with the gpio-sim and
+ * gpio-mockup test drivers of the kernel as well.
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+#include <urjtag/cable.h>
+#include <urjtag/chain.h>
+#include <urjtag/cmd.h>
+
+#include "generic.h"
+
+/* lines of the request, in this order */
+enum {
+    GPIO_TCK = 0,
+    GPIO_TMS,
+    GPIO_TDI,
+    GPIO_TDO,
+    GPIO_REQUIRED
+};
+
+#define BIT_TCK (1 << GPIO_TCK)
+#define BIT_TMS (1 << GPIO_TMS)
+#define BIT_TDI (1 << GPIO_TDI)
+#define BIT_TDO (1 << GPIO_TDO)
+
+typedef struct {
+    char        *chip;
+    unsigned int offsets[GPIO_REQUIRED];
+    int          signals;
+    int          fd;            /* line request, -1 if not open */
+    uint64_t     lastout;       /* BIT_TCK | BIT_TMS | BIT_TDI */
+} gpiochip_params_t;
+
+static int
+gpiochip_set (gpiochip_params_t *p, uint64_t bits)
+{
+    struct gpio_v2_line_values v;
+
+    v.bits = bits;
+    v.mask = BIT_TCK | BIT_TMS | BIT_TDI;
+    if (ioctl (p->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &v) < 0)
+    {
+        urj_error_IO_set (_("%s: cannot set GPIO lines"), p->chip);
+        return URJ_STATUS_FAIL;
+    }
+    p->lastout = bits;
+
+    return URJ_STATUS_OK;
+}
+
+static int
+gpiochip_get_tdo_value (gpiochip_params_t *p)
+{
+    struct gpio_v2_line_values v;
+
+    v.bits = 0;
+    v.mask = BIT_TDO;
+    if (ioctl (p->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &v) < 0)
+    {
+        urj_error_IO_set (_("%s: cannot get GPIO lines"), p->chip);
+        return -1;
+    }
+
+    return (v.bits & BIT_TDO) ? 1 : 0;
+}
+
+static int
+gpiochip_open (urj_cable_t *cable)
+{
+    gpiochip_params_t *p = cable->params;
+    struct gpio_v2_line_request req;
+    int fd, i;
+
+    fd = open (p->chip, O_RDWR);
+    if (fd < 0)
+    {
+        urj_error_IO_set (_("%s: cannot open GPIO chip"), p->chip);
+        return URJ_STATUS_FAIL;
+    }
+
+    memset (&req, 0, sizeof req);
+    for (i = 0; i < GPIO_REQUIRED; i++)
+        req.offsets[i] = p->offsets[i];
+    req.num_lines = GPIO_REQUIRED;
+    strncpy (req.consumer, "urjtag", sizeof req.consumer - 1);
+
+    /* TCK, TMS and TDI are outputs, initially low; TDO is an input */
+    req.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+    req.config.num_attrs = 2;
+    req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+    req.config.attrs[0].attr.flags = GPIO_V2_LINE_FLAG_INPUT;
+    req.config.attrs[0].mask = BIT_TDO;
+    req.config.attrs[1].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+    req.config.attrs[1].attr.values = 0;
+    req.config.attrs[1].mask = BIT_TCK | BIT_TMS | BIT_TDI;
+
+    if (ioctl (fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0)
+    {
+        urj_error_IO_set (_("%s: cannot request GPIO lines %u,%u,%u,%u"),
+                          p->chip, p->offsets[GPIO_TCK], p->offsets[GPIO_TMS],
+                          p->offsets[GPIO_TDI], p->offsets[GPIO_TDO]);
+        close (fd);
+        return URJ_STATUS_FAIL;
+    }
+    /* the request lives on without the chip */
+    close (fd);
+
+    p->fd = req.fd;
+    p->lastout = 0;
+
+    return URJ_STATUS_OK;
+}
+
+static void
+gpiochip_close (urj_cable_t *cable)
+{
+    gpiochip_params_t *p = cable->params;
+
+    if (p->fd >= 0)
+        close (p->fd);
+    p->fd = -1;
+}
+
+static void
+gpiochip_help (urj_log_level_t ll, const char *cablename)
+{
+    urj_log (ll,
+        _("Usage: cable %s chip=<gpiochip> tdi=<line> tdo=<line> "
+        "tck=<line> tms=<line>\n"
+        "\n"
+        "gpiochip   GPIO chip device (e.g. /dev/gpiochip0)\n"
+        "line       line offset within the chip\n"
+        "\n"), cablename);
+}
+
+static int
+gpiochip_connect (urj_cable_t *cable, const urj_param_t *params[])
+{
+    gpiochip_params_t *cable_params;
+    const char *chip = NULL;
+    int i;
+
+    cable_params = calloc (1, sizeof (*cable_params));
+    if (!cable_params)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd) fails"),
+                       sizeof (*cable_params));
+        return URJ_STATUS_FAIL;
+    }
+
+    for (i = 0; i < GPIO_REQUIRED; i++)
+        cable_params->offsets[i] = GPIO_V2_LINES_MAX;
+    if (params != NULL)
+        /* parse arguments beyond the cable name */
+        for (i = 0; params[i] != NULL; i++)
+        {
+            switch (params[i]->key)
+            {
+            case URJ_CABLE_PARAM_KEY_CHIP:
+                chip = params[i]->value.string;
+                break;
+            case URJ_CABLE_PARAM_KEY_TDI:
+                cable_params->offsets[GPIO_TDI] = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_TDO:
+                cable_params->offsets[GPIO_TDO] = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_TMS:
+                cable_params->offsets[GPIO_TMS] = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_TCK:
+                cable_params->offsets[GPIO_TCK] = params[i]->value.lu;
+                break;
+            default:
+                break;
+            }
+        }
+
+    for (i = 0; i < GPIO_REQUIRED; i++)
+        if (cable_params->offsets[i] >= GPIO_V2_LINES_MAX)
+            break;
+    if (chip == NULL || i < GPIO_REQUIRED)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX, _("missing GPIO chip or lines"));
+        gpiochip_help (URJ_LOG_LEVEL_ERROR, "gpiochip");
+        free (cable_params);
+        return URJ_STATUS_FAIL;
+    }
+
+    cable_params->chip = strdup (chip);
+    if (cable_params->chip == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("strdup(%s) fails"), chip);
+        free (cable_params);
+        return URJ_STATUS_FAIL;
+    }
+    cable_params->fd = -1;
+
+    cable->params = cable_params;
+    cable->chain = NULL;
+
+    return URJ_STATUS_OK;
+}
+
+static void
+gpiochip_disconnect (urj_cable_t *cable)
+{
+    urj_tap_chain_disconnect (cable->chain);
+    gpiochip_close (cable);
+}
+
+static void
+gpiochip_cable_free (urj_cable_t *cable)
+{
+    gpiochip_params_t *p = cable->params;
+
+    free (p->chip);
+    free (p);
+    free (cable);
+}
+
+static int
+gpiochip_init (urj_cable_t *cable)
+{
+    gpiochip_params_t *p = cable->params;
+
+    if (gpiochip_open (cable) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    p->signals = URJ_POD_CS_TRST;
+
+    return URJ_STATUS_OK;
+}
+
+static void
+gpiochip_done (urj_cable_t *cable)
+{
+    gpiochip_close (cable);
+}
+
+static void
+gpiochip_clock (urj_cable_t *cable, int tms, int tdi, int n)
+{
+    gpiochip_params_t *p = cable->params;
+    uint64_t bits;
+    int i;
+
+    bits = (tms ? BIT_TMS : 0) | (tdi ? BIT_TDI : 0);
+
+    for (i = 0; i < n; i++)
+    {
+        gpiochip_set (p, bits);
+        urj_tap_cable_wait (cable);
+        gpiochip_set (p, bits | BIT_TCK);
+        urj_tap_cable_wait (cable);
+    }
+}
+
+static int
+gpiochip_get_tdo (urj_cable_t *cable)
+{
+    gpiochip_params_t *p = cable->params;
+
+    gpiochip_set (p, 0);
+    urj_tap_cable_wait (cable);
+
+    return gpiochip_get_tdo_value (p);
+}
+
+/* Per bit: TCK low with the new TMS and TDI, sample TDO, TCK high */
+static int
+gpiochip_transfer (urj_cable_t *cable, int len, const char *in, char *out)
+{
+    gpiochip_params_t *p = cable->params;
+    uint64_t bits;
+    int i, tdo;
+
+    for (i = 0; i < len; i++)
+    {
+        bits = in[i] ? BIT_TDI : 0;
+        if (gpiochip_set (p, bits) != URJ_STATUS_OK)
+            return -1;
+        urj_tap_cable_wait (cable);
+        if (out)
+        {
+            tdo = gpiochip_get_tdo_value (p);
+            if (tdo < 0)
+                return -1;
+            out[i] = tdo;
+        }
+        if (gpiochip_set (p, bits | BIT_TCK) != URJ_STATUS_OK)
+            return -1;
+        urj_tap_cable_wait (cable);
+    }
+
+    return i;
+}
+
+static int
+gpiochip_tms_sequence (urj_cable_t *cable, int len, const char *seq,
+                       char *out)
+{
+    gpiochip_params_t *p = cable->params;
+    uint64_t bits;
+    int i, k = 0, tdo;
+
+    for (i = 0; i < len; i++)
+    {
+        bits = ((seq[i] & URJ_CABLE_SEQ_TMS) ? BIT_TMS : 0)
+            | ((seq[i] & URJ_CABLE_SEQ_TDI) ? BIT_TDI : 0);
+        if (gpiochip_set (p, bits) != URJ_STATUS_OK)
+            return -1;
+        urj_tap_cable_wait (cable);
+        if (seq[i] & URJ_CABLE_SEQ_CAPTURE)
+        {
+            tdo = gpiochip_get_tdo_value (p);
+            if (tdo < 0)
+                return -1;
+            out[k++] = tdo;
+        }
+        if (gpiochip_set (p, bits | BIT_TCK) != URJ_STATUS_OK)
+            return -1;
+        urj_tap_cable_wait (cable);
+    }
+
+    return k;
+}
+
+static int
+gpiochip_current_signals (urj_cable_t *cable)
+{
+    gpiochip_params_t *p = cable->params;
+
+    int sigs = p->signals & ~(URJ_POD_CS_TMS | URJ_POD_CS_TDI | URJ_POD_CS_TCK);
+
+    if (p->lastout & BIT_TCK) sigs |= URJ_POD_CS_TCK;
+    if (p->lastout & BIT_TDI) sigs |= URJ_POD_CS_TDI;
+    if (p->lastout & BIT_TMS) sigs |= URJ_POD_CS_TMS;
+
+    return sigs;
+}
+
+static int
+gpiochip_set_signal (urj_cable_t *cable, int mask, int val)
+{
+    int prev_sigs = gpiochip_current_signals (cable);
+    gpiochip_params_t *p = cable->params;
+    uint64_t bits = p->lastout;
+
+    mask &= (URJ_POD_CS_TDI | URJ_POD_CS_TCK | URJ_POD_CS_TMS); // only these can be modified
+
+    if (mask & URJ_POD_CS_TMS)
+        bits = (val & URJ_POD_CS_TMS) ? bits | BIT_TMS : bits & ~BIT_TMS;
+    if (mask & URJ_POD_CS_TDI)
+        bits = (val & URJ_POD_CS_TDI) ? bits | BIT_TDI : bits & ~BIT_TDI;
+    if (mask & URJ_POD_CS_TCK)
+        bits = (val & URJ_POD_CS_TCK) ? bits | BIT_TCK : bits & ~BIT_TCK;
+    if (mask != 0)
+        gpiochip_set (p, bits);
+
+    return prev_sigs;
+}
+
+static int
+gpiochip_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig)
+{
+    return (gpiochip_current_signals (cable) & sig) ? 1 : 0;
+}
+
+const urj_cable_driver_t urj_tap_cable_gpiochip_driver = {
+    "gpiochip",
+    N_("GPIO JTAG Chain on a GPIO character device"),
+    URJ_CABLE_DEVICE_OTHER,
+    { .other = gpiochip_connect, },
+    gpiochip_disconnect,
+    gpiochip_cable_free,
+    gpiochip_init,
+    gpiochip_done,
+    urj_tap_cable_generic_set_frequency,
+    gpiochip_clock,
+    gpiochip_get_tdo,
+    gpiochip_transfer,
+    gpiochip_set_signal,
+    gpiochip_get_signal,
+    urj_tap_cable_generic_flush_one_by_one,
+    gpiochip_help,
+    0,
+    gpiochip_tms_sequence
+};
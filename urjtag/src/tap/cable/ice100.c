@@ -39,7 +39,6 @@
 #include "generic_usbconn.h"
 
 #include <urjtag/usbconn.h>
-#include "usbconn/libusb.h"
 
 /*
  * Internal Structures
@@ -188,34 +187,33 @@ static const uint32_t avail_freqs[MAX_FREQ] = { 5000000, 10000000, 17000000, 250
  * Internal Macros
  */
 
-#define adi_usb_read_or_ret(p, buf, len) \
+#define adi_usb_read_or_ret(conn, buf, len) \
 do { \
-    int __ret, __actual, __size = (len); \
-    __ret = libusb_bulk_transfer (((urj_usbconn_libusb_param_t *)p)->handle, \
-                                  cable_params->r_ep | LIBUSB_ENDPOINT_IN, \
-                                  (unsigned char *)(buf), __size, \
-                                  &__actual, cable_params->r_timeout); \
-    if (__ret || __actual != __size) \
+    int __actual, __size = (len); \
+    __actual = urj_tap_usbconn_bulk ((conn), \
+                                     cable_params->r_ep | URJ_USBCONN_ENDPOINT_IN, \
+                                     (uint8_t *)(buf), __size, \
+                                     cable_params->r_timeout); \
+    if (__actual != __size) \
     { \
-        urj_error_IO_set (_("%s: unable to read from usb to " #buf ": %i;" \
+        urj_error_IO_set (_("%s: unable to read from usb to " #buf ": " \
                             "wanted %i bytes but only received %i bytes"), \
-                          __func__, __ret, __size, __actual); \
+                          __func__, __size, __actual); \
         return URJ_STATUS_FAIL; \
     } \
 } while (0)
 
-#define adi_usb_write_or_ret(p, buf, len) \
+#define adi_usb_write_or_ret(conn, buf, len) \
 do { \
-    int __ret, __actual, __size = (len); \
-    __ret = libusb_bulk_transfer (((urj_usbconn_libusb_param_t *)p)->handle, \
-                                  cable_params->wr_ep, \
-                                  (unsigned char *)(buf), __size, \
-                                  &__actual, cable_params->wr_timeout); \
-    if (__ret || __actual != __size) \
+    int __actual, __size = (len); \
+    __actual = urj_tap_usbconn_bulk ((conn), cable_params->wr_ep, \
+                                     (uint8_t *)(buf), __size, \
+                                     cable_params->wr_timeout); \
+    if (__actual != __size) \
     { \
-        urj_error_IO_set (_("%s: unable to write from " #buf " to usb: %i;" \
+        urj_error_IO_set (_("%s: unable to write from " #buf " to usb: " \
                             "wanted %i bytes but only wrote %i bytes"), \
-                          __func__, __ret, __size, __actual); \
+                          __func__, __size, __actual); \
         return URJ_STATUS_FAIL; \
     } \
 } while (0)
@@ -626,9 +624,9 @@ ice_send_flash_data (urj_cable_t *cable, struct flash_block *p, uint16_t crc)
             usb_cmd_blk.command = HOST_REQUEST_TX_DATA;
             usb_cmd_blk.count = count + 16;
             usb_cmd_blk.buffer = 0;
-            adi_usb_write_or_ret (cable->link.usb->params, &usb_cmd_blk, sizeof (usb_cmd_blk));
+            adi_usb_write_or_ret (cable->link.usb, &usb_cmd_blk, sizeof (usb_cmd_blk));
 
-            adi_usb_write_or_ret (cable->link.usb->params, buffer, usb_cmd_blk.count);
+            adi_usb_write_or_ret (cable->link.usb, buffer, usb_cmd_blk.count);
 
             first = 0;
 
@@ -656,9 +654,9 @@ ice_firmware_crc (urj_cable_t *cable, uint16_t *p)
     usb_cmd_blk.count = 2;
     usb_cmd_blk.buffer = 0;
 
-    adi_usb_write_or_ret (cable->link.usb->params, &usb_cmd_blk, sizeof (usb_cmd_blk));
+    adi_usb_write_or_ret (cable->link.usb, &usb_cmd_blk, sizeof (usb_cmd_blk));
 
-    adi_usb_read_or_ret (cable->link.usb->params, p, sizeof (*p));
+    adi_usb_read_or_ret (cable->link.usb, p, sizeof (*p));
 
     return URJ_STATUS_OK;
 }
@@ -1205,8 +1203,6 @@ static void adi_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                 break;
             case URJ_TAP_CABLE_TRANSFER:
                 /* set up the get data */
-                free (todo_data->arg.transfer.in);
-                todo_data->arg.transfer.in = NULL;
                 if ((todo_data->arg.transfer.out != NULL) && (tdo_ptr != NULL))
                 {
                     int32_t k = urj_tap_cable_add_queue_item (cable, &cable->done);
@@ -1600,7 +1596,7 @@ static uint32_t do_single_reg_value (urj_cable_t *cable, uint8_t reg, int32_t r_
     usb_cmd_blk.count = size;
     usb_cmd_blk.buffer = 0;
 
-    adi_usb_write_or_ret (cable->link.usb->params, &usb_cmd_blk, sizeof (usb_cmd_blk));
+    adi_usb_write_or_ret (cable->link.usb, &usb_cmd_blk, sizeof (usb_cmd_blk));
     i = 0;
 
     /* send HOST_SET_SINGLE_REG command */
@@ -1613,10 +1609,10 @@ static uint32_t do_single_reg_value (urj_cable_t *cable, uint8_t reg, int32_t r_
         cmd_buffer.l[i / 4] = data;
     }
 
-    adi_usb_write_or_ret (cable->link.usb->params, cmd_buffer.b, size);
+    adi_usb_write_or_ret (cable->link.usb, cmd_buffer.b, size);
 
     if (r_data)
-        adi_usb_read_or_ret (cable->link.usb->params, &count, sizeof (count));
+        adi_usb_read_or_ret (cable->link.usb, &count, sizeof (count));
 
     return count;
 }
@@ -1643,7 +1639,7 @@ static uint16_t do_host_cmd (urj_cable_t *cable, uint8_t cmd, uint8_t param, int
     usb_cmd_blk.count = 4;
     usb_cmd_blk.buffer = 0;
 
-    adi_usb_write_or_ret (cable->link.usb->params, &usb_cmd_blk, sizeof (usb_cmd_blk));
+    adi_usb_write_or_ret (cable->link.usb, &usb_cmd_blk, sizeof (usb_cmd_blk));
     i = 0;
 
     /* send command */
@@ -1652,7 +1648,7 @@ static uint16_t do_host_cmd (urj_cable_t *cable, uint8_t cmd, uint8_t param, int
     cmd_buffer.b[i++] = cmd;
     cmd_buffer.b[i] = 0;
 
-    adi_usb_write_or_ret (cable->link.usb->params, cmd_buffer.b, size);
+    adi_usb_write_or_ret (cable->link.usb, cmd_buffer.b, size);
 
     if (r_data)
     {
@@ -1660,9 +1656,9 @@ static uint16_t do_host_cmd (urj_cable_t *cable, uint8_t cmd, uint8_t param, int
         usb_cmd_blk.count = 2;
         usb_cmd_blk.buffer = 0;
 
-        adi_usb_write_or_ret (cable->link.usb->params, &usb_cmd_blk, sizeof (usb_cmd_blk));
+        adi_usb_write_or_ret (cable->link.usb, &usb_cmd_blk, sizeof (usb_cmd_blk));
 
-        adi_usb_read_or_ret (cable->link.usb->params, &results, sizeof (results));
+        adi_usb_read_or_ret (cable->link.usb, &results, sizeof (results));
     }
 
     return results;
@@ -1810,7 +1806,7 @@ static int do_rawscan (urj_cable_t *cable, uint8_t firstpkt, uint8_t lastpkt,
     usb_cmd_blk.buffer = 0;
 
     /* first send Xmit request with the count of what will be sent */
-    adi_usb_write_or_ret (cable->link.usb->params, &usb_cmd_blk, sizeof (usb_cmd_blk));
+    adi_usb_write_or_ret (cable->link.usb, &usb_cmd_blk, sizeof (usb_cmd_blk));
     i = 0;
 
     /* send HOST_DO_SELECTIVE_RAW_SCAN command */
@@ -1841,7 +1837,7 @@ static int do_rawscan (urj_cable_t *cable, uint8_t firstpkt, uint8_t lastpkt,
     /* only Ice emulators use this */
     memcpy (raw_buf + i + 4, &dof_start, 4);
 
-    adi_usb_write_or_ret (cable->link.usb->params, raw_buf, size);
+    adi_usb_write_or_ret (cable->link.usb, raw_buf, size);
 
     if (lastpkt)
     {
@@ -1854,7 +1850,7 @@ static int do_rawscan (urj_cable_t *cable, uint8_t firstpkt, uint8_t lastpkt,
             cur_rd_bytes = ((rd_bytes_left - tot_bytes_rd) > cable_params->r_buf_sz) ?
                 cable_params->r_buf_sz : (rd_bytes_left - tot_bytes_rd);
 
-            adi_usb_read_or_ret (cable->link.usb->params, out + tot_bytes_rd, cur_rd_bytes);
+            adi_usb_read_or_ret (cable->link.usb, out + tot_bytes_rd, cur_rd_bytes);
             tot_bytes_rd += cur_rd_bytes;
         }
 
@@ -1899,7 +1895,7 @@ const urj_cable_driver_t urj_tap_cable_ice100B_driver = {
     ice_get_sig,
     adi_flush,
     ice_cable_help,
-    URJ_CABLE_QUIRK_ONESHOT
+    URJ_CABLE_QUIRK_ONESHOT | URJ_CABLE_QUIRK_NO_TMS_SEQUENCE
 };
 URJ_DECLARE_USBCONN_CABLE(0x064B, 0x1225, "libusb", "ICE-100B", ice100B)
 URJ_DECLARE_USBCONN_CABLE(0x064B, 0x0225, "libusb", "ICE-100B", ice100Bw)
@@ -131,6 +131,25 @@ jim_cable_get_tdo (urj_cable_t *cable)
     return urj_jim_get_tdo (jcp->s);
 }
 
+static int
+jim_cable_tms_sequence (urj_cable_t *cable, int len, const char *seq,
+                        char *out)
+{
+    int i, k = 0;
+    jim_cable_params_t *jcp = cable->params;
+
+    for (i = 0; i < len; i++)
+    {
+        if (seq[i] & URJ_CABLE_SEQ_CAPTURE)
+            out[k++] = urj_jim_get_tdo (jcp->s);
+        urj_jim_tck_rise (jcp->s, (seq[i] & URJ_CABLE_SEQ_TMS) ? 1 : 0,
+                          seq[i] & URJ_CABLE_SEQ_TDI);
+        urj_jim_tck_fall (jcp->s);
+    }
+
+    return k;
+}
+
 static int
 jim_cable_get_trst (urj_cable_t *cable, urj_pod_sigsel_t sig)
 {
@@ -172,5 +191,7 @@ const urj_cable_driver_t urj_tap_cable_jim_driver = {
     jim_cable_set_trst,
     jim_cable_get_trst,
     urj_tap_cable_generic_flush_using_transfer,
-    jim_cable_help
+    jim_cable_help,
+    0,
+    jim_cable_tms_sequence
 };
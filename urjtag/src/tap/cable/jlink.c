@@ -52,14 +52,19 @@
 
 #define JLINK_USB_TIMEOUT 100
 
-#define JLINK_IN_BUFFER_SIZE  2064
-#define JLINK_OUT_BUFFER_SIZE 2064
+/* Bytes of TMS and of TDI in one JLINK_TAP_SEQUENCE_COMMAND; the probe
+ * buffers up to 2048 bytes of each */
+#define JLINK_TAP_BUFFER_SIZE 2048
 
-/* We use the maximal value observed */
-#define JLINK_TAP_BUFFER_SIZE 390
+/* A reply whose length is a multiple of the USB packet size is followed
+ * by one extra byte */
+#define JLINK_IN_BUFFER_SIZE  (JLINK_TAP_BUFFER_SIZE + 1)
+#define JLINK_OUT_BUFFER_SIZE (3 + 2 * JLINK_TAP_BUFFER_SIZE)
 
 typedef struct
 {
+    int signals;                /* see urj_tap_cable_generic_params_t */
+
     /* Global USB buffers */
     unsigned char usb_in_buffer[JLINK_IN_BUFFER_SIZE];
     unsigned char usb_out_buffer[JLINK_OUT_BUFFER_SIZE];
@@ -69,6 +74,7 @@ typedef struct
     uint8_t tdi_buffer[JLINK_TAP_BUFFER_SIZE];
 
     int last_tdo;
+    int speed;                  /* TCK frequency in kHz */
 }
 jlink_usbconn_data_t;
 
@@ -91,23 +97,24 @@ jlink_usbconn_data_t;
 #define JLINK_MAX_SPEED 12000
 
 /* Queue command functions */
-static void urj_tap_cable_jlink_reset (urj_usbconn_libusb_param_t *params,
+static void urj_tap_cable_jlink_reset (urj_cable_t *cable,
                                        int trst, int srst);
-static void jlink_simple_command (urj_usbconn_libusb_param_t *params,
+static void jlink_simple_command (urj_cable_t *cable,
                                   uint8_t command);
 
 
 /* J-Link tap buffer functions */
 static void jlink_tap_init (jlink_usbconn_data_t *data);
-static int jlink_tap_execute (urj_usbconn_libusb_param_t *params);
+static int jlink_tap_execute (urj_cable_t *cable);
 static void jlink_tap_append_step (jlink_usbconn_data_t *data, int, int);
 
 /* Jlink lowlevel functions */
-static int jlink_usb_message (urj_usbconn_libusb_param_t *params, int, int);
+static int jlink_usb_message (urj_cable_t *cable, int, int,
+                              int);
 /** @return number of bytes written; -1 on error */
-static int jlink_usb_write (urj_usbconn_libusb_param_t *params, unsigned int);
+static int jlink_usb_write (urj_cable_t *cable, unsigned int);
 /** @return number of bytes read; -1 on error */
-static int jlink_usb_read (urj_usbconn_libusb_param_t *params);
+static int jlink_usb_read (urj_cable_t *cable, int timeout);
 
 static void jlink_debug_buffer (unsigned char *buffer, int length);
 
@@ -120,7 +127,7 @@ void urj_tap_cable_jlink_set_frequency (urj_cable_t *cable,
 /* J-Link tap functions */
 
 void
-urj_tap_cable_jlink_reset (urj_usbconn_libusb_param_t *params, int trst,
+urj_tap_cable_jlink_reset (urj_cable_t *cable, int trst,
                            int srst)
 {
     urj_log (URJ_LOG_LEVEL_DETAIL, "trst: %i, srst: %i\n", trst, srst);
@@ -128,34 +135,34 @@ urj_tap_cable_jlink_reset (urj_usbconn_libusb_param_t *params, int trst,
     /* Signals are active low */
     if (trst == 0)
     {
-        jlink_simple_command (params, JLINK_SET_TRST_HIGH_COMMAND);
+        jlink_simple_command (cable, JLINK_SET_TRST_HIGH_COMMAND);
     }
     else if (trst == 1)
     {
-        jlink_simple_command (params, JLINK_SET_TRST_LOW_COMMAND);
+        jlink_simple_command (cable, JLINK_SET_TRST_LOW_COMMAND);
     }
 
     if (srst == 0)
     {
-        jlink_simple_command (params, JLINK_SET_SRST_HIGH_COMMAND);
+        jlink_simple_command (cable, JLINK_SET_SRST_HIGH_COMMAND);
     }
     else if (srst == 1)
     {
-        jlink_simple_command (params, JLINK_SET_SRST_LOW_COMMAND);
+        jlink_simple_command (cable, JLINK_SET_SRST_LOW_COMMAND);
     }
 }
 
 
 static void
-jlink_simple_command (urj_usbconn_libusb_param_t *params, uint8_t command)
+jlink_simple_command (urj_cable_t *cable, uint8_t command)
 {
     int result;
-    jlink_usbconn_data_t *data = params->data;
+    jlink_usbconn_data_t *data = cable->params;
 
     urj_log (URJ_LOG_LEVEL_DETAIL, "simple_command: 0x%02x\n", command);
 
     data->usb_out_buffer[0] = command;
-    result = jlink_usb_write (params, 1);
+    result = jlink_usb_write (cable, 1);
 
     if (result != 1)
     {
@@ -165,14 +172,14 @@ jlink_simple_command (urj_usbconn_libusb_param_t *params, uint8_t command)
 }
 
 static int
-jlink_get_status (urj_usbconn_libusb_param_t *params)
+jlink_get_status (urj_cable_t *cable)
 {
     int result;
-    jlink_usbconn_data_t *data = params->data;
+    jlink_usbconn_data_t *data = cable->params;
 
-    jlink_simple_command (params, 0x07);
+    jlink_simple_command (cable, 0x07);
 
-    result = jlink_usb_read (params);
+    result = jlink_usb_read (cable, JLINK_USB_TIMEOUT);
 
     if (result == 8)
     {
@@ -245,9 +252,9 @@ jlink_tap_append_step (jlink_usbconn_data_t *data, int tms, int tdi)
 /* Send a tap sequence to the device, and receive the answer */
 
 static int
-jlink_tap_execute (urj_usbconn_libusb_param_t *params)
+jlink_tap_execute (urj_cable_t *cable)
 {
-    jlink_usbconn_data_t *data = params->data;
+    jlink_usbconn_data_t *data = cable->params;
     int byte_length;
     int tms_offset;
     int tdi_offset;
@@ -273,7 +280,10 @@ jlink_tap_execute (urj_usbconn_libusb_param_t *params)
             data->usb_out_buffer[tdi_offset + i] = data->tdi_buffer[i];
         }
 
-        result = jlink_usb_message (params, 3 + 2 * byte_length, byte_length);
+        /* at low frequencies the sequence takes a while to clock out */
+        result = jlink_usb_message (cable, 3 + 2 * byte_length, byte_length,
+                                    JLINK_USB_TIMEOUT
+                                    + data->tap_length / data->speed);
 
         if (result == byte_length)
         {
@@ -289,6 +299,7 @@ jlink_tap_execute (urj_usbconn_libusb_param_t *params)
                      "jlink_tap_execute, wrong result %d, expected %d\n",
                      result, byte_length);
 
+            jlink_tap_init (data);
             return -2;
         }
 
@@ -301,18 +312,19 @@ jlink_tap_execute (urj_usbconn_libusb_param_t *params)
 
 /* Send a message and receive the reply. */
 static int
-jlink_usb_message (urj_usbconn_libusb_param_t *params, int out_length,
-                   int in_length)
+jlink_usb_message (urj_cable_t *cable, int out_length,
+                   int in_length, int timeout)
 {
     int result;
 
-    result = jlink_usb_write (params, out_length);
+    result = jlink_usb_write (cable, out_length);
     if (result == out_length)
     {
-        result = jlink_usb_read (params);
-        if (result == in_length)
+        result = jlink_usb_read (cable, timeout);
+        if (result == in_length
+            || (result == in_length + 1 && in_length % 64 == 0))
         {
-            return result;
+            return in_length;
         }
         else
         {
@@ -337,12 +349,10 @@ jlink_usb_message (urj_usbconn_libusb_param_t *params, int out_length,
 
 /* Write data from out_buffer to USB. */
 static int
-jlink_usb_write (urj_usbconn_libusb_param_t *params, unsigned int out_length)
+jlink_usb_write (urj_cable_t *cable, unsigned int out_length)
 {
-    int result, actual;
-    jlink_usbconn_data_t *data;
-
-    data = params->data;
+    int result;
+    jlink_usbconn_data_t *data = cable->params;
 
     if (out_length > JLINK_OUT_BUFFER_SIZE)
     {
@@ -353,42 +363,36 @@ jlink_usb_write (urj_usbconn_libusb_param_t *params, unsigned int out_length)
         return -1;
     }
 
-    result = libusb_bulk_transfer (params->handle,
-                                   JLINK_WRITE_ENDPOINT,
-                                   data->usb_out_buffer,
-                                   out_length, &actual,
+    result = urj_tap_usbconn_bulk (cable->link.usb, JLINK_WRITE_ENDPOINT,
+                                   data->usb_out_buffer, out_length,
                                    JLINK_USB_TIMEOUT);
 
     urj_log (URJ_LOG_LEVEL_DETAIL,
-             "jlink_usb_write, out_length = %d, result = %d, actual = %d\n",
-             out_length, result, actual);
+             "jlink_usb_write, out_length = %d, result = %d\n",
+             out_length, result);
     jlink_debug_buffer (data->usb_out_buffer, out_length);
 
-    return actual;
+    return result;
 }
 
 /* ---------------------------------------------------------------------- */
 
 /* Read data from USB into in_buffer. */
 static int
-jlink_usb_read (urj_usbconn_libusb_param_t *params)
+jlink_usb_read (urj_cable_t *cable, int timeout)
 {
-    jlink_usbconn_data_t *data = params->data;
+    jlink_usbconn_data_t *data = cable->params;
+    int result;
 
-    int result, actual;
+    result = urj_tap_usbconn_bulk (cable->link.usb, JLINK_READ_ENDPOINT,
+                                   data->usb_in_buffer, JLINK_IN_BUFFER_SIZE,
+                                   timeout);
 
-    result = libusb_bulk_transfer (params->handle,
-                                   JLINK_READ_ENDPOINT,
-                                   data->usb_in_buffer,
-                                   JLINK_IN_BUFFER_SIZE,
-                                   &actual,
-                                   JLINK_USB_TIMEOUT);
+    urj_log (URJ_LOG_LEVEL_DETAIL, "jlink_usb_read, result = %d\n", result);
+    if (result > 0)
+        jlink_debug_buffer (data->usb_in_buffer, result);
 
-    urj_log (URJ_LOG_LEVEL_DETAIL, "jlink_usb_read, result = %d, actual = %d\n",
-             result, actual);
-    jlink_debug_buffer (data->usb_in_buffer, actual);
-
-    return actual;
+    return result;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -418,28 +422,49 @@ jlink_debug_buffer (unsigned char *buffer, int length)
 /* ---------------------------------------------------------------------- */
 
 static int
-jlink_init (urj_cable_t *cable)
+jlink_connect (urj_cable_t *cable, const urj_param_t *params[])
 {
-    int result;
-    urj_usbconn_libusb_param_t *params;
     jlink_usbconn_data_t *data;
 
-    params = cable->link.usb->params;
-    params->data = malloc (sizeof (jlink_usbconn_data_t));
-    if (params->data == NULL)
+    if (urj_tap_cable_generic_usbconn_connect (cable, params) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    data = calloc (1, sizeof (*data));
+    if (data == NULL)
     {
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-                       sizeof (jlink_usbconn_data_t));
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd) fails"),
+                       sizeof (*data));
+        /* see ft2232_connect(): the caller frees the cable itself */
+        cable->link.usb->driver->free (cable->link.usb);
+        free (cable->params);
         return URJ_STATUS_FAIL;
     }
-    data = params->data;
+
+    /* kept in the cable rather than the USB connection, which may be a
+     * recording or a replay */
+    free (cable->params);
+    cable->params = data;
+
+    return URJ_STATUS_OK;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int
+jlink_init (urj_cable_t *cable)
+{
+    int result;
+    jlink_usbconn_data_t *data = cable->params;
+
+    data->last_tdo = 0;
+    data->speed = 1;
 
     if (urj_tap_usbconn_open (cable->link.usb) != URJ_STATUS_OK)
         return URJ_STATUS_FAIL;
 
     jlink_tap_init (data);
 
-    result = jlink_usb_read (params);
+    result = jlink_usb_read (cable, JLINK_USB_TIMEOUT);
 
     if (result != 2 || data->usb_in_buffer[0] != 0x07
         || data->usb_in_buffer[1] != 0x00)
@@ -447,15 +472,18 @@ jlink_init (urj_cable_t *cable)
         urj_log (URJ_LOG_LEVEL_NORMAL,
                  "J-Link initial read failed, don't worry (result=%d)\n",
                  result);
+        urj_error_reset ();
     }
 
-    result = jlink_get_status (params);
+    result = jlink_get_status (cable);
     if (result < 0)
     {
         // retain error state
         urj_log (URJ_LOG_LEVEL_ERROR,
                  "Resetting J-Link. Please retry the cable command.\n");
-        libusb_reset_device (params->handle);
+        if (strcmp (cable->link.usb->driver->type, "libusb") == 0)
+            libusb_reset_device (((urj_usbconn_libusb_param_t *)
+                                  cable->link.usb->params)->handle);
         return URJ_STATUS_FAIL;
     }
 
@@ -463,32 +491,19 @@ jlink_init (urj_cable_t *cable)
 
     urj_tap_cable_jlink_set_frequency (cable, 4E6);
 
-    urj_tap_cable_jlink_reset (params, 0, 0);
+    urj_tap_cable_jlink_reset (cable, 0, 0);
 
     return URJ_STATUS_OK;
 }
 
 /* ---------------------------------------------------------------------- */
 
-static void
-jlink_free (urj_cable_t *cable)
-{
-    jlink_usbconn_data_t *data;
-    data = ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->data;
-    free (data);
-
-    urj_tap_cable_generic_usbconn_free (cable);
-}
-
-/* ---------------------------------------------------------------------- */
-
 void
 urj_tap_cable_jlink_set_frequency (urj_cable_t *cable, uint32_t frequency)
 {
     int result;
     int speed = frequency / 1E3;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    jlink_usbconn_data_t *data = params->data;
+    jlink_usbconn_data_t *data = cable->params;
 
     if (1 <= speed && speed <= JLINK_MAX_SPEED)
     {
@@ -497,13 +512,15 @@ urj_tap_cable_jlink_set_frequency (urj_cable_t *cable, uint32_t frequency)
         data->usb_out_buffer[1] = (speed >> 0) & 0xff;
         data->usb_out_buffer[2] = (speed >> 8) & 0xff;
 
-        result = jlink_usb_write (params, 3);
+        result = jlink_usb_write (cable, 3);
 
         if (result != 3)
         {
             urj_log (URJ_LOG_LEVEL_ERROR,
                      "J-Link setting speed failed (%d)\n", result);
         }
+        else
+            data->speed = speed;
     }
     else
     {
@@ -519,14 +536,15 @@ static void
 jlink_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
     int i;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    jlink_usbconn_data_t *data = params->data;
+    jlink_usbconn_data_t *data = cable->params;
 
     for (i = 0; i < n; i++)
     {
         jlink_tap_append_step (data, tms, tdi);
+        if (data->tap_length >= 8 * JLINK_TAP_BUFFER_SIZE)
+            jlink_tap_execute (cable);
     }
-    jlink_tap_execute (params);
+    jlink_tap_execute (cable);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -534,8 +552,7 @@ jlink_clock (urj_cable_t *cable, int tms, int tdi, int n)
 static int
 jlink_get_tdo (urj_cable_t *cable)
 {
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    jlink_usbconn_data_t *data = params->data;
+    jlink_usbconn_data_t *data = cable->params;
 
     // TODO: This is the TDO _before_ last clock occured
     // ...   Anyone knows how to get the current TDO state?
@@ -562,8 +579,7 @@ static int
 jlink_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 {
     int i, j;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    jlink_usbconn_data_t *data = params->data;
+    jlink_usbconn_data_t *data = cable->params;
 
     for (j = 0, i = 0; i < len; i++)
     {
@@ -571,15 +587,17 @@ jlink_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 
         if (data->tap_length >= 8 * JLINK_TAP_BUFFER_SIZE)
         {
-            jlink_tap_execute (params);
+            if (jlink_tap_execute (cable) < 0)
+                return -1;
             if (out)
-                jlink_copy_out_data (data, i - j, j, out);
-            j = i;
+                jlink_copy_out_data (data, i + 1 - j, j, out);
+            j = i + 1;
         }
     }
     if (data->tap_length > 0)
     {
-        jlink_tap_execute (params);
+        if (jlink_tap_execute (cable) < 0)
+            return -1;
         if (out)
             jlink_copy_out_data (data, i - j, j, out);
     }
@@ -589,6 +607,31 @@ jlink_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 
 /* ---------------------------------------------------------------------- */
 
+static int
+jlink_tms_append (urj_cable_t *cable, int tms, int tdi)
+{
+    jlink_usbconn_data_t *data = cable->params;
+
+    jlink_tap_append_step (data, tms, tdi);
+
+    return data->tap_length >= 8 * JLINK_TAP_BUFFER_SIZE;
+}
+
+/* One bit of TMS and TDI per clock in JLINK_TAP_SEQUENCE_COMMANDs; the
+ * reply has the TDO of each clock, LSB first. */
+static int
+jlink_tms_sequence (urj_cable_t *cable, int len, const char *seq, char *out)
+{
+    jlink_usbconn_data_t *data = cable->params;
+
+    return urj_tap_cable_generic_usbconn_tms_sequence (cable, len, seq, out,
+                                                       jlink_tms_append,
+                                                       jlink_tap_execute,
+                                                       data->usb_in_buffer);
+}
+
+/* ---------------------------------------------------------------------- */
+
 static int
 jlink_set_signal (urj_cable_t *cable, int mask, int val)
 {
@@ -599,9 +642,9 @@ const urj_cable_driver_t urj_tap_cable_jlink_driver = {
     "jlink",
     N_("Segger/IAR J-Link, Atmel SAM-ICE and others."),
     URJ_CABLE_DEVICE_USB,
-    { .usb = urj_tap_cable_generic_usbconn_connect, },
+    { .usb = jlink_connect, },
     urj_tap_cable_generic_disconnect,
-    jlink_free,
+    urj_tap_cable_generic_usbconn_free,
     jlink_init,
     urj_tap_cable_generic_usbconn_done,
     urj_tap_cable_jlink_set_frequency,
@@ -611,6 +654,8 @@ const urj_cable_driver_t urj_tap_cable_jlink_driver = {
     jlink_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_using_transfer,
-    urj_tap_cable_generic_usbconn_help
+    urj_tap_cable_generic_usbconn_help,
+    0,
+    jlink_tms_sequence
 };
 URJ_DECLARE_USBCONN_CABLE(0x1366, 0x0101, "libusb", "jlink", jlink)
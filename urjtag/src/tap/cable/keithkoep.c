@@ -72,6 +72,9 @@ keithkoep_init (urj_cable_t *cable)
     urj_tap_parport_set_control (cable->link.port, 1 << TRST);
     PARAM_SIGNALS (cable) = URJ_POD_CS_TRST;
 
+    urj_tap_cable_generic_parport_pins (cable, 0, TMS, TDI, TCK, TDO,
+                                        -1, -1);
+
     return URJ_STATUS_OK;
 }
 
@@ -160,9 +163,11 @@ const urj_cable_driver_t urj_tap_cable_keithkoep_driver = {
     urj_tap_cable_generic_set_frequency,
     keithkoep_clock,
     keithkoep_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     keithkoep_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    urj_tap_cable_generic_parport_help
+    urj_tap_cable_generic_parport_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
@@ -69,6 +69,9 @@ lattice_init (urj_cable_t *cable)
     else
         PARAM_SIGNALS (cable) = ((data >> TRST) && 1) ? URJ_POD_CS_TRST : 0;
 
+    urj_tap_cable_generic_parport_pins (cable, 0, TMS, TDI, TCK, TDO,
+                                        TRST, -1);
+
     return URJ_STATUS_OK;
 }
 
@@ -152,9 +155,11 @@ const urj_cable_driver_t urj_tap_cable_lattice_driver = {
     urj_tap_cable_generic_set_frequency,
     lattice_clock,
     lattice_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     lattice_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    urj_tap_cable_generic_parport_help
+    urj_tap_cable_generic_parport_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
@@ -0,0 +1,524 @@
+/*
+ * $Id$
+ *
+ * Loopback "cable" driver with a model of the link to the cable
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ * The target is either a single TAP with a one bit instruction register
+ * that is always in BYPASS, or the JIM simulator. Every method of the
+ * driver is turned into the bytes a typical USB or network cable would
+ * move, and those are sent in transactions of at most "packet" bytes, each
+ * costing "latency" plus its size at "bandwidth" of real time. So the
+ * effect of the queueing in the layers above can be measured without
+ * hardware; see "cable stats" for the counters.
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <urjtag/cable.h>
+#include <urjtag/chain.h>
+#include <urjtag/fclock.h>
+
+#include "generic.h"
+
+#ifdef ENABLE_JIM
+#include <urjtag/jim.h>
+#endif
+
+/* Cost of a driver method: a command header, then the payload packed
+ * eight bits per byte (two bits per clock if TMS varies) */
+#define LOOPBACK_HEADER         3
+#define LOOPBACK_BYTES(bits)    (((bits) + 7) / 8)
+
+typedef struct
+{
+    const char *name;
+    unsigned long latency;      /* us per transaction */
+    unsigned long bandwidth;    /* bytes per second; 0: unlimited */
+    unsigned long packet;       /* bytes per transaction; 0: unlimited */
+}
+loopback_profile_t;
+
+static const loopback_profile_t loopback_profiles[] = {
+    /* 1 ms frames, about 8 Mbit/s of bulk data */
+    { "fs", 1000, 1000000, 4096 },
+    /* 125 us microframes */
+    { "hs", 125, 30000000, 65536 },
+    /* 100 Mbit/s LAN, one TCP segment per packet */
+    { "net", 200, 10000000, 1460 },
+};
+
+/* TAP controller states of the BYPASS target */
+enum
+{
+    TAP_RESET, TAP_IDLE,
+    TAP_SELECT_DR, TAP_CAPTURE_DR, TAP_SHIFT_DR, TAP_EXIT1_DR,
+    TAP_PAUSE_DR, TAP_EXIT2_DR, TAP_UPDATE_DR,
+    TAP_SELECT_IR, TAP_CAPTURE_IR, TAP_SHIFT_IR, TAP_EXIT1_IR,
+    TAP_PAUSE_IR, TAP_EXIT2_IR, TAP_UPDATE_IR
+};
+
+/* next state for TMS = 0 and TMS = 1 */
+static const unsigned char tap_next[16][2] = {
+    { TAP_IDLE, TAP_RESET },                    /* Test-Logic-Reset */
+    { TAP_IDLE, TAP_SELECT_DR },                /* Run-Test/Idle */
+    { TAP_CAPTURE_DR, TAP_SELECT_IR },          /* Select-DR-Scan */
+    { TAP_SHIFT_DR, TAP_EXIT1_DR },             /* Capture-DR */
+    { TAP_SHIFT_DR, TAP_EXIT1_DR },             /* Shift-DR */
+    { TAP_PAUSE_DR, TAP_UPDATE_DR },            /* Exit1-DR */
+    { TAP_PAUSE_DR, TAP_EXIT2_DR },             /* Pause-DR */
+    { TAP_SHIFT_DR, TAP_UPDATE_DR },            /* Exit2-DR */
+    { TAP_IDLE, TAP_SELECT_DR },                /* Update-DR */
+    { TAP_CAPTURE_IR, TAP_RESET },              /* Select-IR-Scan */
+    { TAP_SHIFT_IR, TAP_EXIT1_IR },             /* Capture-IR */
+    { TAP_SHIFT_IR, TAP_EXIT1_IR },             /* Shift-IR */
+    { TAP_PAUSE_IR, TAP_UPDATE_IR },            /* Exit1-IR */
+    { TAP_PAUSE_IR, TAP_EXIT2_IR },             /* Pause-IR */
+    { TAP_SHIFT_IR, TAP_UPDATE_IR },            /* Exit2-IR */
+    { TAP_IDLE, TAP_SELECT_DR },                /* Update-IR */
+};
+
+/* private parameters of this cable driver */
+typedef struct
+{
+#ifdef ENABLE_JIM
+    urj_jim_state_t *jim;       /* NULL: BYPASS target */
+#endif
+    int state;                  /* of the BYPASS target */
+    int bit;                    /* its only stage of IR or DR */
+    int trst;
+    unsigned long latency;
+    unsigned long bandwidth;
+    unsigned long packet;
+    unsigned long out_pending;  /* bytes not sent yet */
+    unsigned long in_pending;   /* bytes not read back yet */
+    int in_flush;
+}
+loopback_params_t;
+
+static void
+loopback_wait (long double seconds)
+{
+    long double end = urj_lib_frealtime () + seconds;
+    long double now;
+
+    /* sleep for the bulk of it, spin for the rest */
+    while ((now = urj_lib_frealtime ()) < end)
+        if (end - now > 2e-3)
+            usleep ((unsigned long) ((end - now - 1e-3) * 1e6));
+}
+
+static void
+loopback_transaction (urj_cable_t *cable, unsigned long out, unsigned long in)
+{
+    loopback_params_t *lp = cable->params;
+    long double t = lp->latency * 1e-6;
+
+    if (lp->bandwidth > 0)
+        t += (long double) (out + in) / lp->bandwidth;
+
+    cable->stats.transactions++;
+    cable->stats.bytes_out += out;
+    cable->stats.bytes_in += in;
+
+    loopback_wait (t);
+}
+
+/* Send what is pending and read back all results */
+static void
+loopback_sync (urj_cable_t *cable)
+{
+    loopback_params_t *lp = cable->params;
+    unsigned long n;
+
+    if (lp->out_pending > 0)
+    {
+        loopback_transaction (cable, lp->out_pending, 0);
+        lp->out_pending = 0;
+    }
+    while (lp->in_pending > 0)
+    {
+        n = lp->in_pending;
+        if (lp->packet > 0 && n > lp->packet)
+            n = lp->packet;
+        loopback_transaction (cable, 0, n);
+        lp->in_pending -= n;
+    }
+}
+
+/* Account for a driver method. Within a flush the bytes are collected and
+ * only full packets go out; otherwise the method is a round trip of its
+ * own. */
+static void
+loopback_io (urj_cable_t *cable, unsigned long out, unsigned long in)
+{
+    loopback_params_t *lp = cable->params;
+
+    lp->out_pending += out;
+    lp->in_pending += in;
+
+    while (lp->packet > 0 && lp->out_pending >= lp->packet)
+    {
+        loopback_transaction (cable, lp->packet, 0);
+        lp->out_pending -= lp->packet;
+    }
+
+    if (!lp->in_flush)
+        loopback_sync (cable);
+}
+
+static int
+loopback_tdo (loopback_params_t *lp)
+{
+#ifdef ENABLE_JIM
+    if (lp->jim != NULL)
+        return urj_jim_get_tdo (lp->jim);
+#endif
+    if (lp->state == TAP_SHIFT_DR || lp->state == TAP_SHIFT_IR)
+        return lp->bit;
+
+    return 0;
+}
+
+static void
+loopback_tck (loopback_params_t *lp, int tms, int tdi)
+{
+#ifdef ENABLE_JIM
+    if (lp->jim != NULL)
+    {
+        urj_jim_tck_rise (lp->jim, tms, tdi);
+        urj_jim_tck_fall (lp->jim);
+        return;
+    }
+#endif
+    if (!lp->trst)
+        return;
+
+    switch (lp->state)
+    {
+    case TAP_CAPTURE_DR:
+        lp->bit = 0;            /* BYPASS register */
+        break;
+    case TAP_CAPTURE_IR:
+        lp->bit = 1;
+        break;
+    case TAP_SHIFT_DR:
+    case TAP_SHIFT_IR:
+        lp->bit = tdi ? 1 : 0;
+        break;
+    default:
+        break;
+    }
+    lp->state = tap_next[lp->state][tms ? 1 : 0];
+}
+
+static int
+loopback_connect (urj_cable_t *cable, const urj_param_t *params[])
+{
+    loopback_params_t *lp;
+    const loopback_profile_t *profile = &loopback_profiles[0];
+    long latency = -1, bandwidth = -1, packet = -1;
+    int jim = 0;
+    int i, j;
+
+    if (params != NULL)
+        for (i = 0; params[i] != NULL; i++)
+        {
+            switch (params[i]->key)
+            {
+            case URJ_CABLE_PARAM_KEY_PROFILE:
+                for (j = 0; j < ARRAY_SIZE (loopback_profiles); j++)
+                    if (strcasecmp (params[i]->value.string,
+                                    loopback_profiles[j].name) == 0)
+                        break;
+                if (j == ARRAY_SIZE (loopback_profiles))
+                {
+                    urj_error_set (URJ_ERROR_INVALID,
+                                   _("unknown profile '%s'"),
+                                   params[i]->value.string);
+                    return URJ_STATUS_FAIL;
+                }
+                profile = &loopback_profiles[j];
+                break;
+            case URJ_CABLE_PARAM_KEY_LATENCY:
+                latency = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_BANDWIDTH:
+                bandwidth = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_PACKET:
+                packet = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_TARGET:
+                if (strcasecmp (params[i]->value.string, "jim") == 0)
+                    jim = 1;
+                else if (strcasecmp (params[i]->value.string, "bypass") == 0)
+                    jim = 0;
+                else
+                {
+                    urj_error_set (URJ_ERROR_INVALID,
+                                   _("unknown target '%s'"),
+                                   params[i]->value.string);
+                    return URJ_STATUS_FAIL;
+                }
+                break;
+            default:
+                urj_error_set (URJ_ERROR_SYNTAX,
+                               _("unsupported parameter for this cable"));
+                return URJ_STATUS_FAIL;
+            }
+        }
+
+#ifndef ENABLE_JIM
+    if (jim)
+    {
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("this build does not include the JIM simulator"));
+        return URJ_STATUS_FAIL;
+    }
+#endif
+
+    lp = calloc (1, sizeof (loopback_params_t));
+    if (!lp)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd) fails"),
+                       sizeof (loopback_params_t));
+        return URJ_STATUS_FAIL;
+    }
+
+#ifdef ENABLE_JIM
+    if (jim)
+    {
+        lp->jim = urj_jim_init ();
+        if (!lp->jim)
+        {
+            // retain error state
+            free (lp);
+            return URJ_STATUS_FAIL;
+        }
+    }
+#endif
+
+    lp->state = TAP_RESET;
+    lp->trst = 1;
+    lp->latency = latency >= 0 ? latency : profile->latency;
+    lp->bandwidth = bandwidth >= 0 ? bandwidth : profile->bandwidth;
+    lp->packet = packet >= 0 ? packet : profile->packet;
+
+    cable->params = lp;
+    cable->chain = NULL;
+
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             _("Loopback to %s: %lu us latency, %lu bytes/s, %lu byte packets\n"),
+             jim ? "JIM" : "BYPASS", lp->latency, lp->bandwidth, lp->packet);
+
+    return URJ_STATUS_OK;
+}
+
+static void
+loopback_disconnect (urj_cable_t *cable)
+{
+    urj_tap_cable_done (cable);
+    urj_tap_chain_disconnect (cable->chain);
+}
+
+static void
+loopback_free (urj_cable_t *cable)
+{
+    if (cable->params != NULL)
+    {
+#ifdef ENABLE_JIM
+        loopback_params_t *lp = cable->params;
+
+        if (lp->jim != NULL)
+            urj_jim_free (lp->jim);
+#endif
+        free (cable->params);
+    }
+    free (cable);
+}
+
+static int
+loopback_init (urj_cable_t *cable)
+{
+    return URJ_STATUS_OK;
+}
+
+static void
+loopback_done (urj_cable_t *cable)
+{
+}
+
+static void
+loopback_clock (urj_cable_t *cable, int tms, int tdi, int n)
+{
+    loopback_params_t *lp = cable->params;
+    int i;
+
+    for (i = 0; i < n; i++)
+        loopback_tck (lp, tms, tdi);
+
+    loopback_io (cable, LOOPBACK_HEADER + LOOPBACK_BYTES (2 * n), 0);
+}
+
+static int
+loopback_get_tdo (urj_cable_t *cable)
+{
+    loopback_params_t *lp = cable->params;
+
+    loopback_io (cable, LOOPBACK_HEADER, 1);
+
+    return loopback_tdo (lp);
+}
+
+static int
+loopback_transfer (urj_cable_t *cable, int len, const char *in, char *out)
+{
+    loopback_params_t *lp = cable->params;
+    int i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (out)
+            out[i] = loopback_tdo (lp);
+        loopback_tck (lp, 0, in[i]);
+    }
+
+    loopback_io (cable, LOOPBACK_HEADER + LOOPBACK_BYTES (len),
+                 out ? LOOPBACK_BYTES (len) : 0);
+
+    return i;
+}
+
+static int
+loopback_tms_sequence (urj_cable_t *cable, int len, const char *seq,
+                       char *out)
+{
+    loopback_params_t *lp = cable->params;
+    int i, k = 0;
+
+    for (i = 0; i < len; i++)
+    {
+        if (seq[i] & URJ_CABLE_SEQ_CAPTURE)
+            out[k++] = loopback_tdo (lp);
+        loopback_tck (lp, (seq[i] & URJ_CABLE_SEQ_TMS) ? 1 : 0,
+                      seq[i] & URJ_CABLE_SEQ_TDI);
+    }
+
+    loopback_io (cable, LOOPBACK_HEADER + LOOPBACK_BYTES (2 * len),
+                 LOOPBACK_BYTES (k));
+
+    return k;
+}
+
+static int
+loopback_set_signal (urj_cable_t *cable, int mask, int val)
+{
+    loopback_params_t *lp = cable->params;
+    int old = lp->trst ? URJ_POD_CS_TRST : 0;
+
+    if (mask & URJ_POD_CS_TRST)
+    {
+        lp->trst = (val & URJ_POD_CS_TRST) ? 1 : 0;
+#ifdef ENABLE_JIM
+        if (lp->jim != NULL)
+            urj_jim_set_trst (lp->jim, lp->trst);
+#endif
+        if (!lp->trst)
+            lp->state = TAP_RESET;
+    }
+
+    loopback_io (cable, LOOPBACK_HEADER, 0);
+
+    return old;
+}
+
+static int
+loopback_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig)
+{
+    loopback_params_t *lp = cable->params;
+
+    loopback_io (cable, LOOPBACK_HEADER, 1);
+
+    if (sig == URJ_POD_CS_TRST)
+        return lp->trst;
+
+    return 0;
+}
+
+static void
+loopback_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
+{
+    loopback_params_t *lp = cable->params;
+
+    /* urj_tap_cable_set_signal() flushes again from within */
+    lp->in_flush++;
+    urj_tap_cable_generic_flush_one_by_one (cable, how_much);
+    lp->in_flush--;
+
+    if (how_much != URJ_TAP_CABLE_OPTIONALLY && !lp->in_flush)
+        loopback_sync (cable);
+}
+
+static void
+loopback_help (urj_log_level_t ll, const char *cablename)
+{
+    int i;
+
+    urj_log (ll,
+             _("Usage: cable %s [profile=PROFILE] [latency=US] [bandwidth=BPS]\n"
+               "                [packet=BYTES] [target=bypass|jim]\n"
+               "\n"
+               "profile    link to model (default %s)\n"
+               "latency    microseconds per transaction\n"
+               "bandwidth  bytes per second, 0 for unlimited\n"
+               "packet     bytes per transaction, 0 for unlimited\n"
+               "target     TAP in BYPASS (default) or the JIM simulator\n"
+               "\n"
+               "Profiles:\n"),
+             cablename, loopback_profiles[0].name);
+    for (i = 0; i < ARRAY_SIZE (loopback_profiles); i++)
+        urj_log (ll, _("  %-5s latency=%lu bandwidth=%lu packet=%lu\n"),
+                 loopback_profiles[i].name, loopback_profiles[i].latency,
+                 loopback_profiles[i].bandwidth, loopback_profiles[i].packet);
+    urj_log (ll, "\n");
+}
+
+const urj_cable_driver_t urj_tap_cable_loopback_driver = {
+    "loopback",
+    N_("Loopback to a simulated target over a modelled link"),
+    URJ_CABLE_DEVICE_OTHER,
+    { .other = loopback_connect, },
+    loopback_disconnect,
+    loopback_free,
+    loopback_init,
+    loopback_done,
+    urj_tap_cable_generic_set_frequency,
+    loopback_clock,
+    loopback_get_tdo,
+    loopback_transfer,
+    loopback_set_signal,
+    loopback_get_signal,
+    loopback_flush,
+    loopback_help,
+    0,
+    loopback_tms_sequence
+};
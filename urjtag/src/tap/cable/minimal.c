@@ -80,6 +80,9 @@ minimal_init (urj_cable_t *cable)
     PARAM_SIGNALS (cable) |= (data & TCK) ? URJ_POD_CS_TCK : 0;
     PARAM_SIGNALS (cable) |= (data & TMS) ? URJ_POD_CS_TMS : 0;
 
+    urj_tap_cable_generic_parport_pins (cable, unused_bits, TMS, TDI, TCK, TDO,
+                                        -1, -1);
+
     return URJ_STATUS_OK;
 }
 
@@ -160,9 +163,11 @@ const urj_cable_driver_t urj_tap_cable_minimal_driver = {
     urj_tap_cable_generic_set_frequency,
     minimal_clock,
     minimal_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     minimal_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    urj_tap_cable_generic_parport_help
+    urj_tap_cable_generic_parport_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
@@ -0,0 +1,436 @@
+/*
+ * $Id$
+ *
+ * Memory-mapped GPIO JTAG Cable Driver
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ * Drives TCK, TMS and TDI and samples TDO through the 32 bit data
+ * registers of a SoC GPIO block, like the ts7800 and ep9307 cables do for
+ * their boards, but with the registers and bits given as parameters:
+ *
+ *   cable mmgpio base=0xF1010000 outreg=0x100 inreg=0x110 \
+ *                tck=1 tms=5 tdi=2 tdo=4
+ *
+ * The registers are mapped once from /dev/mem, or from any other file
+ * given with mem=, e.g. a plain file standing in for the hardware.
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <urjtag/cable.h>
+#include <urjtag/chain.h>
+#include <urjtag/cmd.h>
+
+#include "generic.h"
+
+#define MMGPIO_NONE             (~0UL)
+
+/* pin mapping */
+enum {
+    GPIO_TDI = 0,
+    GPIO_TCK,
+    GPIO_TMS,
+    GPIO_TDO,
+    GPIO_REQUIRED
+};
+
+typedef struct
+{
+    char *mem;
+    unsigned long base, out, in, dir;
+    unsigned long bits[GPIO_REQUIRED];
+    int fd;
+    void *map_base;
+    size_t map_size;
+    volatile uint32_t *reg_out;
+    volatile uint32_t *reg_in;
+    uint32_t tck, tms, tdi, tdo;        /* masks */
+    uint32_t lastout;
+    int signals;
+} mmgpio_params_t;
+
+/* The busy-wait between two edges, cable->delay as calibrated by
+ * urj_tap_cable_generic_set_frequency() through mmgpio_clock() */
+static inline void
+mmgpio_wait (int delay)
+{
+    volatile int j;
+
+    for (j = 0; j < delay; j++)
+        ;
+}
+
+static inline void
+mmgpio_write (mmgpio_params_t *p, uint32_t data)
+{
+    p->lastout = (p->lastout & ~(p->tck | p->tms | p->tdi)) | data;
+    *p->reg_out = p->lastout;
+}
+
+static int
+mmgpio_open (urj_cable_t *cable)
+{
+    mmgpio_params_t *p = cable->params;
+    unsigned long map_mask, end;
+    off_t map_offset;
+    void *map_base;
+
+    p->fd = open (p->mem, O_RDWR | O_SYNC);
+    if (p->fd == -1)
+    {
+        urj_error_IO_set (_("unable to open %s"), p->mem);
+        return URJ_STATUS_FAIL;
+    }
+
+    map_mask = getpagesize () - 1;
+    map_offset = p->base & ~map_mask;
+    end = p->out > p->in ? p->out : p->in;
+    if (p->dir != MMGPIO_NONE && p->dir > end)
+        end = p->dir;
+    end += (p->base & map_mask) + sizeof (uint32_t);
+    p->map_size = (end + map_mask) & ~map_mask;
+
+    /* map_base stays NULL until the mapping exists, see mmgpio_close() */
+    map_base = mmap (0, p->map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     p->fd, map_offset);
+    if (map_base == MAP_FAILED)
+    {
+        urj_error_IO_set (_("unable to mmap the GPIO registers"));
+        close (p->fd);
+        p->fd = -1;
+        return URJ_STATUS_FAIL;
+    }
+    p->map_base = map_base;
+
+    p->reg_out = (volatile uint32_t *)
+        ((char *) p->map_base + (p->base & map_mask) + p->out);
+    p->reg_in = (volatile uint32_t *)
+        ((char *) p->map_base + (p->base & map_mask) + p->in);
+
+    /* TCK, TMS and TDI are outputs, TDO an input */
+    if (p->dir != MMGPIO_NONE)
+    {
+        volatile uint32_t *reg_dir = (volatile uint32_t *)
+            ((char *) p->map_base + (p->base & map_mask) + p->dir);
+
+        *reg_dir = (*reg_dir & ~p->tdo) | p->tck | p->tms | p->tdi;
+    }
+
+    p->lastout = *p->reg_out;
+
+    return URJ_STATUS_OK;
+}
+
+static void
+mmgpio_close (urj_cable_t *cable)
+{
+    mmgpio_params_t *p = cable->params;
+
+    if (p->map_base == NULL)
+        return;
+
+    if (munmap (p->map_base, p->map_size) == -1)
+        urj_error_IO_set (_("unable to munmap the GPIO registers"));
+    close (p->fd);
+    p->map_base = NULL;
+}
+
+static void
+mmgpio_help (urj_log_level_t ll, const char *cablename)
+{
+    urj_log (ll,
+             _("Usage: cable %s base=ADDR outreg=OFFSET [inreg=OFFSET]\n"
+               "           [dirreg=OFFSET] tdi=BIT tdo=BIT tck=BIT tms=BIT\n"
+               "           [mem=FILE]\n"
+               "\n"
+               "ADDR       physical address of the GPIO registers\n"
+               "OFFSET     offset of the output, input and direction registers\n"
+               "           (inreg defaults to outreg; a set bit in dirreg is\n"
+               "           an output)\n"
+               "BIT        bit of the signal in the registers\n"
+               "FILE       file to map the registers from (default /dev/mem)\n"
+               "\n"), cablename);
+}
+
+static int
+mmgpio_connect (urj_cable_t *cable, const urj_param_t *params[])
+{
+    mmgpio_params_t *cable_params;
+    const char *mem = "/dev/mem";
+    int i;
+
+    cable_params = calloc (1, sizeof (*cable_params));
+    if (!cable_params)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd) fails"),
+                       sizeof (*cable_params));
+        return URJ_STATUS_FAIL;
+    }
+
+    cable_params->base = MMGPIO_NONE;
+    cable_params->out = MMGPIO_NONE;
+    cable_params->in = MMGPIO_NONE;
+    cable_params->dir = MMGPIO_NONE;
+    for (i = 0; i < GPIO_REQUIRED; i++)
+        cable_params->bits[i] = MMGPIO_NONE;
+
+    if (params != NULL)
+        /* parse arguments beyond the cable name */
+        for (i = 0; params[i] != NULL; i++)
+        {
+            switch (params[i]->key)
+            {
+            case URJ_CABLE_PARAM_KEY_MEM:
+                mem = params[i]->value.string;
+                break;
+            case URJ_CABLE_PARAM_KEY_BASE:
+                cable_params->base = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_OUTREG:
+                cable_params->out = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_INREG:
+                cable_params->in = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_DIRREG:
+                cable_params->dir = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_TDI:
+                cable_params->bits[GPIO_TDI] = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_TDO:
+                cable_params->bits[GPIO_TDO] = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_TMS:
+                cable_params->bits[GPIO_TMS] = params[i]->value.lu;
+                break;
+            case URJ_CABLE_PARAM_KEY_TCK:
+                cable_params->bits[GPIO_TCK] = params[i]->value.lu;
+                break;
+            default:
+                break;
+            }
+        }
+
+    if (cable_params->in == MMGPIO_NONE)
+        cable_params->in = cable_params->out;
+
+    for (i = 0; i < GPIO_REQUIRED; i++)
+        if (cable_params->bits[i] > 31)
+            break;
+    if (cable_params->base == MMGPIO_NONE || cable_params->out == MMGPIO_NONE
+        || i < GPIO_REQUIRED)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX,
+                       _("missing or invalid GPIO registers or bits"));
+        mmgpio_help (URJ_LOG_LEVEL_ERROR, "mmgpio");
+        free (cable_params);
+        return URJ_STATUS_FAIL;
+    }
+    if ((cable_params->out | cable_params->in) & 3
+        || (cable_params->dir != MMGPIO_NONE && (cable_params->dir & 3)))
+    {
+        urj_error_set (URJ_ERROR_SYNTAX,
+                       _("GPIO register offsets must be 32 bit aligned"));
+        free (cable_params);
+        return URJ_STATUS_FAIL;
+    }
+
+    cable_params->mem = strdup (mem);
+    if (cable_params->mem == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("strdup(%s) fails"), mem);
+        free (cable_params);
+        return URJ_STATUS_FAIL;
+    }
+
+    cable_params->tck = (uint32_t) 1 << cable_params->bits[GPIO_TCK];
+    cable_params->tms = (uint32_t) 1 << cable_params->bits[GPIO_TMS];
+    cable_params->tdi = (uint32_t) 1 << cable_params->bits[GPIO_TDI];
+    cable_params->tdo = (uint32_t) 1 << cable_params->bits[GPIO_TDO];
+
+    cable->params = cable_params;
+    cable->chain = NULL;
+
+    return URJ_STATUS_OK;
+}
+
+static void
+mmgpio_disconnect (urj_cable_t *cable)
+{
+    mmgpio_close (cable);
+    urj_tap_chain_disconnect (cable->chain);
+}
+
+static void
+mmgpio_cable_free (urj_cable_t *cable)
+{
+    mmgpio_params_t *p = cable->params;
+
+    free (p->mem);
+    free (p);
+    free (cable);
+}
+
+static int
+mmgpio_init (urj_cable_t *cable)
+{
+    mmgpio_params_t *p = cable->params;
+
+    if (mmgpio_open (cable) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    p->signals = URJ_POD_CS_TRST;
+
+    return URJ_STATUS_OK;
+}
+
+static void
+mmgpio_done (urj_cable_t *cable)
+{
+    mmgpio_close (cable);
+}
+
+static void
+mmgpio_clock (urj_cable_t *cable, int tms, int tdi, int n)
+{
+    mmgpio_params_t *p = cable->params;
+    uint32_t data;
+    int i;
+
+    data = (tms ? p->tms : 0) | (tdi ? p->tdi : 0);
+
+    for (i = 0; i < n; i++)
+    {
+        mmgpio_write (p, data);
+        mmgpio_wait (cable->delay);
+        mmgpio_write (p, data | p->tck);
+        mmgpio_wait (cable->delay);
+    }
+}
+
+static int
+mmgpio_get_tdo (urj_cable_t *cable)
+{
+    mmgpio_params_t *p = cable->params;
+
+    mmgpio_write (p, 0);
+    mmgpio_wait (cable->delay);
+
+    return (*p->reg_in & p->tdo) ? 1 : 0;
+}
+
+/* Per bit: TCK low with the new TDI, sample TDO, TCK high; the same edges
+ * and waits as mmgpio_clock(), so its calibration holds here as well */
+static int
+mmgpio_transfer (urj_cable_t *cable, int len, const char *in, char *out)
+{
+    mmgpio_params_t *p = cable->params;
+    volatile uint32_t *reg_out = p->reg_out;
+    uint32_t low, tdo = p->tdo;
+    int delay = cable->delay;
+    int i;
+
+    low = p->lastout & ~(p->tck | p->tms | p->tdi);
+
+    for (i = 0; i < len; i++)
+    {
+        uint32_t data = low | (in[i] ? p->tdi : 0);
+
+        *reg_out = data;
+        mmgpio_wait (delay);
+        if (out)
+            out[i] = (*p->reg_in & tdo) ? 1 : 0;
+        *reg_out = data | p->tck;
+        mmgpio_wait (delay);
+    }
+
+    if (len > 0)
+        p->lastout = low | (in[len - 1] ? p->tdi : 0) | p->tck;
+
+    return i;
+}
+
+static int
+mmgpio_current_signals (urj_cable_t *cable)
+{
+    mmgpio_params_t *p = cable->params;
+    int sigs = p->signals & ~(URJ_POD_CS_TMS | URJ_POD_CS_TDI | URJ_POD_CS_TCK);
+
+    if (p->lastout & p->tck)
+        sigs |= URJ_POD_CS_TCK;
+    if (p->lastout & p->tdi)
+        sigs |= URJ_POD_CS_TDI;
+    if (p->lastout & p->tms)
+        sigs |= URJ_POD_CS_TMS;
+
+    return sigs;
+}
+
+static int
+mmgpio_set_signal (urj_cable_t *cable, int mask, int val)
+{
+    mmgpio_params_t *p = cable->params;
+    int prev_sigs = mmgpio_current_signals (cable);
+
+    mask &= (URJ_POD_CS_TDI | URJ_POD_CS_TCK | URJ_POD_CS_TMS); // only these can be modified
+
+    if (mask != 0)
+    {
+        int sigs = (prev_sigs & ~mask) | (val & mask);
+        uint32_t tms = (sigs & URJ_POD_CS_TMS) ? p->tms : 0;
+        uint32_t tdi = (sigs & URJ_POD_CS_TDI) ? p->tdi : 0;
+        uint32_t tck = (sigs & URJ_POD_CS_TCK) ? p->tck : 0;
+        mmgpio_write (p, tms | tdi | tck);
+    }
+
+    return prev_sigs;
+}
+
+static int
+mmgpio_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig)
+{
+    return (mmgpio_current_signals (cable) & sig) ? 1 : 0;
+}
+
+const urj_cable_driver_t urj_tap_cable_mmgpio_driver = {
+    "mmgpio",
+    N_("Memory-mapped GPIO JTAG Chain"),
+    URJ_CABLE_DEVICE_OTHER,
+    { .other = mmgpio_connect, },
+    mmgpio_disconnect,
+    mmgpio_cable_free,
+    mmgpio_init,
+    mmgpio_done,
+    urj_tap_cable_generic_set_frequency,
+    mmgpio_clock,
+    mmgpio_get_tdo,
+    mmgpio_transfer,
+    mmgpio_set_signal,
+    mmgpio_get_signal,
+    urj_tap_cable_generic_flush_one_by_one,
+    mmgpio_help
+};
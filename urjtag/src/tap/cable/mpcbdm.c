@@ -70,6 +70,9 @@ mpcbdm_init (urj_cable_t *cable)
     urj_tap_parport_set_control (cable->link.port, 0);
     PARAM_SIGNALS (cable) = (URJ_POD_CS_TRST | URJ_POD_CS_RESET);
 
+    urj_tap_cable_generic_parport_pins (cable, 0, TMS, TDI, TCK, TDO,
+                                        -1, -1);
+
     return URJ_STATUS_OK;
 }
 
@@ -159,9 +162,11 @@ const urj_cable_driver_t urj_tap_cable_mpcbdm_driver = {
     urj_tap_cable_generic_set_frequency,
     mpcbdm_clock,
     mpcbdm_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     mpcbdm_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    urj_tap_cable_generic_parport_help
+    urj_tap_cable_generic_parport_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
@@ -39,15 +39,14 @@
 #include "generic_usbconn.h"
 
 #include "urjtag/usbconn.h"
-#include "usbconn/libusb.h"
 
 /* ---------------------------------------------------------------------- */
 
 
-#include "cable.h"
-#include "chain.h"
+#include <urjtag/cable.h>
+#include <urjtag/chain.h>
 
-#include "jtag.h"
+#include <urjtag/jtag.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -61,10 +60,16 @@
 
 #define OPENDOUS_USB_TIMEOUT     1000
 
-#define OPENDOUS_IN_BUFFER_SIZE  64
-#define OPENDOUS_OUT_BUFFER_SIZE 64
+/* The probe takes commands of up to 360 bytes, spread over as many USB
+ * packets as needed. A TAP sequence of up to 350 bytes (1400 clocks) fits
+ * into one and is answered with all its TDO bits in one IN transfer. */
+#define OPENDOUS_BUFFER_SIZE      360
+#define OPENDOUS_MAX_TAP_TRANSMIT (OPENDOUS_BUFFER_SIZE - 10)
 
-#define OPENDOUS_TAP_BUFFER_SIZE (63)
+#define OPENDOUS_IN_BUFFER_SIZE  (OPENDOUS_MAX_TAP_TRANSMIT / 2)
+#define OPENDOUS_OUT_BUFFER_SIZE OPENDOUS_BUFFER_SIZE
+
+#define OPENDOUS_TAP_BUFFER_SIZE OPENDOUS_MAX_TAP_TRANSMIT
 #define OPENDOUS_SCHEDULE_BUFFER_SIZE 102400
 
 
@@ -83,6 +88,8 @@
 
 typedef struct
 {
+  int signals;			/* see urj_tap_cable_generic_params_t */
+
   /* Global USB buffers */
   unsigned char usb_in_buffer[OPENDOUS_IN_BUFFER_SIZE];
   struct {
@@ -108,22 +115,22 @@ FILE *debug_log=0;
 
 
 /* Queue command functions */
-static void urj_tap_cable_opendous_reset (urj_usbconn_libusb_param_t *params,
+static void urj_tap_cable_opendous_reset (urj_cable_t *cable,
                                           int trst, int srst);
                                        
-static int opendous_simple_command (urj_usbconn_libusb_param_t *params,
+static int opendous_simple_command (urj_cable_t *cable,
                                     uint8_t command,uint8_t data);
 
 
 /* J-Link tap buffer functions */
 static void opendous_tap_init (opendous_usbconn_data_t *data);
-static int opendous_tap_execute (urj_usbconn_libusb_param_t *params);
+static int opendous_tap_execute (urj_cable_t *cable);
 static void opendous_tap_append_step (opendous_usbconn_data_t *data, int tms, int tdi);
 
 /* Jlink lowlevel functions */
-static int opendous_usb_message (urj_usbconn_libusb_param_t *params, int out_length, int in_length);
-static int opendous_usb_write (urj_usbconn_libusb_param_t *params, unsigned int length);
-static int opendous_usb_read (urj_usbconn_libusb_param_t *params);
+static int opendous_usb_message (urj_cable_t *cable, int out_length, int in_length);
+static int opendous_usb_write (urj_cable_t *cable, unsigned int length);
+static int opendous_usb_read (urj_cable_t *cable);
 
 static void opendous_debug_buffer (char *buffer, int length);
 
@@ -136,33 +143,33 @@ void urj_tap_cable_opendous_set_frequency (urj_cable_t *cable,
 /* Opendous tap functions */
 
 void
-urj_tap_cable_opendous_reset (urj_usbconn_libusb_param_t *params, int trst,
+urj_tap_cable_opendous_reset (urj_cable_t *cable, int trst,
                               int srst)
 {
     urj_log (URJ_LOG_LEVEL_COMM, "trst=%d, srst=%d\n", trst, srst);
  
     /* Signals are active low */
-    opendous_simple_command (params, JTAG_CMD_SET_SRST_TRST, (srst ? 0 : 1) | (trst ? 0 : 2));
+    opendous_simple_command (cable, JTAG_CMD_SET_SRST_TRST, (srst ? 0 : 1) | (trst ? 0 : 2));
 }
 
 
 static int
-opendous_simple_command (urj_usbconn_libusb_param_t *params, uint8_t command, uint8_t _data)
+opendous_simple_command (urj_cable_t *cable, uint8_t command, uint8_t _data)
 {
     int result;
-    opendous_usbconn_data_t *data = params->data;
+    opendous_usbconn_data_t *data = cable->params;
 
     urj_log (URJ_LOG_LEVEL_COMM, "simple comand %#02x %#02x\n", command, _data);
 
     data->usb_out_buffer[0] = command;
     data->usb_out_buffer[1] = _data;
-    result = opendous_usb_write (params, 2);
+    result = opendous_usb_write (cable, 2);
 
     if (result != 2) {
 	urj_log (URJ_LOG_LEVEL_COMM, "writting: command=%#02x, data=%#02x, result=%d\n",
 		 command, _data, result);
     }
-    result = opendous_usb_read (params);
+    result = opendous_usb_read (cable);
     if (result != 1) {
 	urj_log (URJ_LOG_LEVEL_COMM, "reading: command=%#02x, result=%d\n",
 		 command, result);
@@ -172,7 +179,7 @@ opendous_simple_command (urj_usbconn_libusb_param_t *params, uint8_t command, ui
 
 /*
 static int
-opendous_get_status (urj_usbconn_libusb_param_t *params)
+opendous_get_status (urj_cable_t *cable)
 {
     //TODO: make some function for reading info
   
@@ -248,9 +255,9 @@ opendous_schedule_tap_append_step (opendous_usbconn_data_t *data, int tms, int t
 /* Send a tap sequence to the device, and receive the answer */
 
 static int
-opendous_tap_execute (urj_usbconn_libusb_param_t *params)
+opendous_tap_execute (urj_cable_t *cable)
 {
-    opendous_usbconn_data_t *data = params->data;
+    opendous_usbconn_data_t *data = cable->params;
     int byte_length,byte_length_out;
     int i;
     int result;
@@ -268,16 +275,18 @@ opendous_tap_execute (urj_usbconn_libusb_param_t *params)
             data->usb_out_buffer[i+1] = data->tms_buffer[i];
         }
         
-        result = opendous_usb_message (params, byte_length+1, byte_length_out);
+        result = opendous_usb_message (cable, byte_length+1, byte_length_out);
 
         if (result == byte_length_out)
         {
-          data->last_tdo = (data->usb_in_buffer[byte_length_out - 1])&(1<< (data->tap_length%8) )? 1 : 0;
+          data->last_tdo = (data->usb_in_buffer[(data->tap_length - 1) / 8]
+                            >> ((data->tap_length - 1) % 8)) & 1;
           //opendous_debug_buffer(data->usb_in_buffer,byte_length);
         } else {
             ERROR ("opendous_tap_execute, wrong result %d, expected %d\n",
                    result, byte_length_out);
 
+            opendous_tap_init (data);
             return -2;
         }
         opendous_tap_init (data);
@@ -286,9 +295,9 @@ opendous_tap_execute (urj_usbconn_libusb_param_t *params)
 }
 
 static int
-opendous_schedule_flush (urj_usbconn_libusb_param_t *params)
+opendous_schedule_flush (urj_cable_t *cable)
 {
-    opendous_usbconn_data_t *data = params->data;
+    opendous_usbconn_data_t *data = cable->params;
     int byte_length,byte_length_out;
     /*int i;*/
     int result;
@@ -303,17 +312,18 @@ opendous_schedule_flush (urj_usbconn_libusb_param_t *params)
 
         byte_length = (bit_length+3)/4;
       
-        if(byte_length<(OPENDOUS_IN_BUFFER_SIZE-2))     
+        if(byte_length<=OPENDOUS_MAX_TAP_TRANSMIT)
         {
           byte_length_out = (bit_length+7)/8;
           data->usb_out_buffer[0]=JTAG_CMD_TAP_OUTPUT | ((bit_length%4)<<4); //transfer command
           bit_length=0;
         } else {
-          byte_length=(OPENDOUS_IN_BUFFER_SIZE-2);
+          /* a whole number of TDO bytes, so that the next reply follows on */
+          byte_length=OPENDOUS_MAX_TAP_TRANSMIT;
           data->usb_out_buffer[0]=JTAG_CMD_TAP_OUTPUT ; //transfer command
           
-          bit_length-=(OPENDOUS_IN_BUFFER_SIZE-2)*4;
-          byte_length_out = (OPENDOUS_IN_BUFFER_SIZE-2)/2;
+          bit_length-=OPENDOUS_MAX_TAP_TRANSMIT*4;
+          byte_length_out = OPENDOUS_MAX_TAP_TRANSMIT/2;
         }
 
         //for (i = 0; i < byte_length; i++)
@@ -323,7 +333,7 @@ opendous_schedule_flush (urj_usbconn_libusb_param_t *params)
         memmove(data->usb_out_buffer+1,data->schedule_tap+in_offset,byte_length);
         in_offset+=byte_length;
         
-        result = opendous_usb_message (params, byte_length+1, byte_length_out);
+        result = opendous_usb_message (cable, byte_length+1, byte_length_out);
 
         if (result == byte_length_out)
         {
@@ -347,14 +357,14 @@ opendous_schedule_flush (urj_usbconn_libusb_param_t *params)
 
 /* Send a message and receive the reply. */
 static int
-opendous_usb_message (urj_usbconn_libusb_param_t *params, int out_length, int in_length)
+opendous_usb_message (urj_cable_t *cable, int out_length, int in_length)
 {
     int result;
 
-    result = opendous_usb_write (params, out_length);
+    result = opendous_usb_write (cable, out_length);
     if (result == out_length)
     {
-        result = opendous_usb_read (params);
+        result = opendous_usb_read (cable);
         if (result == in_length)
         {
             return result;
@@ -376,11 +386,10 @@ opendous_usb_message (urj_usbconn_libusb_param_t *params, int out_length, int in
 
 /* Write data from out_buffer to USB. */
 static int
-opendous_usb_write (urj_usbconn_libusb_param_t *params, unsigned int out_length)
+opendous_usb_write (urj_cable_t *cable, unsigned int out_length)
 {
-    int result, transferred;
-    opendous_usbconn_data_t *data;
-    data = params->data;
+    int result;
+    opendous_usbconn_data_t *data = cable->params;
 
     urj_log (URJ_LOG_LEVEL_ALL, "out_length=%d\n", out_length);
     if (out_length > OPENDOUS_OUT_BUFFER_SIZE) {
@@ -395,53 +404,39 @@ opendous_usb_write (urj_usbconn_libusb_param_t *params, unsigned int out_length)
 	opendous_debug_buffer (data->usb_out_buffer, out_length);
     }
    
-    urj_log(URJ_LOG_LEVEL_ALL, "dev: %#p, ep=%#02x, buff: %#p, size=%d, timeout=%d\n",
-	    params->handle, OPENDOUS_WRITE_ENDPOINT, data->usb_out_buffer,
+    urj_log(URJ_LOG_LEVEL_ALL, "ep=%#02x, buff: %#p, size=%d, timeout=%d\n",
+	    OPENDOUS_WRITE_ENDPOINT, data->usb_out_buffer,
 	    out_length, OPENDOUS_USB_TIMEOUT);
     data->usb_out_size_lo = out_length & 0xff;
     data->usb_out_size_hi = out_length >> 8;
-    result = libusb_bulk_transfer (params->handle,
-                                   OPENDOUS_WRITE_ENDPOINT,
-                                   &data->usb_out_size_lo,
-                                   out_length + 2,
-                                   &transferred,
+    result = urj_tap_usbconn_bulk (cable->link.usb, OPENDOUS_WRITE_ENDPOINT,
+                                   &data->usb_out_size_lo, out_length + 2,
                                    OPENDOUS_USB_TIMEOUT);
-#ifdef HAVE_LIBUSB1
-    if (result) {
-        urj_log (URJ_LOG_LEVEL_DEBUG, "libusb_error_name='%s'\n", libusb_error_name(result));
-    }
-#endif
-    urj_log (URJ_LOG_LEVEL_DETAIL, "result=%d, length=%d, transferred=%d\n",
-	    result, out_length + 2, transferred);
+    urj_log (URJ_LOG_LEVEL_DETAIL, "length=%d, transferred=%d\n",
+	    out_length + 2, result);
 
-    return transferred - 2;
+    return result < 0 ? -1 : result - 2;
 }
 
 /* ---------------------------------------------------------------------- */
 
 /* Read data from USB into in_buffer. */
 static int
-opendous_usb_read (urj_usbconn_libusb_param_t *params)
+opendous_usb_read (urj_cable_t *cable)
 {
-    opendous_usbconn_data_t *data = params->data;
+    opendous_usbconn_data_t *data = cable->params;
     int transferred;
-    urj_log(URJ_LOG_LEVEL_ALL, "dev: %#p, ep=%#02x, buff: %#p, size=%d, timeout=%d\n",
-	    params->handle, OPENDOUS_READ_ENDPOINT, data->usb_in_buffer,
+    urj_log(URJ_LOG_LEVEL_ALL, "ep=%#02x, buff: %#p, size=%d, timeout=%d\n",
+	    OPENDOUS_READ_ENDPOINT, data->usb_in_buffer,
 	    OPENDOUS_IN_BUFFER_SIZE, OPENDOUS_USB_TIMEOUT);
-    int result = libusb_bulk_transfer (params->handle,
-                                       OPENDOUS_READ_ENDPOINT,
-                                       data->usb_in_buffer,
-                                       OPENDOUS_IN_BUFFER_SIZE,
-                                       &transferred,
-                                       OPENDOUS_USB_TIMEOUT);
-#ifdef HAVE_LIBUSB1
-    if (result) {
-      urj_log (URJ_LOG_LEVEL_DEBUG, "libusb_error_name='%s'\n", libusb_error_name(result));
-    }
-#endif
-    urj_log (URJ_LOG_LEVEL_ALL, "result=%d, transferred=%d\n", result, transferred);
+    transferred = urj_tap_usbconn_bulk (cable->link.usb,
+                                        OPENDOUS_READ_ENDPOINT,
+                                        data->usb_in_buffer,
+                                        OPENDOUS_IN_BUFFER_SIZE,
+                                        OPENDOUS_USB_TIMEOUT);
+    urj_log (URJ_LOG_LEVEL_ALL, "transferred=%d\n", transferred);
     urj_log (URJ_LOG_LEVEL_ALL, "Have read:\n");
-    if (URJ_LOG_LEVEL_ALL >= urj_log_state.level) {
+    if (URJ_LOG_LEVEL_ALL >= urj_log_state.level && transferred > 0) {
 	opendous_debug_buffer (data->usb_in_buffer, transferred);
     }
     return transferred;
@@ -476,38 +471,53 @@ opendous_debug_buffer (char *buffer, int length)
 /* ---------------------------------------------------------------------- */
 
 static int
-opendous_init (urj_cable_t *cable)
+opendous_connect (urj_cable_t *cable, const urj_param_t *params[])
 {
-    int result;
-    urj_usbconn_libusb_param_t *params;
     opendous_usbconn_data_t *data;
 
-    params = cable->link.usb->params;
-    params->data = malloc (sizeof (opendous_usbconn_data_t));
-    if (params->data == NULL)
+    if (urj_tap_cable_generic_usbconn_connect (cable, params) != URJ_STATUS_OK)
+	return URJ_STATUS_FAIL;
+
+    data = calloc (1, sizeof (*data));
+    if (data == NULL)
     {
-	urj_error_set(URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-		      sizeof(opendous_usbconn_data_t));
+	urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd) fails",
+		       sizeof (*data));
+	/* see ft2232_connect(): the caller frees the cable itself */
+	cable->link.usb->driver->free (cable->link.usb);
+	free (cable->params);
 	return URJ_STATUS_FAIL;
     }
-    data = params->data;
-    memset (data, 0, sizeof(*data));	/*be paranoid*/
+
+    /* kept in the cable rather than the USB connection, which may be a
+     * recording or a replay */
+    free (cable->params);
+    cable->params = data;
+
+    return URJ_STATUS_OK;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int
+opendous_init (urj_cable_t *cable)
+{
+    opendous_usbconn_data_t *data = cable->params;
 
     if (urj_tap_usbconn_open (cable->link.usb) != URJ_STATUS_OK) {
 	urj_log (URJ_LOG_LEVEL_ERROR, "Failed to open\n");
-	free(data);
 	return URJ_STATUS_FAIL;
     }
 
     data->last_tdo = 0;
     opendous_tap_init (data);
 
-    //result = opendous_usb_read(params); /*WAS NOT THERE*/
+    //result = opendous_usb_read(cable); /*WAS NOT THERE*/
     //urj_log (URJ_LOG_LEVEL_DEBUG, "result=%d\n", result);
 
     urj_log (URJ_LOG_LEVEL_DETAIL, "OPENDOUS JTAG Interface ready\n");
     urj_tap_cable_opendous_set_frequency (cable, 4E6);
-    urj_tap_cable_opendous_reset (params, 0, 0);
+    urj_tap_cable_opendous_reset (cable, 0, 0);
     
 #ifdef DEBUG_TRANSFER_STATS    
     debug_log=fopen("/tmp/Debug-log.txt","at");
@@ -521,9 +531,6 @@ opendous_init (urj_cable_t *cable)
 static void
 opendous_free (urj_cable_t *cable)
 {
-    opendous_usbconn_data_t *data;
-    data = ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->data;
-    free (data);
 #ifdef DEBUG_TRANSFER_STATS  
     if(debug_log) fclose(debug_log);
     debug_log=NULL;
@@ -538,8 +545,7 @@ urj_tap_cable_opendous_set_frequency (urj_cable_t *cable, uint32_t frequency)
 {
     /*int result;*/
     int speed = frequency / 1E3;
-    /*urj_usbconn_libusb_param_t *params = cable->link.usb->params;*/
-    /*opendous_usbconn_data_t *data = params->data;*/
+    /*opendous_usbconn_data_t *data = cable->params;*/
 
     if (1 <= speed && speed <= OPENDOUS_MAX_SPEED)
     {
@@ -559,23 +565,21 @@ static void
 opendous_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
     int i;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    opendous_usbconn_data_t *data = params->data;
+    opendous_usbconn_data_t *data = cable->params;
     for (i = 0; i < n; i++)
     {
       opendous_tap_append_step (data, tms, tdi);
       if (data->tap_length >= (OPENDOUS_TAP_BUFFER_SIZE*4))
-          opendous_tap_execute (params);
+          opendous_tap_execute (cable);
     }
-    opendous_tap_execute (params);
+    opendous_tap_execute (cable);
 }
 
 static void
 opendous_schedule_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
     int i;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    opendous_usbconn_data_t *data = params->data;
+    opendous_usbconn_data_t *data = cable->params;
     for (i = 0; i < n; i++)
     {
       opendous_schedule_tap_append_step (data, tms, tdi);
@@ -588,8 +592,7 @@ opendous_schedule_clock (urj_cable_t *cable, int tms, int tdi, int n)
 static int
 opendous_get_tdo (urj_cable_t *cable)
 {
-  urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-  opendous_usbconn_data_t *data = params->data;
+  opendous_usbconn_data_t *data = cable->params;
   // TODO: This is the TDO _before_ last clock occured
   // ...   Anyone knows how to get the current TDO state?
   return data->last_tdo;
@@ -613,8 +616,7 @@ static int
 opendous_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 {
     int i, j;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    opendous_usbconn_data_t *data = params->data;
+    opendous_usbconn_data_t *data = cable->params;
 
     //INFO ("Opendous transfer len:%d\n",len);
     for (j = 0, i = 0; i < len; i++)
@@ -623,27 +625,51 @@ opendous_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 
         if (data->tap_length >= OPENDOUS_TAP_BUFFER_SIZE*4)
         {
-            opendous_tap_execute (params);
+            if (opendous_tap_execute (cable) < 0)
+                return -1;
             if (out)
-                opendous_copy_out_data (data, i - j, j, out);
-            j = i;
+                opendous_copy_out_data (data, i + 1 - j, j, out);
+            j = i + 1;
         }
     }
     if (data->tap_length > 0)
     {
-        opendous_tap_execute (params);
+        if (opendous_tap_execute (cable) < 0)
+            return -1;
         if (out)
             opendous_copy_out_data (data, i - j, j, out);
     }
     return len;
 }
 
+static int
+opendous_tms_append (urj_cable_t *cable, int tms, int tdi)
+{
+    opendous_usbconn_data_t *data = cable->params;
+
+    opendous_tap_append_step (data, tms, tdi);
+
+    return data->tap_length >= OPENDOUS_TAP_BUFFER_SIZE*4;
+}
+
+/* Two bits, TDI and TMS, per clock in JTAG_CMD_TAP_OUTPUT commands; the
+ * reply has the TDO of each clock, LSB first. */
+static int
+opendous_tms_sequence (urj_cable_t *cable, int len, const char *seq, char *out)
+{
+    opendous_usbconn_data_t *data = cable->params;
+
+    return urj_tap_cable_generic_usbconn_tms_sequence (cable, len, seq, out,
+                                                       opendous_tms_append,
+                                                       opendous_tap_execute,
+                                                       data->usb_in_buffer);
+}
+
 static int
 opendous_schedule_transfer (urj_cable_t *cable, int len, char *in)
 {
     int i;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    opendous_usbconn_data_t *data = params->data;
+    opendous_usbconn_data_t *data = cable->params;
 
     for (i = 0; i < len; i++)
     {
@@ -655,6 +681,22 @@ opendous_schedule_transfer (urj_cable_t *cable, int len, char *in)
 
 
 
+static void
+opendous_schedule_sequence (urj_cable_t *cable, int len, const char *seq)
+{
+    int i;
+    opendous_usbconn_data_t *data = cable->params;
+
+    for (i = 0; i < len; i++)
+    {
+        opendous_schedule_tap_append_step (data,
+                                           (seq[i] & URJ_CABLE_SEQ_TMS) ? 1 : 0,
+                                           (seq[i] & URJ_CABLE_SEQ_TDI) ? 1 : 0);
+    }
+}
+
+
+
 /* ---------------------------------------------------------------------- */
 
 static int
@@ -667,118 +709,173 @@ opendous_set_signal (urj_cable_t *cable, int mask, int val)
 static void
 opendous_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much )
 {
-  urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-  opendous_usbconn_data_t *data=(opendous_usbconn_data_t*)params->data;
-  
-	if (how_much == URJ_TAP_CABLE_OPTIONALLY) return;
-  if (how_much == URJ_TAP_CABLE_TO_OUTPUT && cable->done.num_items>0) return;
-  
-  opendous_schedule_tap_init(data);
-#ifdef DEBUG_TRANSFER_STATS  
-  if(debug_log) fprintf (debug_log,"ff:%d %d\t",how_much,cable->todo.num_items);  
+    opendous_usbconn_data_t *data = cable->params;
+
+    if (how_much == URJ_TAP_CABLE_OPTIONALLY) return;
+    if (how_much == URJ_TAP_CABLE_TO_OUTPUT && cable->done.num_items>0) return;
+
+#ifdef DEBUG_TRANSFER_STATS
+    if(debug_log) fprintf (debug_log,"ff:%d %d\t",how_much,cable->todo.num_items);
 #endif //DEBUG_TRANSFER_STATS
-  
-	while (cable->todo.num_items > 0) //???
-	{
-		int i, j, n;
-
-		for (j = i = cable->todo.next_item, n = 0; n < cable->todo.num_items; n++)
-		{
-
-			switch (cable->todo.data[i].action)
-			{
-			case URJ_TAP_CABLE_CLOCK:
-				opendous_schedule_clock( cable,
-				                           cable->todo.data[i].arg.clock.tms,
-				                           cable->todo.data[i].arg.clock.tdi,
-				                           cable->todo.data[i].arg.clock.n );
-				break;
-
-			case URJ_TAP_CABLE_GET_TDO:
-       				 break;
-
-			case URJ_TAP_CABLE_TRANSFER:
-				opendous_schedule_transfer( cable,
-                                    cable->todo.data[i].arg.transfer.len,
-                                    cable->todo.data[i].arg.transfer.in);
-				break;
-
-			default:
-				break;
-			}
-
-			i++;
-			if (i >= cable->todo.max_items)
-				i = 0;
-		}
-    
 
-		opendous_schedule_flush(params);
-    int bit_pos=0;
-		while (j != i)
-		{
-			switch (cable->todo.data[j].action)
-			{
-			case URJ_TAP_CABLE_GET_TDO:
-				{
-					int m;
-					m = urj_tap_cable_add_queue_item( cable, &(cable->done) );
-					cable->done.data[m].action = URJ_TAP_CABLE_GET_TDO;
-					cable->done.data[m].arg.value.val = data->schedule_tdo[bit_pos/8]&(1<<(bit_pos%8))?1:0;
-					break;
-				}
-			case URJ_TAP_CABLE_GET_SIGNAL:
-				{
-					int m = urj_tap_cable_add_queue_item( cable, &(cable->done) );
-					cable->done.data[m].action = URJ_TAP_CABLE_GET_SIGNAL;
-					cable->done.data[m].arg.value.sig = cable->todo.data[j].arg.value.sig;
-					if (cable->todo.data[j].arg.value.sig == URJ_POD_CS_TRST)
-						cable->done.data[m].arg.value.val = 1;
-					else
-						cable->done.data[m].arg.value.val = -1; // not supported yet
-					break;
-				}
-      case URJ_TAP_CABLE_CLOCK:
-        bit_pos+=cable->todo.data[j].arg.clock.n;
-        break;
-			case URJ_TAP_CABLE_TRANSFER:
-				{
-					free( cable->todo.data[j].arg.transfer.in );
-					if (cable->todo.data[j].arg.transfer.out)
-					{
-            int k;
-						int m = urj_tap_cable_add_queue_item( cable, &(cable->done) );
-						if (m < 0)
-							fprintf(stderr,"out of memory!\n");
-            
-						cable->done.data[m].action = URJ_TAP_CABLE_TRANSFER;
-						cable->done.data[m].arg.xferred.len = cable->todo.data[j].arg.transfer.len;
-						cable->done.data[m].arg.xferred.res = 0;
-            
-						cable->done.data[m].arg.xferred.out = cable->todo.data[j].arg.transfer.out;
-            for(k=0;k< cable->todo.data[j].arg.transfer.len;k++)
+    while (cable->todo.num_items > 0)
+    {
+        int i, j, n, k, bits, res;
+        int bit_pos = 0;
+
+        /* Encode as much of the queue as the schedule buffer holds into
+           TAP output commands, which opendous_schedule_flush() sends with
+           as many clocks per USB exchange as the probe takes */
+        opendous_schedule_tap_init (data);
+        for (i = cable->todo.next_item, n = 0; n < cable->todo.num_items;
+             n++)
+        {
+            urj_cable_queue_t *item = &cable->todo.data[i];
+
+            switch (item->action)
             {
-              int offset=bit_pos+k;
-              cable->todo.data[j].arg.transfer.out[k]=
-								data->schedule_tdo[offset/8]&(1<<(offset%8))?1:0;
+            case URJ_TAP_CABLE_CLOCK:
+                bits = item->arg.clock.n;
+                break;
+            case URJ_TAP_CABLE_TRANSFER:
+                bits = item->arg.transfer.len;
+                break;
+            case URJ_TAP_CABLE_TMS_SEQUENCE:
+                bits = item->arg.sequence.len;
+                break;
+            default:
+                bits = 0;
+                break;
             }
-					}
-					bit_pos+=cable->todo.data[j].arg.transfer.len;
-				}
-			default:
-				break;
-			}
-
-			j++;
-			if (j >= cable->todo.max_items)
-				j = 0;
-			cable->todo.num_items--;
-		}
-    
-    data->last_tdo = (data->schedule_tdo[bit_pos/8])&(1<<(bit_pos%8))? 1 : 0;
-		cable->todo.next_item = i;
-	}
-  
+            if (n > 0 && data->schedule_tap_length + bits
+                > OPENDOUS_SCHEDULE_BUFFER_SIZE * 4)
+                break;
+
+            switch (item->action)
+            {
+            case URJ_TAP_CABLE_CLOCK:
+                opendous_schedule_clock (cable, item->arg.clock.tms,
+                                         item->arg.clock.tdi,
+                                         item->arg.clock.n);
+                break;
+
+            case URJ_TAP_CABLE_TRANSFER:
+                opendous_schedule_transfer (cable, item->arg.transfer.len,
+                                            item->arg.transfer.in);
+                break;
+
+            case URJ_TAP_CABLE_TMS_SEQUENCE:
+                opendous_schedule_sequence (cable, item->arg.sequence.len,
+                                            item->arg.sequence.seq);
+                break;
+
+            default:
+                break;
+            }
+
+            i++;
+            if (i >= cable->todo.max_items)
+                i = 0;
+        }
+
+        bits = data->schedule_tap_length;
+        res = opendous_schedule_flush (cable) < 0 ? -1 : 0;
+
+        /* Hand out the results of the n items just done; bit k of
+           schedule_tdo is TDO as sampled by clock k */
+        for (k = 0; k < n; k++)
+        {
+            urj_cable_queue_t *item;
+
+            j = urj_tap_cable_get_queue_item (cable, &cable->todo);
+            item = &cable->todo.data[j];
+
+            switch (item->action)
+            {
+            case URJ_TAP_CABLE_GET_TDO:
+                {
+                    int m = urj_tap_cable_add_queue_item (cable, &cable->done);
+                    cable->done.data[m].action = URJ_TAP_CABLE_GET_TDO;
+                    /* TDO as the next clock samples it; with no clock
+                       after it in the batch the probe has nothing to
+                       sample with, and this is the cached bit sampled
+                       by the last clock, before its TCK edge */
+                    if (bit_pos < bits)
+                        cable->done.data[m].arg.value.val =
+                            (data->schedule_tdo[bit_pos / 8]
+                             >> (bit_pos % 8)) & 1;
+                    else
+                        cable->done.data[m].arg.value.val = data->last_tdo;
+                    break;
+                }
+            case URJ_TAP_CABLE_GET_SIGNAL:
+                {
+                    int m = urj_tap_cable_add_queue_item (cable, &cable->done);
+                    cable->done.data[m].action = URJ_TAP_CABLE_GET_SIGNAL;
+                    cable->done.data[m].arg.value.sig = item->arg.value.sig;
+                    if (item->arg.value.sig == URJ_POD_CS_TRST)
+                        cable->done.data[m].arg.value.val = 1;
+                    else
+                        cable->done.data[m].arg.value.val = -1; // not supported yet
+                    break;
+                }
+            case URJ_TAP_CABLE_CLOCK:
+                bit_pos += item->arg.clock.n;
+                break;
+            case URJ_TAP_CABLE_TRANSFER:
+                if (item->arg.transfer.out)
+                {
+                    int b;
+                    int m = urj_tap_cable_add_queue_item (cable, &cable->done);
+
+                    cable->done.data[m].action = URJ_TAP_CABLE_TRANSFER;
+                    cable->done.data[m].arg.xferred.len = item->arg.transfer.len;
+                    cable->done.data[m].arg.xferred.res = res;
+                    cable->done.data[m].arg.xferred.out = item->arg.transfer.out;
+                    for (b = 0; b < item->arg.transfer.len; b++)
+                    {
+                        int offset = bit_pos + b;
+                        item->arg.transfer.out[b] =
+                            (data->schedule_tdo[offset / 8] >> (offset % 8)) & 1;
+                    }
+                }
+                bit_pos += item->arg.transfer.len;
+                break;
+            case URJ_TAP_CABLE_TMS_SEQUENCE:
+                {
+                    const char *seq = item->arg.sequence.seq;
+                    char *out = item->arg.sequence.out;
+                    int b, r = 0;
+
+                    if (out)
+                    {
+                        int m;
+
+                        for (b = 0; b < item->arg.sequence.len; b++)
+                        {
+                            int offset = bit_pos + b;
+                            if (seq[b] & URJ_CABLE_SEQ_CAPTURE)
+                                out[r++] = (data->schedule_tdo[offset / 8]
+                                            >> (offset % 8)) & 1;
+                        }
+                        m = urj_tap_cable_add_queue_item (cable, &cable->done);
+                        cable->done.data[m].action = URJ_TAP_CABLE_TMS_SEQUENCE;
+                        cable->done.data[m].arg.xferred.len = r;
+                        cable->done.data[m].arg.xferred.res = res < 0 ? res : r;
+                        cable->done.data[m].arg.xferred.out = out;
+                    }
+                    bit_pos += item->arg.sequence.len;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (bits > 0)
+            data->last_tdo = (data->schedule_tdo[(bits - 1) / 8]
+                              >> ((bits - 1) % 8)) & 1;
+    }
 }
 
 
@@ -786,7 +883,7 @@ const urj_cable_driver_t urj_tap_cable_opendous_driver = {
 	"opendous",
 	N_("Opendous based JTAG"),
 	URJ_CABLE_DEVICE_USB,
-	{ .usb = urj_tap_cable_generic_usbconn_connect, },
+	{ .usb = opendous_connect, },
 	urj_tap_cable_generic_disconnect,
 	opendous_free,
 	opendous_init,
@@ -798,7 +895,9 @@ const urj_cable_driver_t urj_tap_cable_opendous_driver = {
 	opendous_set_signal,
 	urj_tap_cable_generic_get_signal,
 	opendous_flush,
-	urj_tap_cable_generic_usbconn_help
+	urj_tap_cable_generic_usbconn_help,
+	0,
+	opendous_tms_sequence
 };
 
 // (vid, pid, driver, name, cable)
@@ -0,0 +1,1109 @@
+/*
+ * $Id$
+ *
+ * Remote cable driver, talking to a cable of another UrJTAG over TCP
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ * The cable does not drive any pins itself. Its flush() method encodes the
+ * whole queue of deferred cable activity into one message and sends it to
+ * urj_tap_cable_remote_serve() (see jtag-serve), which queues the same
+ * activity on its local cable and answers with the results, so a scan
+ * costs one network round trip rather than one per driver method.
+ *
+ * Every message is a type byte and the 32 bit length of the payload
+ * that follows; all numbers are little endian. Batches carry a flag byte
+ * and then the items, each an action byte with its arguments:
+ *
+ *   'c' clock          TMS, TDI (bytes), count
+ *   'g' get_tdo
+ *   't' transfer       length, flags (REMOTE_OUT), TDI bits
+ *   's' set_signal     mask, value
+ *   'G' get_signal     signal
+ *   'q' tms_sequence   length, flags (REMOTE_OUT), one byte per clock
+ *
+ * Bits are packed eight to a byte, LSB first. The reply to a batch holds
+ * the results in the order of their items: TDO or signal values, or the
+ * return value of a transfer or sequence followed by its TDO bits.
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+
+#include <urjtag/cable.h>
+#include <urjtag/chain.h>
+#include <urjtag/error.h>
+#include <urjtag/log.h>
+
+#include "generic.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define REMOTE_VERSION          1
+#define REMOTE_HEADER           5       /* type and payload length */
+#define REMOTE_MAX_PAYLOAD      (64 * 1024 * 1024)
+
+/* message types */
+#define REMOTE_HELLO            'H'     /* version; answered alike */
+#define REMOTE_FREQUENCY        'F'     /* frequency; answers the new one */
+#define REMOTE_SIGNAL           'S'     /* mask, value; answers the old */
+#define REMOTE_BATCH            'B'     /* flags, items; answered by: */
+#define REMOTE_RESULTS          'R'     /* results of the batch */
+#define REMOTE_ERROR            'E'     /* message of a failure */
+
+/* batch flags */
+#define REMOTE_SYNC             0x1     /* answer even without results */
+
+/* item actions */
+#define REMOTE_CLOCK            'c'
+#define REMOTE_GET_TDO          'g'
+#define REMOTE_TRANSFER         't'
+#define REMOTE_SET_SIGNAL       's'
+#define REMOTE_GET_SIGNAL       'G'
+#define REMOTE_TMS_SEQUENCE     'q'
+
+/* transfer and sequence flags */
+#define REMOTE_OUT              0x1     /* TDO bits wanted */
+
+/* An optional flush leaves the queue alone until it has this many items */
+#define REMOTE_OPTIONAL_ITEMS   1024
+
+typedef struct
+{
+    unsigned char *data;
+    size_t len;
+    size_t size;
+}
+remote_buf_t;
+
+typedef struct
+{
+    const unsigned char *data;
+    size_t len;
+    size_t pos;
+    int bad;                    /* read beyond the end */
+}
+remote_reader_t;
+
+/* private parameters of this cable driver */
+typedef struct
+{
+    int fd;
+    remote_buf_t msg;
+    remote_buf_t reply;
+}
+remote_params_t;
+
+/* ---------------------------------------------------------------------- */
+
+static int
+remote_reserve (remote_buf_t *b, size_t n)
+{
+    unsigned char *data;
+    size_t size;
+
+    if (b->len + n <= b->size)
+        return URJ_STATUS_OK;
+
+    size = b->size ? b->size : 4096;
+    while (size < b->len + n)
+        size *= 2;
+    data = realloc (b->data, size);
+    if (data == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("realloc(%zd) fails"),
+                       size);
+        return URJ_STATUS_FAIL;
+    }
+    b->data = data;
+    b->size = size;
+
+    return URJ_STATUS_OK;
+}
+
+static int
+remote_put_u8 (remote_buf_t *b, int v)
+{
+    if (remote_reserve (b, 1) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    b->data[b->len++] = v;
+    return URJ_STATUS_OK;
+}
+
+static void
+remote_set_u32 (unsigned char *p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static int
+remote_put_u32 (remote_buf_t *b, uint32_t v)
+{
+    if (remote_reserve (b, 4) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    remote_set_u32 (b->data + b->len, v);
+    b->len += 4;
+    return URJ_STATUS_OK;
+}
+
+static int
+remote_put_bytes (remote_buf_t *b, const char *bytes, int n)
+{
+    if (remote_reserve (b, n) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    memcpy (b->data + b->len, bytes, n);
+    b->len += n;
+    return URJ_STATUS_OK;
+}
+
+/* Pack @n bits, one per char in @bits */
+static int
+remote_put_bits (remote_buf_t *b, const char *bits, int n)
+{
+    int i;
+
+    if (remote_reserve (b, (n + 7) / 8) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    memset (b->data + b->len, 0, (n + 7) / 8);
+    for (i = 0; i < n; i++)
+        if (bits[i] & 1)
+            b->data[b->len + i / 8] |= 1 << (i % 8);
+    b->len += (n + 7) / 8;
+    return URJ_STATUS_OK;
+}
+
+static const unsigned char *
+remote_get (remote_reader_t *r, size_t n)
+{
+    const unsigned char *p;
+
+    if (r->bad || r->len - r->pos < n)
+    {
+        r->bad = 1;
+        return NULL;
+    }
+    p = r->data + r->pos;
+    r->pos += n;
+    return p;
+}
+
+static int
+remote_get_u8 (remote_reader_t *r)
+{
+    const unsigned char *p = remote_get (r, 1);
+
+    return p ? p[0] : 0;
+}
+
+static uint32_t
+remote_get_u32 (remote_reader_t *r)
+{
+    const unsigned char *p = remote_get (r, 4);
+
+    if (p == NULL)
+        return 0;
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/* Unpack @n bits to one char each in @bits */
+static int
+remote_get_bits (remote_reader_t *r, char *bits, int n)
+{
+    const unsigned char *p = remote_get (r, (n + 7) / 8);
+    int i;
+
+    if (p == NULL)
+        return URJ_STATUS_FAIL;
+    for (i = 0; i < n; i++)
+        bits[i] = (p[i / 8] >> (i % 8)) & 1;
+    return URJ_STATUS_OK;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* Start a message in @b, leaving room for the header */
+static void
+remote_begin (remote_buf_t *b)
+{
+    b->len = 0;
+    remote_reserve (b, REMOTE_HEADER);
+    b->len = REMOTE_HEADER;
+}
+
+static int
+remote_send (int fd, int type, remote_buf_t *b)
+{
+    size_t done = 0;
+    ssize_t n;
+
+    if (b->size < REMOTE_HEADER)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("message buffer missing"));
+        return URJ_STATUS_FAIL;
+    }
+    b->data[0] = type;
+    remote_set_u32 (b->data + 1, b->len - REMOTE_HEADER);
+
+    while (done < b->len)
+    {
+        n = send (fd, b->data + done, b->len - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            urj_error_IO_set (_("send() to remote cable fails"));
+            return URJ_STATUS_FAIL;
+        }
+        done += n;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+/* Read @len bytes; *@closed is set if the other side closed the connection
+ * before the first of them */
+static int
+remote_read_all (int fd, unsigned char *buf, size_t len, int *closed)
+{
+    size_t done = 0;
+    ssize_t n;
+
+    while (done < len)
+    {
+        n = recv (fd, buf + done, len - done, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            urj_error_IO_set (_("recv() from remote cable fails"));
+            return URJ_STATUS_FAIL;
+        }
+        if (n == 0 && done == 0 && closed != NULL)
+        {
+            *closed = 1;
+            return URJ_STATUS_FAIL;
+        }
+        if (n == 0)
+        {
+            urj_error_set (URJ_ERROR_IO, _("remote cable closed the connection"));
+            return URJ_STATUS_FAIL;
+        }
+        done += n;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+/* Receive a message to @b, its payload starting at b->data */
+static int
+remote_recv (int fd, int *type, remote_buf_t *b, int *closed)
+{
+    unsigned char header[REMOTE_HEADER];
+    uint32_t len;
+
+    if (remote_read_all (fd, header, REMOTE_HEADER, closed) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    len = header[1] | (header[2] << 8) | (header[3] << 16)
+        | ((uint32_t) header[4] << 24);
+    if (len > REMOTE_MAX_PAYLOAD)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
+                       _("remote message of %lu bytes is too large"),
+                       (unsigned long) len);
+        return URJ_STATUS_FAIL;
+    }
+
+    b->len = 0;
+    if (remote_reserve (b, len + 1) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (remote_read_all (fd, b->data, len, NULL) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    b->len = len;
+    *type = header[0];
+
+    return URJ_STATUS_OK;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int
+remote_put_item (remote_buf_t *b, const urj_cable_queue_t *item)
+{
+    int r = URJ_STATUS_OK;
+
+    switch (item->action)
+    {
+    case URJ_TAP_CABLE_CLOCK:
+        r |= remote_put_u8 (b, REMOTE_CLOCK);
+        r |= remote_put_u8 (b, item->arg.clock.tms ? 1 : 0);
+        r |= remote_put_u8 (b, item->arg.clock.tdi ? 1 : 0);
+        r |= remote_put_u32 (b, item->arg.clock.n);
+        break;
+    case URJ_TAP_CABLE_GET_TDO:
+        r |= remote_put_u8 (b, REMOTE_GET_TDO);
+        break;
+    case URJ_TAP_CABLE_TRANSFER:
+        r |= remote_put_u8 (b, REMOTE_TRANSFER);
+        r |= remote_put_u32 (b, item->arg.transfer.len);
+        r |= remote_put_u8 (b, item->arg.transfer.out ? REMOTE_OUT : 0);
+        r |= remote_put_bits (b, item->arg.transfer.in,
+                              item->arg.transfer.len);
+        break;
+    case URJ_TAP_CABLE_SET_SIGNAL:
+        r |= remote_put_u8 (b, REMOTE_SET_SIGNAL);
+        r |= remote_put_u32 (b, item->arg.value.sig);
+        r |= remote_put_u32 (b, item->arg.value.val);
+        break;
+    case URJ_TAP_CABLE_GET_SIGNAL:
+        r |= remote_put_u8 (b, REMOTE_GET_SIGNAL);
+        r |= remote_put_u32 (b, item->arg.value.sig);
+        break;
+    case URJ_TAP_CABLE_TMS_SEQUENCE:
+        r |= remote_put_u8 (b, REMOTE_TMS_SEQUENCE);
+        r |= remote_put_u32 (b, item->arg.sequence.len);
+        r |= remote_put_u8 (b, item->arg.sequence.out ? REMOTE_OUT : 0);
+        r |= remote_put_bytes (b, item->arg.sequence.seq,
+                               item->arg.sequence.len);
+        break;
+    default:
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("cable activity %d can't be sent to a remote cable"),
+                       item->action);
+        return URJ_STATUS_FAIL;
+    }
+
+    return r == URJ_STATUS_OK ? URJ_STATUS_OK : URJ_STATUS_FAIL;
+}
+
+/* Whether the remote side answers @item with a result */
+static int
+remote_has_result (const urj_cable_queue_t *item)
+{
+    switch (item->action)
+    {
+    case URJ_TAP_CABLE_GET_TDO:
+    case URJ_TAP_CABLE_GET_SIGNAL:
+        return 1;
+    case URJ_TAP_CABLE_TRANSFER:
+        return item->arg.transfer.out != NULL;
+    case URJ_TAP_CABLE_TMS_SEQUENCE:
+        return item->arg.sequence.out != NULL;
+    default:
+        return 0;
+    }
+}
+
+/* Take the result of @item from @r; TDO bits go to the item's buffer.
+ * Returns what the driver method would have. */
+static int
+remote_take_result (remote_reader_t *r, const urj_cable_queue_t *item)
+{
+    int res = (int32_t) remote_get_u32 (r);
+
+    switch (item->action)
+    {
+    case URJ_TAP_CABLE_TRANSFER:
+        remote_get_bits (r, item->arg.transfer.out, item->arg.transfer.len);
+        break;
+    case URJ_TAP_CABLE_TMS_SEQUENCE:
+        if (res > 0)
+            remote_get_bits (r, item->arg.sequence.out, res);
+        break;
+    default:
+        break;
+    }
+
+    return r->bad ? -1 : res;
+}
+
+/* Send the batch in p->msg and, if @wait, read the answer into @r */
+static int
+remote_exchange (urj_cable_t *cable, int wait, remote_reader_t *r)
+{
+    remote_params_t *p = cable->params;
+    int type;
+
+    memset (r, 0, sizeof (*r));
+    r->bad = 1;
+
+    cable->stats.transactions++;
+    cable->stats.bytes_out += p->msg.len;
+    if (remote_send (p->fd, REMOTE_BATCH, &p->msg) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (!wait)
+        return URJ_STATUS_OK;
+
+    if (remote_recv (p->fd, &type, &p->reply, NULL) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    cable->stats.bytes_in += REMOTE_HEADER + p->reply.len;
+    if (type == REMOTE_ERROR)
+    {
+        p->reply.data[p->reply.len] = '\0';
+        urj_error_set (URJ_ERROR_IO, _("remote cable: %s"), p->reply.data);
+        return URJ_STATUS_FAIL;
+    }
+    if (type != REMOTE_RESULTS)
+    {
+        urj_error_set (URJ_ERROR_IO, _("unexpected remote message '%c'"),
+                       type);
+        return URJ_STATUS_FAIL;
+    }
+
+    r->data = p->reply.data;
+    r->len = p->reply.len;
+    r->bad = 0;
+
+    return URJ_STATUS_OK;
+}
+
+/* Run a single driver method on the remote cable */
+static int
+remote_run (urj_cable_t *cable, const urj_cable_queue_t *item)
+{
+    remote_params_t *p = cable->params;
+    remote_reader_t r;
+    int wait = remote_has_result (item);
+
+    remote_begin (&p->msg);
+    remote_put_u8 (&p->msg, wait ? 0 : REMOTE_SYNC);
+    if (remote_put_item (&p->msg, item) != URJ_STATUS_OK
+        || remote_exchange (cable, 1, &r) != URJ_STATUS_OK)
+    {
+        urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+        return -1;
+    }
+
+    return wait ? remote_take_result (&r, item) : 0;
+}
+
+/* Send a message other than a batch and return the number it answers */
+static int
+remote_call (urj_cable_t *cable, int type, uint32_t a, uint32_t b, int args,
+             uint32_t *answer)
+{
+    remote_params_t *p = cable->params;
+    remote_reader_t r;
+    int rtype;
+
+    remote_begin (&p->msg);
+    remote_put_u32 (&p->msg, a);
+    if (args > 1)
+        remote_put_u32 (&p->msg, b);
+    cable->stats.transactions++;
+    cable->stats.bytes_out += p->msg.len;
+    if (remote_send (p->fd, type, &p->msg) != URJ_STATUS_OK
+        || remote_recv (p->fd, &rtype, &p->reply, NULL) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    cable->stats.bytes_in += REMOTE_HEADER + p->reply.len;
+    if (rtype == REMOTE_ERROR)
+    {
+        p->reply.data[p->reply.len] = '\0';
+        urj_error_set (URJ_ERROR_IO, _("remote cable: %s"), p->reply.data);
+        return URJ_STATUS_FAIL;
+    }
+
+    memset (&r, 0, sizeof (r));
+    r.data = p->reply.data;
+    r.len = p->reply.len;
+    *answer = remote_get_u32 (&r);
+    if (rtype != type || r.bad)
+    {
+        urj_error_set (URJ_ERROR_IO, _("unexpected remote message '%c'"),
+                       rtype);
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int
+remote_connect (urj_cable_t *cable, const urj_param_t *params[])
+{
+    remote_params_t *p;
+    const char *host = "localhost";
+    char port[16];
+    struct addrinfo hints, *res, *ai;
+    int fd = -1;
+    int one = 1;
+    int i, e;
+
+    snprintf (port, sizeof port, "%d", URJ_CABLE_REMOTE_PORT);
+
+    if (params != NULL)
+        for (i = 0; params[i] != NULL; i++)
+        {
+            switch (params[i]->key)
+            {
+            case URJ_CABLE_PARAM_KEY_HOST:
+                host = params[i]->value.string;
+                break;
+            case URJ_CABLE_PARAM_KEY_PORT:
+                snprintf (port, sizeof port, "%lu", params[i]->value.lu);
+                break;
+            default:
+                urj_error_set (URJ_ERROR_SYNTAX,
+                               _("unsupported parameter for this cable"));
+                return URJ_STATUS_FAIL;
+            }
+        }
+
+    memset (&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    e = getaddrinfo (host, port, &hints, &res);
+    if (e != 0)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND, _("unknown host '%s': %s"),
+                       host, gai_strerror (e));
+        return URJ_STATUS_FAIL;
+    }
+    for (ai = res; ai != NULL; ai = ai->ai_next)
+    {
+        fd = socket (ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        if (connect (fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        close (fd);
+        fd = -1;
+    }
+    freeaddrinfo (res);
+    if (fd < 0)
+    {
+        urj_error_IO_set (_("Unable to connect to %s port %s"), host, port);
+        return URJ_STATUS_FAIL;
+    }
+    /* batches are complete messages, don't hold them back */
+    setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+
+    p = calloc (1, sizeof (remote_params_t));
+    if (!p)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd) fails"),
+                       sizeof (remote_params_t));
+        close (fd);
+        return URJ_STATUS_FAIL;
+    }
+    p->fd = fd;
+    cable->params = p;
+    cable->chain = NULL;
+
+    urj_log (URJ_LOG_LEVEL_NORMAL, _("Connected to remote cable at %s:%s\n"),
+             host, port);
+
+    return URJ_STATUS_OK;
+}
+
+static void
+remote_disconnect (urj_cable_t *cable)
+{
+    urj_tap_cable_done (cable);
+    urj_tap_chain_disconnect (cable->chain);
+}
+
+static void
+remote_free (urj_cable_t *cable)
+{
+    remote_params_t *p = cable->params;
+
+    if (p != NULL)
+    {
+        if (p->fd >= 0)
+            close (p->fd);
+        free (p->msg.data);
+        free (p->reply.data);
+        free (p);
+    }
+    free (cable);
+}
+
+static int
+remote_init (urj_cable_t *cable)
+{
+    uint32_t version;
+
+    if (remote_call (cable, REMOTE_HELLO, REMOTE_VERSION, 0, 1, &version)
+        != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (version != REMOTE_VERSION)
+    {
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("remote cable speaks protocol version %lu, not %d"),
+                       (unsigned long) version, REMOTE_VERSION);
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+static void
+remote_done (urj_cable_t *cable)
+{
+}
+
+static void
+remote_set_frequency (urj_cable_t *cable, uint32_t new_frequency)
+{
+    uint32_t frequency;
+
+    if (remote_call (cable, REMOTE_FREQUENCY, new_frequency, 0, 1, &frequency)
+        != URJ_STATUS_OK)
+    {
+        urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+        return;
+    }
+    cable->frequency = frequency;
+}
+
+static void
+remote_clock (urj_cable_t *cable, int tms, int tdi, int n)
+{
+    urj_cable_queue_t item;
+
+    item.action = URJ_TAP_CABLE_CLOCK;
+    item.arg.clock.tms = tms;
+    item.arg.clock.tdi = tdi;
+    item.arg.clock.n = n;
+    remote_run (cable, &item);
+}
+
+static int
+remote_get_tdo (urj_cable_t *cable)
+{
+    urj_cable_queue_t item;
+
+    item.action = URJ_TAP_CABLE_GET_TDO;
+    return remote_run (cable, &item);
+}
+
+static int
+remote_transfer (urj_cable_t *cable, int len, const char *in, char *out)
+{
+    urj_cable_queue_t item;
+    int r;
+
+    item.action = URJ_TAP_CABLE_TRANSFER;
+    item.arg.transfer.len = len;
+    item.arg.transfer.in = (char *) in;
+    item.arg.transfer.out = out;
+    /* with TDO bits wanted, the server answers the transfer's status */
+    r = remote_run (cable, &item);
+    if (r < 0)
+    {
+        urj_error_set (URJ_ERROR_IO,
+                       _("remote cable: transfer of %d bits failed"), len);
+        return -1;
+    }
+    return len;
+}
+
+static int
+remote_tms_sequence (urj_cable_t *cable, int len, const char *seq, char *out)
+{
+    urj_cable_queue_t item;
+
+    item.action = URJ_TAP_CABLE_TMS_SEQUENCE;
+    item.arg.sequence.len = len;
+    item.arg.sequence.seq = (char *) seq;
+    item.arg.sequence.out = out;
+    return remote_run (cable, &item);
+}
+
+static int
+remote_set_signal (urj_cable_t *cable, int mask, int val)
+{
+    uint32_t old;
+
+    if (remote_call (cable, REMOTE_SIGNAL, mask, val, 2, &old)
+        != URJ_STATUS_OK)
+    {
+        urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+        return -1;
+    }
+    return (int32_t) old;
+}
+
+static int
+remote_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig)
+{
+    urj_cable_queue_t item;
+
+    item.action = URJ_TAP_CABLE_GET_SIGNAL;
+    item.arg.value.sig = sig;
+    return remote_run (cable, &item);
+}
+
+static void
+remote_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
+{
+    remote_params_t *p = cable->params;
+    urj_cable_queue_t *item;
+    remote_reader_t r;
+    int results = 0;
+    int i, j, k, n, sent;
+
+    n = cable->todo.num_items;
+    if (n == 0)
+        return;
+    if (how_much == URJ_TAP_CABLE_OPTIONALLY && n < REMOTE_OPTIONAL_ITEMS)
+        return;
+
+    remote_begin (&p->msg);
+    remote_put_u8 (&p->msg,
+                   how_much == URJ_TAP_CABLE_COMPLETELY ? REMOTE_SYNC : 0);
+    for (k = 0, i = cable->todo.next_item; k < n; k++)
+    {
+        item = &cable->todo.data[i];
+        if (remote_put_item (&p->msg, item) != URJ_STATUS_OK)
+        {
+            urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+            break;
+        }
+        results += remote_has_result (item);
+        if (++i >= cable->todo.max_items)
+            i = 0;
+    }
+    sent = k;
+
+    if (sent > 0 && remote_exchange (cable, results > 0
+                                     || how_much == URJ_TAP_CABLE_COMPLETELY,
+                                     &r) != URJ_STATUS_OK)
+        urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+
+    /* fill the done queue like urj_tap_cable_generic_flush_one_by_one();
+     * an item that couldn't be sent fails, and so do the ones after it,
+     * rather than stay queued to fail again on every flush */
+    for (k = 0; k < n; k++)
+    {
+        if (k == sent)
+            r.bad = 1;
+        i = urj_tap_cable_get_queue_item (cable, &cable->todo);
+        item = &cable->todo.data[i];
+        if (!remote_has_result (item))
+            continue;
+
+        j = urj_tap_cable_add_queue_item (cable, &cable->done);
+        if (j < 0)
+            break;
+        cable->done.data[j].action = item->action;
+        switch (item->action)
+        {
+        case URJ_TAP_CABLE_GET_TDO:
+            cable->done.data[j].arg.value.val = remote_take_result (&r, item);
+            break;
+        case URJ_TAP_CABLE_GET_SIGNAL:
+            cable->done.data[j].arg.value.sig = item->arg.value.sig;
+            cable->done.data[j].arg.value.val = remote_take_result (&r, item);
+            break;
+        case URJ_TAP_CABLE_TRANSFER:
+            cable->done.data[j].arg.xferred.len = item->arg.transfer.len;
+            cable->done.data[j].arg.xferred.res =
+                remote_take_result (&r, item);
+            cable->done.data[j].arg.xferred.out = item->arg.transfer.out;
+            break;
+        case URJ_TAP_CABLE_TMS_SEQUENCE:
+            {
+                int res = remote_take_result (&r, item);
+
+                cable->done.data[j].arg.xferred.len = res < 0 ? 0 : res;
+                cable->done.data[j].arg.xferred.res = res;
+                cable->done.data[j].arg.xferred.out = item->arg.sequence.out;
+                break;
+            }
+        default:
+            break;
+        }
+    }
+}
+
+static void
+remote_help (urj_log_level_t ll, const char *cablename)
+{
+    urj_log (ll,
+             _("Usage: cable %s [host=HOST] [port=PORT]\n"
+               "\n"
+               "host       computer running jtag-serve (default localhost)\n"
+               "port       TCP port of jtag-serve (default %d)\n"
+               "\n"),
+             cablename, URJ_CABLE_REMOTE_PORT);
+}
+
+const urj_cable_driver_t urj_tap_cable_remote_driver = {
+    "remote",
+    N_("Cable of a jtag-serve on another computer (TCP)"),
+    URJ_CABLE_DEVICE_OTHER,
+    { .other = remote_connect, },
+    remote_disconnect,
+    remote_free,
+    remote_init,
+    remote_done,
+    remote_set_frequency,
+    remote_clock,
+    remote_get_tdo,
+    remote_transfer,
+    remote_set_signal,
+    remote_get_signal,
+    remote_flush,
+    remote_help,
+    0,
+    remote_tms_sequence
+};
+
+/* ---------------------------------------------------------------------- */
+
+static int
+remote_serve_error (int fd, remote_buf_t *b)
+{
+    const char *msg = urj_error_describe ();
+
+    remote_begin (b);
+    remote_put_bytes (b, msg, strlen (msg));
+    urj_error_reset ();
+    return remote_send (fd, REMOTE_ERROR, b);
+}
+
+/* Queue the items of a batch on @cable (@collect = 0), or collect their
+ * results into @out (@collect = 1), using @tmp for the TDO bits */
+static int
+remote_serve_items (urj_cable_t *cable, remote_reader_t *r, int collect,
+                    remote_buf_t *out, remote_buf_t *tmp)
+{
+    char *buf;
+    int action, len, flags, res;
+    int tms, tdi;
+
+    while (r->pos < r->len && !r->bad)
+    {
+        action = remote_get_u8 (r);
+        switch (action)
+        {
+        case REMOTE_CLOCK:
+            tms = remote_get_u8 (r);
+            tdi = remote_get_u8 (r);
+            len = remote_get_u32 (r);
+            if (!collect && !r->bad
+                && urj_tap_cable_defer_clock (cable, tms, tdi, len)
+                   != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+            break;
+
+        case REMOTE_GET_TDO:
+            if (!collect)
+            {
+                if (urj_tap_cable_defer_get_tdo (cable) != URJ_STATUS_OK)
+                    return URJ_STATUS_FAIL;
+            }
+            else if (remote_put_u32 (out, urj_tap_cable_get_tdo_late (cable))
+                     != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+            break;
+
+        case REMOTE_TRANSFER:
+        case REMOTE_TMS_SEQUENCE:
+            len = remote_get_u32 (r);
+            flags = remote_get_u8 (r);
+            if (r->bad || len < 0 || len > REMOTE_MAX_PAYLOAD)
+                break;
+            if (!collect)
+            {
+                buf = urj_tap_cable_arena_alloc (cable,
+                                                 (flags & REMOTE_OUT)
+                                                 ? 2 * len : len);
+                if (buf == NULL)
+                    return URJ_STATUS_FAIL;
+                if (action == REMOTE_TRANSFER)
+                {
+                    if (remote_get_bits (r, buf, len) != URJ_STATUS_OK)
+                        break;
+                    res = urj_tap_cable_defer_transfer_nocopy (cable, len,
+                                buf, (flags & REMOTE_OUT) ? buf + len : NULL);
+                }
+                else
+                {
+                    const unsigned char *seq = remote_get (r, len);
+
+                    if (seq == NULL)
+                        break;
+                    memcpy (buf, seq, len);
+                    res = urj_tap_cable_defer_tms_sequence (cable, len, buf,
+                                (flags & REMOTE_OUT) ? buf + len : NULL);
+                }
+                if (res != URJ_STATUS_OK)
+                    return URJ_STATUS_FAIL;
+                break;
+            }
+
+            remote_get (r, action == REMOTE_TRANSFER ? (len + 7) / 8 : len);
+            if (!(flags & REMOTE_OUT))
+                break;
+            tmp->len = 0;
+            if (remote_reserve (tmp, len) != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+            buf = (char *) tmp->data;
+            if (action == REMOTE_TRANSFER)
+                res = urj_tap_cable_transfer_late (cable, buf);
+            else
+                res = urj_tap_cable_tms_sequence_late (cable, buf);
+            if (remote_put_u32 (out, res) != URJ_STATUS_OK
+                || remote_put_bits (out, buf,
+                                    action == REMOTE_TRANSFER ? len
+                                    : res > 0 ? res : 0) != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+            break;
+
+        case REMOTE_SET_SIGNAL:
+            tms = remote_get_u32 (r);
+            tdi = remote_get_u32 (r);
+            if (!collect && !r->bad
+                && urj_tap_cable_defer_set_signal (cable, tms, tdi)
+                   != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+            break;
+
+        case REMOTE_GET_SIGNAL:
+            len = remote_get_u32 (r);
+            if (r->bad)
+                break;
+            if (!collect)
+            {
+                if (urj_tap_cable_defer_get_signal (cable, len)
+                    != URJ_STATUS_OK)
+                    return URJ_STATUS_FAIL;
+            }
+            else if (remote_put_u32 (out,
+                                     urj_tap_cable_get_signal_late (cable,
+                                                                    len))
+                     != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+            break;
+
+        default:
+            r->bad = 1;
+            break;
+        }
+    }
+
+    if (r->bad)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX, _("malformed remote batch"));
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_tap_cable_remote_serve (urj_cable_t *cable, int fd)
+{
+    remote_buf_t in = { NULL, 0, 0 };
+    remote_buf_t out = { NULL, 0, 0 };
+    remote_buf_t bits = { NULL, 0, 0 };
+    remote_reader_t r;
+    uint32_t a, b;
+    int type, flags;
+    int status = URJ_STATUS_OK;
+    int closed = 0;
+    int one = 1;
+
+    setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+
+    while (status == URJ_STATUS_OK)
+    {
+        if (remote_recv (fd, &type, &in, &closed) != URJ_STATUS_OK)
+        {
+            /* the client going away is the normal end */
+            if (!closed)
+                status = URJ_STATUS_FAIL;
+            break;
+        }
+        memset (&r, 0, sizeof (r));
+        r.data = in.data;
+        r.len = in.len;
+        remote_begin (&out);
+
+        switch (type)
+        {
+        case REMOTE_HELLO:
+            remote_get_u32 (&r);
+            remote_put_u32 (&out, REMOTE_VERSION);
+            status = remote_send (fd, REMOTE_HELLO, &out);
+            break;
+
+        case REMOTE_FREQUENCY:
+            a = remote_get_u32 (&r);
+            urj_tap_cable_set_frequency (cable, a);
+            remote_put_u32 (&out, urj_tap_cable_get_frequency (cable));
+            status = remote_send (fd, REMOTE_FREQUENCY, &out);
+            break;
+
+        case REMOTE_SIGNAL:
+            a = remote_get_u32 (&r);
+            b = remote_get_u32 (&r);
+            remote_put_u32 (&out, urj_tap_cable_set_signal (cable, a, b));
+            status = remote_send (fd, REMOTE_SIGNAL, &out);
+            break;
+
+        case REMOTE_BATCH:
+            flags = remote_get_u8 (&r);
+            status = remote_serve_items (cable, &r, 0, NULL, NULL);
+            if (status == URJ_STATUS_OK)
+            {
+                r.pos = 1;
+                status = remote_serve_items (cable, &r, 1, &out, &bits);
+            }
+            urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+            if (status != URJ_STATUS_OK)
+            {
+                /* the results not collected must not go to the next
+                 * client of the cable */
+                urj_tap_cable_purge_queue (&cable->done, 1);
+                remote_serve_error (fd, &out);
+            }
+            else if (out.len > REMOTE_HEADER || (flags & REMOTE_SYNC))
+                status = remote_send (fd, REMOTE_RESULTS, &out);
+            break;
+
+        default:
+            urj_error_set (URJ_ERROR_SYNTAX,
+                           _("unknown remote message '%c'"), type);
+            remote_serve_error (fd, &out);
+            status = URJ_STATUS_FAIL;
+            break;
+        }
+    }
+
+    free (in.data);
+    free (out.data);
+    free (bits.data);
+
+    return status;
+}
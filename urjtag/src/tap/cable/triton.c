@@ -75,6 +75,9 @@ triton_init (urj_cable_t *cable)
     PARAM_SIGNALS (cable) = URJ_POD_CS_TRST | URJ_POD_CS_RESET;
     urj_tap_parport_set_data (cable->link.port, (1 << TRST) | (1 << SRESET));
 
+    urj_tap_cable_generic_parport_pins (cable, 0, TMS, TDI, TCK, TDO,
+                                        TRST, SRESET);
+
     return URJ_STATUS_OK;
 }
 
@@ -162,9 +165,11 @@ const urj_cable_driver_t urj_tap_cable_triton_driver = {
     urj_tap_cable_generic_set_frequency,
     triton_clock,
     triton_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     triton_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    urj_tap_cable_generic_parport_help
+    urj_tap_cable_generic_parport_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
@@ -59,9 +59,20 @@
 
 #define FIXED_FREQUENCY 12000000L
 
+/* Bytes the write windows are limited to: what the usbconn layer sends in
+ * one go, and what the FT245 can hold of results before they are fetched */
+#define WINDOW_SEND URJ_USBCONN_FTDX_MAXSEND
+#define WINDOW_RECV URJ_USBCONN_FTDX_MAXRECV
+
 typedef struct
 {
     urj_tap_cable_cx_cmd_root_t cmd_root;
+    int pins;                   /* last bit-banged TCK/TMS/TDI, -1 if unknown */
+    uint32_t to_recv;           /* TDO bytes scheduled since the last xfer */
+    uint8_t *recv_buf;          /* TDO bytes of the last xfer */
+    uint32_t recv_size;
+    uint32_t recv_len;
+    uint32_t recv_pos;
 } params_t;
 
 static int
@@ -88,6 +99,12 @@ usbblaster_connect (urj_cable_t *cable, const urj_param_t *params[])
     }
 
     urj_tap_cable_cx_cmd_init (&cable_params->cmd_root);
+    cable_params->pins = -1;
+    cable_params->to_recv = 0;
+    cable_params->recv_buf = NULL;
+    cable_params->recv_size = 0;
+    cable_params->recv_len = 0;
+    cable_params->recv_pos = 0;
 
     /* exchange generic cable parameters with our private parameter set */
     free (cable->params);
@@ -121,6 +138,7 @@ usbblaster_init (urj_cable_t *cable)
         urj_tap_cable_cx_cmd_push (cmd_root, 0);
 
     urj_tap_cable_cx_xfer (cmd_root, NULL, cable, URJ_TAP_CABLE_COMPLETELY);
+    params->pins = -1;
 
     usbblaster_set_frequency (cable, FIXED_FREQUENCY);
 
@@ -133,110 +151,176 @@ usbblaster_cable_free (urj_cable_t *cable)
     params_t *params = cable->params;
 
     urj_tap_cable_cx_cmd_deinit (&params->cmd_root);
+    free (params->recv_buf);
 
     urj_tap_cable_generic_usbconn_free (cable);
 }
 
+/* Make room for send more bytes, recv of which return TDO, in the current
+ * write window. Byte shift commands and bit-banged clocks all go into one
+ * window until it is full; the usbconn layer then sends it in one piece. */
+static void
+usbblaster_window (params_t *params, int send, int recv)
+{
+    urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
+
+    if (cmd_root->last != NULL
+        && urj_tap_cable_cx_cmd_space (cmd_root, WINDOW_SEND) >= send
+        && cmd_root->last->to_recv + recv <= WINDOW_RECV)
+        cmd_root->last->to_recv += recv;
+    else if (urj_tap_cable_cx_cmd_queue (cmd_root, recv) == NULL)
+        return;
+
+    params->to_recv += recv;
+}
+
+/* Drive TCK/TMS/TDI to pins, sampling TDO if read is set */
+static void
+usbblaster_pins (params_t *params, int pins, int read)
+{
+    usbblaster_window (params, 1, read ? 1 : 0);
+    urj_tap_cable_cx_cmd_push (&params->cmd_root,
+                               OTHERS | pins | (read ? (1 << READ) : 0));
+    params->pins = pins;
+}
+
+/* One bit-banged clock. The TCK low phase is left out when the pins are
+ * already there, e.g. after a TDO read or a byte shift preamble. */
+static void
+usbblaster_bitbang (params_t *params, int tms, int tdi, int read)
+{
+    int pins = (tms ? (1 << TMS) : 0) | (tdi ? (1 << TDI) : 0);
+
+    if (params->pins != pins)
+        usbblaster_pins (params, pins, 0);      /* TCK low */
+    usbblaster_pins (params, pins | (1 << TCK), read);
+}
+
+/* Start a byte shift command for chunkbytes bytes, which the caller pushes
+ * next. Byte shift mode keeps TMS from the last bit-banged state, so that
+ * is brought to TCK low and TMS=0 first. */
+static void
+usbblaster_shift (params_t *params, int chunkbytes, int read)
+{
+    if (params->pins != 0)
+        usbblaster_pins (params, 0, 0);
+    usbblaster_window (params, chunkbytes + 1, read ? chunkbytes : 0);
+    urj_tap_cable_cx_cmd_push (&params->cmd_root,
+                               (1 << SHMODE) | (read ? (1 << READ) : 0) |
+                               chunkbytes);
+    /* TDI follows the shifted data */
+    params->pins = -1;
+}
+
+/* Send all scheduled windows and fetch the TDO bytes they return with a
+ * single read, to be taken by usbblaster_recv() */
+static void
+usbblaster_xfer (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
+{
+    params_t *params = cable->params;
+    uint32_t len = params->to_recv;
+    int r;
+
+    urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable, how_much);
+
+    params->to_recv = 0;
+    params->recv_len = 0;
+    params->recv_pos = 0;
+    if (len == 0)
+        return;
+
+    if (len > params->recv_size)
+    {
+        uint8_t *buf = realloc (params->recv_buf, len);
+        if (buf == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("realloc(%s,%zd) fails"),
+                           "recv_buf", (size_t) len);
+            return;
+        }
+        params->recv_buf = buf;
+        params->recv_size = len;
+    }
+
+    r = urj_tap_usbconn_read (cable->link.usb, params->recv_buf, len);
+    if (r > 0)
+        params->recv_len = r;
+}
+
+static uint8_t
+usbblaster_recv (params_t *params)
+{
+    if (params->recv_pos < params->recv_len)
+        return params->recv_buf[params->recv_pos++];
+
+    return 0;
+}
+
 static void
 usbblaster_clock_schedule (urj_cable_t *cable, int tms, int tdi, int n)
 {
     params_t *params = cable->params;
     urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
-    int i, m;
-
-    tms = tms ? (1 << TMS) : 0;
-    tdi = tdi ? (1 << TDI) : 0;
+    int i;
 
     // urj_log (URJ_LOG_LEVEL_COMM, "clock: %d %d %d\n", tms, tdi, n);
 
-    m = n;
-    if (tms == 0 && m >= 8)
+    if (!tms)
     {
         unsigned char tdis = tdi ? 0xFF : 0;
 
-        urj_tap_cable_cx_cmd_queue (cmd_root, 0);
-        while (m >= 8)
+        while (n >= 8)
         {
-            int i;
-            int chunkbytes = (m >> 3);
+            int chunkbytes = (n >> 3);
             if (chunkbytes > 63)
                 chunkbytes = 63;
 
-            if (urj_tap_cable_cx_cmd_space (cmd_root,
-                                            URJ_USBCONN_FTDX_MAXSEND)
-                < chunkbytes + 1)
-            {
-                /* no space left for next clocking command
-                   transfer queued commands to device and read receive data
-                   to internal buffer */
-                urj_tap_cable_cx_xfer (cmd_root, NULL, cable,
-                                       URJ_TAP_CABLE_COMPLETELY);
-                urj_tap_cable_cx_cmd_queue (cmd_root, 0);
-            }
-
-
-            urj_tap_cable_cx_cmd_push (cmd_root,
-                                       (1 << SHMODE) | (0 << READ) |
-                                       chunkbytes);
-
+            usbblaster_shift (params, chunkbytes, 0);
             for (i = 0; i < chunkbytes; i++)
-            {
                 urj_tap_cable_cx_cmd_push (cmd_root, tdis);
-            }
 
-            m -= (chunkbytes << 3);
+            n -= (chunkbytes << 3);
         }
     }
 
-    for (i = 0; i < m; i++)
-    {
-        urj_tap_cable_cx_cmd_queue (cmd_root, 0);
-        urj_tap_cable_cx_cmd_push (cmd_root, OTHERS | (0 << TCK) | tms | tdi);
-        urj_tap_cable_cx_cmd_push (cmd_root, OTHERS | (1 << TCK) | tms | tdi);
-    }
+    for (i = 0; i < n; i++)
+        usbblaster_bitbang (params, tms, tdi, 0);
 }
 
 static void
 usbblaster_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
-    params_t *params = cable->params;
-
     usbblaster_clock_schedule (cable, tms, tdi, n);
-    urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
+    usbblaster_xfer (cable, URJ_TAP_CABLE_COMPLETELY);
 }
 
 static void
 usbblaster_get_tdo_schedule (urj_cable_t *cable)
 {
     params_t *params = cable->params;
-    urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
 
-    urj_tap_cable_cx_cmd_queue (cmd_root, 1);
-    urj_tap_cable_cx_cmd_push (cmd_root, OTHERS);       /* TCK low */
-    urj_tap_cable_cx_cmd_push (cmd_root, OTHERS | (1 << READ)); /* TCK low */
+    if (params->pins != 0)
+        usbblaster_pins (params, 0, 0);         /* TCK low */
+    usbblaster_pins (params, 0, 1);
 }
 
 static int
 usbblaster_get_tdo_finish (urj_cable_t *cable)
 {
 #if 0
-    char x = (urj_tap_cable_cx_xfer_recv (cable) & (1 << TDO)) ? 1 : 0;
+    char x = (usbblaster_recv (cable->params) & (1 << TDO)) ? 1 : 0;
     urj_log (URJ_LOG_LEVEL_COMM, "GetTDO %d\n", x);
     return x;
 #else
-    return (urj_tap_cable_cx_xfer_recv (cable) & (1 << TDO)) ? 1 : 0;
+    return (usbblaster_recv (cable->params) & (1 << TDO)) ? 1 : 0;
 #endif
 }
 
 static int
 usbblaster_get_tdo (urj_cable_t *cable)
 {
-    params_t *params = cable->params;
-
     usbblaster_get_tdo_schedule (cable);
-    urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
+    usbblaster_xfer (cable, URJ_TAP_CABLE_COMPLETELY);
     return usbblaster_get_tdo_finish (cable);
 }
 
@@ -246,17 +330,15 @@ usbblaster_set_signal (urj_cable_t *cable, int mask, int val)
     return 1;
 }
 
+/* Shift len bits, TDI is (in[k] & mask); read TDO if requested */
 static void
-usbblaster_transfer_schedule (urj_cable_t *cable, int len, const char *in,
-                              char *out)
+usbblaster_data_schedule (urj_cable_t *cable, int len, const char *in,
+                          int mask, int read)
 {
     params_t *params = cable->params;
     urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
     int in_offset = 0;
 
-    urj_tap_cable_cx_cmd_queue (cmd_root, 0);
-    urj_tap_cable_cx_cmd_push (cmd_root, OTHERS);       /* TCK low */
-
 #if 0
     {
         int o;
@@ -274,135 +356,201 @@ usbblaster_transfer_schedule (urj_cable_t *cable, int len, const char *in,
         if (chunkbytes > 63)
             chunkbytes = 63;
 
-        if (out)
-        {
-            urj_tap_cable_cx_cmd_queue (cmd_root, chunkbytes);
-            urj_tap_cable_cx_cmd_push (cmd_root,
-                                       (1 << SHMODE) | (1 << READ) |
-                                       chunkbytes);
-        }
-        else
-        {
-            urj_tap_cable_cx_cmd_queue (cmd_root, 0);
-            urj_tap_cable_cx_cmd_push (cmd_root,
-                                       (1 << SHMODE) | (0 << READ) |
-                                       chunkbytes);
-        }
+        usbblaster_shift (params, chunkbytes, read);
 
         for (i = 0; i < chunkbytes; i++)
         {
             int j;
             unsigned char b = 0;
             for (j = 1; j < 256; j <<= 1)
-                if (in[in_offset++])
+                if (in[in_offset++] & mask)
                     b |= j;
             urj_tap_cable_cx_cmd_push (cmd_root, b);
         }
     }
 
     while (len > in_offset)
-    {
-        char tdi = in[in_offset++] ? 1 : 0;
-
-        urj_tap_cable_cx_cmd_queue (cmd_root, out ? 1 : 0);
-        urj_tap_cable_cx_cmd_push (cmd_root, OTHERS | (tdi << TDI));    /* TCK low */
-        urj_tap_cable_cx_cmd_push (cmd_root,
-                                   OTHERS | ((out) ? (1 << READ) : 0) | (1 <<
-                                                                         TCK)
-                                   | (tdi << TDI));
-    }
+        usbblaster_bitbang (params, 0, in[in_offset++] & mask, read);
+}
+
+static void
+usbblaster_transfer_schedule (urj_cable_t *cable, int len, const char *in,
+                              char *out)
+{
+    usbblaster_data_schedule (cable, len, in, ~0, out != NULL);
 }
 
+/* Collect the bits read by usbblaster_data_schedule(). Without seq, all of
+ * them go to out; otherwise only those with URJ_CABLE_SEQ_CAPTURE set in
+ * seq. Returns the number of stored bits. */
 static int
-usbblaster_transfer_finish (urj_cable_t *cable, int len, char *out)
+usbblaster_data_finish (urj_cable_t *cable, int len, const char *seq,
+                        char *out)
 {
     params_t *params = cable->params;
-    urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
     int out_offset = 0;
+    int k = 0;
 
     if (out == NULL)
         return 0;
 
-    while (len - out_offset >= 8)
+    for (; len - out_offset >= 8; out_offset += 8)
     {
-        int i;
-        int chunkbytes = ((len - out_offset) >> 3);
-        if (chunkbytes > 63)
-            chunkbytes = 63;
-
-        if (out)
-        {
-            urj_tap_cable_cx_xfer (cmd_root, NULL, cable,
-                                   URJ_TAP_CABLE_COMPLETELY);
-
-            for (i = 0; i < chunkbytes; i++)
-            {
-                int j;
-                unsigned char b = urj_tap_cable_cx_xfer_recv (cable);
+        int j;
+        unsigned char b = usbblaster_recv (params);
 #if 0
-                urj_log (URJ_LOG_LEVEL_COMM, "read byte: %02X\n", b);
+        urj_log (URJ_LOG_LEVEL_COMM, "read byte: %02X\n", b);
 #endif
 
-                for (j = 1; j < 256; j <<= 1)
-                    out[out_offset++] = (b & j) ? 1 : 0;
-            }
-        }
+        for (j = 0; j < 8; j++)
+            if (seq == NULL
+                || (seq[out_offset + j] & URJ_CABLE_SEQ_CAPTURE))
+                out[k++] = (b >> j) & 1;
     }
 
-    while (len > out_offset)
-        out[out_offset++] =
-            (urj_tap_cable_cx_xfer_recv (cable) & (1 << TDO)) ? 1 : 0;
+    for (; len > out_offset; out_offset++)
+    {
+        char tdo = (usbblaster_recv (params) & (1 << TDO)) ? 1 : 0;
+
+        if (seq == NULL || (seq[out_offset] & URJ_CABLE_SEQ_CAPTURE))
+            out[k++] = tdo;
+    }
 
 #if 0
     {
         int o;
         urj_log (URJ_LOG_LEVEL_COMM, "%d out: ", len);
-        for (o = 0; o < len; o++)
+        for (o = 0; o < k; o++)
             urj_log (URJ_LOG_LEVEL_COMM, "%c", out[o] ? '1' : '0');
         urj_log (URJ_LOG_LEVEL_COMM, "\n");
     }
 #endif
 
+    return k;
+}
+
+static int
+usbblaster_transfer_finish (urj_cable_t *cable, int len, char *out)
+{
+    usbblaster_data_finish (cable, len, NULL, out);
+
     return 0;
 }
 
 static int
 usbblaster_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 {
-    params_t *params = cable->params;
-
     usbblaster_transfer_schedule (cable, len, in, out);
-    urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
+    usbblaster_xfer (cable, URJ_TAP_CABLE_COMPLETELY);
     return usbblaster_transfer_finish (cable, len, out);
 }
 
+/* Runs of 8 or more clocks with TMS=0 in a TMS sequence go through the
+ * byte shift mode, all other clocks are bit-banged. Returns the length of
+ * the segment at seq[i] and whether TDO is read in it. */
+static int
+usbblaster_sequence_segment (const char *seq, int i, int len, int *read)
+{
+    int n, j;
+
+    for (n = 0; i + n < len && !(seq[i + n] & URJ_CABLE_SEQ_TMS); n++)
+        ;
+    if (n < 8)
+        n = 1;
+
+    *read = 0;
+    for (j = 0; j < n; j++)
+        if (seq[i + j] & URJ_CABLE_SEQ_CAPTURE)
+            *read = 1;
+
+    return n;
+}
+
 static void
-usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
+usbblaster_sequence_schedule (urj_cable_t *cable, int len, const char *seq)
 {
     params_t *params = cable->params;
+    int i, n, read;
+
+    for (i = 0; i < len; i += n)
+    {
+        n = usbblaster_sequence_segment (seq, i, len, &read);
+        if (n > 1)
+            usbblaster_data_schedule (cable, n, seq + i, URJ_CABLE_SEQ_TDI,
+                                      read);
+        else
+            usbblaster_bitbang (params, seq[i] & URJ_CABLE_SEQ_TMS,
+                                seq[i] & URJ_CABLE_SEQ_TDI, read);
+    }
+}
 
+static int
+usbblaster_sequence_finish (urj_cable_t *cable, int len, const char *seq,
+                            char *out)
+{
+    int i, n, read;
+    int out_offset = 0;
+
+    for (i = 0; i < len; i += n)
+    {
+        n = usbblaster_sequence_segment (seq, i, len, &read);
+        if (!read)
+            continue;
+        if (n > 1)
+            out_offset += usbblaster_data_finish (cable, n, seq + i,
+                                                  out + out_offset);
+        else
+            out[out_offset++] =
+                (usbblaster_recv (cable->params) & (1 << TDO)) ? 1 : 0;
+    }
+
+    return out_offset;
+}
+
+static int
+usbblaster_tms_sequence (urj_cable_t *cable, int len, const char *seq,
+                         char *out)
+{
+    usbblaster_sequence_schedule (cable, len, seq);
+    usbblaster_xfer (cable, URJ_TAP_CABLE_COMPLETELY);
+    return usbblaster_sequence_finish (cable, len, seq, out);
+}
+
+static void
+usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
+{
     if (how_much == URJ_TAP_CABLE_OPTIONALLY)
         return;
 
     if (cable->todo.num_items == 0)
-        urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable, how_much);
+        usbblaster_xfer (cable, how_much);
 
     while (cable->todo.num_items > 0)
     {
         int i, j, n;
+        int tms = 0, tdi = 0, clocks = 0;
 
+        /* schedule the whole queue into the write windows, then transfer
+           them and collect the results; clocks with the same TMS and TDI
+           in consecutive items are merged so that they can be byte shifted */
         for (j = i = cable->todo.next_item, n = 0; n < cable->todo.num_items;
              n++)
         {
+            if (clocks > 0
+                && (cable->todo.data[i].action != URJ_TAP_CABLE_CLOCK
+                    || !cable->todo.data[i].arg.clock.tms != !tms
+                    || !cable->todo.data[i].arg.clock.tdi != !tdi))
+            {
+                usbblaster_clock_schedule (cable, tms, tdi, clocks);
+                clocks = 0;
+            }
 
             switch (cable->todo.data[i].action)
             {
             case URJ_TAP_CABLE_CLOCK:
-                usbblaster_clock_schedule (cable,
-                                           cable->todo.data[i].arg.clock.tms,
-                                           cable->todo.data[i].arg.clock.tdi,
-                                           cable->todo.data[i].arg.clock.n);
+                tms = cable->todo.data[i].arg.clock.tms;
+                tdi = cable->todo.data[i].arg.clock.tdi;
+                clocks += cable->todo.data[i].arg.clock.n;
                 break;
 
             case URJ_TAP_CABLE_GET_TDO:
@@ -419,6 +567,14 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                                               transfer.out);
                 break;
 
+            case URJ_TAP_CABLE_TMS_SEQUENCE:
+                usbblaster_sequence_schedule (cable,
+                                              cable->todo.data[i].arg.
+                                              sequence.len,
+                                              cable->todo.data[i].arg.
+                                              sequence.seq);
+                break;
+
             default:
                 break;
             }
@@ -427,9 +583,10 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
             if (i >= cable->todo.max_items)
                 i = 0;
         }
+        if (clocks > 0)
+            usbblaster_clock_schedule (cable, tms, tdi, clocks);
 
-        urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable, how_much);
-
+        usbblaster_xfer (cable, how_much);
         while (j != i)
         {
             switch (cable->todo.data[j].action)
@@ -463,7 +620,6 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                                                         arg.transfer.len,
                                                         cable->todo.data[j].
                                                         arg.transfer.out);
-                    free (cable->todo.data[j].arg.transfer.in);
                     if (cable->todo.data[j].arg.transfer.out)
                     {
                         int m = urj_tap_cable_add_queue_item (cable,
@@ -481,6 +637,29 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                             cable->todo.data[j].arg.transfer.out;
                     }
                 }
+                break;
+            case URJ_TAP_CABLE_TMS_SEQUENCE:
+                {
+                    int r = usbblaster_sequence_finish (cable,
+                                                        cable->todo.data[j].
+                                                        arg.sequence.len,
+                                                        cable->todo.data[j].
+                                                        arg.sequence.seq,
+                                                        cable->todo.data[j].
+                                                        arg.sequence.out);
+                    if (cable->todo.data[j].arg.sequence.out)
+                    {
+                        int m = urj_tap_cable_add_queue_item (cable,
+                                                              &cable->done);
+                        cable->done.data[m].action =
+                            URJ_TAP_CABLE_TMS_SEQUENCE;
+                        cable->done.data[m].arg.xferred.len = r;
+                        cable->done.data[m].arg.xferred.res = r;
+                        cable->done.data[m].arg.xferred.out =
+                            cable->todo.data[j].arg.sequence.out;
+                    }
+                    break;
+                }
             default:
                 break;
             }
@@ -513,7 +692,9 @@ const urj_cable_driver_t urj_tap_cable_usbblaster_driver = {
 //      urj_tap_cable_generic_flush_one_by_one,
 //      urj_tap_cable_generic_flush_using_transfer,
     usbblaster_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    usbblaster_tms_sequence
 };
 URJ_DECLARE_FTDX_CABLE(0x09FB, 0x6001, "", "UsbBlaster", usbblaster)
 URJ_DECLARE_FTDX_CABLE(0x09FB, 0x6002, "", "UsbBlaster", cubic_cyclonium)
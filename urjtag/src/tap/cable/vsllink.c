@@ -46,6 +46,8 @@
 
 typedef struct
 {
+    int signals;                /* see urj_tap_cable_generic_params_t */
+
     /* Global USB buffers */
     unsigned char *usb_buffer;
     uint32_t usb_buffer_size;
@@ -80,8 +82,7 @@ vsllink_usbconn_data_t;
 #define GPIO_TRST              (1 << 1)
 
 /* VSLlink lowlevel functions */
-static int vsllink_usb_message (urj_usbconn_libusb_param_t *params, int, int, int);
-static void vsllink_free (urj_cable_t *cable);
+static int vsllink_usb_message (urj_cable_t *cable, int, int, int);
 
 /***************************************************************************/
 
@@ -117,9 +118,9 @@ vsllink_tap_append_step (vsllink_usbconn_data_t *data, int tms, int tdi)
 /* Send a tap sequence to the device, and receive the answer */
 
 static int
-vsllink_tap_execute (urj_usbconn_libusb_param_t *params)
+vsllink_tap_execute (urj_cable_t *cable)
 {
-    vsllink_usbconn_data_t *data = params->data;
+    vsllink_usbconn_data_t *data = cable->params;
     int byte_length;
     int in_length, out_length;
     int result;
@@ -144,7 +145,7 @@ vsllink_tap_execute (urj_usbconn_libusb_param_t *params)
         memcpy (&data->usb_buffer[out_length], data->tms_buffer, byte_length);
         out_length += byte_length;
         in_length = 1 + byte_length;
-        result = vsllink_usb_message (params, out_length, in_length,
+        result = vsllink_usb_message (cable, out_length, in_length,
                                       VERSALOON_USB_TIMEOUT);
 
         if (result == (1 + byte_length))
@@ -162,6 +163,7 @@ vsllink_tap_execute (urj_usbconn_libusb_param_t *params)
                          _("tap execute failure (%d)\n"),
                          data->usb_buffer[0]);
 
+                data->tap_length = 0;
                 return URJ_STATUS_FAIL;
             }
         }
@@ -171,6 +173,7 @@ vsllink_tap_execute (urj_usbconn_libusb_param_t *params)
                      _("wrong result %d, expected %d\n"),
                      result, 1 + byte_length);
 
+            data->tap_length = 0;
             return URJ_STATUS_FAIL;
         }
 
@@ -185,30 +188,23 @@ vsllink_tap_execute (urj_usbconn_libusb_param_t *params)
 /* Send a message and receive the reply. */
 
 static int
-vsllink_usb_message (urj_usbconn_libusb_param_t *params, int out_length,
-                     int in_length, int timeout)
+vsllink_usb_message (urj_cable_t *cable, int out_length, int in_length,
+                     int timeout)
 {
-    vsllink_usbconn_data_t *data = params->data;
-    int result, actual;
-
-    result = libusb_bulk_transfer (params->handle,
-                                   VERSALOON_OUTP,
-                                   data->usb_buffer,
-                                   out_length,
-                                   &actual,
-                                   timeout);
-    if (actual == out_length)
+    vsllink_usbconn_data_t *data = cable->params;
+    int result;
+
+    result = urj_tap_usbconn_bulk (cable->link.usb, VERSALOON_OUTP,
+                                   data->usb_buffer, out_length, timeout);
+    if (result == out_length)
     {
-        result = libusb_bulk_transfer (params->handle,
-                                       VERSALOON_INP,
+        result = urj_tap_usbconn_bulk (cable->link.usb, VERSALOON_INP,
                                        data->usb_buffer,
-                                       data->usb_buffer_size,
-                                       &actual,
-                                       timeout);
+                                       data->usb_buffer_size, timeout);
 
-        if (in_length == 0 || actual == in_length)
+        if (result >= 0 && (in_length == 0 || result == in_length))
         {
-            return actual;
+            return result;
         }
         else
         {
@@ -232,51 +228,62 @@ vsllink_usb_message (urj_usbconn_libusb_param_t *params, int out_length,
 /* ---------------------------------------------------------------------- */
 
 static int
-vsllink_init (urj_cable_t *cable)
+vsllink_connect (urj_cable_t *cable, const urj_param_t *params[])
 {
-    int result, in_length, out_length;
-    int retry;
-    urj_usbconn_libusb_param_t *params;
     vsllink_usbconn_data_t *data;
 
-    params = cable->link.usb->params;
-    params->data = malloc (sizeof (*data));
-    if (params->data == NULL)
+    if (urj_tap_cable_generic_usbconn_connect (cable, params) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    data = calloc (1, sizeof (*data));
+    if (data == NULL)
     {
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("malloc(%zd) fails"),
-                       sizeof (vsllink_usbconn_data_t));
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd) fails"),
+                       sizeof (*data));
+        /* see ft2232_connect(): the caller frees the cable itself */
+        cable->link.usb->driver->free (cable->link.usb);
+        free (cable->params);
         return URJ_STATUS_FAIL;
     }
-    data = params->data;
-    memset (data, 0, sizeof (*data));
+
+    /* kept in the cable rather than the USB connection, which may be a
+     * recording or a replay */
+    free (cable->params);
+    cable->params = data;
+
+    return URJ_STATUS_OK;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* On failure the caller frees the cable, and with it the buffers. */
+static int
+vsllink_init (urj_cable_t *cable)
+{
+    int result, in_length, out_length;
+    int retry;
+    vsllink_usbconn_data_t *data = cable->params;
 
     if (urj_tap_usbconn_open (cable->link.usb) != URJ_STATUS_OK)
-    {
-        free (data);
         return URJ_STATUS_FAIL;
-    }
 
     /* malloc temporary buffer */
     data->usb_buffer_size = 256;
     data->usb_buffer = malloc (data->usb_buffer_size);
     if (data->usb_buffer == NULL)
     {
-        free (data);
-        data = NULL;
-        params->data = NULL;
         urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("malloc(%d) fails"),
                        data->usb_buffer_size);
         return URJ_STATUS_FAIL;
     }
 
     /* disable cdc device */
-    result = libusb_control_transfer (params->handle,
+    result = urj_tap_usbconn_control (cable->link.usb,
                                       LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_INTERFACE,
                                       0, 0, 0, NULL, 0, VERSALOON_USB_TIMEOUT);
     if (result < 0)
     {
         urj_log (URJ_LOG_LEVEL_ERROR, _("fail to disable cdc in Versaloon\n"));
-        vsllink_free (cable);
         return URJ_STATUS_FAIL;
     }
 
@@ -285,13 +292,12 @@ vsllink_init (urj_cable_t *cable)
     for (retry = 0; retry < 3; retry++)
     {
         data->usb_buffer[0] = VERSALOON_GET_INFO;
-        result = vsllink_usb_message (params, 1, in_length, 100);
+        result = vsllink_usb_message (cable, 1, in_length, 100);
         if (result >= 3)
             break;
     }
     if (retry == 3)
     {
-        vsllink_free (cable);
         return URJ_STATUS_FAIL;
     }
 
@@ -299,7 +305,6 @@ vsllink_init (urj_cable_t *cable)
     data->usb_buffer_size = data->usb_buffer[0] + (data->usb_buffer[1] << 8);
     if (data->usb_buffer_size < 64)
     {
-        vsllink_free (cable);
         return URJ_STATUS_FAIL;
     }
     urj_log (URJ_LOG_LEVEL_NORMAL, _("%s(buffer size %d bytes)\n"),
@@ -316,16 +321,14 @@ vsllink_init (urj_cable_t *cable)
         data->tdi_buffer == NULL)
     {
         urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("malloc() fails"));
-        vsllink_free (cable);
         return URJ_STATUS_FAIL;
     }
 
     data->usb_buffer[0] = VERSALOON_GET_TVCC;
     in_length = 2;
-    result = vsllink_usb_message (params, 1, in_length, 100);
+    result = vsllink_usb_message (cable, 1, in_length, 100);
     if (result < 0)
     {
-        vsllink_free (cable);
         return URJ_STATUS_FAIL;
     }
 
@@ -367,7 +370,7 @@ vsllink_init (urj_cable_t *cable)
     data->usb_buffer[out_length++] = 0x03;
     data->usb_buffer[out_length++] = 0x00;
     in_length = 7;
-    result = vsllink_usb_message (params, out_length, in_length, 500);
+    result = vsllink_usb_message (cable, out_length, in_length, 500);
     if ((result < 0)
             /* ack to USB_TO_DELAY */
         || (data->usb_buffer[0] != 0)
@@ -380,7 +383,6 @@ vsllink_init (urj_cable_t *cable)
             /* ack to USB_TO_GPIO->UB_TO_XXX_CONFIG */
         || (data->usb_buffer[6] != 0))
     {
-        vsllink_free (cable);
         return URJ_STATUS_FAIL;
     }
 
@@ -397,8 +399,7 @@ vsllink_done (urj_cable_t *cable)
 {
     int result;
     int in_length, out_length;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    vsllink_usbconn_data_t *data = params->data;
+    vsllink_usbconn_data_t *data = cable->params;
 
     out_length = 0;
     data->usb_buffer[out_length++] = USB_TO_ALL;
@@ -419,7 +420,7 @@ vsllink_done (urj_cable_t *cable)
     data->usb_buffer[out_length++] = 0x00;
     data->usb_buffer[out_length++] = 0x00;
     in_length = 2;
-    result = vsllink_usb_message (params, out_length, in_length, 100);
+    result = vsllink_usb_message (cable, out_length, in_length, 100);
     if (result < 0 ||
         data->usb_buffer[0] != 0 ||
         data->usb_buffer[1] != 0)
@@ -433,16 +434,11 @@ vsllink_done (urj_cable_t *cable)
 static void
 vsllink_free (urj_cable_t *cable)
 {
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    vsllink_usbconn_data_t *data = params->data;
+    vsllink_usbconn_data_t *data = cable->params;
 
-    if (data != NULL)
-    {
-        free (data->usb_buffer);
-        free (data->tms_buffer);
-        free (data->tdi_buffer);
-        free (data);
-    }
+    free (data->usb_buffer);
+    free (data->tms_buffer);
+    free (data->tdi_buffer);
 
     urj_tap_cable_generic_usbconn_free (cable);
 }
@@ -455,8 +451,7 @@ vsllink_set_frequency (urj_cable_t *cable, uint32_t frequency)
     int result;
     int in_length, out_length;
     uint16_t kHz = frequency / 1E3;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    vsllink_usbconn_data_t *data = params->data;
+    vsllink_usbconn_data_t *data = cable->params;
 
     out_length = 0;
     data->usb_buffer[out_length++] = USB_TO_JTAG_RAW;
@@ -468,7 +463,7 @@ vsllink_set_frequency (urj_cable_t *cable, uint32_t frequency)
     data->usb_buffer[out_length++] = (kHz >> 0) & 0xFF;
     data->usb_buffer[out_length++] = (kHz >> 8) & 0xFF;
     in_length = 1;
-    result = vsllink_usb_message (params, out_length, in_length, 100);
+    result = vsllink_usb_message (cable, out_length, in_length, 100);
     if ((result < 0)
             /* ack to USB_TO_JTAG_RAW->UB_TO_XXX_CONFIG */
         || (data->usb_buffer[0] != 0))
@@ -484,14 +479,15 @@ static void
 vsllink_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
     int i;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    vsllink_usbconn_data_t *data = params->data;
+    vsllink_usbconn_data_t *data = cable->params;
 
     for (i = 0; i < n; i++)
     {
         vsllink_tap_append_step (data, tms, tdi);
+        if (data->tap_length >= 8 * data->tap_buffer_size)
+            vsllink_tap_execute (cable);
     }
-    vsllink_tap_execute (params);
+    vsllink_tap_execute (cable);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -499,8 +495,7 @@ vsllink_clock (urj_cable_t *cable, int tms, int tdi, int n)
 static int
 vsllink_get_tdo (urj_cable_t *cable)
 {
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    vsllink_usbconn_data_t *data = params->data;
+    vsllink_usbconn_data_t *data = cable->params;
 
     return data->last_tdo;
 }
@@ -524,8 +519,7 @@ static int
 vsllink_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 {
     int i, j;
-    urj_usbconn_libusb_param_t *params = cable->link.usb->params;
-    vsllink_usbconn_data_t *data = params->data;
+    vsllink_usbconn_data_t *data = cable->params;
 
     for (j = 0, i = 0; i < len; i++)
     {
@@ -533,15 +527,17 @@ vsllink_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 
         if (data->tap_length >= 8 * data->tap_buffer_size)
         {
-            vsllink_tap_execute (params);
+            if (vsllink_tap_execute (cable) != URJ_STATUS_OK)
+                return -1;
             if (out)
-                vsllink_copy_out_data (data, i - j, j, out);
-            j = i;
+                vsllink_copy_out_data (data, i + 1 - j, j, out);
+            j = i + 1;
         }
     }
     if (data->tap_length > 0)
     {
-        vsllink_tap_execute (params);
+        if (vsllink_tap_execute (cable) != URJ_STATUS_OK)
+            return -1;
         if (out)
             vsllink_copy_out_data (data, i - j, j, out);
     }
@@ -551,6 +547,32 @@ vsllink_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 
 /* ---------------------------------------------------------------------- */
 
+static int
+vsllink_tms_append (urj_cable_t *cable, int tms, int tdi)
+{
+    vsllink_usbconn_data_t *data = cable->params;
+
+    vsllink_tap_append_step (data, tms, tdi);
+
+    return data->tap_length >= 8 * data->tap_buffer_size;
+}
+
+/* One bit of TMS and TDI per clock in USB_TO_JTAG_RAW commands; the reply
+ * has a status byte, then the TDO of each clock, LSB first. */
+static int
+vsllink_tms_sequence (urj_cable_t *cable, int len, const char *seq,
+                      char *out)
+{
+    vsllink_usbconn_data_t *data = cable->params;
+
+    return urj_tap_cable_generic_usbconn_tms_sequence (cable, len, seq, out,
+                                                       vsllink_tms_append,
+                                                       vsllink_tap_execute,
+                                                       data->usb_buffer + 1);
+}
+
+/* ---------------------------------------------------------------------- */
+
 static int
 vsllink_set_signal (urj_cable_t *cable, int mask, int val)
 {
@@ -561,7 +583,7 @@ const urj_cable_driver_t urj_tap_cable_vsllink_driver = {
     "vsllink",
     N_("Versaloon Link -- http://www.versaloon.com."),
     URJ_CABLE_DEVICE_USB,
-    { .usb = urj_tap_cable_generic_usbconn_connect, },
+    { .usb = vsllink_connect, },
     urj_tap_cable_generic_disconnect,
     vsllink_free,
     vsllink_init,
@@ -573,6 +595,8 @@ const urj_cable_driver_t urj_tap_cable_vsllink_driver = {
     vsllink_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_using_transfer,
-    urj_tap_cable_generic_usbconn_help
+    urj_tap_cable_generic_usbconn_help,
+    0,
+    vsllink_tms_sequence
 };
 URJ_DECLARE_USBCONN_CABLE (0x0483, 0x5740, "libusb", "vsllink", vsllink)
@@ -77,9 +77,11 @@ static const char *std_wgl_map = xstr (TDO) ","
 
 
 /* private parameters of this cable driver */
+/* starts like urj_tap_cable_generic_parport_params_t */
 typedef struct
 {
     int signals;
+    urj_tap_cable_parport_pins_t pins;
     int trst_lvl;
     int srst_act, srst_inact;
     int tms_act, tms_inact;
@@ -192,6 +194,29 @@ set_mapping (const char *bitmap, urj_cable_t *cable)
 }
 
 
+/* Set up PARAM_PINS for the mapping */
+static void
+wiggler_pins (urj_cable_t *cable)
+{
+    urj_tap_cable_parport_pins_t *pins = PARAM_PINS (cable);
+    int i;
+
+    for (i = 0; i < 8; i++)
+        pins->data[i] = PRM_UNUSED_BITS (cable)
+            | (i & URJ_TAP_CABLE_PARPORT_PINS (1, 0, 0)
+               ? PRM_TMS_ACT (cable) : PRM_TMS_INACT (cable))
+            | (i & URJ_TAP_CABLE_PARPORT_PINS (0, 1, 0)
+               ? PRM_TDI_ACT (cable) : PRM_TDI_INACT (cable))
+            | (i & URJ_TAP_CABLE_PARPORT_PINS (0, 0, 1)
+               ? PRM_TCK_ACT (cable) : PRM_TCK_INACT (cable));
+    pins->trst[0] = PRM_TRST_INACT (cable);
+    pins->trst[1] = PRM_TRST_ACT (cable);
+    pins->reset[0] = 0;
+    pins->reset[1] = 0;
+    pins->tdo_mask = PRM_TDO_ACT (cable) | PRM_TDO_INACT (cable);
+    pins->tdo_value = PRM_TDO_ACT (cable);
+}
+
 static int
 wiggler_connect (urj_cable_t *cable, urj_cable_parport_devtype_t devtype,
                  const char *devname, const urj_param_t *params[])
@@ -264,6 +289,8 @@ wiggler_connect (urj_cable_t *cable, urj_cable_parport_devtype_t devtype,
           | PRM_TDI_ACT (cable) | PRM_TDI_INACT (cable) | PRM_TRST_ACT (cable)
           | PRM_TRST_INACT (cable)) & 0xff;
 
+    wiggler_pins (cable);
+
     return 0;
 }
 
@@ -427,11 +454,13 @@ const urj_cable_driver_t urj_tap_cable_wiggler_driver = {
     urj_tap_cable_generic_set_frequency,
     wiggler_clock,
     wiggler_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     wiggler_set_signal,
     wiggler_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    wiggler_help
+    wiggler_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
 
 const urj_cable_driver_t urj_tap_cable_igloo_driver = {
@@ -446,9 +475,11 @@ const urj_cable_driver_t urj_tap_cable_igloo_driver = {
     urj_tap_cable_generic_set_frequency,
     wiggler_clock,
     wiggler_get_tdo,
-    urj_tap_cable_generic_transfer,
+    urj_tap_cable_generic_parport_transfer,
     wiggler_set_signal,
     wiggler_get_signal,
     urj_tap_cable_generic_flush_one_by_one,
-    wiggler_help
+    wiggler_help,
+    0,
+    urj_tap_cable_generic_parport_tms_sequence
 };
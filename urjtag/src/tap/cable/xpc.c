@@ -38,7 +38,6 @@
 #include "generic_usbconn.h"
 
 #include <urjtag/usbconn.h>
-#include "usbconn/libusb.h"
 
 // #define VERBOSE 1
 #undef VERBOSE
@@ -78,9 +77,9 @@ static int last_tdo;
 /* ---------------------------------------------------------------------- */
 
 static int
-xpcu_output_enable (struct libusb_device_handle *xpcu, int enable)
+xpcu_output_enable (urj_usbconn_t *xpcu, int enable)
 {
-    if (libusb_control_transfer
+    if (urj_tap_usbconn_control
         (xpcu, 0x40, 0xB0, enable ? 0x18 : 0x10, 0, NULL, 0, 1000) < 0)
     {
         urj_error_IO_set ("libusb_control_transfer(0x10/0x18)");
@@ -94,10 +93,10 @@ xpcu_output_enable (struct libusb_device_handle *xpcu, int enable)
 
 #ifdef UNUSED                   /* RFHH */
 static int
-xpcu_bit_reverse (struct libusb_device_handle *xpcu, uint8_t bits_in,
+xpcu_bit_reverse (urj_usbconn_t *xpcu, uint8_t bits_in,
                   uint8_t *bits_out)
 {
-    if (libusb_control_transfer
+    if (urj_tap_usbconn_control
         (xpcu, 0xC0, 0xB0, 0x0020, bits_in, bits_out, 1, 1000) < 0)
     {
         urj_error_IO_set ("libusb_control_transfer(0x20.x) (bit reverse)");
@@ -111,11 +110,11 @@ xpcu_bit_reverse (struct libusb_device_handle *xpcu, uint8_t bits_in,
 /* ----------------------------------------------------------------- */
 
 static int
-xpcu_request_28 (struct libusb_device_handle *xpcu, int value)
+xpcu_request_28 (urj_usbconn_t *xpcu, int value)
 {
     /* Typical values seen during autodetection of chain configuration: 0x11, 0x12 */
 
-    if (libusb_control_transfer (xpcu, 0x40, 0xB0, 0x0028, value, NULL, 0, 1000) < 0)
+    if (urj_tap_usbconn_control (xpcu, 0x40, 0xB0, 0x0028, value, NULL, 0, 1000) < 0)
     {
         urj_error_IO_set ("libusb_control_transfer(0x28.x)");
         return URJ_STATUS_FAIL;
@@ -127,9 +126,9 @@ xpcu_request_28 (struct libusb_device_handle *xpcu, int value)
 /* ---------------------------------------------------------------------- */
 
 static int
-xpcu_write_gpio (struct libusb_device_handle *xpcu, uint8_t bits)
+xpcu_write_gpio (urj_usbconn_t *xpcu, uint8_t bits)
 {
-    if (libusb_control_transfer (xpcu, 0x40, 0xB0, 0x0030, bits, NULL, 0, 1000) < 0)
+    if (urj_tap_usbconn_control (xpcu, 0x40, 0xB0, 0x0030, bits, NULL, 0, 1000) < 0)
     {
         urj_error_IO_set ("libusb_control_transfer(0x30.0x00) (write port E)");
         return URJ_STATUS_FAIL;
@@ -141,9 +140,9 @@ xpcu_write_gpio (struct libusb_device_handle *xpcu, uint8_t bits)
 /* ---------------------------------------------------------------------- */
 
 static int
-xpcu_read_gpio (struct libusb_device_handle *xpcu, uint8_t *bits)
+xpcu_read_gpio (urj_usbconn_t *xpcu, uint8_t *bits)
 {
-    if (libusb_control_transfer (xpcu, 0xC0, 0xB0, 0x0038, 0, bits, 1, 1000)
+    if (urj_tap_usbconn_control (xpcu, 0xC0, 0xB0, 0x0038, 0, bits, 1, 1000)
         < 0)
     {
         urj_error_IO_set ("libusb_control_transfer(0x38.0x00) (read port E)");
@@ -157,9 +156,9 @@ xpcu_read_gpio (struct libusb_device_handle *xpcu, uint8_t *bits)
 
 
 static int
-xpcu_read_cpld_version (struct libusb_device_handle *xpcu, uint16_t *buf)
+xpcu_read_cpld_version (urj_usbconn_t *xpcu, uint16_t *buf)
 {
-    if (libusb_control_transfer
+    if (urj_tap_usbconn_control
         (xpcu, 0xC0, 0xB0, 0x0050, 0x0001, (unsigned char *) buf, 2, 1000) < 0)
     {
         urj_error_IO_set ("libusb_control_transfer(0x50.1) (read_cpld_version)");
@@ -171,9 +170,9 @@ xpcu_read_cpld_version (struct libusb_device_handle *xpcu, uint16_t *buf)
 /* ---------------------------------------------------------------------- */
 
 static int
-xpcu_read_firmware_version (struct libusb_device_handle *xpcu, uint16_t *buf)
+xpcu_read_firmware_version (urj_usbconn_t *xpcu, uint16_t *buf)
 {
-    if (libusb_control_transfer
+    if (urj_tap_usbconn_control
         (xpcu, 0xC0, 0xB0, 0x0050, 0x0000, (unsigned char *) buf, 2, 1000) < 0)
     {
         urj_error_IO_set ("libusb_control_transfer(0x50.0) (read_firmware_version)");
@@ -186,9 +185,9 @@ xpcu_read_firmware_version (struct libusb_device_handle *xpcu, uint16_t *buf)
 /* ----------------------------------------------------------------- */
 
 static int
-xpcu_select_gpio (struct libusb_device_handle *xpcu, int int_or_ext)
+xpcu_select_gpio (urj_usbconn_t *xpcu, int int_or_ext)
 {
-    if (libusb_control_transfer (xpcu, 0x40, 0xB0, 0x0052, int_or_ext, NULL, 0, 1000)
+    if (urj_tap_usbconn_control (xpcu, 0x40, 0xB0, 0x0052, int_or_ext, NULL, 0, 1000)
         < 0)
     {
         urj_error_IO_set ("libusb_control_transfer(0x52.x) (select gpio)");
@@ -243,12 +242,12 @@ xpcu_select_gpio (struct libusb_device_handle *xpcu, int int_or_ext)
 
 /** @return 0 on success; -1 on error */
 static int
-xpcu_shift (struct libusb_device_handle *xpcu, int reqno, int bits, int in_len,
+xpcu_shift (urj_usbconn_t *xpcu, int reqno, int bits, int in_len,
             uint8_t *in, int out_len, uint8_t *out)
 {
-    int ret, actual;
+    int ret;
 
-    if (libusb_control_transfer (xpcu, 0x40, 0xB0, reqno, bits, NULL, 0, 1000) < 0)
+    if (urj_tap_usbconn_control (xpcu, 0x40, 0xB0, reqno, bits, NULL, 0, 1000) < 0)
     {
         urj_error_IO_set ("libusb_control_transfer(x.x) (shift)");
         return -1;
@@ -270,21 +269,21 @@ xpcu_shift (struct libusb_device_handle *xpcu, int reqno, int bits, int in_len,
     }
 #endif
 
-    ret = libusb_bulk_transfer (xpcu, 0x02, in, in_len, &actual, 1000);
-    if (ret)
+    ret = urj_tap_usbconn_bulk (xpcu, 0x02, in, in_len, 1000);
+    if (ret < 0)
     {
-        urj_error_IO_set ("usb_bulk_write error(shift): %i (transferred %i)",
-                          ret, actual);
+        urj_error_IO_set ("usb_bulk_write error(shift): transferred %i", ret);
         return -1;
     }
 
     if (out_len > 0 && out != NULL)
     {
-        ret = libusb_bulk_transfer (xpcu, 0x06 | LIBUSB_ENDPOINT_IN, out, out_len, &actual, 1000);
-        if (ret)
+        ret = urj_tap_usbconn_bulk (xpcu, 0x06 | URJ_USBCONN_ENDPOINT_IN, out,
+                                    out_len, 1000);
+        if (ret < 0)
         {
-            urj_error_IO_set ("usb_bulk_read error(shift): %i (transferred %i)",
-                              ret, actual);
+            urj_error_IO_set ("usb_bulk_read error(shift): transferred %i",
+                              ret);
             return -1;
         }
     }
@@ -309,12 +308,12 @@ xpcu_common_init (urj_cable_t *cable)
 {
     int r;
     uint16_t buf;
-    struct libusb_device_handle *xpcu;
+    urj_usbconn_t *xpcu;
 
     if (urj_tap_usbconn_open (cable->link.usb) != URJ_STATUS_OK)
         return URJ_STATUS_FAIL;
 
-    xpcu = ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->handle;
+    xpcu = cable->link.usb;
 
     r = xpcu_request_28 (xpcu, 0x11);
     if (r != URJ_STATUS_FAIL)
@@ -348,7 +347,7 @@ xpcu_common_init (urj_cable_t *cable)
 
     if (r != URJ_STATUS_OK)
     {
-        libusb_close (xpcu);
+        urj_tap_usbconn_close (xpcu);
     }
 
     return r;
@@ -357,12 +356,12 @@ xpcu_common_init (urj_cable_t *cable)
 static int
 xpc_int_init (urj_cable_t *cable)
 {
-    struct libusb_device_handle *xpcu;
+    urj_usbconn_t *xpcu;
 
     if (xpcu_common_init (cable) == URJ_STATUS_FAIL)
         return URJ_STATUS_FAIL;
 
-    xpcu = ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->handle;
+    xpcu = cable->link.usb;
     if (xpcu_select_gpio (xpcu, 0) == URJ_STATUS_FAIL)
         return URJ_STATUS_FAIL;
 
@@ -372,7 +371,7 @@ xpc_int_init (urj_cable_t *cable)
 static int
 xpc_ext_init (urj_cable_t *cable)
 {
-    struct libusb_device_handle *xpcu;
+    urj_usbconn_t *xpcu;
     uint8_t zero[2] = { 0, 0 };
     int r;
 
@@ -392,7 +391,7 @@ xpc_ext_init (urj_cable_t *cable)
         r = URJ_STATUS_FAIL;
     }
 
-    xpcu = ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->handle;
+    xpcu = cable->link.usb;
 
     if (r == URJ_STATUS_OK)
         r = xpcu_output_enable (xpcu, 0);
@@ -408,7 +407,7 @@ xpc_ext_init (urj_cable_t *cable)
 
     if (r != URJ_STATUS_OK)
     {
-        libusb_close (xpcu);
+        urj_tap_usbconn_close (xpcu);
 
         free (cable->params);
         cable->params = NULL;
@@ -442,8 +441,8 @@ static void
 xpc_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
     int i;
-    struct libusb_device_handle *xpcu;
-    xpcu = ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->handle;
+    urj_usbconn_t *xpcu;
+    xpcu = cable->link.usb;
 
     tms = tms ? (1 << TMS) : 0;
     tdi = tdi ? (1 << TDI) : 0;
@@ -468,8 +467,8 @@ static int
 xpc_get_tdo (urj_cable_t *cable)
 {
     unsigned char d;
-    struct libusb_device_handle *xpcu;
-    xpcu = ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->handle;
+    urj_usbconn_t *xpcu;
+    xpcu = cable->link.usb;
 
     xpcu_read_gpio (xpcu, &d);
     return (d & (1 << TDO)) ? 1 : 0;
@@ -491,12 +490,12 @@ xpc_ext_clock (urj_cable_t *cable, int tms, int tdi, int n)
     int i;
     uint8_t tdo[2];
     uint8_t clock[2];
-    struct libusb_device_handle *xpcu;
+    urj_usbconn_t *xpcu;
 
     clock[0] = (tms ? 0x10 : 0) | (tdi ? 0x01 : 0);
     clock[1] = 0x11;            /* clock'n read */
 
-    xpcu = ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->handle;
+    xpcu = cable->link.usb;
 
     for (i = 0; i < n; i++)
         xpcu_shift (xpcu, 0xA6, 1, 2, clock, 2, tdo);
@@ -522,7 +521,7 @@ xpc_ext_get_tdo (urj_cable_t *cable)
 typedef struct
 {
     urj_cable_t *cable;
-    struct libusb_device_handle *xpcu;
+    urj_usbconn_t *xpcu;
     int in_bits;
     int out_bits;
     int out_done;
@@ -654,7 +653,7 @@ xpc_ext_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 #endif
 
     xts.xpcu =
-        ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->handle;
+        cable->link.usb;
     xts.out = (uint8_t *) out;
     xts.in_bits = 0;
     xts.out_bits = 0;
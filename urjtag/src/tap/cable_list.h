@@ -65,6 +65,9 @@ _URJ_CABLE(ft2232_usbtojtagif)
 #ifdef ENABLE_CABLE_GPIO
 _URJ_CABLE(gpio)
 #endif
+#ifdef ENABLE_CABLE_GPIOCHIP
+_URJ_CABLE(gpiochip)
+#endif
 #ifdef ENABLE_CABLE_ICE100
 _URJ_CABLE(ice100B)
 #endif
@@ -83,12 +86,21 @@ _URJ_CABLE(keithkoep)
 #ifdef ENABLE_CABLE_LATTICE
 _URJ_CABLE(lattice)
 #endif
+#ifdef ENABLE_CABLE_LOOPBACK
+_URJ_CABLE(loopback)
+#endif
 #ifdef ENABLE_CABLE_WIGGLER
 _URJ_CABLE(minimal)
 #endif
+#ifdef ENABLE_CABLE_MMGPIO
+_URJ_CABLE(mmgpio)
+#endif
 #ifdef ENABLE_CABLE_MPCBDM
 _URJ_CABLE(mpcbdm)
 #endif
+#ifdef ENABLE_CABLE_REMOTE
+_URJ_CABLE(remote)
+#endif
 #ifdef ENABLE_CABLE_TRITON
 _URJ_CABLE(triton)
 #endif
@@ -0,0 +1,341 @@
+/*
+ * $Id$
+ *
+ * Background I/O thread for cable drivers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+/*
+ * In pipelined mode the TAP layer does not put its activity into the
+ * cable's todo queue directly. Instead, items go into a single-producer,
+ * single-consumer ring, and a dedicated thread moves them into the todo
+ * queue and runs the driver's flush(). While the thread waits for the
+ * hardware, the caller can already prepare the next scan.
+ *
+ * Ownership rules:
+ *  - the ring slots between tail and head belong to the I/O thread, all
+ *    others to the producer; head and tail are the only shared variables
+ *    on the fast path.
+ *  - the todo and done queues as well as the driver state belong to the
+ *    I/O thread while it is busy. The producer only touches them after
+ *    urj_tap_cable_thread_flush() with URJ_TAP_CABLE_TO_OUTPUT or
+ *    URJ_TAP_CABLE_COMPLETELY returned, i.e. while the thread is idle.
+ *  - the error state is per thread. The first error the driver sets on
+ *    the I/O thread is kept under the lock and becomes the producer's
+ *    error state when urj_tap_cable_thread_flush() returns.
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <urjtag/log.h>
+#include <urjtag/error.h>
+#include <urjtag/cable.h>
+
+#include "cable.h"
+
+/* number of items in the ring; must be a power of two */
+#define RING_SIZE       4096
+
+struct URJ_CABLE_IO_THREAD
+{
+    urj_cable_t *cable;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* producer -> I/O thread */
+    pthread_cond_t idle_cond;   /* I/O thread -> producer */
+
+    urj_cable_queue_t ring[RING_SIZE];
+    unsigned int head;          /* next slot to fill; producer only */
+    unsigned int tail;          /* next slot to drain; I/O thread only */
+    int idle;                   /* thread waits for work */
+
+    /* protected by lock */
+    int stop;                   /* thread shall terminate */
+    int request;                /* a flush was requested ... */
+    urj_cable_flush_amount_t how_much;  /* ... with this amount */
+    int failed;                 /* the driver has set ... */
+    urj_error_state_t error;    /* ... this error, not yet passed on */
+};
+
+/* head and idle are accessed sequentially consistent: the producer
+ * publishes an item and then checks whether the thread sleeps, the thread
+ * announces that it sleeps and then checks for new items. At least one of
+ * them is guaranteed to see the other's store. */
+static unsigned int
+ring_load (const unsigned int *p)
+{
+    return __atomic_load_n (p, __ATOMIC_SEQ_CST);
+}
+
+static void
+ring_store (unsigned int *p, unsigned int v)
+{
+    __atomic_store_n (p, v, __ATOMIC_SEQ_CST);
+}
+
+/* Move everything the producer has published into the todo queue */
+static int
+drain_ring (urj_cable_io_thread_t *t)
+{
+    urj_cable_t *cable = t->cable;
+    unsigned int head = ring_load (&t->head);
+    unsigned int tail = t->tail;
+    int n = 0;
+
+    while (tail != head)
+    {
+        int i = urj_tap_cable_add_queue_item (cable, &cable->todo);
+
+        if (i < 0)
+            break;
+        cable->todo.data[i] = t->ring[tail & (RING_SIZE - 1)];
+        tail++;
+        n++;
+    }
+    ring_store (&t->tail, tail);
+
+    return n;
+}
+
+static void *
+io_thread (void *arg)
+{
+    urj_cable_io_thread_t *t = arg;
+    urj_cable_t *cable = t->cable;
+
+    pthread_mutex_lock (&t->lock);
+    for (;;)
+    {
+        int request;
+        urj_cable_flush_amount_t how_much;
+
+        while (!t->stop && !t->request)
+        {
+            __atomic_store_n (&t->idle, 1, __ATOMIC_SEQ_CST);
+            if (ring_load (&t->head) != t->tail)
+                break;
+            pthread_cond_broadcast (&t->idle_cond);
+            pthread_cond_wait (&t->wake, &t->lock);
+        }
+        __atomic_store_n (&t->idle, 0, __ATOMIC_SEQ_CST);
+        if (t->stop)
+            break;
+
+        request = t->request;
+        how_much = t->how_much;
+        t->request = 0;
+        pthread_mutex_unlock (&t->lock);
+
+        urj_error_reset ();
+
+        if (drain_ring (t) > 0)
+        {
+            /* a producer may wait for room in the ring */
+            pthread_mutex_lock (&t->lock);
+            pthread_cond_broadcast (&t->idle_cond);
+            pthread_mutex_unlock (&t->lock);
+        }
+
+        /* A requested flush covers everything queued before the request,
+         * so only honour it once the ring has been emptied. */
+        if (request && ring_load (&t->head) == t->tail)
+            cable->driver->flush (cable, how_much);
+        else
+        {
+            cable->driver->flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+            if (request)
+            {
+                pthread_mutex_lock (&t->lock);
+                if (!t->request || t->how_much < how_much)
+                    t->how_much = how_much;
+                t->request = 1;
+                pthread_mutex_unlock (&t->lock);
+            }
+        }
+
+        pthread_mutex_lock (&t->lock);
+        if (urj_error_get () != URJ_ERROR_OK && !t->failed)
+        {
+            t->error = urj_error_state;
+            t->failed = 1;
+        }
+    }
+    pthread_mutex_unlock (&t->lock);
+
+    return NULL;
+}
+
+int
+urj_tap_cable_thread_start (urj_cable_t *cable)
+{
+    urj_cable_io_thread_t *t;
+    int r;
+
+    if (cable->io_thread != NULL)
+        return URJ_STATUS_OK;
+
+    t = calloc (1, sizeof (urj_cable_io_thread_t));
+    if (t == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       (size_t) 1, sizeof (urj_cable_io_thread_t));
+        return URJ_STATUS_FAIL;
+    }
+
+    t->cable = cable;
+    pthread_mutex_init (&t->lock, NULL);
+    pthread_cond_init (&t->wake, NULL);
+    pthread_cond_init (&t->idle_cond, NULL);
+
+    /* hand over whatever has been queued so far */
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+
+    r = pthread_create (&t->thread, NULL, io_thread, t);
+    if (r != 0)
+    {
+        pthread_cond_destroy (&t->idle_cond);
+        pthread_cond_destroy (&t->wake);
+        pthread_mutex_destroy (&t->lock);
+        free (t);
+        urj_error_set (URJ_ERROR_IO, "pthread_create() fails: %s",
+                       strerror (r));
+        return URJ_STATUS_FAIL;
+    }
+
+    cable->io_thread = t;
+    urj_log (URJ_LOG_LEVEL_DETAIL, "cable I/O thread started\n");
+
+    return URJ_STATUS_OK;
+}
+
+void
+urj_tap_cable_thread_stop (urj_cable_t *cable)
+{
+    urj_cable_io_thread_t *t = cable->io_thread;
+
+    if (t == NULL)
+        return;
+
+    urj_tap_cable_thread_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+
+    pthread_mutex_lock (&t->lock);
+    t->stop = 1;
+    pthread_cond_signal (&t->wake);
+    pthread_mutex_unlock (&t->lock);
+    pthread_join (t->thread, NULL);
+
+    pthread_cond_destroy (&t->idle_cond);
+    pthread_cond_destroy (&t->wake);
+    pthread_mutex_destroy (&t->lock);
+    cable->io_thread = NULL;
+    free (t);
+
+    urj_log (URJ_LOG_LEVEL_DETAIL, "cable I/O thread stopped\n");
+}
+
+int
+urj_tap_cable_thread_is_self (urj_cable_t *cable)
+{
+    return pthread_equal (pthread_self (), cable->io_thread->thread);
+}
+
+int
+urj_tap_cable_thread_idle (urj_cable_t *cable)
+{
+    urj_cable_io_thread_t *t = cable->io_thread;
+    int idle;
+
+    if (ring_load (&t->head) != ring_load (&t->tail))
+        return 0;
+
+    pthread_mutex_lock (&t->lock);
+    idle = t->idle && !t->request && ring_load (&t->head) == t->tail;
+    pthread_mutex_unlock (&t->lock);
+
+    return idle;
+}
+
+urj_cable_queue_t *
+urj_tap_cable_thread_slot (urj_cable_t *cable)
+{
+    urj_cable_io_thread_t *t = cable->io_thread;
+
+    if (t->head - ring_load (&t->tail) >= RING_SIZE)
+    {
+        /* ring full: have the thread drain it and wait for some room */
+        pthread_mutex_lock (&t->lock);
+        while (t->head - ring_load (&t->tail) >= RING_SIZE)
+        {
+            pthread_cond_signal (&t->wake);
+            pthread_cond_wait (&t->idle_cond, &t->lock);
+        }
+        pthread_mutex_unlock (&t->lock);
+    }
+
+    return &t->ring[t->head & (RING_SIZE - 1)];
+}
+
+void
+urj_tap_cable_thread_commit (urj_cable_t *cable)
+{
+    urj_cable_io_thread_t *t = cable->io_thread;
+
+    ring_store (&t->head, t->head + 1);
+}
+
+void
+urj_tap_cable_thread_flush (urj_cable_t *cable,
+                            urj_cable_flush_amount_t how_much)
+{
+    urj_cable_io_thread_t *t = cable->io_thread;
+
+    if (how_much == URJ_TAP_CABLE_OPTIONALLY)
+    {
+        /* just make sure the thread picks up the new items; a busy
+         * thread looks at the ring again before it goes to sleep */
+        if (__atomic_load_n (&t->idle, __ATOMIC_SEQ_CST))
+        {
+            pthread_mutex_lock (&t->lock);
+            pthread_cond_signal (&t->wake);
+            pthread_mutex_unlock (&t->lock);
+        }
+        return;
+    }
+
+    pthread_mutex_lock (&t->lock);
+    if (!t->request || t->how_much < how_much)
+        t->how_much = how_much;
+    t->request = 1;
+    pthread_cond_signal (&t->wake);
+
+    while (t->request || !__atomic_load_n (&t->idle, __ATOMIC_SEQ_CST)
+           || ring_load (&t->head) != ring_load (&t->tail))
+        pthread_cond_wait (&t->idle_cond, &t->lock);
+
+    if (t->failed)
+    {
+        urj_error_state = t->error;
+        t->failed = 0;
+    }
+
+    pthread_mutex_unlock (&t->lock);
+}
@@ -53,6 +53,7 @@ urj_tap_chain_alloc (void)
     chain->parts = NULL;
     chain->total_instr_len = 0;
     chain->active_part = 0;
+    chain->defer_output = 0;
     URJ_BSDL_GLOBS_INIT (chain->bsdl);
     urj_tap_state_init (chain);
 
@@ -78,6 +79,7 @@ urj_tap_chain_connect (urj_chain_t *chain, const char *drivername, char *params[
     int j, paramc;
     const urj_param_t **cable_params;
     const urj_cable_driver_t *driver;
+    int io_thread = 0;
 
     urj_cable_parport_devtype_t devtype;
     const char *devname;
@@ -129,6 +131,20 @@ urj_tap_chain_connect (urj_chain_t *chain, const char *drivername, char *params[
                              &urj_cable_param_list) != URJ_STATUS_OK)
         return URJ_STATUS_FAIL;
 
+    /* iothread is not for the driver but for the cable layer; take it
+     * out of the list so drivers rejecting unknown parameters don't see it */
+    for (j = 0; cable_params[j] != NULL; j++)
+        if (cable_params[j]->key == URJ_CABLE_PARAM_KEY_IOTHREAD)
+        {
+            int k;
+
+            io_thread = cable_params[j]->value.enabled;
+            free ((void *) cable_params[j]);
+            for (k = j; cable_params[k] != NULL; k++)
+                cable_params[k] = cable_params[k + 1];
+            j--;
+        }
+
     switch (driver->device_type)
     {
     case URJ_CABLE_DEVICE_PARPORT:
@@ -152,6 +168,14 @@ urj_tap_chain_connect (urj_chain_t *chain, const char *drivername, char *params[
         return URJ_STATUS_FAIL;
 
     chain->cable->chain = chain;
+
+    if (io_thread
+        && urj_tap_cable_set_io_thread (chain->cable, 1) != URJ_STATUS_OK)
+    {
+        urj_tap_chain_disconnect (chain);
+        return URJ_STATUS_FAIL;
+    }
+
     return URJ_STATUS_OK;
 }
 
@@ -205,6 +229,68 @@ urj_tap_chain_defer_clock (urj_chain_t *chain, int tms, int tdi, int n)
     return URJ_STATUS_OK;
 }
 
+int
+urj_tap_chain_defer_tms_path (urj_chain_t *chain, int len, unsigned int tms)
+{
+    char seq[URJ_CABLE_SEQ_PREFIX_MAX];
+    int i, n;
+
+    if (!chain || !chain->cable)
+    {
+        urj_error_set (URJ_ERROR_NO_CHAIN, "no chain or no part");
+        return URJ_STATUS_FAIL;
+    }
+
+    /* The cable holds the clocks back and queues them as one item, or
+     * as the start of the next scan */
+    for (i = 0; i < len; i += n)
+    {
+        for (n = 0; n < URJ_CABLE_SEQ_PREFIX_MAX && i + n < len; n++)
+        {
+            seq[n] = ((tms >> (i + n)) & 1) ? URJ_CABLE_SEQ_TMS : 0;
+            urj_tap_state_clock (chain, seq[n] != 0);
+        }
+        if (urj_tap_cable_defer_tms_prefix (chain->cable, n, seq)
+            != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_tap_chain_defer_goto_state (urj_chain_t *chain, int state)
+{
+    unsigned int tms;
+    int len;
+
+    if (!chain || !chain->cable)
+    {
+        urj_error_set (URJ_ERROR_NO_CHAIN, "no chain or no part");
+        return URJ_STATUS_FAIL;
+    }
+
+    if (state == URJ_TAP_STATE_UNKNOWN_STATE)
+        state = URJ_TAP_STATE_TEST_LOGIC_RESET;
+
+    if (urj_tap_state_path (urj_tap_state (chain), state, &tms) < 0)
+    {
+        /* Test-Logic-Reset can be reached from anywhere */
+        urj_tap_cable_defer_clock (chain->cable, 1, 0, 5);
+        urj_tap_state_reset (chain);
+    }
+
+    len = urj_tap_state_path (urj_tap_state (chain), state, &tms);
+    if (len < 0)
+    {
+        urj_error_set (URJ_ERROR_ILLEGAL_STATE, _("invalid TAP state 0x%02X"),
+                       state);
+        return URJ_STATUS_FAIL;
+    }
+
+    return urj_tap_chain_defer_tms_path (chain, len, tms);
+}
+
 int
 urj_tap_chain_set_trst (urj_chain_t *chain, int trst)
 {
@@ -297,7 +383,9 @@ urj_tap_chain_shift_instructions_mode (urj_chain_t *chain,
     else
     {
         /* give the cable driver a chance to flush if it's considered useful */
-        urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_TO_OUTPUT);
+        urj_tap_cable_flush (chain->cable, chain->defer_output > 0
+                             ? URJ_TAP_CABLE_OPTIONALLY
+                             : URJ_TAP_CABLE_TO_OUTPUT);
     }
 
     return URJ_STATUS_OK;
@@ -310,10 +398,8 @@ urj_tap_chain_shift_instructions (urj_chain_t *chain)
                                                   URJ_CHAIN_EXITMODE_IDLE);
 }
 
-int
-urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
-                                         int capture_output, int capture,
-                                         int chain_exit)
+static int
+urj_tap_chain_check_data_registers (urj_chain_t *chain)
 {
     int i;
     urj_parts_t *ps;
@@ -342,11 +428,16 @@ urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
         }
     }
 
-    if (capture)
-        urj_tap_capture_dr (chain);
+    return URJ_STATUS_OK;
+}
 
-    /* new implementation: split into defer + retrieve part
-       shift the data register of each part in the chain one by one */
+/* shift the data register of each part in the chain one by one */
+static void
+urj_tap_chain_defer_data_registers_mode (urj_chain_t *chain,
+                                         int capture_output, int chain_exit)
+{
+    int i;
+    urj_parts_t *ps = chain->parts;
 
     for (i = 0; i < ps->len; i++)
     {
@@ -357,26 +448,71 @@ urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
                     : NULL,
                 (i + 1) == ps->len ? chain_exit : URJ_CHAIN_EXITMODE_SHIFT);
     }
+}
 
-    if (capture_output)
+static void
+urj_tap_chain_get_data_registers_mode (urj_chain_t *chain, int chain_exit)
+{
+    int i;
+    urj_parts_t *ps = chain->parts;
+
+    for (i = 0; i < ps->len; i++)
     {
-        for (i = 0; i < ps->len; i++)
-        {
-            urj_tap_shift_register_output (chain,
-                    ps->parts[i]->active_instruction->data_register->in,
-                    ps->parts[i]->active_instruction->data_register->out,
-                    (i + 1) == ps->len ? chain_exit : URJ_CHAIN_EXITMODE_SHIFT);
-        }
+        urj_tap_shift_register_output (chain,
+                ps->parts[i]->active_instruction->data_register->in,
+                ps->parts[i]->active_instruction->data_register->out,
+                (i + 1) == ps->len ? chain_exit : URJ_CHAIN_EXITMODE_SHIFT);
     }
+}
+
+int
+urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
+                                         int capture_output, int capture,
+                                         int chain_exit)
+{
+    if (urj_tap_chain_check_data_registers (chain) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    if (capture)
+        urj_tap_capture_dr (chain);
+
+    urj_tap_chain_defer_data_registers_mode (chain, capture_output,
+                                             chain_exit);
+
+    if (capture_output)
+        urj_tap_chain_get_data_registers_mode (chain, chain_exit);
     else
     {
         /* give the cable driver a chance to flush if it's considered useful */
-        urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_TO_OUTPUT);
+        urj_tap_cable_flush (chain->cable, chain->defer_output > 0
+                             ? URJ_TAP_CABLE_OPTIONALLY
+                             : URJ_TAP_CABLE_TO_OUTPUT);
     }
 
     return URJ_STATUS_OK;
 }
 
+int
+urj_tap_chain_defer_data_registers (urj_chain_t *chain)
+{
+    if (urj_tap_chain_check_data_registers (chain) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    urj_tap_capture_dr (chain);
+    urj_tap_chain_defer_data_registers_mode (chain, 1,
+                                             URJ_CHAIN_EXITMODE_IDLE);
+    /* let the cable send off a full queue; the captures stay queued */
+    urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_OPTIONALLY);
+
+    return URJ_STATUS_OK;
+}
+
+void
+urj_tap_chain_get_data_registers (urj_chain_t *chain)
+{
+    urj_tap_chain_get_data_registers_mode (chain, URJ_CHAIN_EXITMODE_IDLE);
+}
+
 int
 urj_tap_chain_shift_data_registers (urj_chain_t *chain, int capture_output)
 {
@@ -391,6 +527,20 @@ urj_tap_chain_flush (urj_chain_t *chain)
         urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_COMPLETELY);
 }
 
+void
+urj_tap_chain_defer_output_begin (urj_chain_t *chain)
+{
+    chain->defer_output++;
+}
+
+void
+urj_tap_chain_defer_output_end (urj_chain_t *chain)
+{
+    if (chain->defer_output > 0 && --chain->defer_output == 0
+        && chain->cable != NULL)
+        urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_TO_OUTPUT);
+}
+
 urj_part_t *
 urj_tap_chain_active_part (urj_chain_t *chain)
 {
@@ -274,7 +274,8 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
         urj_part_init_func_t part_init_func;
 
         if (all_ids)
-            br->data[0] = all_ids->data[i * 32];
+            urj_tap_register_set_bit (br, 0,
+                                      urj_tap_register_get_bit (all_ids, i * 32));
         else
             urj_tap_shift_register (chain, one, br, URJ_CHAIN_EXITMODE_SHIFT);
 
@@ -282,12 +283,16 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
         {
             /* Part that supports IDCODE */
             if (all_ids)
-                memcpy (id->data, &all_ids->data[i * 32 + 1], 31 * sizeof (id->data[0]));
+                urj_tap_register_set_value_bit_range (id,
+                        urj_tap_register_get_value_bit_range (all_ids,
+                                                              i * 32 + 31,
+                                                              i * 32 + 1),
+                        30, 0);
             else
                 urj_tap_shift_register (chain, ones, id,
                                         URJ_CHAIN_EXITMODE_SHIFT);
             urj_tap_register_shift_left (id, 1);
-            id->data[0] = 1;
+            urj_tap_register_set_bit (id, 0, 1);
             did = id;
 
             urj_log (URJ_LOG_LEVEL_NORMAL, _("Device Id: %s (0x%0*" PRIX64 ")\n"),
@@ -329,7 +334,8 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
             strncat_const (data_path, "/MANUFACTURERS");
 
             key = urj_tap_register_alloc (11);
-            memcpy (key->data, &id->data[1], key->len);
+            urj_tap_register_set_value (key,
+                    urj_tap_register_get_value_bit_range (id, 11, 1));
             if (!find_record (data_path, key, &id_name, &id_fullname))
             {
                 urj_log (URJ_LOG_LEVEL_NORMAL, "  %s (%s) (%s)\n",
@@ -359,7 +365,8 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
             strncat_const (data_path, "/PARTS");
 
             key = urj_tap_register_alloc (16);
-            memcpy (key->data, &id->data[12], key->len);
+            urj_tap_register_set_value (key,
+                    urj_tap_register_get_value_bit_range (id, 27, 12));
             if (!find_record (data_path, key, &id_name, &id_fullname))
             {
                 urj_log (URJ_LOG_LEVEL_NORMAL, "  %s (%s) (%s)\n",
@@ -389,7 +396,8 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
             strncat_const (data_path, "/STEPPINGS");
 
             key = urj_tap_register_alloc (4);
-            memcpy (key->data, &id->data[28], key->len);
+            urj_tap_register_set_value (key,
+                    urj_tap_register_get_value_bit_range (id, 31, 28));
             if (!find_record (data_path, key, &id_name, &id_fullname))
             {
                 urj_log (URJ_LOG_LEVEL_NORMAL, "  %s (%s) (%s)\n",
@@ -29,7 +29,12 @@
 
 #include <urjtag/tap.h>
 #include <urjtag/tap_register.h>
+#include <urjtag/tap_state.h>
 #include <urjtag/chain.h>
+#include <urjtag/cable.h>
+#include <urjtag/part.h>
+#include <urjtag/error.h>
+#include <urjtag/log.h>
 
 
 #define DETECT_PATTERN_SIZE     8
@@ -37,6 +42,14 @@
 #define TEST_COUNT              1
 #define TEST_THRESHOLD          100     /* in % */
 
+/* urj_tap_auto_frequency() */
+#define AUTO_PATTERN_SIZE       4096    /* bits per pass */
+#define AUTO_TEST_COUNT         4       /* passes that must all be exact */
+#define AUTO_MAX_FREQUENCY      100000000       /* Hz, if none given */
+#define AUTO_MIN_FREQUENCY      10000   /* Hz */
+#define AUTO_RESOLUTION         32      /* stop at 1/32 of the frequency */
+#define AUTO_MARGIN             20      /* in %, above generic cables' 10% */
+
 #undef VERY_LOW_LEVEL_DEBUG
 
 int
@@ -186,3 +199,167 @@ urj_tap_discovery (urj_chain_t *chain)
 
     return URJ_STATUS_OK;
 }
+
+/* Shift AUTO_TEST_COUNT pseudo-random patterns through the @bypass bits of
+ * the chain in BYPASS; 1 if all of them came back bit-exact, else 0 */
+static int
+auto_pattern_ok (urj_chain_t *chain, int bypass, urj_tap_register_t *rpat,
+                 urj_tap_register_t *rout)
+{
+    uint32_t lfsr;
+    int i, t;
+
+    for (t = 0; t < AUTO_TEST_COUNT; t++)
+    {
+        /* xorshift, a different pattern each time */
+        lfsr = 0x2545f491u * (t + 1);
+        for (i = 0; i < rpat->len; i++)
+        {
+            lfsr ^= lfsr << 13;
+            lfsr ^= lfsr >> 17;
+            lfsr ^= lfsr << 5;
+            urj_tap_register_set_bit (rpat, i, lfsr & 1);
+        }
+
+        urj_tap_capture_dr (chain);
+        urj_tap_shift_register (chain, rpat, rout, URJ_CHAIN_EXITMODE_IDLE);
+
+        /* the captured BYPASS bits are 0, then the pattern follows */
+        for (i = 0; i < bypass; i++)
+            if (urj_tap_register_get_bit (rout, i) != 0)
+                return 0;
+        for (i = bypass; i < rout->len; i++)
+            if (urj_tap_register_get_bit (rout, i)
+                != urj_tap_register_get_bit (rpat, i - bypass))
+                return 0;
+    }
+
+    return 1;
+}
+
+static int
+auto_try (urj_chain_t *chain, uint32_t frequency, int bypass,
+          urj_tap_register_t *rpat, urj_tap_register_t *rout)
+{
+    int ok;
+
+    urj_tap_cable_set_frequency (chain->cable, frequency);
+    ok = auto_pattern_ok (chain, bypass, rpat, rout);
+    urj_log (URJ_LOG_LEVEL_DETAIL, "TCK %lu Hz (%lu Hz requested): %s\n",
+             (long unsigned) urj_tap_cable_get_frequency (chain->cable),
+             (long unsigned) frequency, ok ? "ok" : "errors");
+
+    return ok;
+}
+
+int
+urj_tap_auto_frequency (urj_chain_t *chain, uint32_t max_frequency,
+                        uint32_t *frequency)
+{
+    urj_cable_t *cable = chain->cable;
+    urj_tap_register_t *rpat, *rout;
+    uint32_t start = urj_tap_cable_get_frequency (cable);
+    uint32_t lo, hi, mid;
+    int bypass;
+
+    /* put all parts in BYPASS and learn how many bits that makes, at the
+     * frequency set before */
+    if (chain->parts != NULL && chain->total_instr_len > 0)
+    {
+        if (urj_tap_reset_bypass (chain) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        bypass = chain->parts->len;
+    }
+    else
+    {
+        /* as in urj_tap_discovery(), more ones than any IR has */
+        urj_tap_register_t *ir = urj_tap_register_fill (
+                    urj_tap_register_alloc (DEFAULT_MAX_REGISTER_LENGTH), 1);
+
+        if (ir == NULL)
+            return URJ_STATUS_FAIL;
+        urj_tap_trst_reset (chain);
+        urj_tap_capture_ir (chain);
+        urj_tap_shift_register (chain, ir, NULL, URJ_CHAIN_EXITMODE_IDLE);
+        urj_tap_register_free (ir);
+
+        urj_tap_capture_dr (chain);
+        bypass = urj_tap_detect_register_size (chain, 0);
+        urj_tap_chain_defer_goto_state (chain, URJ_TAP_STATE_RUN_TEST_IDLE);
+        if (bypass < 1)
+        {
+            urj_error_set (URJ_ERROR_NOTFOUND,
+                           _("no chain of parts in BYPASS found"));
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    /* bypass more bits than the pattern, to push it out again */
+    rpat = urj_tap_register_alloc (AUTO_PATTERN_SIZE + bypass);
+    rout = urj_tap_register_alloc (AUTO_PATTERN_SIZE + bypass);
+    if (rpat == NULL || rout == NULL)
+    {
+        urj_tap_register_free (rpat);
+        urj_tap_register_free (rout);
+        return URJ_STATUS_FAIL;
+    }
+
+    /* the fastest the cable can do */
+    urj_tap_cable_set_frequency (cable, max_frequency ? max_frequency
+                                 : AUTO_MAX_FREQUENCY);
+    hi = urj_tap_cable_get_frequency (cable);
+    if (hi == 0)
+    {
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("cable '%s' can't set the TCK frequency"),
+                       cable->driver->name);
+        goto fail;
+    }
+
+    if (auto_try (chain, hi, bypass, rpat, rout))
+        lo = hi;
+    else
+    {
+        /* a frequency that works, then bisect between it and hi */
+        lo = start != 0 && start < hi ? start : hi / 4;
+        while (!auto_try (chain, lo, bypass, rpat, rout))
+        {
+            if (lo <= AUTO_MIN_FREQUENCY)
+            {
+                urj_error_set (URJ_ERROR_ILLEGAL_STATE,
+                               _("BYPASS test fails even at %lu Hz"),
+                               (long unsigned) lo);
+                goto fail;
+            }
+            hi = lo;
+            lo = lo / 4 > AUTO_MIN_FREQUENCY ? lo / 4 : AUTO_MIN_FREQUENCY;
+        }
+        while (hi - lo > lo / AUTO_RESOLUTION)
+        {
+            mid = lo + (hi - lo) / 2;
+            if (auto_try (chain, mid, bypass, rpat, rout))
+                lo = mid;
+            else
+                hi = mid;
+        }
+    }
+
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             _("BYPASS test passes up to %lu Hz, backing off by %d%%\n"),
+             (long unsigned) lo, AUTO_MARGIN);
+    urj_tap_cable_set_frequency (cable, lo - lo / 100 * AUTO_MARGIN);
+    *frequency = urj_tap_cable_get_frequency (cable);
+
+    urj_tap_register_free (rpat);
+    urj_tap_register_free (rout);
+    if (chain->parts != NULL && chain->total_instr_len > 0)
+        return urj_tap_reset_bypass (chain);
+    urj_tap_reset (chain);
+    return URJ_STATUS_OK;
+
+ fail:
+    urj_tap_cable_set_frequency (cable, start);
+    urj_tap_register_free (rpat);
+    urj_tap_register_free (rout);
+    return URJ_STATUS_FAIL;
+}
@@ -78,7 +78,9 @@ urj_tap_idcode (urj_chain_t *chain, unsigned int bytes)
         uint8_t val;
 
         if (all_rout)
-            memcpy (rout->data, &all_rout->data[i * 8], 8 * sizeof (rout->data[0]));
+            urj_tap_register_set_value (rout,
+                    urj_tap_register_get_value_bit_range (all_rout,
+                                                          i * 8 + 7, i * 8));
         else
             urj_tap_shift_register (chain, rz, rout, 0);
 
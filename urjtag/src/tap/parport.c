@@ -27,6 +27,7 @@
 #include <stddef.h>
 
 #include <urjtag/parport.h>
+#include <urjtag/cable.h>
 
 #include "parport.h"
 
@@ -49,30 +50,101 @@ urj_tap_parport_close (urj_parport_t *port)
     return port->driver->close (port);
 }
 
+/* Every port access is a transaction of one byte */
+static void
+urj_tap_parport_count (urj_parport_t *port, int out)
+{
+    if (port->cable == NULL)
+        return;
+
+    port->cable->stats.transactions++;
+    if (out)
+        port->cable->stats.bytes_out++;
+    else
+        port->cable->stats.bytes_in++;
+}
+
 int
 urj_tap_parport_set_data (urj_parport_t *port, const unsigned char data)
 {
+    urj_tap_parport_count (port, 1);
     return port->driver->set_data (port, data);
 }
 
 int
 urj_tap_parport_get_data (urj_parport_t *port)
 {
+    urj_tap_parport_count (port, 0);
     return port->driver->get_data (port);
 }
 
 int
 urj_tap_parport_get_status (urj_parport_t *port)
 {
+    urj_tap_parport_count (port, 0);
     return port->driver->get_status (port);
 }
 
 int
 urj_tap_parport_set_control (urj_parport_t *port, const unsigned char data)
 {
+    urj_tap_parport_count (port, 1);
     return port->driver->set_control (port, data);
 }
 
+/* Drivers without the bulk operations get the byte-wise ones in a loop */
+int
+urj_tap_parport_write_data_seq (urj_parport_t *port,
+                                const unsigned char *data, int len)
+{
+    int i;
+
+    if (port->cable != NULL)
+    {
+        port->cable->stats.transactions += len;
+        port->cable->stats.bytes_out += len;
+    }
+
+    if (port->driver->write_data_seq != NULL)
+        return port->driver->write_data_seq (port, data, len);
+
+    for (i = 0; i < len; i++)
+        if (port->driver->set_data (port, data[i]) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_tap_parport_read_status_seq (urj_parport_t *port,
+                                 const unsigned char *data, int len,
+                                 unsigned char *status)
+{
+    int i, s;
+
+    if (port->cable != NULL)
+    {
+        port->cable->stats.transactions += 2 * len;
+        port->cable->stats.bytes_out += len;
+        port->cable->stats.bytes_in += len;
+    }
+
+    if (port->driver->read_status_seq != NULL)
+        return port->driver->read_status_seq (port, data, len, status);
+
+    for (i = 0; i < len; i++)
+    {
+        if (port->driver->set_data (port, data[i]) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        s = port->driver->get_status (port);
+        if (s == -1)
+            return URJ_STATUS_FAIL;
+        status[i] = s;
+    }
+
+    return URJ_STATUS_OK;
+}
+
 const char *
 urj_cable_parport_devtype_string(urj_cable_parport_devtype_t dt)
 {
@@ -303,6 +303,33 @@ direct_set_control (urj_parport_t *parport, unsigned char data)
     return URJ_STATUS_OK;
 }
 
+static int
+direct_write_data_seq (urj_parport_t *parport, const unsigned char *data,
+                       int len)
+{
+    unsigned short int port = ((direct_params_t *) parport->params)->port;
+    int i;
+
+    for (i = 0; i < len; i++)
+        outb (data[i], port);
+    return URJ_STATUS_OK;
+}
+
+static int
+direct_read_status_seq (urj_parport_t *parport, const unsigned char *data,
+                        int len, unsigned char *status)
+{
+    unsigned short int port = ((direct_params_t *) parport->params)->port;
+    int i;
+
+    for (i = 0; i < len; i++)
+    {
+        outb (data[i], port);
+        status[i] = inb (port + 1) ^ 0x80;      /* BUSY is inverted */
+    }
+    return URJ_STATUS_OK;
+}
+
 const urj_parport_driver_t urj_tap_parport_direct_parport_driver = {
     URJ_CABLE_PARPORT_DEV_PARALLEL,
     direct_connect,
@@ -312,5 +339,7 @@ const urj_parport_driver_t urj_tap_parport_direct_parport_driver = {
     direct_set_data,
     direct_get_data,
     direct_get_status,
-    direct_set_control
+    direct_set_control,
+    direct_write_data_seq,
+    direct_read_status_seq
 };
@@ -237,6 +237,54 @@ ppdev_set_control (urj_parport_t *parport, unsigned char data)
     return URJ_STATUS_OK;
 }
 
+static int
+ppdev_write_data_seq (urj_parport_t *parport, const unsigned char *data,
+                      int len)
+{
+    ppdev_params_t *p = parport->params;
+    unsigned char d;
+    int i;
+
+    for (i = 0; i < len; i++)
+    {
+        d = data[i];
+        if (ioctl (p->fd, PPWDATA, &d) == -1)
+        {
+            urj_error_IO_set ("ioctl(PPWDATA) fails");
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    return URJ_STATUS_OK;
+}
+
+static int
+ppdev_read_status_seq (urj_parport_t *parport, const unsigned char *data,
+                       int len, unsigned char *status)
+{
+    ppdev_params_t *p = parport->params;
+    unsigned char d;
+    int i;
+
+    for (i = 0; i < len; i++)
+    {
+        d = data[i];
+        if (ioctl (p->fd, PPWDATA, &d) == -1)
+        {
+            urj_error_IO_set ("ioctl(PPWDATA) fails");
+            return URJ_STATUS_FAIL;
+        }
+        if (ioctl (p->fd, PPRSTATUS, &d) == -1)
+        {
+            urj_error_IO_set ("ioctl(PPRSTATUS) fails");
+            return URJ_STATUS_FAIL;
+        }
+        status[i] = d ^ 0x80;   /* BUSY is inverted */
+    }
+
+    return URJ_STATUS_OK;
+}
+
 const urj_parport_driver_t urj_tap_parport_ppdev_parport_driver = {
     URJ_CABLE_PARPORT_DEV_PPDEV,
     ppdev_connect,
@@ -246,5 +294,7 @@ const urj_parport_driver_t urj_tap_parport_ppdev_parport_driver = {
     ppdev_set_data,
     ppdev_get_data,
     ppdev_get_status,
-    ppdev_set_control
+    ppdev_set_control,
+    ppdev_write_data_seq,
+    ppdev_read_status_seq
 };
@@ -231,5 +231,7 @@ const urj_parport_driver_t urj_tap_parport_ppi_parport_driver = {
     ppi_set_data,
     ppi_get_data,
     ppi_get_status,
-    ppi_set_control
+    ppi_set_control,
+    NULL,
+    NULL
 };
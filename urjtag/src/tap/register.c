@@ -32,10 +32,64 @@
 #include <urjtag/log.h>
 #include <urjtag/tap_register.h>
 
+#define WORD_BITS       URJ_TAP_REGISTER_WORD_BITS
+#define WORD(pos)       ((pos) / WORD_BITS)
+#define BIT(pos)        ((uint64_t) 1 << ((pos) % WORD_BITS))
+
+/* mask of the valid bits in the last word of a register */
+static uint64_t
+tail_mask (int len)
+{
+    int used = len % WORD_BITS;
+
+    return used ? (((uint64_t) 1 << used) - 1) : ~(uint64_t) 0;
+}
+
+static void
+clear_tail (urj_tap_register_t *tr)
+{
+    tr->words[WORD (tr->len - 1)] &= tail_mask (tr->len);
+}
+
+/* read up to 64 bits starting at pos; bits beyond tr->len read as 0 */
+static uint64_t
+get_word_at (const urj_tap_register_t *tr, int pos)
+{
+    int w = WORD (pos);
+    int sh = pos % WORD_BITS;
+    int nwords = URJ_TAP_REGISTER_WORDS (tr->len);
+    uint64_t v;
+
+    v = tr->words[w] >> sh;
+    if (sh && w + 1 < nwords)
+        v |= tr->words[w + 1] << (WORD_BITS - sh);
+
+    return v;
+}
+
+/* write the n (1..64) low bits of val at pos; pos + n must be <= tr->len */
+static void
+put_bits_at (urj_tap_register_t *tr, int pos, int n, uint64_t val)
+{
+    int w = WORD (pos);
+    int sh = pos % WORD_BITS;
+    uint64_t mask = (n < WORD_BITS) ? (((uint64_t) 1 << n) - 1) : ~(uint64_t) 0;
+
+    val &= mask;
+    tr->words[w] = (tr->words[w] & ~(mask << sh)) | (val << sh);
+    if (sh + n > WORD_BITS)
+    {
+        int rest = WORD_BITS - sh;
+
+        tr->words[w + 1] = (tr->words[w + 1] & ~(mask >> rest)) | (val >> rest);
+    }
+}
+
 urj_tap_register_t *
 urj_tap_register_alloc (int len)
 {
     urj_tap_register_t *tr;
+    size_t nwords;
 
     if (len < 1)
     {
@@ -51,29 +105,19 @@ urj_tap_register_alloc (int len)
         return NULL;
     }
 
-    tr->data = malloc (len);
-    if (!tr->data)
-    {
-        free (tr);
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-                       (size_t) len);
-        return NULL;
-    }
-
-    memset (tr->data, 0, len);
-
-    tr->string = malloc (len + 1);
-    if (!tr->string)
+    nwords = URJ_TAP_REGISTER_WORDS (len);
+    tr->words = calloc (nwords, sizeof (uint64_t));
+    if (!tr->words)
     {
-        free (tr->data);
         free (tr);
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-                       (size_t) (len + 1));
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       nwords, sizeof (uint64_t));
         return NULL;
     }
 
+    /* the string representation is only built on demand */
+    tr->string = NULL;
     tr->len = len;
-    tr->string[len] = '\0';
 
     return tr;
 }
@@ -81,6 +125,9 @@ urj_tap_register_alloc (int len)
 urj_tap_register_t *
 urj_tap_register_realloc (urj_tap_register_t *tr, int new_len)
 {
+    size_t old_words, new_words;
+    uint64_t *words;
+
     if (!tr)
         return urj_tap_register_alloc (new_len);
 
@@ -90,19 +137,27 @@ urj_tap_register_realloc (urj_tap_register_t *tr, int new_len)
         return NULL;
     }
 
-    tr->data = realloc (tr->data, new_len);
+    old_words = URJ_TAP_REGISTER_WORDS (tr->len);
+    new_words = URJ_TAP_REGISTER_WORDS (new_len);
 
-    if (!tr->data)
+    words = realloc (tr->words, new_words * sizeof (uint64_t));
+    if (!words)
     {
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%d) fails",
-                       new_len);
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%zd) fails",
+                       new_words * sizeof (uint64_t));
         return NULL;
     }
+    tr->words = words;
 
-    if (tr->len < new_len)
-        memset (tr->data + tr->len, 0, (new_len - tr->len));
+    if (new_words > old_words)
+        memset (tr->words + old_words, 0,
+                (new_words - old_words) * sizeof (uint64_t));
 
     tr->len = new_len;
+    clear_tail (tr);
+
+    free (tr->string);
+    tr->string = NULL;
 
     return tr;
 }
@@ -110,14 +165,20 @@ urj_tap_register_realloc (urj_tap_register_t *tr, int new_len)
 urj_tap_register_t *
 urj_tap_register_duplicate (const urj_tap_register_t *tr)
 {
+    urj_tap_register_t *dup;
+
     if (!tr)
     {
         urj_error_set (URJ_ERROR_INVALID, "tr == NULL");
         return NULL;
     }
 
-    return urj_tap_register_init (urj_tap_register_alloc (tr->len),
-                                  urj_tap_register_get_string (tr));
+    dup = urj_tap_register_alloc (tr->len);
+    if (dup)
+        memcpy (dup->words, tr->words,
+                URJ_TAP_REGISTER_WORDS (tr->len) * sizeof (uint64_t));
+
+    return dup;
 }
 
 void
@@ -125,7 +186,7 @@ urj_tap_register_free (urj_tap_register_t *tr)
 {
     if (tr)
     {
-        free (tr->data);
+        free (tr->words);
         free (tr->string);
     }
     free (tr);
@@ -135,7 +196,11 @@ urj_tap_register_t *
 urj_tap_register_fill (urj_tap_register_t *tr, int val)
 {
     if (tr)
-        memset (tr->data, val & 1, tr->len);
+    {
+        memset (tr->words, (val & 1) ? 0xff : 0,
+                URJ_TAP_REGISTER_WORDS (tr->len) * sizeof (uint64_t));
+        clear_tail (tr);
+    }
 
     return tr;
 }
@@ -166,8 +231,6 @@ urj_tap_register_set_string (urj_tap_register_t *tr, const char *str)
     else
     {
         /* Bit string */
-        unsigned int bit;
-
         if (strspn (str, "01") != strlen (str))
         {
             urj_error_set (URJ_ERROR_SYNTAX,
@@ -183,8 +246,7 @@ urj_tap_register_set_string (urj_tap_register_t *tr, const char *str)
             return URJ_STATUS_FAIL;
         }
 
-        for (bit = 0; str[bit]; ++bit)
-            tr->data[tr->len - 1 - bit] = (str[bit] == '1');
+        urj_tap_register_init (tr, str);
 
         return URJ_STATUS_OK;
     }
@@ -194,7 +256,6 @@ int
 urj_tap_register_set_value_bit_range (urj_tap_register_t *tr, uint64_t val, int msb, int lsb)
 {
     int bit;
-    int step = msb >= lsb ? 1 : -1;
 
     if (!tr)
     {
@@ -210,10 +271,27 @@ urj_tap_register_set_value_bit_range (urj_tap_register_t *tr, uint64_t val, int
         return URJ_STATUS_FAIL;
     }
 
-    for (bit = lsb; bit * step <= msb * step; bit += step)
+    if (msb >= lsb)
+    {
+        /* bits above the 64 supplied ones are cleared */
+        for (bit = lsb; bit <= msb; bit += WORD_BITS)
+        {
+            int n = msb - bit + 1;
+
+            if (n > WORD_BITS)
+                n = WORD_BITS;
+            put_bits_at (tr, bit, n, val);
+            val = 0;
+        }
+    }
+    else
     {
-        tr->data[bit] = !!(val & 1);
-        val >>= 1;
+        /* reversed bit order */
+        for (bit = lsb; bit >= msb; bit--)
+        {
+            urj_tap_register_set_bit (tr, bit, val & 1);
+            val >>= 1;
+        }
     }
 
     return URJ_STATUS_OK;
@@ -236,8 +314,24 @@ urj_tap_register_get_string (const urj_tap_register_t *tr)
         return NULL;
     }
 
+    if (!tr->string)
+    {
+        /* the cached string is not part of the register value */
+        char *string = malloc (tr->len + 1);
+
+        if (!string)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                           (size_t) (tr->len + 1));
+            return NULL;
+        }
+        string[tr->len] = '\0';
+        ((urj_tap_register_t *) tr)->string = string;
+    }
+
     for (i = 0; i < tr->len; i++)
-        tr->string[tr->len - 1 - i] = (tr->data[i] & 1) ? '1' : '0';
+        tr->string[tr->len - 1 - i] =
+            (tr->words[WORD (i)] & BIT (i)) ? '1' : '0';
 
     return tr->string;
 }
@@ -247,7 +341,6 @@ urj_tap_register_get_value_bit_range (const urj_tap_register_t *tr, int msb, int
 {
     int bit;
     uint64_t l, b;
-    int step = msb >= lsb ? 1 : -1;
 
     if (!tr)
         return 0;
@@ -255,11 +348,23 @@ urj_tap_register_get_value_bit_range (const urj_tap_register_t *tr, int msb, int
     if (msb > tr->len - 1 || lsb > tr->len - 1 || msb < 0 || lsb < 0)
         return 0;
 
+    if (msb >= lsb)
+    {
+        int n = msb - lsb + 1;
+
+        l = get_word_at (tr, lsb);
+        if (n < WORD_BITS)
+            l &= ((uint64_t) 1 << n) - 1;
+
+        return l;
+    }
+
+    /* reversed bit order */
     l = 0;
     b = 1;
-    for (bit = lsb; bit * step <= msb * step; bit += step)
+    for (bit = lsb; bit >= msb && b; bit--)
     {
-        if (tr->data[bit] & 1)
+        if (urj_tap_register_get_bit (tr, bit))
             l |= b;
         b <<= 1;
     }
@@ -276,7 +381,9 @@ urj_tap_register_get_value (const urj_tap_register_t *tr)
 int
 urj_tap_register_all_bits_same_value (const urj_tap_register_t *tr)
 {
-    int i, value;
+    int i, nwords, value;
+    uint64_t ref;
+
     if (!tr)
         return -1;
     if (tr->len < 0)
@@ -285,13 +392,17 @@ urj_tap_register_all_bits_same_value (const urj_tap_register_t *tr)
     /* Return -1 if any of the bits in the register
      * differs from the others; the value otherwise. */
 
-    value = tr->data[0] & 1;
+    value = tr->words[0] & 1;
+    ref = value ? ~(uint64_t) 0 : 0;
+    nwords = URJ_TAP_REGISTER_WORDS (tr->len);
 
-    for (i = 1; i < tr->len; i++)
-    {
-        if ((tr->data[i] & 1) != value)
+    for (i = 0; i < nwords - 1; i++)
+        if (tr->words[i] != ref)
             return -1;
-    }
+
+    if (tr->words[i] != (ref & tail_mask (tr->len)))
+        return -1;
+
     return value;
 }
 
@@ -299,6 +410,7 @@ urj_tap_register_t *
 urj_tap_register_init (urj_tap_register_t *tr, const char *value)
 {
     int i;
+    uint64_t w;
 
     const char *p;
 
@@ -307,14 +419,20 @@ urj_tap_register_init (urj_tap_register_t *tr, const char *value)
 
     p = strchr (value, '\0');
 
+    w = 0;
     for (i = 0; i < tr->len; i++)
     {
-        if (p == value)
-            tr->data[i] = 0;
-        else
+        if (p != value)
         {
             p--;
-            tr->data[i] = (*p == '0') ? 0 : 1;
+            if (*p != '0')
+                w |= BIT (i);
+        }
+
+        if ((i + 1) % WORD_BITS == 0 || i + 1 == tr->len)
+        {
+            tr->words[WORD (i)] = w;
+            w = 0;
         }
     }
 
@@ -325,8 +443,6 @@ int
 urj_tap_register_compare (const urj_tap_register_t *tr,
                           const urj_tap_register_t *tr2)
 {
-    int i;
-
     if (!tr && !tr2)
         return 0;
 
@@ -336,9 +452,10 @@ urj_tap_register_compare (const urj_tap_register_t *tr,
     if (tr->len != tr2->len)
         return 1;
 
-    for (i = 0; i < tr->len; i++)
-        if (tr->data[i] != tr2->data[i])
-            return 1;
+    /* unused tail bits are always 0, so whole words can be compared */
+    if (memcmp (tr->words, tr2->words,
+                URJ_TAP_REGISTER_WORDS (tr->len) * sizeof (uint64_t)) != 0)
+        return 1;
 
     return 0;
 }
@@ -353,6 +470,8 @@ urj_tap_register_match (const urj_tap_register_t *tr, const char *expr)
         return 0;
 
     s = urj_tap_register_get_string (tr);
+    if (!s)
+        return 0;
 
     for (i = 0; i < tr->len; i++)
         if ((expr[i] != '?') && (expr[i] != s[i]))
@@ -364,18 +483,17 @@ urj_tap_register_match (const urj_tap_register_t *tr, const char *expr)
 urj_tap_register_t *
 urj_tap_register_inc (urj_tap_register_t *tr)
 {
-    int i;
+    int i, nwords;
 
     if (!tr)
         return NULL;
 
-    for (i = 0; i < tr->len; i++)
-    {
-        tr->data[i] ^= 1;
-
-        if (tr->data[i] == 1)
+    nwords = URJ_TAP_REGISTER_WORDS (tr->len);
+    for (i = 0; i < nwords; i++)
+        if (++tr->words[i] != 0)
             break;
-    }
+
+    clear_tail (tr);
 
     return tr;
 }
@@ -383,18 +501,17 @@ urj_tap_register_inc (urj_tap_register_t *tr)
 urj_tap_register_t *
 urj_tap_register_dec (urj_tap_register_t *tr)
 {
-    int i;
+    int i, nwords;
 
     if (!tr)
         return NULL;
 
-    for (i = 0; i < tr->len; i++)
-    {
-        tr->data[i] ^= 1;
-
-        if (tr->data[i] == 0)
+    nwords = URJ_TAP_REGISTER_WORDS (tr->len);
+    for (i = 0; i < nwords; i++)
+        if (tr->words[i]-- != 0)
             break;
-    }
+
+    clear_tail (tr);
 
     return tr;
 }
@@ -402,7 +519,7 @@ urj_tap_register_dec (urj_tap_register_t *tr)
 urj_tap_register_t *
 urj_tap_register_shift_right (urj_tap_register_t *tr, int shift)
 {
-    int i;
+    int i, nwords, ws, bs;
 
     if (!tr)
         return NULL;
@@ -410,12 +527,21 @@ urj_tap_register_shift_right (urj_tap_register_t *tr, int shift)
     if (shift < 1)
         return tr;
 
-    for (i = 0; i < tr->len; i++)
+    nwords = URJ_TAP_REGISTER_WORDS (tr->len);
+    ws = WORD (shift);
+    bs = shift % WORD_BITS;
+
+    for (i = 0; i < nwords; i++)
     {
-        if (i + shift < tr->len)
-            tr->data[i] = tr->data[i + shift];
-        else
-            tr->data[i] = 0;
+        uint64_t w = 0;
+
+        if (i + ws < nwords)
+        {
+            w = tr->words[i + ws] >> bs;
+            if (bs && i + ws + 1 < nwords)
+                w |= tr->words[i + ws + 1] << (WORD_BITS - bs);
+        }
+        tr->words[i] = w;
     }
 
     return tr;
@@ -424,7 +550,7 @@ urj_tap_register_shift_right (urj_tap_register_t *tr, int shift)
 urj_tap_register_t *
 urj_tap_register_shift_left (urj_tap_register_t *tr, int shift)
 {
-    int i;
+    int i, nwords, ws, bs;
 
     if (!tr)
         return NULL;
@@ -432,13 +558,169 @@ urj_tap_register_shift_left (urj_tap_register_t *tr, int shift)
     if (shift < 1)
         return tr;
 
-    for (i = tr->len - 1; i >= 0; i--)
+    nwords = URJ_TAP_REGISTER_WORDS (tr->len);
+    ws = WORD (shift);
+    bs = shift % WORD_BITS;
+
+    for (i = nwords - 1; i >= 0; i--)
     {
-        if (i - shift >= 0)
-            tr->data[i] = tr->data[i - shift];
-        else
-            tr->data[i] = 0;
+        uint64_t w = 0;
+
+        if (i - ws >= 0)
+        {
+            w = tr->words[i - ws] << bs;
+            if (bs && i - ws - 1 >= 0)
+                w |= tr->words[i - ws - 1] >> (WORD_BITS - bs);
+        }
+        tr->words[i] = w;
     }
 
+    clear_tail (tr);
+
     return tr;
 }
+
+int
+urj_tap_register_get_bit (const urj_tap_register_t *tr, int pos)
+{
+    return (tr->words[WORD (pos)] & BIT (pos)) ? 1 : 0;
+}
+
+void
+urj_tap_register_set_bit (urj_tap_register_t *tr, int pos, int val)
+{
+    if (val & 1)
+        tr->words[WORD (pos)] |= BIT (pos);
+    else
+        tr->words[WORD (pos)] &= ~BIT (pos);
+}
+
+uint64_t
+urj_tap_register_get_word (const urj_tap_register_t *tr, int word)
+{
+    return tr->words[word];
+}
+
+void
+urj_tap_register_update_word (urj_tap_register_t *tr, int word,
+                              uint64_t mask, uint64_t val)
+{
+    tr->words[word] = (tr->words[word] & ~mask) | (val & mask);
+    if (word == WORD (tr->len - 1))
+        clear_tail (tr);
+}
+
+static const uint8_t flip8[256] = {
+#define R2(n)   n, n + 2*64, n + 1*64, n + 3*64
+#define R4(n)   R2(n), R2(n + 2*16), R2(n + 1*16), R2(n + 3*16)
+#define R6(n)   R4(n), R4(n + 2*4 ), R4(n + 1*4 ), R4(n + 3*4 )
+    R6(0), R6(2), R6(1), R6(3)
+#undef R6
+#undef R4
+#undef R2
+};
+
+int
+urj_tap_register_set_bytes (urj_tap_register_t *tr, const uint8_t *buf,
+                            int nbytes, int msb_first)
+{
+    int i, nbits;
+
+    if (!tr || !buf)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "tr == NULL || buf == NULL");
+        return URJ_STATUS_FAIL;
+    }
+
+    nbits = nbytes * 8;
+    if (nbits > tr->len)
+        nbits = tr->len;
+
+    /* full words first, then the remaining bytes */
+    for (i = 0; i + WORD_BITS <= nbits; i += WORD_BITS)
+    {
+        const uint8_t *b = buf + i / 8;
+        uint64_t w = 0;
+        int k;
+
+        for (k = 7; k >= 0; k--)
+            w = (w << 8) | (msb_first ? flip8[b[k]] : b[k]);
+        tr->words[WORD (i)] = w;
+    }
+    for (; i < nbits; i += 8)
+    {
+        uint8_t b = buf[i / 8];
+        int n = nbits - i;
+
+        put_bits_at (tr, i, n < 8 ? n : 8, msb_first ? flip8[b] : b);
+    }
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_tap_register_get_bytes (const urj_tap_register_t *tr, uint8_t *buf,
+                            int nbytes, int msb_first)
+{
+    int i, nbits;
+
+    if (!tr || !buf)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "tr == NULL || buf == NULL");
+        return URJ_STATUS_FAIL;
+    }
+
+    nbits = nbytes * 8;
+    if (nbits > tr->len)
+        nbits = tr->len;
+
+    for (i = 0; i < nbits; i += 8)
+    {
+        uint8_t b = get_word_at (tr, i) & 0xff;
+        int n = nbits - i;
+
+        if (n < 8)
+        {
+            /* keep the buffer bits beyond the end of the register */
+            uint8_t keep = (0xff << n) & 0xff;
+
+            if (msb_first)
+                b = (buf[i / 8] & flip8[keep]) | flip8[b];
+            else
+                b = (buf[i / 8] & keep) | b;
+        }
+        else if (msb_first)
+            b = flip8[b];
+        buf[i / 8] = b;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+void
+urj_tap_register_unpack (const urj_tap_register_t *tr, char *bits)
+{
+    int i;
+
+    for (i = 0; i < tr->len; i++)
+        bits[i] = (tr->words[WORD (i)] & BIT (i)) ? 1 : 0;
+}
+
+void
+urj_tap_register_pack (urj_tap_register_t *tr, const char *bits)
+{
+    int i;
+    uint64_t w = 0;
+
+    for (i = 0; i < tr->len; i++)
+    {
+        if (bits[i] & 1)
+            w |= BIT (i);
+
+        if ((i + 1) % WORD_BITS == 0 || i + 1 == tr->len)
+        {
+            tr->words[WORD (i)] = w;
+            w = 0;
+        }
+    }
+}
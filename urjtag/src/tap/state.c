@@ -203,3 +203,169 @@ urj_tap_state_clock (urj_chain_t *chain, int tms)
     urj_tap_state_dump_2 (oldstate, chain->state, tms);
     return chain->state;
 }
+
+/* Position of the TAP states in urj_tap_state_paths[] */
+static int
+urj_tap_state_index (int state)
+{
+    switch (state)
+    {
+    case URJ_TAP_STATE_TEST_LOGIC_RESET:	return 0;
+    case URJ_TAP_STATE_RUN_TEST_IDLE:		return 1;
+    case URJ_TAP_STATE_SELECT_DR_SCAN:		return 2;
+    case URJ_TAP_STATE_CAPTURE_DR:		return 3;
+    case URJ_TAP_STATE_SHIFT_DR:		return 4;
+    case URJ_TAP_STATE_EXIT1_DR:		return 5;
+    case URJ_TAP_STATE_PAUSE_DR:		return 6;
+    case URJ_TAP_STATE_EXIT2_DR:		return 7;
+    case URJ_TAP_STATE_UPDATE_DR:		return 8;
+    case URJ_TAP_STATE_SELECT_IR_SCAN:		return 9;
+    case URJ_TAP_STATE_CAPTURE_IR:		return 10;
+    case URJ_TAP_STATE_SHIFT_IR:		return 11;
+    case URJ_TAP_STATE_EXIT1_IR:		return 12;
+    case URJ_TAP_STATE_PAUSE_IR:		return 13;
+    case URJ_TAP_STATE_EXIT2_IR:		return 14;
+    case URJ_TAP_STATE_UPDATE_IR:		return 15;
+    default:					return -1;
+    }
+}
+
+/*
+ * Shortest paths between any two TAP states: the number of clocks and the
+ * TMS values, the first clock in bit 0. Test-Logic-Reset is only passed
+ * through on the way to Test-Logic-Reset itself, so a path never resets
+ * the instruction register by accident. Rows are the current state,
+ * columns the destination, both in the order of urj_tap_state_index().
+ */
+static const struct
+{
+    unsigned char len;
+    unsigned char tms;
+}
+urj_tap_state_paths[16][16] = {
+    /* from Test-Logic-Reset */
+    {
+        { 0, 0x00 }, { 1, 0x00 }, { 2, 0x02 }, { 3, 0x02 },
+        { 4, 0x02 }, { 4, 0x0A }, { 5, 0x0A }, { 6, 0x2A },
+        { 5, 0x1A }, { 3, 0x06 }, { 4, 0x06 }, { 5, 0x06 },
+        { 5, 0x16 }, { 6, 0x16 }, { 7, 0x56 }, { 6, 0x36 }
+    },
+    /* from Run-Test/Idle */
+    {
+        { 3, 0x07 }, { 0, 0x00 }, { 1, 0x01 }, { 2, 0x01 },
+        { 3, 0x01 }, { 3, 0x05 }, { 4, 0x05 }, { 5, 0x15 },
+        { 4, 0x0D }, { 2, 0x03 }, { 3, 0x03 }, { 4, 0x03 },
+        { 4, 0x0B }, { 5, 0x0B }, { 6, 0x2B }, { 5, 0x1B }
+    },
+    /* from Select-DR-Scan */
+    {
+        { 2, 0x03 }, { 4, 0x06 }, { 0, 0x00 }, { 1, 0x00 },
+        { 2, 0x00 }, { 2, 0x02 }, { 3, 0x02 }, { 4, 0x0A },
+        { 3, 0x06 }, { 1, 0x01 }, { 2, 0x01 }, { 3, 0x01 },
+        { 3, 0x05 }, { 4, 0x05 }, { 5, 0x15 }, { 4, 0x0D }
+    },
+    /* from Capture-DR */
+    {
+        { 5, 0x1F }, { 3, 0x03 }, { 3, 0x07 }, { 0, 0x00 },
+        { 1, 0x00 }, { 1, 0x01 }, { 2, 0x01 }, { 3, 0x05 },
+        { 2, 0x03 }, { 4, 0x0F }, { 5, 0x0F }, { 6, 0x0F },
+        { 6, 0x2F }, { 7, 0x2F }, { 8, 0xAF }, { 7, 0x6F }
+    },
+    /* from Shift-DR */
+    {
+        { 5, 0x1F }, { 3, 0x03 }, { 3, 0x07 }, { 4, 0x07 },
+        { 0, 0x00 }, { 1, 0x01 }, { 2, 0x01 }, { 3, 0x05 },
+        { 2, 0x03 }, { 4, 0x0F }, { 5, 0x0F }, { 6, 0x0F },
+        { 6, 0x2F }, { 7, 0x2F }, { 8, 0xAF }, { 7, 0x6F }
+    },
+    /* from Exit1-DR */
+    {
+        { 4, 0x0F }, { 2, 0x01 }, { 2, 0x03 }, { 3, 0x03 },
+        { 3, 0x02 }, { 0, 0x00 }, { 1, 0x00 }, { 2, 0x02 },
+        { 1, 0x01 }, { 3, 0x07 }, { 4, 0x07 }, { 5, 0x07 },
+        { 5, 0x17 }, { 6, 0x17 }, { 7, 0x57 }, { 6, 0x37 }
+    },
+    /* from Pause-DR */
+    {
+        { 5, 0x1F }, { 3, 0x03 }, { 3, 0x07 }, { 4, 0x07 },
+        { 2, 0x01 }, { 3, 0x05 }, { 0, 0x00 }, { 1, 0x01 },
+        { 2, 0x03 }, { 4, 0x0F }, { 5, 0x0F }, { 6, 0x0F },
+        { 6, 0x2F }, { 7, 0x2F }, { 8, 0xAF }, { 7, 0x6F }
+    },
+    /* from Exit2-DR */
+    {
+        { 4, 0x0F }, { 2, 0x01 }, { 2, 0x03 }, { 3, 0x03 },
+        { 1, 0x00 }, { 2, 0x02 }, { 3, 0x02 }, { 0, 0x00 },
+        { 1, 0x01 }, { 3, 0x07 }, { 4, 0x07 }, { 5, 0x07 },
+        { 5, 0x17 }, { 6, 0x17 }, { 7, 0x57 }, { 6, 0x37 }
+    },
+    /* from Update-DR */
+    {
+        { 3, 0x07 }, { 1, 0x00 }, { 1, 0x01 }, { 2, 0x01 },
+        { 3, 0x01 }, { 3, 0x05 }, { 4, 0x05 }, { 5, 0x15 },
+        { 0, 0x00 }, { 2, 0x03 }, { 3, 0x03 }, { 4, 0x03 },
+        { 4, 0x0B }, { 5, 0x0B }, { 6, 0x2B }, { 5, 0x1B }
+    },
+    /* from Select-IR-Scan */
+    {
+        { 1, 0x01 }, { 4, 0x06 }, { 4, 0x0E }, { 5, 0x0E },
+        { 6, 0x0E }, { 6, 0x2E }, { 7, 0x2E }, { 8, 0xAE },
+        { 7, 0x6E }, { 0, 0x00 }, { 1, 0x00 }, { 2, 0x00 },
+        { 2, 0x02 }, { 3, 0x02 }, { 4, 0x0A }, { 3, 0x06 }
+    },
+    /* from Capture-IR */
+    {
+        { 5, 0x1F }, { 3, 0x03 }, { 3, 0x07 }, { 4, 0x07 },
+        { 5, 0x07 }, { 5, 0x17 }, { 6, 0x17 }, { 7, 0x57 },
+        { 6, 0x37 }, { 4, 0x0F }, { 0, 0x00 }, { 1, 0x00 },
+        { 1, 0x01 }, { 2, 0x01 }, { 3, 0x05 }, { 2, 0x03 }
+    },
+    /* from Shift-IR */
+    {
+        { 5, 0x1F }, { 3, 0x03 }, { 3, 0x07 }, { 4, 0x07 },
+        { 5, 0x07 }, { 5, 0x17 }, { 6, 0x17 }, { 7, 0x57 },
+        { 6, 0x37 }, { 4, 0x0F }, { 5, 0x0F }, { 0, 0x00 },
+        { 1, 0x01 }, { 2, 0x01 }, { 3, 0x05 }, { 2, 0x03 }
+    },
+    /* from Exit1-IR */
+    {
+        { 4, 0x0F }, { 2, 0x01 }, { 2, 0x03 }, { 3, 0x03 },
+        { 4, 0x03 }, { 4, 0x0B }, { 5, 0x0B }, { 6, 0x2B },
+        { 5, 0x1B }, { 3, 0x07 }, { 4, 0x07 }, { 3, 0x02 },
+        { 0, 0x00 }, { 1, 0x00 }, { 2, 0x02 }, { 1, 0x01 }
+    },
+    /* from Pause-IR */
+    {
+        { 5, 0x1F }, { 3, 0x03 }, { 3, 0x07 }, { 4, 0x07 },
+        { 5, 0x07 }, { 5, 0x17 }, { 6, 0x17 }, { 7, 0x57 },
+        { 6, 0x37 }, { 4, 0x0F }, { 5, 0x0F }, { 2, 0x01 },
+        { 3, 0x05 }, { 0, 0x00 }, { 1, 0x01 }, { 2, 0x03 }
+    },
+    /* from Exit2-IR */
+    {
+        { 4, 0x0F }, { 2, 0x01 }, { 2, 0x03 }, { 3, 0x03 },
+        { 4, 0x03 }, { 4, 0x0B }, { 5, 0x0B }, { 6, 0x2B },
+        { 5, 0x1B }, { 3, 0x07 }, { 4, 0x07 }, { 1, 0x00 },
+        { 2, 0x02 }, { 3, 0x02 }, { 0, 0x00 }, { 1, 0x01 }
+    },
+    /* from Update-IR */
+    {
+        { 3, 0x07 }, { 1, 0x00 }, { 1, 0x01 }, { 2, 0x01 },
+        { 3, 0x01 }, { 3, 0x05 }, { 4, 0x05 }, { 5, 0x15 },
+        { 4, 0x0D }, { 2, 0x03 }, { 3, 0x03 }, { 4, 0x03 },
+        { 4, 0x0B }, { 5, 0x0B }, { 6, 0x2B }, { 0, 0x00 }
+    }
+};
+
+int
+urj_tap_state_path (int from, int to, unsigned int *tms)
+{
+    int i = urj_tap_state_index (from);
+    int j = urj_tap_state_index (to);
+
+    if (i < 0 || j < 0)
+        return -1;
+
+    *tms = urj_tap_state_paths[i][j].tms;
+    return urj_tap_state_paths[i][j].len;
+}
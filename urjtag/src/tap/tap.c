@@ -76,16 +76,19 @@ urj_tap_reset_bypass (urj_chain_t *chain)
     return URJ_STATUS_OK;
 }
 
-void
-urj_tap_defer_shift_register (urj_chain_t *chain,
-                              const urj_tap_register_t *in,
-                              urj_tap_register_t *out, int tap_exit)
+/* The cable drivers work on one char per bit. Both the clocks and room
+ * for the TDO bits come from the cable's transfer arena, so they can be
+ * queued without another copy; the TDO bits are collected by
+ * urj_tap_shift_register_output(). */
+
+/* For cables without TMS sequences: a transfer, then the last bit and the
+ * clocks to leave the shift state one by one */
+static void
+defer_shift_register_items (urj_chain_t *chain, const urj_tap_register_t *in,
+                            urj_tap_register_t *out, int tap_exit)
 {
     int i;
-
-    if (!(urj_tap_state (chain) & URJ_TAP_STATE_SHIFT))
-        urj_log (URJ_LOG_LEVEL_NORMAL, _("%s: Invalid state: %2X\n"), __func__,
-                urj_tap_state (chain));
+    char *bits;
 
     /* Capture-DR, Capture-IR, Shift-DR, Shift-IR, Exit2-DR or Exit2-IR state */
     if (urj_tap_state (chain) & URJ_TAP_STATE_CAPTURE)
@@ -97,16 +100,23 @@ urj_tap_defer_shift_register (urj_chain_t *chain,
     if (out && out->len < i)
         i = out->len;
 
-    if (out)
-        urj_tap_cable_defer_transfer (chain->cable, i, in->data, out->data);
-    else
-        urj_tap_cable_defer_transfer (chain->cable, i, in->data, NULL);
+    bits = urj_tap_cable_arena_alloc (chain->cable,
+                                      out ? in->len + i : in->len);
+    if (bits == NULL)
+        return;
+    urj_tap_register_unpack (in, bits);
+
+    /* the transfer, a get_tdo and a clock per remaining bit, and the
+     * clocks to leave the shift state */
+    urj_tap_cable_reserve_queue (chain->cable, 2 * (in->len - i) + 3);
+    urj_tap_cable_defer_transfer_nocopy (chain->cable, i, bits,
+                                         out ? bits + in->len : NULL);
 
     for (; i < in->len; i++)
     {
         if (out != NULL && (i < out->len))
-            out->data[i] = urj_tap_cable_defer_get_tdo (chain->cable);
-        urj_tap_chain_defer_clock (chain, (tap_exit != URJ_CHAIN_EXITMODE_SHIFT && ((i + 1) == in->len)) ? 1 : 0, in->data[i], 1);      /* Shift (& Exit1) */
+            urj_tap_cable_defer_get_tdo (chain->cable);
+        urj_tap_chain_defer_clock (chain, (tap_exit != URJ_CHAIN_EXITMODE_SHIFT && ((i + 1) == in->len)) ? 1 : 0, bits[i], 1);      /* Shift (& Exit1) */
     }
 
     /* Shift-DR, Shift-IR, Exit1-DR or Exit1-IR state */
@@ -120,6 +130,82 @@ urj_tap_defer_shift_register (urj_chain_t *chain,
         urj_tap_chain_defer_clock (chain, 1, 0, 1);     /* Update-DR or Update-IR */
 }
 
+void
+urj_tap_defer_shift_register (urj_chain_t *chain,
+                              const urj_tap_register_t *in,
+                              urj_tap_register_t *out, int tap_exit)
+{
+    int i, lead, tail, len, captured;
+    char *seq;
+
+    if (!(urj_tap_state (chain) & URJ_TAP_STATE_SHIFT))
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("%s: Invalid state: %2X\n"), __func__,
+                urj_tap_state (chain));
+
+    if (chain->cable->driver->quirks & URJ_CABLE_QUIRK_NO_TMS_SEQUENCE)
+    {
+        defer_shift_register_items (chain, in, out, tap_exit);
+        return;
+    }
+
+    /* The whole scan is one sequence: the clock from Capture to Shift (if
+     * needed), the register, and the clocks to Update and Run-Test/Idle.
+     * Together with the clocks from urj_tap_capture_dr/ir(), which the
+     * cable holds back, it goes to the driver as one item. */
+    lead = (urj_tap_state (chain) & URJ_TAP_STATE_CAPTURE) ? 1 : 0;
+    if (tap_exit == URJ_CHAIN_EXITMODE_IDLE)
+        tail = 2;
+    else if (tap_exit == URJ_CHAIN_EXITMODE_UPDATE)
+        tail = 1;
+    else
+        tail = 0;
+    len = lead + in->len + tail;
+    captured = 0;
+    if (out)
+        captured = out->len < in->len ? out->len : in->len;
+
+    seq = urj_tap_cable_arena_alloc (chain->cable, len + captured);
+    if (seq == NULL)
+        return;
+
+    /* Capture-DR, Capture-IR, Shift-DR, Shift-IR, Exit2-DR or Exit2-IR state */
+    if (lead)
+    {
+        seq[0] = 0;                                     /* save last TDO bit :-) */
+        urj_tap_state_clock (chain, 0);
+    }
+
+    urj_tap_register_unpack (in, seq + lead);   /* TDI is bit 0 */
+    for (i = 0; i < captured; i++)
+        seq[lead + i] |= URJ_CABLE_SEQ_CAPTURE;
+    if (in->len > 1)
+        urj_tap_state_clock (chain, 0);                 /* Shift */
+    if (in->len > 0)
+    {
+        if (tap_exit != URJ_CHAIN_EXITMODE_SHIFT)
+            seq[lead + in->len - 1] |= URJ_CABLE_SEQ_TMS;       /* Exit1 */
+        urj_tap_state_clock (chain, tap_exit != URJ_CHAIN_EXITMODE_SHIFT);
+    }
+
+    /* Shift-DR, Shift-IR, Exit1-DR or Exit1-IR state */
+    if (tail > 0)
+    {
+        seq[lead + in->len] = URJ_CABLE_SEQ_TMS;        /* Update-DR or Update-IR */
+        urj_tap_state_clock (chain, 1);
+    }
+    if (tail > 1)
+    {
+        seq[lead + in->len + 1] = 0;                    /* Run-Test/Idle */
+        urj_tap_state_clock (chain, 0);
+    }
+
+    urj_tap_cable_defer_tms_sequence (chain->cable, len, seq,
+                                      out ? seq + len : NULL);
+
+    if (tap_exit == URJ_CHAIN_EXITMODE_IDLE)
+        urj_tap_chain_wait_ready (chain);
+}
+
 void
 urj_tap_shift_register_output (urj_chain_t *chain,
                                const urj_tap_register_t *in,
@@ -128,6 +214,7 @@ urj_tap_shift_register_output (urj_chain_t *chain,
     if (out != NULL)
     {
         int j;
+        char *bits;
 
         j = in->len;
         if (tap_exit)
@@ -135,12 +222,24 @@ urj_tap_shift_register_output (urj_chain_t *chain,
         if (out && out->len < j)
             j = out->len;
 
+        bits = urj_tap_cable_arena_alloc (chain->cable, out->len);
+        if (bits == NULL)
+            return;
+        urj_tap_register_unpack (out, bits);
+
         /* Asking for the result of the cable transfer
          * actually flushes the queue */
 
-        (void) urj_tap_cable_transfer_late (chain->cable, out->data);
-        for (; j < in->len && j < out->len; j++)
-            out->data[j] = urj_tap_cable_get_tdo_late (chain->cable);
+        if (chain->cable->driver->quirks & URJ_CABLE_QUIRK_NO_TMS_SEQUENCE)
+        {
+            (void) urj_tap_cable_transfer_late (chain->cable, bits);
+            for (; j < in->len && j < out->len; j++)
+                bits[j] = urj_tap_cable_get_tdo_late (chain->cable);
+        }
+        else
+            (void) urj_tap_cable_tms_sequence_late (chain->cable, bits);
+
+        urj_tap_register_pack (out, bits);
     }
 }
 
@@ -160,9 +259,9 @@ urj_tap_capture_dr (urj_chain_t *chain)
         urj_log (URJ_LOG_LEVEL_NORMAL, _("%s: Invalid state: %2X\n"), __func__,
                  urj_tap_state (chain));
 
-    /* Run-Test/Idle or Update-DR or Update-IR state */
-    urj_tap_chain_defer_clock (chain, 1, 0, 1); /* Select-DR-Scan */
-    urj_tap_chain_defer_clock (chain, 0, 0, 1); /* Capture-DR */
+    /* Run-Test/Idle or Update-DR or Update-IR state; the cable holds the
+     * clocks back, so they become part of the following scan */
+    urj_tap_chain_defer_goto_state (chain, URJ_TAP_STATE_CAPTURE_DR);
 }
 
 void
@@ -173,7 +272,7 @@ urj_tap_capture_ir (urj_chain_t *chain)
         urj_log (URJ_LOG_LEVEL_NORMAL, _("%s: Invalid state: %2X\n"), __func__,
                  urj_tap_state (chain));
 
-    /* Run-Test/Idle or Update-DR or Update-IR state */
-    urj_tap_chain_defer_clock (chain, 1, 0, 2); /* Select-DR-Scan, then Select-IR-Scan */
-    urj_tap_chain_defer_clock (chain, 0, 0, 1); /* Capture-IR */
+    /* Run-Test/Idle or Update-DR or Update-IR state; the cable holds the
+     * clocks back, so they become part of the following scan */
+    urj_tap_chain_defer_goto_state (chain, URJ_TAP_STATE_CAPTURE_IR);
 }
@@ -27,7 +27,9 @@
 #include <string.h>
 #include <stddef.h>
 
+#include <urjtag/error.h>
 #include <urjtag/usbconn.h>
+#include <urjtag/cable.h>
 
 #include "usbconn.h"
 
@@ -52,17 +54,91 @@ urj_tap_usbconn_close (urj_usbconn_t *conn)
 int
 urj_tap_usbconn_read (urj_usbconn_t *conn, uint8_t *buf, int len)
 {
-    if (conn->driver->read)
-        return conn->driver->read (conn, buf, len);
-    else
+    int r;
+
+    if (!conn->driver->read)
         return 0;
+
+    r = conn->driver->read (conn, buf, len);
+    if (conn->cable != NULL)
+    {
+        conn->cable->stats.transactions++;
+        if (r > 0)
+            conn->cable->stats.bytes_in += r;
+    }
+    return r;
 }
 
 int
 urj_tap_usbconn_write (urj_usbconn_t *conn, uint8_t *buf, int len, int recv)
 {
-    if (conn->driver->write)
-        return conn->driver->write (conn, buf, len, recv);
-    else
+    int r;
+
+    if (!conn->driver->write)
         return 0;
+
+    r = conn->driver->write (conn, buf, len, recv);
+    if (conn->cable != NULL)
+    {
+        conn->cable->stats.transactions++;
+        if (r > 0)
+            conn->cable->stats.bytes_out += len;
+    }
+    return r;
+}
+
+static void
+usbconn_count (urj_usbconn_t *conn, int in, int r)
+{
+    if (conn->cable == NULL)
+        return;
+
+    conn->cable->stats.transactions++;
+    if (r > 0)
+    {
+        if (in)
+            conn->cable->stats.bytes_in += r;
+        else
+            conn->cable->stats.bytes_out += r;
+    }
+}
+
+int
+urj_tap_usbconn_bulk (urj_usbconn_t *conn, int endpoint, uint8_t *buf,
+                      int len, int timeout)
+{
+    int r;
+
+    if (!conn->driver->bulk)
+    {
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("USB driver '%s' has no bulk transfers"),
+                       conn->driver->type);
+        return -1;
+    }
+
+    r = conn->driver->bulk (conn, endpoint, buf, len, timeout);
+    usbconn_count (conn, endpoint & URJ_USBCONN_ENDPOINT_IN, r);
+    return r;
+}
+
+int
+urj_tap_usbconn_control (urj_usbconn_t *conn, int request_type, int request,
+                         int value, int index, uint8_t *buf, int len,
+                         int timeout)
+{
+    int r;
+
+    if (!conn->driver->control)
+    {
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("USB driver '%s' has no control transfers"),
+                       conn->driver->type);
+        return -1;
+    }
+
+    r = conn->driver->control (conn, request_type, request, value, index,
+                               buf, len, timeout);
+    usbconn_count (conn, request_type & URJ_USBCONN_ENDPOINT_IN, r);
+    return r;
 }
@@ -28,4 +28,17 @@
 #define _URJ_LIST(item) extern const urj_usbconn_driver_t urj_tap_usbconn_##item##_driver;
 #include "usbconn_list.h"
 
+/**
+ * Wrap @conn in a connection that writes its traffic to @filename.
+ * @return the new connection; NULL on failure, @conn is left alone then
+ */
+urj_usbconn_t *urj_tap_usbconn_record (urj_usbconn_t *conn,
+                                       const char *filename);
+/**
+ * A connection without hardware that plays back a trace written by a
+ * connection from urj_tap_usbconn_record().
+ * @return the new connection; NULL on failure
+ */
+urj_usbconn_t *urj_tap_usbconn_replay (const char *filename);
+
 #endif /* URJ_CABLE_USBCONN_H */
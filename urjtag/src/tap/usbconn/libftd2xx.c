@@ -599,7 +599,9 @@ const urj_usbconn_driver_t urj_tap_usbconn_ftd2xx_driver = {
     usbconn_ftd2xx_open,
     usbconn_ftd2xx_close,
     usbconn_ftd2xx_read,
-    usbconn_ftd2xx_write
+    usbconn_ftd2xx_write,
+    NULL,
+    NULL
 };
 
 const urj_usbconn_driver_t urj_tap_usbconn_ftd2xx_mpsse_driver = {
@@ -609,7 +611,9 @@ const urj_usbconn_driver_t urj_tap_usbconn_ftd2xx_mpsse_driver = {
     usbconn_ftd2xx_mpsse_open,
     usbconn_ftd2xx_close,
     usbconn_ftd2xx_read,
-    usbconn_ftd2xx_write
+    usbconn_ftd2xx_write,
+    NULL,
+    NULL
 };
 
 
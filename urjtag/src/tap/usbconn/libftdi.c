@@ -59,6 +59,14 @@ typedef struct
     uint32_t recv_write_idx;
     uint32_t recv_read_idx;
     uint8_t *recv_buf;
+#ifdef HAVE_LIBFTDI_ASYNC_MODE
+    /* writes in flight, see usbconn_ftdi_submit_write() */
+    struct ftdi_transfer_control *write_tc[URJ_USBCONN_FTDI_WRITE_URBS];
+    uint8_t *write_buf[URJ_USBCONN_FTDI_WRITE_URBS];
+    uint32_t write_buf_len[URJ_USBCONN_FTDI_WRITE_URBS];
+    uint32_t write_len[URJ_USBCONN_FTDI_WRITE_URBS];
+    int write_next;
+#endif
 } ftdi_param_t;
 
 static int usbconn_ftdi_common_open (urj_usbconn_t *conn, urj_log_level_t ll);
@@ -66,6 +74,100 @@ static void usbconn_ftdi_free (urj_usbconn_t *conn);
 
 /* ---------------------------------------------------------------------- */
 
+#ifdef HAVE_LIBFTDI_ASYNC_MODE
+/** @return number of bytes written; -1 on error */
+static int
+usbconn_ftdi_write_done (ftdi_param_t *p, int slot)
+{
+    int xferred = ftdi_transfer_data_done (p->write_tc[slot]);
+
+    p->write_tc[slot] = NULL;
+    if (xferred < 0)
+    {
+        urj_error_set (URJ_ERROR_FTD, "%s", ftdi_get_error_string (p->fc));
+        return -1;
+    }
+    if (xferred < p->write_len[slot])
+    {
+        urj_error_set (URJ_ERROR_FTD, _("Written fewer bytes than requested."));
+        return -1;
+    }
+
+    return xferred;
+}
+
+/** Wait for all writes in flight, oldest first.
+ * @return 0 on success; -1 on error */
+static int
+usbconn_ftdi_wait_writes (ftdi_param_t *p)
+{
+    int i, slot;
+    int r = 0;
+
+    for (i = 0; i < URJ_USBCONN_FTDI_WRITE_URBS; i++)
+    {
+        slot = (p->write_next + i) % URJ_USBCONN_FTDI_WRITE_URBS;
+        if (p->write_tc[slot] != NULL && usbconn_ftdi_write_done (p, slot) < 0)
+            r = -1;
+    }
+
+    return r;
+}
+
+/* Hand the send buffer over to a write transfer of its own and go on with
+ * an idle buffer. With several writes in flight, a long stream of data
+ * reaches the chip without waiting for a round trip per buffer.
+ * @return number of bytes submitted; -1 on error */
+static int
+usbconn_ftdi_submit_write (ftdi_param_t *p)
+{
+    int slot = p->write_next;
+    uint8_t *buf;
+    uint32_t buf_len;
+    int xferred;
+
+    if (p->send_buffered == 0)
+        return 0;
+
+    /* the oldest write has to be finished to reuse its slot */
+    if (p->write_tc[slot] != NULL && usbconn_ftdi_write_done (p, slot) < 0)
+        return -1;
+    if (p->write_buf[slot] == NULL)
+    {
+        p->write_buf_len[slot] = URJ_USBCONN_FTDX_MAXSEND;
+        p->write_buf[slot] = malloc (p->write_buf_len[slot]);
+        if (p->write_buf[slot] == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("malloc(%zd) fails"),
+                           (size_t) p->write_buf_len[slot]);
+            return -1;
+        }
+    }
+
+    p->write_tc[slot] = ftdi_write_data_submit (p->fc, p->send_buf,
+                                                p->send_buffered);
+    if (p->write_tc[slot] == NULL)
+    {
+        urj_error_set (URJ_ERROR_FTD,
+                       _("Error from ftdi_write_data_submit(): %s"),
+                       ftdi_get_error_string (p->fc));
+        return -1;
+    }
+    xferred = p->write_len[slot] = p->send_buffered;
+
+    buf = p->write_buf[slot];
+    buf_len = p->write_buf_len[slot];
+    p->write_buf[slot] = p->send_buf;
+    p->write_buf_len[slot] = p->send_buf_len;
+    p->send_buf = buf;
+    p->send_buf_len = buf_len;
+    p->send_buffered = 0;
+    p->write_next = (slot + 1) % URJ_USBCONN_FTDI_WRITE_URBS;
+
+    return xferred;
+}
+#endif
+
 /** @return number of bytes flushed; -1 on error */
 static int
 usbconn_ftdi_flush (ftdi_param_t *p)
@@ -100,6 +202,15 @@ usbconn_ftdi_flush (ftdi_param_t *p)
     /* now read all scheduled receive bytes */
     if (p->to_recv)
     {
+        if (p->recv_write_idx + p->to_recv > p->recv_buf_len
+            && p->recv_read_idx > 0)
+        {
+            /* move the unread bytes to the front instead of growing */
+            memmove (p->recv_buf, &(p->recv_buf[p->recv_read_idx]),
+                     p->recv_write_idx - p->recv_read_idx);
+            p->recv_write_idx -= p->recv_read_idx;
+            p->recv_read_idx = 0;
+        }
         if (p->recv_write_idx + p->to_recv > p->recv_buf_len)
         {
             /* extend receive buffer */
@@ -116,27 +227,21 @@ usbconn_ftdi_flush (ftdi_param_t *p)
         }
 
 #ifdef HAVE_LIBFTDI_ASYNC_MODE
+        /* the read is under way before the writes producing its data, so
+         * the chip never has to hold back results for lack of room */
         if ((tc = ftdi_read_data_submit (p->fc,
                                          &(p->recv_buf[p->recv_write_idx]),
                                          p->to_recv)) == NULL)
+        {
             urj_error_set (URJ_ERROR_FTD,
                            _("Error from ftdi_read_data_submit(): %s"),
                            ftdi_get_error_string (p->fc));
+            return -1;
+        }
     }
 
-    if ((xferred = ftdi_write_data (p->fc, p->send_buf, p->send_buffered)) < 0)
-    {
-        urj_error_set (URJ_ERROR_FTD, "%s", ftdi_get_error_string (p->fc));
-        return -1;
-    }
-
-    if (xferred < p->send_buffered)
-    {
-        urj_error_set (URJ_ERROR_FTD, _("Written fewer bytes than requested."));
+    if ((xferred = usbconn_ftdi_submit_write (p)) < 0)
         return -1;
-    }
-
-    p->send_buffered = 0;
 
     if (p->to_recv)
     {
@@ -179,6 +284,10 @@ usbconn_ftdi_read (urj_usbconn_t *conn, uint8_t *buf, int len)
     /* flush send buffer to get all scheduled receive bytes */
     if (usbconn_ftdi_flush (p) < 0)
         return -1;
+#ifdef HAVE_LIBFTDI_ASYNC_MODE
+    if (usbconn_ftdi_wait_writes (p) < 0)
+        return -1;
+#endif
 
     if (len == 0)
         return 0;
@@ -288,6 +397,12 @@ usbconn_ftdi_connect (urj_usbconn_cable_t *template,
         p->recv_write_idx = 0;
         p->recv_read_idx = 0;
         p->recv_buf = malloc (p->recv_buf_len);
+#ifdef HAVE_LIBFTDI_ASYNC_MODE
+        memset (p->write_tc, 0, sizeof (p->write_tc));
+        memset (p->write_buf, 0, sizeof (p->write_buf));
+        memset (p->write_buf_len, 0, sizeof (p->write_buf_len));
+        p->write_next = 0;
+#endif
     }
 
     if (!p || !c || !fc || !p->send_buf || !p->recv_buf)
@@ -625,6 +740,9 @@ usbconn_ftdi_close (urj_usbconn_t *conn)
 
     if (p->fc)
     {
+#ifdef HAVE_LIBFTDI_ASYNC_MODE
+        usbconn_ftdi_wait_writes (p);
+#endif
         ftdi_usb_close (p->fc);
         ftdi_deinit (p->fc);
         p->fc = NULL;
@@ -644,6 +762,15 @@ usbconn_ftdi_free (urj_usbconn_t *conn)
         free (p->send_buf);
     if (p->recv_buf)
         free (p->recv_buf);
+#ifdef HAVE_LIBFTDI_ASYNC_MODE
+    {
+        int i;
+
+        for (i = 0; i < URJ_USBCONN_FTDI_WRITE_URBS; i++)
+            if (p->write_buf[i])
+                free (p->write_buf[i]);
+    }
+#endif
     if (p->fc)
         free (p->fc);
     if (p->serial)
@@ -662,7 +789,9 @@ const urj_usbconn_driver_t urj_tap_usbconn_ftdi_driver = {
     usbconn_ftdi_open,
     usbconn_ftdi_close,
     usbconn_ftdi_read,
-    usbconn_ftdi_write
+    usbconn_ftdi_write,
+    NULL,
+    NULL
 };
 
 const urj_usbconn_driver_t urj_tap_usbconn_ftdi_mpsse_driver = {
@@ -672,7 +801,9 @@ const urj_usbconn_driver_t urj_tap_usbconn_ftdi_mpsse_driver = {
     usbconn_ftdi_mpsse_open,
     usbconn_ftdi_close,
     usbconn_ftdi_read,
-    usbconn_ftdi_write
+    usbconn_ftdi_write,
+    NULL,
+    NULL
 };
 
 
@@ -29,14 +29,27 @@
 /* Maximum chunk to receive from ftdi/ftd2xx driver.
    Larger values might speed up comm, but there's an upper limit
    when too many bytes are sent and the underlying libftdi or libftd2xx
-   don't fetch the returned data in time -> deadlock */
+   don't fetch the returned data in time -> deadlock.
+   In async mode, libftdi has the read under way before the data that
+   produces the results is written, so it can take as much as fits into
+   one MPSSE command buffer. */
 #ifdef HAVE_LIBFTDI_ASYNC_MODE
-#define URJ_USBCONN_FTDI_MAXRECV   (63 * 64)
+#define URJ_USBCONN_FTDI_MAXRECV   URJ_USBCONN_FTDX_MAXSEND_MPSSE
 #else
 #define URJ_USBCONN_FTDI_MAXRECV   ( 4 * 64)
 #endif
 #define URJ_USBCONN_FTD2XX_MAXRECV (63 * 64)
+/* the limit for cable drivers: that of the lowlevel drivers built in */
+#if defined ENABLE_LOWLEVEL_FTDI && defined ENABLE_LOWLEVEL_FTD2XX
 #define URJ_USBCONN_FTDX_MAXRECV   (URJ_USBCONN_FTD2XX_MAXRECV < URJ_USBCONN_FTDI_MAXRECV ? URJ_USBCONN_FTD2XX_MAXRECV : URJ_USBCONN_FTDI_MAXRECV)
+#elif defined ENABLE_LOWLEVEL_FTD2XX
+#define URJ_USBCONN_FTDX_MAXRECV   URJ_USBCONN_FTD2XX_MAXRECV
+#else
+#define URJ_USBCONN_FTDX_MAXRECV   URJ_USBCONN_FTDI_MAXRECV
+#endif
+
+/* Number of writes libftdi may have in flight in async mode */
+#define URJ_USBCONN_FTDI_WRITE_URBS 4
 
 /*
  * Helpers to avoid having to copy & paste ifdef's everywhere
@@ -255,6 +255,52 @@ usbconn_libusb_free (urj_usbconn_t *conn)
 
 /* ---------------------------------------------------------------------- */
 
+static int
+usbconn_libusb_bulk (urj_usbconn_t *conn, int endpoint, uint8_t *buf,
+                     int len, int timeout)
+{
+    urj_usbconn_libusb_param_t *p = conn->params;
+    int ret, actual = 0;
+
+    ret = libusb_bulk_transfer (p->handle, endpoint, buf, len, &actual,
+                                timeout);
+    /* a timeout may still have moved some of the data */
+    if (ret && actual == 0)
+    {
+        urj_error_set (URJ_ERROR_USB,
+                       "libusb_bulk_transfer(0x%02x) failed: %i", endpoint,
+                       ret);
+        return -1;
+    }
+
+    return actual;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int
+usbconn_libusb_control (urj_usbconn_t *conn, int request_type, int request,
+                        int value, int index, uint8_t *buf, int len,
+                        int timeout)
+{
+    urj_usbconn_libusb_param_t *p = conn->params;
+    int ret;
+
+    ret = libusb_control_transfer (p->handle, request_type, request, value,
+                                   index, buf, len, timeout);
+    if (ret < 0)
+    {
+        urj_error_set (URJ_ERROR_USB,
+                       "libusb_control_transfer(0x%02x) failed: %i", request,
+                       ret);
+        return -1;
+    }
+
+    return ret;
+}
+
+/* ---------------------------------------------------------------------- */
+
 const urj_usbconn_driver_t urj_tap_usbconn_libusb_driver = {
     "libusb",
     usbconn_libusb_connect,
@@ -262,5 +308,7 @@ const urj_usbconn_driver_t urj_tap_usbconn_libusb_driver = {
     usbconn_libusb_open,
     usbconn_libusb_close,
     NULL,
-    NULL
+    NULL,
+    usbconn_libusb_bulk,
+    usbconn_libusb_control
 };
@@ -0,0 +1,501 @@
+/*
+ * $Id$
+ *
+ * Record and replay of the traffic of an USB connection
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ * The "record" connection wraps a real one and writes every open, close,
+ * read, write, bulk and control transfer to a trace file. The "replay"
+ * connection needs no hardware: it checks the data sent by the cable
+ * driver against a trace and answers the reads from it. A trace is plain
+ * text, one record per operation, e.g.
+ *
+ *   0.001234 write 3 2 3
+ *    4b 00 ff
+ *   0.001300 read 2 2
+ *    ab cd
+ *   0.001420 bulk 81 64 1
+ *    00
+ *
+ * with the time since opening in seconds, the operation, its arguments
+ * and result, and the data in hex. The arguments are the length and for
+ * writes the bytes to receive; for bulk transfers the endpoint (hex) and
+ * length; for control transfers the request type, request, value and
+ * index (all hex) and length. The data is what was sent, or for reads and
+ * transfers from the device what was received. Lines starting with '#'
+ * are comments.
+ */
+
+#include <sysdep.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <urjtag/error.h>
+#include <urjtag/log.h>
+#include <urjtag/usbconn.h>
+#include <urjtag/fclock.h>
+
+#include "../usbconn.h"
+
+typedef struct
+{
+    FILE *f;
+    urj_usbconn_t *conn;        /* recording: the real connection */
+    long double start;
+    unsigned long record;       /* replaying: number of the next record */
+    int failed;                 /* replaying: out of sync with the trace */
+}
+replay_param_t;
+
+/* ---------------------------------------------------------------------- */
+
+static void
+record_data (FILE *f, const uint8_t *buf, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        fprintf (f, "%s%02x", (i % 16) == 0 ? "\n " : " ", buf[i]);
+    fputc ('\n', f);
+}
+
+static void
+record_time (replay_param_t *p)
+{
+    fprintf (p->f, "%.6Lf ", urj_lib_frealtime () - p->start);
+}
+
+static int
+usbconn_record_open (urj_usbconn_t *conn)
+{
+    replay_param_t *p = conn->params;
+    int r;
+
+    p->start = urj_lib_frealtime ();
+    r = p->conn->driver->open (p->conn);
+    record_time (p);
+    fprintf (p->f, "open %d\n", r);
+
+    return r;
+}
+
+static int
+usbconn_record_close (urj_usbconn_t *conn)
+{
+    replay_param_t *p = conn->params;
+    int r;
+
+    r = p->conn->driver->close (p->conn);
+    record_time (p);
+    fprintf (p->f, "close %d\n", r);
+    fflush (p->f);
+
+    return r;
+}
+
+static int
+usbconn_record_read (urj_usbconn_t *conn, uint8_t *buf, int len)
+{
+    replay_param_t *p = conn->params;
+    int r;
+
+    if (p->conn->driver->read == NULL)
+        return 0;
+
+    r = p->conn->driver->read (p->conn, buf, len);
+    record_time (p);
+    fprintf (p->f, "read %d %d", len, r);
+    record_data (p->f, buf, r > 0 ? r : 0);
+
+    return r;
+}
+
+static int
+usbconn_record_write (urj_usbconn_t *conn, uint8_t *buf, int len, int recv)
+{
+    replay_param_t *p = conn->params;
+    int r;
+
+    if (p->conn->driver->write == NULL)
+        return 0;
+
+    r = p->conn->driver->write (p->conn, buf, len, recv);
+    record_time (p);
+    fprintf (p->f, "write %d %d %d", len, recv, r);
+    record_data (p->f, buf, len);
+
+    return r;
+}
+
+static int
+usbconn_record_bulk (urj_usbconn_t *conn, int endpoint, uint8_t *buf,
+                     int len, int timeout)
+{
+    replay_param_t *p = conn->params;
+    int r;
+
+    r = urj_tap_usbconn_bulk (p->conn, endpoint, buf, len, timeout);
+    record_time (p);
+    fprintf (p->f, "bulk %02x %d %d", endpoint, len, r);
+    if (endpoint & URJ_USBCONN_ENDPOINT_IN)
+        record_data (p->f, buf, r > 0 ? r : 0);
+    else
+        record_data (p->f, buf, len);
+
+    return r;
+}
+
+static int
+usbconn_record_control (urj_usbconn_t *conn, int request_type, int request,
+                        int value, int index, uint8_t *buf, int len,
+                        int timeout)
+{
+    replay_param_t *p = conn->params;
+    int r;
+
+    r = urj_tap_usbconn_control (p->conn, request_type, request, value,
+                                 index, buf, len, timeout);
+    record_time (p);
+    fprintf (p->f, "control %02x %02x %04x %04x %d %d", request_type,
+             request, value, index, len, r);
+    if (request_type & URJ_USBCONN_ENDPOINT_IN)
+        record_data (p->f, buf, r > 0 ? r : 0);
+    else
+        record_data (p->f, buf, len);
+
+    return r;
+}
+
+static void
+usbconn_record_free (urj_usbconn_t *conn)
+{
+    replay_param_t *p = conn->params;
+
+    p->conn->driver->free (p->conn);
+    fclose (p->f);
+    free (p);
+    free (conn);
+}
+
+static const urj_usbconn_driver_t urj_tap_usbconn_record_driver = {
+    "record",
+    NULL,
+    usbconn_record_free,
+    usbconn_record_open,
+    usbconn_record_close,
+    usbconn_record_read,
+    usbconn_record_write,
+    usbconn_record_bulk,
+    usbconn_record_control
+};
+
+urj_usbconn_t *
+urj_tap_usbconn_record (urj_usbconn_t *conn, const char *filename)
+{
+    urj_usbconn_t *c;
+    replay_param_t *p;
+
+    c = malloc (sizeof (urj_usbconn_t));
+    p = calloc (1, sizeof (replay_param_t));
+    if (c == NULL || p == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY,
+                       _("malloc(%zd)/calloc(%zd) fails"),
+                       sizeof (urj_usbconn_t), sizeof (replay_param_t));
+        free (c);
+        free (p);
+        return NULL;
+    }
+
+    p->f = fopen (filename, "w");
+    if (p->f == NULL)
+    {
+        urj_error_IO_set (_("Unable to create trace file '%s'"), filename);
+        free (c);
+        free (p);
+        return NULL;
+    }
+    fprintf (p->f, "# UrJTAG USB trace, driver %s\n", conn->driver->type);
+
+    p->conn = conn;
+    p->start = urj_lib_frealtime ();
+    c->driver = &urj_tap_usbconn_record_driver;
+    c->params = p;
+    c->cable = NULL;
+
+    return c;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int
+replay_fail (replay_param_t *p, const char *what)
+{
+    urj_error_set (URJ_ERROR_ILLEGAL_STATE, _("replay record %lu: %s"),
+                   p->record, what);
+    urj_warning ("%s\n", urj_error_describe ());
+    p->failed = 1;
+
+    return -1;
+}
+
+/* Read the header of the next record, which must be @op. Its arguments
+ * and result follow in the trace. */
+static int
+replay_next (replay_param_t *p, const char *op)
+{
+    char name[16];
+    char msg[64];
+    long double t;
+    int c;
+
+    if (p->failed)
+    {
+        urj_error_set (URJ_ERROR_ILLEGAL_STATE,
+                       _("replay is out of sync with the trace"));
+        return URJ_STATUS_FAIL;
+    }
+
+    /* skip comments */
+    while ((c = fgetc (p->f)) == '#' || c == '\n' || c == ' ')
+        if (c == '#')
+            while ((c = fgetc (p->f)) != EOF && c != '\n');
+    if (c != EOF)
+        ungetc (c, p->f);
+
+    p->record++;
+    if (fscanf (p->f, "%Lf %15s", &t, name) != 2)
+    {
+        snprintf (msg, sizeof msg, _("end of trace before %s"), op);
+        replay_fail (p, msg);
+        return URJ_STATUS_FAIL;
+    }
+    if (strcmp (name, op) != 0)
+    {
+        snprintf (msg, sizeof msg, _("%s instead of %s"), name, op);
+        replay_fail (p, msg);
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+static int
+usbconn_replay_open (urj_usbconn_t *conn)
+{
+    replay_param_t *p = conn->params;
+    int r;
+
+    if (replay_next (p, "open") != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (fscanf (p->f, "%d", &r) != 1)
+    {
+        replay_fail (p, _("malformed open"));
+        return URJ_STATUS_FAIL;
+    }
+
+    return r;
+}
+
+static int
+usbconn_replay_close (urj_usbconn_t *conn)
+{
+    replay_param_t *p = conn->params;
+    int r;
+
+    if (replay_next (p, "close") != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (fscanf (p->f, "%d", &r) != 1)
+    {
+        replay_fail (p, _("malformed close"));
+        return URJ_STATUS_FAIL;
+    }
+
+    return r;
+}
+
+static int
+usbconn_replay_read (urj_usbconn_t *conn, uint8_t *buf, int len)
+{
+    replay_param_t *p = conn->params;
+    unsigned int v;
+    int l, r, i;
+
+    if (replay_next (p, "read") != URJ_STATUS_OK)
+        return -1;
+    if (fscanf (p->f, "%d %d", &l, &r) != 2)
+        return replay_fail (p, _("malformed read"));
+    if (l != len)
+        return replay_fail (p, _("read of a different length"));
+
+    for (i = 0; i < r; i++)
+    {
+        if (fscanf (p->f, "%2x", &v) != 1)
+            return replay_fail (p, _("malformed read data"));
+        buf[i] = v;
+    }
+
+    return r;
+}
+
+static int
+usbconn_replay_write (urj_usbconn_t *conn, uint8_t *buf, int len, int recv)
+{
+    replay_param_t *p = conn->params;
+    unsigned int v;
+    int l, rl, r, i;
+
+    if (replay_next (p, "write") != URJ_STATUS_OK)
+        return -1;
+    if (fscanf (p->f, "%d %d %d", &l, &rl, &r) != 3)
+        return replay_fail (p, _("malformed write"));
+    if (l != len || rl != recv)
+        return replay_fail (p, _("write of a different length"));
+
+    for (i = 0; i < len; i++)
+    {
+        if (fscanf (p->f, "%2x", &v) != 1)
+            return replay_fail (p, _("malformed write data"));
+        if (v != buf[i])
+            return replay_fail (p, _("written data differs"));
+    }
+
+    return r;
+}
+
+/* Fill buf with the data of the current record if the transfer came from
+ * the device, otherwise check buf against it. */
+static int
+replay_data (replay_param_t *p, int in, uint8_t *buf, int len, int r)
+{
+    unsigned int v;
+    int i;
+
+    for (i = 0; i < (in ? r : len); i++)
+    {
+        if (fscanf (p->f, "%2x", &v) != 1)
+            return replay_fail (p, _("malformed transfer data"));
+        if (in)
+            buf[i] = v;
+        else if (v != buf[i])
+            return replay_fail (p, _("sent data differs"));
+    }
+
+    if (r < 0)
+        urj_error_set (URJ_ERROR_USB, _("replay record %lu: transfer failed"),
+                       p->record);
+
+    return r;
+}
+
+static int
+usbconn_replay_bulk (urj_usbconn_t *conn, int endpoint, uint8_t *buf,
+                     int len, int timeout)
+{
+    replay_param_t *p = conn->params;
+    unsigned int ep;
+    int l, r;
+
+    if (replay_next (p, "bulk") != URJ_STATUS_OK)
+        return -1;
+    if (fscanf (p->f, "%x %d %d", &ep, &l, &r) != 3 || r > l)
+        return replay_fail (p, _("malformed bulk"));
+    if (ep != endpoint || l != len)
+        return replay_fail (p, _("bulk transfer of a different endpoint or length"));
+
+    return replay_data (p, endpoint & URJ_USBCONN_ENDPOINT_IN, buf, len, r);
+}
+
+static int
+usbconn_replay_control (urj_usbconn_t *conn, int request_type, int request,
+                        int value, int index, uint8_t *buf, int len,
+                        int timeout)
+{
+    replay_param_t *p = conn->params;
+    unsigned int rt, rq, val, idx;
+    int l, r;
+
+    if (replay_next (p, "control") != URJ_STATUS_OK)
+        return -1;
+    if (fscanf (p->f, "%x %x %x %x %d %d", &rt, &rq, &val, &idx, &l, &r) != 6
+        || r > l)
+        return replay_fail (p, _("malformed control"));
+    if (rt != request_type || rq != request || val != value || idx != index
+        || l != len)
+        return replay_fail (p, _("different control transfer"));
+
+    return replay_data (p, request_type & URJ_USBCONN_ENDPOINT_IN, buf, len,
+                        r);
+}
+
+static void
+usbconn_replay_free (urj_usbconn_t *conn)
+{
+    replay_param_t *p = conn->params;
+
+    fclose (p->f);
+    free (p);
+    free (conn);
+}
+
+static const urj_usbconn_driver_t urj_tap_usbconn_replay_driver = {
+    "replay",
+    NULL,
+    usbconn_replay_free,
+    usbconn_replay_open,
+    usbconn_replay_close,
+    usbconn_replay_read,
+    usbconn_replay_write,
+    usbconn_replay_bulk,
+    usbconn_replay_control
+};
+
+urj_usbconn_t *
+urj_tap_usbconn_replay (const char *filename)
+{
+    urj_usbconn_t *c;
+    replay_param_t *p;
+
+    c = malloc (sizeof (urj_usbconn_t));
+    p = calloc (1, sizeof (replay_param_t));
+    if (c == NULL || p == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY,
+                       _("malloc(%zd)/calloc(%zd) fails"),
+                       sizeof (urj_usbconn_t), sizeof (replay_param_t));
+        free (c);
+        free (p);
+        return NULL;
+    }
+
+    p->f = fopen (filename, "r");
+    if (p->f == NULL)
+    {
+        urj_error_IO_set (_("Unable to open trace file '%s'"), filename);
+        free (c);
+        free (p);
+        return NULL;
+    }
+
+    c->driver = &urj_tap_usbconn_replay_driver;
+    c->params = p;
+    c->cable = NULL;
+
+    return c;
+}